@@ -6,6 +6,7 @@ option(BUILD_MINI_FRONTEND "Build the Mini frontend" OFF)
 option(BUILD_REGTEST "Build regression test runner" OFF)
 option(BUILD_TESTS "Build unit tests" OFF)
 option(DISABLE_SSE4 "Build with SSE4 instructions disabled, reduces performance" OFF)
+option(USE_TIMING_EVENT_HEAP "Schedule timing events with an indexed heap instead of a sorted list" OFF)
 
 if(LINUX OR BSD)
   option(ENABLE_X11 "Support X11 window system" ON)
@@ -25,6 +25,9 @@ endif()
 if(BUILD_TESTS)
   message(STATUS "Building unit tests.")
 endif()
+if(USE_TIMING_EVENT_HEAP)
+  message(STATUS "Using indexed heap timing event scheduler.")
+endif()
 
 if(ALLOW_INSTALL)
   message(WARNING "Install target is enabled. This will install all DuckStation files into:
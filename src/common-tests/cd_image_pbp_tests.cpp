@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "util/cd_image.h"
+
+#include "common/bitutils.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/path.h"
+#include "common/timer.h"
+
+#include "zlib.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+using SectorBuffer = std::array<u8, CDImage::RAW_SECTOR_SIZE>;
+
+static constexpr u32 SECTORS_PER_BLOCK = 16;
+static constexpr u32 BLOCK_SIZE = CDImage::RAW_SECTOR_SIZE * SECTORS_PER_BLOCK;
+static constexpr u32 BLOCK_TABLE_ENTRIES = 32256;
+static constexpr u32 PSAR_OFFSET = 0x100;
+static constexpr u32 ISO_DATA_OFFSET = 0x4000 + BLOCK_TABLE_ENTRIES * 32;
+
+/// Deletes the image when the test finishes.
+class TemporaryImage
+{
+public:
+  explicit TemporaryImage(const char* name)
+    : m_path(Path::Combine(std::filesystem::temp_directory_path().string(), name))
+  {
+  }
+  ~TemporaryImage() { FileSystem::DeleteFile(m_path.c_str()); }
+
+  const char* GetPath() const { return m_path.c_str(); }
+
+private:
+  std::string m_path;
+};
+
+} // namespace
+
+static void PutU16(std::vector<u8>& data, size_t offset, u16 value)
+{
+  std::memcpy(&data[offset], &value, sizeof(value));
+}
+
+static void PutU32(std::vector<u8>& data, size_t offset, u32 value)
+{
+  std::memcpy(&data[offset], &value, sizeof(value));
+}
+
+static std::vector<u8> MakeDiscData(u32 num_sectors, u32 seed)
+{
+  // Low entropy, so it deflates by a similar ratio to real discs.
+  std::vector<u8> ret(static_cast<size_t>(num_sectors) * CDImage::RAW_SECTOR_SIZE);
+  std::mt19937 rng(seed);
+  for (size_t i = 0; i < ret.size(); i++)
+    ret[i] = static_cast<u8>((i / 64) ^ (rng() & 3));
+  return ret;
+}
+
+/// Writes a single disc EBOOT.PBP with one data track. Blocks in stored_blocks are written without compression.
+static bool WritePBPImage(const char* path, const std::vector<u8>& disc, std::initializer_list<u32> stored_blocks = {})
+{
+  const u32 num_sectors = static_cast<u32>(disc.size() / CDImage::RAW_SECTOR_SIZE);
+  const u32 num_blocks = num_sectors / SECTORS_PER_BLOCK;
+  if ((num_sectors % SECTORS_PER_BLOCK) != 0 || num_blocks > BLOCK_TABLE_ENTRIES)
+    return false;
+
+  std::vector<u8> header(PSAR_OFFSET + ISO_DATA_OFFSET);
+
+  // PBP header, and a PARAM.SFO with the keys needed to identify a PS1 disc.
+  std::memcpy(&header[0], "\0PBP", 4);
+  PutU32(header, 0x04, 0x10000);
+  for (u32 i = 0; i < 7; i++)
+    PutU32(header, 0x08 + i * 4, 0x28);
+  PutU32(header, 0x24, PSAR_OFFSET);
+
+  static constexpr u32 SFO = 0x28;
+  static constexpr char keys[] = "BOOTABLE\0CATEGORY";
+  std::memcpy(&header[SFO], "\0PSF", 4);
+  PutU32(header, SFO + 0x04, 0x101);
+  PutU32(header, SFO + 0x08, 0x14 + 2 * 0x10);
+  PutU32(header, SFO + 0x0C, 0x14 + 2 * 0x10 + sizeof(keys) + 2);
+  PutU32(header, SFO + 0x10, 2);
+  PutU16(header, SFO + 0x14, 0);
+  PutU16(header, SFO + 0x16, 0x0404);
+  PutU32(header, SFO + 0x18, 4);
+  PutU32(header, SFO + 0x1C, 4);
+  PutU32(header, SFO + 0x20, 0);
+  PutU16(header, SFO + 0x24, 9);
+  PutU16(header, SFO + 0x26, 0x0204);
+  PutU32(header, SFO + 0x28, 3);
+  PutU32(header, SFO + 0x2C, 4);
+  PutU32(header, SFO + 0x30, 4);
+  std::memcpy(&header[SFO + 0x34], keys, sizeof(keys));
+  PutU32(header, SFO + 0x34 + sizeof(keys) + 2, 1);
+  std::memcpy(&header[SFO + 0x34 + sizeof(keys) + 6], "ME", 3);
+
+  // PSAR, with the TOC at 0x800: first track, last track, lead-out, then the data track with a two second pregap.
+  std::memcpy(&header[PSAR_OFFSET], "PSISOIMG0000", 12);
+  static constexpr u32 TOC = PSAR_OFFSET + 0x800;
+  const CDImage::Position leadout = CDImage::Position::FromLBA(num_sectors);
+  const u8 toc[4][10] = {
+    {0x41, 0, 0xA0, 0, 0, 0, 0, 0x01, 0x20, 0x00},
+    {0x41, 0, 0xA1, 0, 0, 0, 0, 0x01, 0x00, 0x00},
+    {0x41, 0, 0xA2, 0, 0, 0, 0, BinaryToBCD(leadout.minute), BinaryToBCD(leadout.second), BinaryToBCD(leadout.frame)},
+    {0x41, 0, 0x01, 0x00, 0x00, 0x00, 0, 0x00, 0x02, 0x00},
+  };
+  std::memcpy(&header[TOC], toc, sizeof(toc));
+  PutU32(header, PSAR_OFFSET + 0xBFC, ISO_DATA_OFFSET);
+
+  std::vector<u8> blocks;
+  std::vector<u8> compressed(compressBound(BLOCK_SIZE));
+  for (u32 i = 0; i < num_blocks; i++)
+  {
+    const u8* block = &disc[static_cast<size_t>(i) * BLOCK_SIZE];
+    size_t size = BLOCK_SIZE;
+    if (std::find(stored_blocks.begin(), stored_blocks.end(), i) == stored_blocks.end())
+    {
+      z_stream zs = {};
+      if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+      zs.next_in = const_cast<u8*>(block);
+      zs.avail_in = BLOCK_SIZE;
+      zs.next_out = compressed.data();
+      zs.avail_out = static_cast<uInt>(compressed.size());
+      const int res = deflate(&zs, Z_FINISH);
+      size = zs.total_out;
+      deflateEnd(&zs);
+      if (res != Z_STREAM_END || size >= BLOCK_SIZE)
+        return false;
+
+      block = compressed.data();
+    }
+
+    const size_t entry = PSAR_OFFSET + 0x4000 + i * 32;
+    PutU32(header, entry, static_cast<u32>(blocks.size()));
+    PutU16(header, entry + 4, static_cast<u16>(size));
+    blocks.insert(blocks.end(), block, block + size);
+  }
+
+  auto fp = FileSystem::OpenManagedCFile(path, "wb");
+  return (fp && std::fwrite(header.data(), header.size(), 1, fp.get()) == 1 &&
+          std::fwrite(blocks.data(), blocks.size(), 1, fp.get()) == 1);
+}
+
+static bool ReadSector(CDImage* image, u32 sector, SectorBuffer* buffer)
+{
+  // Data starts after the track 1 pregap.
+  return (image->Seek(2 * 75 + sector) && image->ReadRawSector(buffer->data(), nullptr));
+}
+
+TEST(CDImagePBP, ReadsMatchSource)
+{
+  static constexpr u32 NUM_SECTORS = 64 * SECTORS_PER_BLOCK;
+
+  const TemporaryImage file("duckstation_pbp_test.pbp");
+  const std::vector<u8> disc = MakeDiscData(NUM_SECTORS, 1234);
+  ASSERT_TRUE(WritePBPImage(file.GetPath(), disc, {3, 40}));
+
+  Error error;
+  std::unique_ptr<CDImage> image = CDImage::OpenPBPImage(file.GetPath(), &error);
+  ASSERT_TRUE(image) << error.GetDescription();
+  ASSERT_EQ(image->GetTrackCount(), 1u);
+  ASSERT_EQ(image->GetTrackLength(1), 2 * 75 + NUM_SECTORS);
+
+  // Sequential reads go through prefetching, random reads land on blocks which are still being inflated.
+  SectorBuffer buffer;
+  for (u32 i = 0; i < NUM_SECTORS; i++)
+  {
+    ASSERT_TRUE(ReadSector(image.get(), i, &buffer)) << "sector " << i;
+    ASSERT_EQ(std::memcmp(buffer.data(), &disc[i * CDImage::RAW_SECTOR_SIZE], buffer.size()), 0) << "sector " << i;
+  }
+
+  std::mt19937 rng(5678);
+  for (u32 i = 0; i < 500; i++)
+  {
+    const u32 sector = rng() % NUM_SECTORS;
+    ASSERT_TRUE(ReadSector(image.get(), sector, &buffer)) << "sector " << sector;
+    ASSERT_EQ(std::memcmp(buffer.data(), &disc[sector * CDImage::RAW_SECTOR_SIZE], buffer.size()), 0)
+      << "sector " << sector;
+  }
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(CDImagePBP, DISABLED_Benchmark)
+{
+  static constexpr u32 NUM_SECTORS = 1024 * SECTORS_PER_BLOCK;
+  static constexpr u32 NUM_RANDOM_READS = 4096;
+
+  const TemporaryImage file("duckstation_pbp_benchmark.pbp");
+  ASSERT_TRUE(WritePBPImage(file.GetPath(), MakeDiscData(NUM_SECTORS, 1234)));
+
+  const auto run = [&file](const char* name, u32 num_reads, const auto& get_sector) {
+    Error error;
+    std::unique_ptr<CDImage> image = CDImage::OpenPBPImage(file.GetPath(), &error);
+    ASSERT_TRUE(image) << error.GetDescription();
+
+    SectorBuffer buffer;
+    Timer timer;
+    for (u32 i = 0; i < num_reads; i++)
+      ASSERT_TRUE(ReadSector(image.get(), get_sector(i), &buffer));
+
+    const double ms = timer.GetTimeMilliseconds();
+    std::printf("%s: %u sectors in %.3f ms, %.1f MB/s\n", name, num_reads, ms,
+                (static_cast<double>(num_reads * CDImage::RAW_SECTOR_SIZE) / 1048576.0) / (ms / 1000.0));
+  };
+
+  run("Sequential", NUM_SECTORS, [](u32 i) { return i; });
+
+  std::mt19937 rng(5678);
+  run("Random", NUM_RANDOM_READS, [&rng](u32) { return static_cast<u32>(rng() % NUM_SECTORS); });
+}
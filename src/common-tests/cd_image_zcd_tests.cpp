@@ -0,0 +1,237 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "util/cd_image.h"
+#include "util/cd_sector_ecc.h"
+
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/heap_array.h"
+#include "common/path.h"
+
+#include "fmt/format.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using SectorBuffer = std::array<u8, CDImage::RAW_SECTOR_SIZE>;
+
+/// Two track disc held in memory: a mode 2 data track with its pregap not in the file, then an audio track.
+class TestImage final : public CDImage
+{
+public:
+  static constexpr u32 DATA_SECTORS = 3000;
+  static constexpr u32 AUDIO_SECTORS = 1001;
+  static constexpr u32 BAD_ECC_SECTOR = 100;
+
+  explicit TestImage(bool subchannel_q) : m_subchannel_q(subchannel_q)
+  {
+    static constexpr u8 sync[12] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+
+    std::mt19937 rng(42);
+    m_data.resize((DATA_SECTORS + AUDIO_SECTORS) * RAW_SECTOR_SIZE);
+    for (u32 i = 0; i < DATA_SECTORS; i++)
+    {
+      u8* sector = &m_data[i * RAW_SECTOR_SIZE];
+      std::memcpy(sector, sync, sizeof(sync));
+      std::tie(sector[12], sector[13], sector[14]) = Position::FromLBA(150 + 150 + i).ToBCD();
+      sector[15] = 2;
+
+      // mix of form 1 and form 2 sectors, some compressible and some not
+      const u8 subheader[4] = {0x01, 0x00, static_cast<u8>(((i % 7) == 0) ? 0x28 : 0x08), 0x00};
+      std::memcpy(&sector[16], subheader, sizeof(subheader));
+      std::memcpy(&sector[20], subheader, sizeof(subheader));
+      for (u32 j = 24; j < RAW_SECTOR_SIZE; j++)
+        sector[j] = ((i % 3) != 0) ? static_cast<u8>(j * i) : static_cast<u8>(rng() & 0x0F);
+
+      CDSectorECC::Regenerate(sector, CDSectorECC::GetSectorType(sector));
+
+      // has to be stored as-is, regenerating would "fix" it
+      if (i == BAD_ECC_SECTOR)
+        sector[RAW_SECTOR_SIZE - 1] ^= 1;
+    }
+    for (size_t i = DATA_SECTORS * RAW_SECTOR_SIZE; i < m_data.size(); i++)
+      m_data[i] = static_cast<u8>(rng());
+
+    SubChannelQ::Control data_control = {};
+    data_control.data = true;
+    const SubChannelQ::Control audio_control = {};
+
+    Index pregap = {};
+    pregap.track_number = 1;
+    pregap.index_number = 0;
+    pregap.start_lba_in_track = static_cast<LBA>(-150);
+    pregap.length = 150;
+    pregap.mode = TrackMode::Mode2Raw;
+    pregap.control = data_control;
+    pregap.is_pregap = true;
+    m_indices.push_back(pregap);
+
+    Index data = {};
+    data.start_lba_on_disc = 150;
+    data.track_number = 1;
+    data.index_number = 1;
+    data.length = DATA_SECTORS;
+    data.mode = TrackMode::Mode2Raw;
+    data.control = data_control;
+    data.file_sector_size = RAW_SECTOR_SIZE;
+    m_indices.push_back(data);
+    m_tracks.push_back(
+      Track{1, 150, 0, 150 + DATA_SECTORS, TrackMode::Mode2Raw, SubchannelMode::None, data_control});
+
+    Index audio = {};
+    audio.start_lba_on_disc = 150 + DATA_SECTORS;
+    audio.track_number = 2;
+    audio.index_number = 1;
+    audio.length = AUDIO_SECTORS;
+    audio.mode = TrackMode::Audio;
+    audio.control = audio_control;
+    audio.file_offset = DATA_SECTORS;
+    audio.file_sector_size = RAW_SECTOR_SIZE;
+    m_indices.push_back(audio);
+    m_tracks.push_back(
+      Track{2, 150 + DATA_SECTORS, 2, AUDIO_SECTORS, TrackMode::Audio, SubchannelMode::None, audio_control});
+
+    m_lba_count = 150 + DATA_SECTORS + AUDIO_SECTORS;
+    AddLeadOutIndex();
+    Seek(1, Position{0, 0, 0});
+  }
+
+  const u8* GetSector(u32 data_sector) const { return &m_data[data_sector * RAW_SECTOR_SIZE]; }
+
+  bool HasSubchannelData() const override { return m_subchannel_q; }
+
+  bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override
+  {
+    // make Q differ from what would be generated, so it has to come from the file
+    if (!CDImage::ReadSubChannelQ(subq, index, lba_in_index))
+      return false;
+    if (m_subchannel_q && index.file_sector_size > 0)
+      subq->data[6] = static_cast<u8>(lba_in_index * 7 + index.track_number);
+    return true;
+  }
+
+protected:
+  bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override
+  {
+    std::memcpy(buffer, &m_data[(index.file_offset + lba_in_index) * RAW_SECTOR_SIZE], RAW_SECTOR_SIZE);
+    return true;
+  }
+
+private:
+  std::vector<u8> m_data;
+  bool m_subchannel_q;
+};
+
+/// Deletes the image when the test finishes.
+class TemporaryImage
+{
+public:
+  explicit TemporaryImage(const char* name)
+    : m_path(Path::Combine(std::filesystem::temp_directory_path().string(), name))
+  {
+  }
+  ~TemporaryImage() { FileSystem::DeleteFile(m_path.c_str()); }
+
+  const char* GetPath() const { return m_path.c_str(); }
+
+private:
+  std::string m_path;
+};
+
+} // namespace
+
+static void TestRoundTrip(bool subchannel_q, u32 sectors_per_hunk)
+{
+  SCOPED_TRACE(fmt::format("subchannel_q={} sectors_per_hunk={}", subchannel_q, sectors_per_hunk));
+
+  const TemporaryImage file("duckstation_zcd_test.zcd");
+  TestImage source(subchannel_q);
+  Error error;
+  ASSERT_TRUE(CDImage::WriteZCDImage(file.GetPath(), &source, sectors_per_hunk, 3,
+                                     ProgressCallback::NullProgressCallback, &error))
+    << error.GetDescription();
+
+  std::unique_ptr<CDImage> image = CDImage::OpenZCDImage(file.GetPath(), &error);
+  ASSERT_TRUE(image) << error.GetDescription();
+  ASSERT_EQ(image->GetLBACount(), source.GetLBACount());
+  ASSERT_EQ(image->GetTrackCount(), source.GetTrackCount());
+  ASSERT_EQ(image->GetIndexCount(), source.GetIndexCount());
+  ASSERT_EQ(image->HasSubchannelData(), subchannel_q);
+
+  // in order first, then random access across hunks
+  std::mt19937 rng(1);
+  const u32 lba_count = source.GetLBACount();
+  for (u32 i = 0; i < lba_count + 2000; i++)
+  {
+    const u32 lba = (i < lba_count) ? i : (rng() % lba_count);
+    SectorBuffer expected, actual;
+    CDImage::SubChannelQ expected_subq, actual_subq;
+    ASSERT_TRUE(source.Seek(lba) && source.ReadRawSector(expected.data(), &expected_subq));
+    ASSERT_TRUE(image->Seek(lba) && image->ReadRawSector(actual.data(), &actual_subq)) << "LBA " << lba;
+    ASSERT_EQ(expected, actual) << "LBA " << lba;
+    ASSERT_EQ(expected_subq.data, actual_subq.data) << "LBA " << lba;
+  }
+
+  // the bad sector must come back with its bad ECC
+  SectorBuffer sector;
+  ASSERT_TRUE(image->Seek(150 + TestImage::BAD_ECC_SECTOR) && image->ReadRawSector(sector.data(), nullptr));
+  EXPECT_EQ(std::memcmp(sector.data(), source.GetSector(TestImage::BAD_ECC_SECTOR), sector.size()), 0);
+  EXPECT_EQ(CDSectorECC::GetRegenerableType(sector.data()), CDSectorECC::SectorType::Unknown);
+}
+
+TEST(CDImageZCD, RoundTrip)
+{
+  for (const u32 sectors_per_hunk : {1u, 5u, 8u, 32u})
+  {
+    TestRoundTrip(false, sectors_per_hunk);
+    TestRoundTrip(true, sectors_per_hunk);
+  }
+}
+
+TEST(CDImageZCD, RejectsCorruptedHeader)
+{
+  const TemporaryImage file("duckstation_zcd_corrupt.zcd");
+  TestImage source(false);
+  Error error;
+  ASSERT_TRUE(
+    CDImage::WriteZCDImage(file.GetPath(), &source, 8, 3, ProgressCallback::NullProgressCallback, &error))
+    << error.GetDescription();
+
+  std::optional<DynamicHeapArray<u8>> original = FileSystem::ReadBinaryFile(file.GetPath(), &error);
+  ASSERT_TRUE(original.has_value()) << error.GetDescription();
+
+  // returns true if the image was rejected as corrupted, rather than failing on a later seek/read
+  const auto rejects_patched = [&](size_t offset, const auto& value) {
+    DynamicHeapArray<u8> data = original.value();
+    std::memcpy(&data[offset], &value, sizeof(value));
+    EXPECT_TRUE(FileSystem::WriteBinaryFile(file.GetPath(), data.cspan()));
+    error.Clear();
+    return (!CDImage::OpenZCDImage(file.GetPath(), &error) && error.GetDescription().starts_with("Corrupted"));
+  };
+
+  // offsets which wrap around when the table size is added
+  static constexpr size_t HUNK_TABLE_OFFSET = 44;
+  static constexpr size_t TOC_OFFSET = 52;
+  EXPECT_TRUE(rejects_patched(HUNK_TABLE_OFFSET, static_cast<u64>(-8)));
+  EXPECT_TRUE(rejects_patched(TOC_OFFSET, static_cast<u64>(-8)));
+
+  // index pointing at a track which doesn't exist, and an index whose subchannel mode differs from its track
+  u64 toc_offset;
+  std::memcpy(&toc_offset, &original.value()[TOC_OFFSET], sizeof(toc_offset));
+  const size_t first_index = static_cast<size_t>(toc_offset) + source.GetTrackCount() * 20;
+  EXPECT_TRUE(rejects_patched(first_index + 8, static_cast<u32>(5)));
+  EXPECT_TRUE(rejects_patched(first_index + 25, static_cast<u8>(CDImage::SubchannelMode::Raw)));
+
+  EXPECT_FALSE(rejects_patched(0, original.value()[0]));
+}
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "util/cd_image.h"
+#include "util/cd_sector_ecc.h"
+
+#include "common/sha256_digest.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+#include <random>
+
+using Sector = std::array<u8, CDImage::RAW_SECTOR_SIZE>;
+
+static Sector MakeSector(CDSectorECC::SectorType type, u32 seed)
+{
+  Sector ret = {};
+  std::memset(&ret[1], 0xFF, 10);
+  ret[12] = 0x00; // 00:02:16
+  ret[13] = 0x02;
+  ret[14] = 0x16;
+  ret[15] = (type == CDSectorECC::SectorType::Mode1) ? 1 : 2;
+
+  std::mt19937 rng(seed);
+  for (u32 i = 16; i < CDImage::RAW_SECTOR_SIZE; i++)
+    ret[i] = static_cast<u8>(rng());
+
+  if (type != CDSectorECC::SectorType::Mode1)
+  {
+    const u8 submode = (type == CDSectorECC::SectorType::Mode2Form2) ? 0x28 : 0x08;
+    const u8 subheader[4] = {0x01, 0x00, submode, 0x00};
+    std::memcpy(&ret[16], subheader, sizeof(subheader));
+    std::memcpy(&ret[20], subheader, sizeof(subheader));
+  }
+
+  CDSectorECC::Regenerate(ret.data(), type);
+  return ret;
+}
+
+static u32 ComputeEDCBytewise(const u8* data, size_t length)
+{
+  u32 edc = 0;
+  for (size_t i = 0; i < length; i++)
+    edc = CDSectorECC::ComputeEDC(&data[i], 1, edc);
+  return edc;
+}
+
+TEST(CDSectorECC, KnownSectors)
+{
+  // Reference digests generated with the libchdr EDC/ECC implementation.
+  static constexpr SHA256Digest::Digest mode1_hash = {{0xbb, 0x13, 0x19, 0x7f, 0xd4, 0x3c, 0x6a, 0x41, 0x39, 0x63, 0x90,
+                                                       0xae, 0x37, 0xbe, 0x79, 0xc5, 0xf9, 0x92, 0xca, 0x93, 0x7e, 0x1b,
+                                                       0xad, 0x2f, 0x5c, 0x81, 0xdc, 0xba, 0x53, 0x88, 0x58, 0x4a}};
+  static constexpr SHA256Digest::Digest form1_hash = {{0x96, 0xda, 0x3d, 0x5a, 0x74, 0xef, 0xc7, 0xc0, 0xe3, 0xd4, 0x6a,
+                                                       0x14, 0x81, 0x76, 0xfb, 0x06, 0x0b, 0x2d, 0x9d, 0xe3, 0x08, 0x5f,
+                                                       0xcf, 0xde, 0xb5, 0xec, 0x9d, 0xb9, 0x60, 0x7b, 0x85, 0xf7}};
+  static constexpr SHA256Digest::Digest form2_hash = {{0xdb, 0xf0, 0xfc, 0x0e, 0x31, 0x4d, 0x2d, 0x63, 0x64, 0x2c, 0x04,
+                                                       0x53, 0xe2, 0xf3, 0x18, 0x07, 0xc5, 0x18, 0x52, 0xbe, 0xfc, 0x55,
+                                                       0x9d, 0x99, 0x28, 0xdd, 0xfe, 0xd9, 0x11, 0xb0, 0x37, 0x4a}};
+
+  const Sector mode1 = MakeSector(CDSectorECC::SectorType::Mode1, 1234);
+  const Sector form1 = MakeSector(CDSectorECC::SectorType::Mode2Form1, 1234);
+  const Sector form2 = MakeSector(CDSectorECC::SectorType::Mode2Form2, 1234);
+  ASSERT_EQ(SHA256Digest::GetDigest(mode1.data(), mode1.size()), mode1_hash);
+  ASSERT_EQ(SHA256Digest::GetDigest(form1.data(), form1.size()), form1_hash);
+  ASSERT_EQ(SHA256Digest::GetDigest(form2.data(), form2.size()), form2_hash);
+}
+
+TEST(CDSectorECC, EDCMatchesBytewise)
+{
+  const Sector sector = MakeSector(CDSectorECC::SectorType::Mode1, 1);
+  for (size_t length : {0, 1, 3, 4, 5, 7, 8, 2056, 2064, 2332, 2351})
+    ASSERT_EQ(CDSectorECC::ComputeEDC(sector.data(), length), ComputeEDCBytewise(sector.data(), length));
+}
+
+TEST(CDSectorECC, RegenerateIsBitExact)
+{
+  for (const CDSectorECC::SectorType type :
+       {CDSectorECC::SectorType::Mode1, CDSectorECC::SectorType::Mode2Form1, CDSectorECC::SectorType::Mode2Form2})
+  {
+    for (u32 seed = 0; seed < 64; seed++)
+    {
+      const Sector original = MakeSector(type, seed);
+      ASSERT_EQ(CDSectorECC::GetSectorType(original.data()), type);
+      ASSERT_EQ(CDSectorECC::GetRegenerableType(original.data()), type);
+
+      Sector stripped = original;
+      CDSectorECC::ClearRegenerableBytes(stripped.data(), type);
+      ASSERT_NE(stripped, original);
+      ASSERT_TRUE(CDSectorECC::Regenerate(stripped.data(), CDSectorECC::GetSectorType(stripped.data())));
+      ASSERT_EQ(stripped, original);
+    }
+  }
+}
+
+TEST(CDSectorECC, RejectsBadSectors)
+{
+  // corrupted parity, e.g. copy protection, must be stored as-is
+  Sector bad_ecc = MakeSector(CDSectorECC::SectorType::Mode1, 5);
+  bad_ecc[CDImage::RAW_SECTOR_SIZE - 1] ^= 0x01;
+  ASSERT_EQ(CDSectorECC::GetRegenerableType(bad_ecc.data()), CDSectorECC::SectorType::Unknown);
+
+  // form 2 sectors are allowed to omit the EDC
+  Sector no_edc = MakeSector(CDSectorECC::SectorType::Mode2Form2, 5);
+  std::memset(&no_edc[CDImage::RAW_SECTOR_SIZE - 4], 0, 4);
+  ASSERT_EQ(CDSectorECC::GetRegenerableType(no_edc.data()), CDSectorECC::SectorType::Unknown);
+
+  // audio has no sync pattern
+  Sector audio = MakeSector(CDSectorECC::SectorType::Mode1, 5);
+  audio[0] = 0x12;
+  ASSERT_EQ(CDSectorECC::GetSectorType(audio.data()), CDSectorECC::SectorType::Unknown);
+  ASSERT_FALSE(CDSectorECC::Regenerate(audio.data(), CDSectorECC::SectorType::Unknown));
+}
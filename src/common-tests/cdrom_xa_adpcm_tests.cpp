@@ -0,0 +1,301 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "core/cdrom_xa_adpcm.h"
+
+#include "fmt/format.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// The reference functions below are the scalar decoder and resamplers the vectorized versions replaced, which process
+// one sample/tap at a time and wrap around the ring buffer on every access.
+
+namespace {
+
+static constexpr u32 NUM_CHUNKS = 18;
+static constexpr u32 CHUNK_SIZE = 128;
+static constexpr u32 SECTOR_DATA_SIZE = NUM_CHUNKS * CHUNK_SIZE;
+static constexpr u32 NUM_SECTORS = 64;
+
+using SectorData = std::array<u8, SECTOR_DATA_SIZE>;
+
+} // namespace
+
+template<bool IS_STEREO, bool IS_8BIT>
+static void ReferenceDecode(const u8* chunk_ptr, s16* samples, XAADPCM::LastSamples& last_samples)
+{
+  static constexpr std::array<s8, 16> filter_table_pos = {{0, 60, 115, 98, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+  static constexpr std::array<s8, 16> filter_table_neg = {{0, 0, -52, -55, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+  constexpr u32 WORDS_PER_BLOCK = 28;
+  constexpr u32 SAMPLES_PER_CHUNK = WORDS_PER_BLOCK * (IS_8BIT ? 4 : 8);
+  constexpr u32 NUM_BLOCKS = IS_8BIT ? 4 : 8;
+
+  for (u32 i = 0; i < NUM_CHUNKS; i++)
+  {
+    const u8* headers_ptr = chunk_ptr + 4;
+    const u8* words_ptr = chunk_ptr + 16;
+
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
+    {
+      const u8 shift = ((headers_ptr[block] & 0x0F) > 12) ? 9 : (headers_ptr[block] & 0x0F);
+      const u8 filter = headers_ptr[block] >> 4;
+      const s32 filter_pos = filter_table_pos[filter];
+      const s32 filter_neg = filter_table_neg[filter];
+
+      s16* out_samples_ptr =
+        IS_STEREO ? &samples[(block / 2) * (WORDS_PER_BLOCK * 2) + (block % 2)] : &samples[block * WORDS_PER_BLOCK];
+      constexpr u32 out_samples_increment = IS_STEREO ? 2 : 1;
+
+      for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+      {
+        u32 word_data;
+        std::memcpy(&word_data, &words_ptr[word * sizeof(u32)], sizeof(word_data));
+
+        const u32 nibble = IS_8BIT ? ((word_data >> (block * 8)) & 0xFF) : ((word_data >> (block * 4)) & 0x0F);
+        const s16 sample = static_cast<s16>(static_cast<u16>(nibble << (IS_8BIT ? 8 : 12))) >> shift;
+
+        s32* prev = IS_STEREO ? &last_samples[(block & 1) * 2] : &last_samples[0];
+        const s32 interp_sample = std::clamp<s32>(
+          static_cast<s32>(sample) + ((prev[0] * filter_pos) >> 6) + ((prev[1] * filter_neg) >> 6), -32768, 32767);
+
+        prev[1] = prev[0];
+        prev[0] = interp_sample;
+
+        *out_samples_ptr = static_cast<s16>(interp_sample);
+        out_samples_ptr += out_samples_increment;
+      }
+    }
+
+    samples += SAMPLES_PER_CHUNK;
+    chunk_ptr += CHUNK_SIZE;
+  }
+}
+
+template<bool STEREO>
+static void ReferenceResample(const s16* frames_in, u32 num_frames_in, XAADPCM::ResamplerState& state,
+                              std::vector<u32>& frames_out)
+{
+  static constexpr std::array<std::array<s16, 29>, 7> tables = {
+    {{0,      0x0,     0x0,     0x0,    0x0,     -0x0002, 0x000A,  -0x0022, 0x0041, -0x0054,
+      0x0034, 0x0009,  -0x010A, 0x0400, -0x0A78, 0x234C,  0x6794,  -0x1780, 0x0BCD, -0x0623,
+      0x0350, -0x016D, 0x006B,  0x000A, -0x0010, 0x0011,  -0x0008, 0x0003,  -0x0001},
+     {0,       0x0,    0x0,     -0x0002, 0x0,    0x0003,  -0x0013, 0x003C,  -0x004B, 0x00A2,
+      -0x00E3, 0x0132, -0x0043, -0x0267, 0x0C9D, 0x74BB,  -0x11B4, 0x09B8,  -0x05BF, 0x0372,
+      -0x01A8, 0x00A6, -0x001B, 0x0005,  0x0006, -0x0008, 0x0003,  -0x0001, 0x0},
+     {0,      0x0,     -0x0001, 0x0003,  -0x0002, -0x0005, 0x001F,  -0x004A, 0x00B3, -0x0192,
+      0x02B1, -0x039E, 0x04F8,  -0x05A6, 0x7939,  -0x05A6, 0x04F8,  -0x039E, 0x02B1, -0x0192,
+      0x00B3, -0x004A, 0x001F,  -0x0005, -0x0002, 0x0003,  -0x0001, 0x0,     0x0},
+     {0,       -0x0001, 0x0003,  -0x0008, 0x0006, 0x0005,  -0x001B, 0x00A6, -0x01A8, 0x0372,
+      -0x05BF, 0x09B8,  -0x11B4, 0x74BB,  0x0C9D, -0x0267, -0x0043, 0x0132, -0x00E3, 0x00A2,
+      -0x004B, 0x003C,  -0x0013, 0x0003,  0x0,    -0x0002, 0x0,     0x0,    0x0},
+     {-0x0001, 0x0003,  -0x0008, 0x0011,  -0x0010, 0x000A, 0x006B,  -0x016D, 0x0350, -0x0623,
+      0x0BCD,  -0x1780, 0x6794,  0x234C,  -0x0A78, 0x0400, -0x010A, 0x0009,  0x0034, -0x0054,
+      0x0041,  -0x0022, 0x000A,  -0x0001, 0x0,     0x0001, 0x0,     0x0,     0x0},
+     {0x0002,  -0x0008, 0x0010,  -0x0023, 0x002B, 0x001A,  -0x00EB, 0x027B,  -0x0548, 0x0AFA,
+      -0x16FA, 0x53E0,  0x3C07,  -0x1249, 0x080E, -0x0347, 0x015B,  -0x0044, -0x0017, 0x0046,
+      -0x0023, 0x0011,  -0x0005, 0x0,     0x0,    0x0,     0x0,     0x0,     0x0},
+     {-0x0005, 0x0011,  -0x0023, 0x0046, -0x0017, -0x0044, 0x015B,  -0x0347, 0x080E, -0x1249,
+      0x3C07,  0x53E0,  -0x16FA, 0x0AFA, -0x0548, 0x027B,  -0x00EB, 0x001A,  0x002B, -0x0023,
+      0x0010,  -0x0008, 0x0002,  0x0,    0x0,     0x0,     0x0,     0x0,     0x0}}};
+
+  const auto zigzag_interpolate = [](const s16* ringbuf, u32 table_index, u32 p) -> s16 {
+    const s16* table = tables[table_index].data();
+    s32 sum = 0;
+    for (u32 i = 0; i < 29; i++)
+      sum += (static_cast<s32>(ringbuf[(p - i) & 0x1F]) * static_cast<s32>(table[i])) >> 15;
+
+    return static_cast<s16>(std::clamp<s32>(sum, -0x8000, 0x7FFF));
+  };
+
+  s16* const left_ringbuf = state.ring_buffer[0].data();
+  s16* const right_ringbuf = state.ring_buffer[1].data();
+  u32 p = state.p;
+  u32 sixstep = state.sixstep;
+
+  for (u32 in_sample_index = 0; in_sample_index < num_frames_in; in_sample_index++)
+  {
+    left_ringbuf[p] = *(frames_in++);
+    if constexpr (STEREO)
+      right_ringbuf[p] = *(frames_in++);
+    p = (p + 1) % 32;
+    sixstep--;
+
+    if (sixstep == 0)
+    {
+      sixstep = 6;
+      for (u32 j = 0; j < 7; j++)
+      {
+        const s16 left_interp = zigzag_interpolate(left_ringbuf, j, p);
+        const s16 right_interp = STEREO ? zigzag_interpolate(right_ringbuf, j, p) : left_interp;
+        frames_out.push_back(XAADPCM::PackFrame(left_interp, right_interp));
+      }
+    }
+  }
+
+  state.p = static_cast<u8>(p);
+  state.sixstep = static_cast<u8>(sixstep);
+}
+
+template<bool STEREO>
+static void ReferenceResample18900(const s16* frames_in, u32 num_frames_in, XAADPCM::ResamplerState& state,
+                                   std::vector<u32>& frames_out)
+{
+  static constexpr std::array<std::array<s16, 25>, 7> tables = {{
+    {{0x0,     -0x5,  0x11,   -0x23, 0x46,  -0x17, -0x44, 0x15b, -0x347, 0x80e, -0x1249, 0x3c07, 0x53e0,
+      -0x16fa, 0xafa, -0x548, 0x27b, -0xeb, 0x1a,  0x2b,  -0x23, 0x10,   -0x8,  0x2,     0x0}},
+    {{0x0,     -0x2,  0xa,    -0x22, 0x41,   -0x54, 0x34, 0x9,   -0x10a, 0x400, -0xa78, 0x234c, 0x6794,
+      -0x1780, 0xbcd, -0x623, 0x350, -0x16d, 0x6b,  0xa,  -0x10, 0x11,   -0x8,  0x3,    -0x1}},
+    {{-0x2,    0x0,   0x3,    -0x13, 0x3c,   -0x4b, 0xa2,  -0xe3, 0x132, -0x43, -0x267, 0xc9d, 0x74bb,
+      -0x11b4, 0x9b8, -0x5bf, 0x372, -0x1a8, 0xa6,  -0x1b, 0x5,   0x6,   -0x8,  0x3,    -0x1}},
+    {{-0x1,   0x3,   -0x2,   -0x5,  0x1f,   -0x4a, 0xb3,  -0x192, 0x2b1, -0x39e, 0x4f8, -0x5a6, 0x7939,
+      -0x5a6, 0x4f8, -0x39e, 0x2b1, -0x192, 0xb3,  -0x4a, 0x1f,   -0x5,  -0x2,   0x3,   -0x1}},
+    {{-0x1,  0x3,    -0x8,  0x6,   0x5,   -0x1b, 0xa6,  -0x1a8, 0x372, -0x5bf, 0x9b8, -0x11b4, 0x74bb,
+      0xc9d, -0x267, -0x43, 0x132, -0xe3, 0xa2,  -0x4b, 0x3c,   -0x13, 0x3,    0x0,   -0x2}},
+    {{-0x1,   0x3,    -0x8,  0x11,   -0x10, 0xa,  0x6b,  -0x16d, 0x350, -0x623, 0xbcd, -0x1780, 0x6794,
+      0x234c, -0xa78, 0x400, -0x10a, 0x9,   0x34, -0x54, 0x41,   -0x22, 0xa,    -0x2,  0x0}},
+    {{0x0,    0x2,     -0x8,  0x10,   -0x23, 0x2b,  0x1a,  -0xeb, 0x27b, -0x548, 0xafa, -0x16fa, 0x53e0,
+      0x3c07, -0x1249, 0x80e, -0x347, 0x15b, -0x44, -0x17, 0x46,  -0x23, 0x11,   -0x5,  0x0}},
+  }};
+
+  const auto interpolate = [](const s16* ringbuf, u32 table_index, u32 p) -> s16 {
+    const s16* table = tables[table_index].data();
+    s32 sum = 0;
+    for (u32 i = 0; i < 25; i++)
+      sum += (static_cast<s32>(ringbuf[(p + 32 - 25 + i) & 0x1F]) * static_cast<s32>(table[i]));
+
+    return static_cast<s16>(std::clamp<s32>(sum >> 15, -0x8000, 0x7FFF));
+  };
+
+  s16* const left_ringbuf = state.ring_buffer[0].data();
+  s16* const right_ringbuf = state.ring_buffer[1].data();
+  u32 p = state.p;
+  u32 sixstep = state.sixstep;
+
+  for (u32 in_sample_index = 0; in_sample_index < num_frames_in;)
+  {
+    if (sixstep >= 7)
+    {
+      sixstep -= 7;
+      p = (p + 1) % 32;
+
+      left_ringbuf[p] = *(frames_in++);
+      if constexpr (STEREO)
+        right_ringbuf[p] = *(frames_in++);
+
+      in_sample_index++;
+    }
+
+    const s16 left_interp = interpolate(left_ringbuf, sixstep, p);
+    const s16 right_interp = STEREO ? interpolate(right_ringbuf, sixstep, p) : left_interp;
+    frames_out.push_back(XAADPCM::PackFrame(left_interp, right_interp));
+    sixstep += 3;
+  }
+
+  state.p = static_cast<u8>(p);
+  state.sixstep = static_cast<u8>(sixstep);
+}
+
+static std::vector<SectorData> MakeRandomSectors(u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<SectorData> sectors(NUM_SECTORS);
+  for (SectorData& sector : sectors)
+    std::generate(sector.begin(), sector.end(), [&rng]() { return static_cast<u8>(rng()); });
+  return sectors;
+}
+
+static std::vector<SectorData> MakeSaturatingSectors(u32 seed)
+{
+  // Every sample at the largest magnitude with no shift, and the filters with the most gain, so the prediction keeps
+  // hitting the clamp. The sign flips every few chunks to swing between both limits.
+  std::mt19937 rng(seed);
+  std::vector<SectorData> sectors(NUM_SECTORS);
+  u32 chunk_index = 0;
+  for (SectorData& sector : sectors)
+  {
+    for (u32 chunk = 0; chunk < NUM_CHUNKS; chunk++, chunk_index++)
+    {
+      u8* chunk_ptr = &sector[chunk * CHUNK_SIZE];
+      for (u32 i = 0; i < 16; i++)
+        chunk_ptr[i] = static_cast<u8>((1 + (rng() % 3)) << 4);
+      std::memset(chunk_ptr + 16, ((chunk_index / 3) & 1) ? 0x88 : 0x77, CHUNK_SIZE - 16);
+    }
+  }
+  return sectors;
+}
+
+template<bool IS_STEREO, bool IS_8BIT>
+static void TestDecodeAndResample(const std::vector<SectorData>& sectors, bool half_sample_rate)
+{
+  SCOPED_TRACE(fmt::format("stereo={} 8bit={} half_sample_rate={}", IS_STEREO, IS_8BIT, half_sample_rate));
+
+  constexpr u32 num_samples = IS_8BIT ? XAADPCM::SAMPLES_PER_SECTOR_8BIT : XAADPCM::SAMPLES_PER_SECTOR_4BIT;
+  constexpr u32 num_frames = num_samples / (IS_STEREO ? 2 : 1);
+
+  XAADPCM::LastSamples last_samples = {};
+  XAADPCM::LastSamples ref_last_samples = {};
+  XAADPCM::ResamplerState resampler;
+  resampler.Reset();
+  XAADPCM::ResamplerState ref_resampler = resampler;
+
+  std::array<s16, XAADPCM::SAMPLES_PER_SECTOR_4BIT> samples, ref_samples;
+  std::array<u32, XAADPCM::MAX_RESAMPLED_FRAMES_PER_SECTOR> frames;
+  std::vector<u32> ref_frames;
+  for (u32 i = 0; i < sectors.size(); i++)
+  {
+    SCOPED_TRACE(fmt::format("sector {}", i));
+
+    XAADPCM::DecodeChunks<IS_STEREO, IS_8BIT>(sectors[i].data(), samples.data(), last_samples);
+    ReferenceDecode<IS_STEREO, IS_8BIT>(sectors[i].data(), ref_samples.data(), ref_last_samples);
+    ASSERT_EQ(std::memcmp(samples.data(), ref_samples.data(), num_samples * sizeof(s16)), 0);
+    ASSERT_EQ(last_samples, ref_last_samples);
+
+    ref_frames.clear();
+    u32 num_resampled_frames;
+    if (half_sample_rate)
+    {
+      num_resampled_frames = XAADPCM::Resample18900<IS_STEREO>(samples.data(), num_frames, resampler, frames.data());
+      ReferenceResample18900<IS_STEREO>(ref_samples.data(), num_frames, ref_resampler, ref_frames);
+    }
+    else
+    {
+      num_resampled_frames = XAADPCM::Resample<IS_STEREO>(samples.data(), num_frames, resampler, frames.data());
+      ReferenceResample<IS_STEREO>(ref_samples.data(), num_frames, ref_resampler, ref_frames);
+    }
+
+    ASSERT_LE(ref_frames.size(), XAADPCM::MAX_RESAMPLED_FRAMES_PER_SECTOR);
+    ASSERT_EQ(num_resampled_frames, ref_frames.size());
+    ASSERT_EQ(std::memcmp(frames.data(), ref_frames.data(), num_resampled_frames * sizeof(u32)), 0);
+    ASSERT_EQ(resampler.ring_buffer, ref_resampler.ring_buffer);
+    ASSERT_EQ(resampler.p, ref_resampler.p);
+    ASSERT_EQ(resampler.sixstep, ref_resampler.sixstep);
+  }
+}
+
+static void TestAllModes(const std::vector<SectorData>& sectors)
+{
+  for (const bool half_sample_rate : {false, true})
+  {
+    TestDecodeAndResample<false, false>(sectors, half_sample_rate);
+    TestDecodeAndResample<false, true>(sectors, half_sample_rate);
+    TestDecodeAndResample<true, false>(sectors, half_sample_rate);
+    TestDecodeAndResample<true, true>(sectors, half_sample_rate);
+  }
+}
+
+TEST(XAADPCM, RandomInputMatchesReference)
+{
+  TestAllModes(MakeRandomSectors(0x1234));
+}
+
+TEST(XAADPCM, SaturatingInputMatchesReference)
+{
+  TestAllModes(MakeSaturatingSectors(0x5678));
+}
@@ -0,0 +1,344 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "core/gpu_sw_display.h"
+
+#include "common/timer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+// The reference functions below are direct translations of the presenter's fragment shaders in gpu_shadergen.cpp,
+// evaluated in float with out-of-bounds texture loads returning zero, and the render target's unorm conversion.
+
+namespace {
+
+using Image = std::vector<u32>;
+
+struct Float3
+{
+  float r, g, b;
+
+  Float3 operator+(const Float3& v) const { return {r + v.r, g + v.g, b + v.b}; }
+  Float3 operator-(const Float3& v) const { return {r - v.r, g - v.g, b - v.b}; }
+  Float3 operator*(float f) const { return {r * f, g * f, b * f}; }
+};
+
+} // namespace
+
+static Float3 LoadTexture(const Image& image, u32 width, u32 height, s32 x, s32 y)
+{
+  if (x < 0 || y < 0 || static_cast<u32>(x) >= width || static_cast<u32>(y) >= height)
+    return {};
+
+  const u32 value = image[static_cast<u32>(y) * width + static_cast<u32>(x)];
+  return {static_cast<float>(value & 0xFF) / 255.0f, static_cast<float>((value >> 8) & 0xFF) / 255.0f,
+          static_cast<float>((value >> 16) & 0xFF) / 255.0f};
+}
+
+static u32 ToRGBA8(const Float3& v, u32 alpha = 0xFF)
+{
+  const auto conv = [](float f) { return static_cast<u32>(std::clamp(f, 0.0f, 1.0f) * 255.0f + 0.5f); };
+  return conv(v.r) | (conv(v.g) << 8) | (conv(v.b) << 16) | (alpha << 24);
+}
+
+static Float3 Lerp(const Float3& a, const Float3& b, float t)
+{
+  return a + (b - a) * t;
+}
+
+static Image ShaderBlend(const Image& cur, const Image& prev, u32 width, u32 field_height)
+{
+  Image out(width * field_height);
+  for (u32 y = 0; y < field_height; y++)
+  {
+    for (u32 x = 0; x < width; x++)
+    {
+      const u32 c0 = cur[y * width + x], c1 = prev[y * width + x];
+      const Float3 c = (LoadTexture(cur, width, field_height, x, y) + LoadTexture(prev, width, field_height, x, y));
+      out[y * width + x] = ToRGBA8(c * 0.5f, ((c0 >> 24) + (c1 >> 24) + 1) / 2);
+    }
+  }
+  return out;
+}
+
+static Image ShaderFastMAD(const std::array<Image, 4>& fields, u32 width, u32 field_height, u32 field)
+{
+  static constexpr float SENSITIVITY = 0.08f;
+
+  const u32 height = field_height * 2;
+  Image out(width * height);
+  for (u32 row = 0; row < height; row++)
+  {
+    for (u32 x = 0; x < width; x++)
+    {
+      const s32 ux = static_cast<s32>(x);
+      const s32 uy = static_cast<s32>(row >> 1);
+      const auto load = [&](u32 i, s32 offset) { return LoadTexture(fields[i], width, field_height, ux, uy + offset); };
+      const Float3 cur = load(0, 0);
+      const Float3 hn = load(0, -1);
+      const Float3 cn = load(1, 0);
+      const Float3 ln = load(0, 1);
+      const Float3 ho = load(2, -1);
+      const Float3 co = load(3, 0);
+      const Float3 lo = load(2, 1);
+
+      const auto mmax = [](const Float3& n, const Float3& o) {
+        return std::max({std::abs(n.r - o.r), std::abs(n.g - o.g), std::abs(n.b - o.b)}) - SENSITIVITY;
+      };
+      const float m = std::max({mmax(hn, ho), mmax(cn, co), mmax(ln, lo)});
+
+      Float3 result;
+      if ((row & 1u) == field)
+        result = cur;
+      else if (row > 0 && row < height && m > 0.0f)
+        result = (hn + ln) * 0.5f;
+      else
+        result = cn;
+
+      out[row * width + x] = ToRGBA8(result);
+    }
+  }
+  return out;
+}
+
+static Image ShaderChromaSmoothing(const Image& src, u32 width, u32 height)
+{
+  const auto rgb_to_yuv = [](const Float3& c) {
+    return Float3{c.r * 0.299f + c.g * 0.587f + c.b * 0.114f, c.r * -0.14713f + c.g * -0.28886f + c.b * 0.436f,
+                  c.r * 0.615f + c.g * -0.51499f + c.b * -0.10001f};
+  };
+  const auto yuv_to_rgb = [](const Float3& c) {
+    return Float3{c.r + c.b * 1.13983f, c.r + c.g * -0.39465f + c.b * -0.58060f, c.r + c.g * 2.03211f};
+  };
+  const auto average_2x2 = [&](s32 x, s32 y) {
+    return (LoadTexture(src, width, height, x, y) + LoadTexture(src, width, height, x, y + 1) +
+            LoadTexture(src, width, height, x + 1, y) + LoadTexture(src, width, height, x + 1, y + 1)) *
+           0.25f;
+  };
+
+  Image out(width * height);
+  for (u32 y = 0; y < height; y++)
+  {
+    for (u32 x = 0; x < width; x++)
+    {
+      const s32 base_x = static_cast<s32>(x) - 1, base_y = static_cast<s32>(y) - 1;
+      const s32 low_x = std::max(base_x & ~1, 0), low_y = std::max(base_y & ~1, 0);
+      const s32 high_x = std::min(low_x + 2, static_cast<s32>(width - 1));
+      const s32 high_y = std::min(low_y + 2, static_cast<s32>(height - 1));
+      const float coeff_x = static_cast<float>(base_x & 1) * 0.5f + 0.25f;
+      const float coeff_y = static_cast<float>(base_y & 1) * 0.5f + 0.25f;
+
+      const Float3 p = LoadTexture(src, width, height, x, y);
+      const Float3 s = Lerp(Lerp(average_2x2(low_x, low_y), average_2x2(high_x, low_y), coeff_x),
+                            Lerp(average_2x2(low_x, high_y), average_2x2(high_x, high_y), coeff_x), coeff_y);
+      const Float3 s_yuv = rgb_to_yuv(s);
+      out[y * width + x] = ToRGBA8(yuv_to_rgb(Float3{rgb_to_yuv(p).r, s_yuv.g, s_yuv.b}));
+    }
+  }
+  return out;
+}
+
+static Image RandomImage(std::mt19937& rng, u32 width, u32 height)
+{
+  Image image(width * height);
+  std::uniform_int_distribution<u32> dist;
+  for (u32& pixel : image)
+    pixel = dist(rng);
+  return image;
+}
+
+// Random images make every missing line interpolated and chroma noisy, so also use smooth gradients with some noise.
+static Image GradientImage(std::mt19937& rng, u32 width, u32 height)
+{
+  Image image(width * height);
+  std::uniform_int_distribution<u32> dist(0, 15);
+  for (u32 y = 0; y < height; y++)
+  {
+    for (u32 x = 0; x < width; x++)
+    {
+      const u32 r = std::min((x * 255) / std::max(width, 1u) + dist(rng), 255u);
+      const u32 g = std::min((y * 255) / std::max(height, 1u) + dist(rng), 255u);
+      const u32 b = std::min(((x + y) * 127) / std::max(width + height, 1u) + dist(rng) * 8, 255u);
+      image[y * width + x] = r | (g << 8) | (b << 16) | 0xFF000000u;
+    }
+  }
+  return image;
+}
+
+static u32 MaxChannelDifference(const Image& a, const Image& b)
+{
+  u32 max_diff = 0;
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    for (u32 shift = 0; shift < 32; shift += 8)
+    {
+      const s32 ca = static_cast<s32>((a[i] >> shift) & 0xFF);
+      const s32 cb = static_cast<s32>((b[i] >> shift) & 0xFF);
+      max_diff = std::max(max_diff, static_cast<u32>(std::abs(ca - cb)));
+    }
+  }
+  return max_diff;
+}
+
+static constexpr std::array<std::pair<u32, u32>, 7> s_test_sizes = {
+  {{1, 1}, {2, 2}, {3, 5}, {7, 4}, {16, 9}, {320, 240}, {641, 17}}};
+
+TEST(GPUSWDisplay, WeaveMatchesShader)
+{
+  std::mt19937 rng(1234);
+  for (const auto& [width, field_height] : s_test_sizes)
+  {
+    const Image cur = RandomImage(rng, width, field_height);
+    const Image prev = RandomImage(rng, width, field_height);
+    for (u32 field = 0; field < 2; field++)
+    {
+      Image out(width * field_height * 2);
+      GPU_SW_Display::DeinterlaceWeave(reinterpret_cast<u8*>(out.data()), width * sizeof(u32), cur.data(),
+                                       prev.data(), width, field_height, field);
+
+      // Lines of the other field are what the weave target held from the previous field.
+      for (u32 row = 0; row < field_height * 2; row++)
+      {
+        const Image& expected = ((row & 1u) == field) ? cur : prev;
+        for (u32 x = 0; x < width; x++)
+          ASSERT_EQ(out[row * width + x], expected[(row / 2) * width + x]) << width << "x" << field_height;
+      }
+    }
+  }
+}
+
+TEST(GPUSWDisplay, BlendMatchesShader)
+{
+  std::mt19937 rng(2345);
+  for (const auto& [width, field_height] : s_test_sizes)
+  {
+    const Image cur = RandomImage(rng, width, field_height);
+    const Image prev = RandomImage(rng, width, field_height);
+    Image out(width * field_height);
+    GPU_SW_Display::DeinterlaceBlend(reinterpret_cast<u8*>(out.data()), width * sizeof(u32), cur.data(), prev.data(),
+                                     width, field_height);
+
+    // Halves are rounded up, rather than to even.
+    EXPECT_LE(MaxChannelDifference(out, ShaderBlend(cur, prev, width, field_height)), 1u)
+      << width << "x" << field_height;
+  }
+}
+
+TEST(GPUSWDisplay, AdaptiveMatchesShader)
+{
+  std::mt19937 rng(3456);
+  for (const auto& [width, field_height] : s_test_sizes)
+  {
+    for (u32 source = 0; source < 3; source++)
+    {
+      // Random fields, still fields with noise under the threshold, and moving gradients.
+      std::array<Image, 4> fields;
+      const Image base = GradientImage(rng, width, field_height);
+      for (u32 i = 0; i < fields.size(); i++)
+      {
+        if (source == 0)
+          fields[i] = RandomImage(rng, width, field_height);
+        else if (source == 1)
+          fields[i] = base;
+        else
+          fields[i] = GradientImage(rng, width, field_height);
+      }
+
+      const u32* field_ptrs[4] = {fields[0].data(), fields[1].data(), fields[2].data(), fields[3].data()};
+      for (u32 field = 0; field < 2; field++)
+      {
+        Image out(width * field_height * 2);
+        GPU_SW_Display::DeinterlaceAdaptive(reinterpret_cast<u8*>(out.data()), width * sizeof(u32), field_ptrs,
+                                            width, field_height, field);
+        EXPECT_LE(MaxChannelDifference(out, ShaderFastMAD(fields, width, field_height, field)), 1u)
+          << width << "x" << field_height << " source " << source << " field " << field;
+      }
+    }
+  }
+}
+
+TEST(GPUSWDisplay, ChromaSmoothingMatchesShader)
+{
+  std::mt19937 rng(4567);
+  GPU_SW_Display::ChromaSmoothingBuffer buffer;
+  for (const auto& [width, height] : s_test_sizes)
+  {
+    for (u32 source = 0; source < 2; source++)
+    {
+      const Image src = (source == 0) ? RandomImage(rng, width, height) : GradientImage(rng, width, height);
+
+      // Padded destination rows, to catch writes past the width.
+      const u32 dst_width = width + 3;
+      Image out(dst_width * height, 0x12345678u);
+      GPU_SW_Display::ApplyChromaSmoothing(reinterpret_cast<u8*>(out.data()), dst_width * sizeof(u32),
+                                           reinterpret_cast<const u8*>(src.data()), width * sizeof(u32), width,
+                                           height, buffer);
+
+      Image cropped(width * height);
+      for (u32 y = 0; y < height; y++)
+      {
+        std::copy_n(&out[y * dst_width], width, &cropped[y * width]);
+        for (u32 x = width; x < dst_width; x++)
+          ASSERT_EQ(out[y * dst_width + x], 0x12345678u);
+      }
+
+      // Fixed-point luma and the inexact YUV matrices in the shader account for up to one step of difference.
+      EXPECT_LE(MaxChannelDifference(cropped, ShaderChromaSmoothing(src, width, height)), 1u)
+        << width << "x" << height << " source " << source;
+    }
+  }
+}
+
+// Benchmarks, run with --gtest_also_run_disabled_tests.
+static void RunBenchmark(const char* name, u32 iterations, const std::function<void()>& func)
+{
+  func();
+
+  Timer timer;
+  for (u32 i = 0; i < iterations; i++)
+    func();
+
+  std::printf("%s: %.3f ms per frame\n", name, timer.GetTimeMilliseconds() / static_cast<double>(iterations));
+}
+
+TEST(GPUSWDisplay, DISABLED_Benchmark)
+{
+  static constexpr u32 WIDTH = 640;
+  static constexpr u32 FIELD_HEIGHT = 240;
+  static constexpr u32 ITERATIONS = 200;
+
+  std::mt19937 rng(5678);
+  std::array<Image, 4> fields;
+  for (Image& field : fields)
+    field = GradientImage(rng, WIDTH, FIELD_HEIGHT);
+  const u32* field_ptrs[4] = {fields[0].data(), fields[1].data(), fields[2].data(), fields[3].data()};
+  const Image frame = GradientImage(rng, WIDTH, FIELD_HEIGHT * 2);
+  Image out(WIDTH * FIELD_HEIGHT * 2);
+  u8* const out_ptr = reinterpret_cast<u8*>(out.data());
+  constexpr u32 stride = WIDTH * sizeof(u32);
+  GPU_SW_Display::ChromaSmoothingBuffer buffer;
+
+  RunBenchmark("Weave 640x480", ITERATIONS, [&]() {
+    GPU_SW_Display::DeinterlaceWeave(out_ptr, stride, field_ptrs[0], field_ptrs[1], WIDTH, FIELD_HEIGHT, 0);
+  });
+  RunBenchmark("Blend 640x240", ITERATIONS, [&]() {
+    GPU_SW_Display::DeinterlaceBlend(out_ptr, stride, field_ptrs[0], field_ptrs[1], WIDTH, FIELD_HEIGHT);
+  });
+  RunBenchmark("Adaptive 640x480", ITERATIONS, [&]() {
+    GPU_SW_Display::DeinterlaceAdaptive(out_ptr, stride, field_ptrs, WIDTH, FIELD_HEIGHT, 0);
+  });
+  RunBenchmark("Chroma smoothing 640x480", ITERATIONS, [&]() {
+    GPU_SW_Display::ApplyChromaSmoothing(out_ptr, stride, reinterpret_cast<const u8*>(frame.data()), stride, WIDTH,
+                                         FIELD_HEIGHT * 2, buffer);
+  });
+  RunBenchmark("Chroma smoothing 640x480 (float reference)", ITERATIONS / 20,
+               [&]() { out = ShaderChromaSmoothing(frame, WIDTH, FIELD_HEIGHT * 2); });
+}
@@ -5,6 +5,7 @@
 #include "align.h"
 #include "assert.h"
 #include "error.h"
+#include "file_system.h"
 #include "log.h"
 #include "small_string.h"
 #include "string_util.h"
@@ -12,6 +13,7 @@
 #include "fmt/format.h"
 
 #include <memory>
+#include <utility>
 
 #if defined(_WIN32)
 #include "windows_headers.h"
@@ -36,6 +38,13 @@
 #include <unistd.h>
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #if defined(__linux__) && !defined(MAP_FIXED_NOREPLACE)
 // Compatibility with old libc.
 #define MAP_FIXED_NOREPLACE 0x100000
@@ -100,6 +109,34 @@ void* MemMap::CreateSharedMemory(const char* name, size_t size, Error* error)
   return static_cast<void*>(mapping);
 }
 
+std::string MemMap::GetSharedFileMappingName(const char* name)
+{
+  return name;
+}
+
+void* MemMap::OpenSharedMemory(const char* name, size_t size, bool* created, Error* error)
+{
+  const std::wstring mapping_name = StringUtil::UTF8StringToWideString(name);
+  const HANDLE mapping =
+    CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                       static_cast<DWORD>(size), mapping_name.c_str());
+  if (!mapping)
+  {
+    Error::SetWin32(error, "CreateFileMappingW() failed: ", GetLastError());
+    return nullptr;
+  }
+
+  // the size of an existing mapping is not changed, mapping past the end will fail instead
+  *created = (GetLastError() != ERROR_ALREADY_EXISTS);
+  return static_cast<void*>(mapping);
+}
+
+void MemMap::CloseSharedMemory(void* handle, const char* name)
+{
+  // Name goes away with the last handle.
+  CloseHandle(static_cast<HANDLE>(handle));
+}
+
 void MemMap::DestroySharedMemory(void* ptr)
 {
   CloseHandle(static_cast<HANDLE>(ptr));
@@ -411,6 +448,23 @@ void* MemMap::CreateSharedMemory(const char* name, size_t size, Error* error)
   return reinterpret_cast<void*>(static_cast<uintptr_t>(port));
 }
 
+std::string MemMap::GetSharedFileMappingName(const char* name)
+{
+  return name;
+}
+
+void* MemMap::OpenSharedMemory(const char* name, size_t size, bool* created, Error* error)
+{
+  // memory entries can't be looked up by name
+  Error::SetStringView(error, "Named shared memory is not supported on this platform.");
+  return nullptr;
+}
+
+void MemMap::CloseSharedMemory(void* handle, const char* name)
+{
+  DestroySharedMemory(handle);
+}
+
 void MemMap::DestroySharedMemory(void* ptr)
 {
   mach_port_deallocate(mach_task_self(), static_cast<mach_port_t>(reinterpret_cast<uintptr_t>(ptr)));
@@ -672,6 +726,15 @@ std::string MemMap::GetFileMappingName(const char* prefix)
 #endif
 }
 
+std::string MemMap::GetSharedFileMappingName(const char* name)
+{
+#if defined(__FreeBSD__)
+  return fmt::format("/tmp/{}", name);
+#else
+  return name;
+#endif
+}
+
 #ifndef __ANDROID__
 
 void* MemMap::CreateSharedMemory(const char* name, size_t size, Error* error)
@@ -732,6 +795,100 @@ void MemMap::DeleteSharedMemory(const char* name)
   shm_unlink(name);
 }
 
+void* MemMap::OpenSharedMemory(const char* name, size_t size, bool* created, Error* error)
+{
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd >= 0)
+  {
+    // use fallocate() to ensure we don't SIGBUS later on.
+#ifdef __linux__
+    if (fallocate(fd, 0, 0, static_cast<off_t>(size)) < 0)
+#else
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+#endif
+    {
+      Error::SetErrno(error, TinyString::from_format("Failed to resize shared memory to {} bytes: ", size), errno);
+      close(fd);
+      shm_unlink(name);
+      return nullptr;
+    }
+
+    // every process holds a shared lock while it has the object open, see CloseSharedMemory()
+    flock(fd, LOCK_SH);
+    *created = true;
+    return reinterpret_cast<void*>(static_cast<intptr_t>(fd));
+  }
+  else if (errno != EEXIST)
+  {
+    Error::SetErrno(error, "shm_open() failed: ", errno);
+    return nullptr;
+  }
+
+  fd = shm_open(name, O_RDWR, 0600);
+  if (fd < 0)
+  {
+    Error::SetErrno(error, "shm_open() failed: ", errno);
+    return nullptr;
+  }
+
+  // the creator might not have resized it yet, and accessing past the end would SIGBUS
+  struct stat st = {};
+  for (u32 tries = 0; fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < size && tries < 100; tries++)
+    usleep(10000);
+  if (static_cast<size_t>(st.st_size) < size)
+  {
+    Error::SetStringFmt(error, "Shared memory object is {} bytes, expected {}.", static_cast<s64>(st.st_size), size);
+    close(fd);
+    return nullptr;
+  }
+
+  // only blocks while the last process to close it is removing the name
+  while (flock(fd, LOCK_SH) != 0 && errno == EINTR)
+    ;
+
+  *created = false;
+  return reinterpret_cast<void*>(static_cast<intptr_t>(fd));
+}
+
+void MemMap::CloseSharedMemory(void* handle, const char* name)
+{
+  // The OS drops the shared lock of a process which dies, so if an exclusive lock can be taken, nobody else is using
+  // the object. While it is held, nobody else can get as far as removing the name either.
+  const int fd = static_cast<int>(reinterpret_cast<intptr_t>(handle));
+  if (flock(fd, LOCK_EX | LOCK_NB) == 0)
+  {
+    // The name may have been removed and reused by a newer object since this one was opened, leave that one alone.
+    const int name_fd = shm_open(name, O_RDONLY, 0600);
+    if (name_fd >= 0)
+    {
+      struct stat st = {};
+      struct stat name_st = {};
+      if (fstat(fd, &st) == 0 && fstat(name_fd, &name_st) == 0 && st.st_dev == name_st.st_dev &&
+          st.st_ino == name_st.st_ino)
+      {
+        shm_unlink(name);
+      }
+
+      close(name_fd);
+    }
+  }
+
+  close(fd);
+}
+
+#else
+
+void* MemMap::OpenSharedMemory(const char* name, size_t size, bool* created, Error* error)
+{
+  Error::SetStringView(error, "Named shared memory is not supported on this platform.");
+  return nullptr;
+}
+
+void MemMap::CloseSharedMemory(void* handle, const char* name)
+{
+  DestroySharedMemory(handle);
+}
+
 #endif
 
 void* MemMap::MapSharedMemory(void* handle, size_t offset, void* baseaddr, size_t size, PageProtect mode)
@@ -969,3 +1126,165 @@ void* MemMap::AllocateJITMemory(size_t size)
 
   return ptr;
 }
+
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(MappedFile&& move)
+  : m_data(std::exchange(move.m_data, nullptr)), m_size(std::exchange(move.m_size, 0))
+{
+}
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& move)
+{
+  Close();
+  m_data = std::exchange(move.m_data, nullptr);
+  m_size = std::exchange(move.m_size, 0);
+  return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* path, bool deny_write, Error* error)
+{
+  Close();
+
+  // unless denied, allow the file to be appended to by other handles while it is mapped
+  const DWORD share_mode = deny_write ? FILE_SHARE_READ : (FILE_SHARE_READ | FILE_SHARE_WRITE);
+  const HANDLE file = CreateFileW(FileSystem::GetWin32Path(path).c_str(), GENERIC_READ, share_mode, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    Error::SetWin32(error, "CreateFileW() failed: ", GetLastError());
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    Error::SetStringView(error, "File is empty or size could not be determined.");
+    CloseHandle(file);
+    return false;
+  }
+
+  // the view holds a reference to the mapping, which holds a reference to the file
+  const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping)
+  {
+    Error::SetWin32(error, "CreateFileMappingW() failed: ", GetLastError());
+    return false;
+  }
+
+  const void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!ptr)
+  {
+    Error::SetWin32(error, "MapViewOfFile() failed: ", GetLastError());
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(ptr);
+  m_size = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (!m_data)
+    return;
+
+  UnmapViewOfFile(m_data);
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const
+{
+  if (offset >= m_size)
+    return;
+
+  WIN32_MEMORY_RANGE_ENTRY range;
+  range.VirtualAddress = const_cast<u8*>(m_data + offset);
+  range.NumberOfBytes = std::min(size, m_size - offset);
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::SetAccessPattern(AccessPattern pattern, size_t offset, size_t size) const
+{
+  // No equivalent for views on Windows, the cache manager detects sequential access on its own.
+}
+
+#else
+
+bool MappedFile::Open(const char* path, bool deny_write, Error* error)
+{
+  Close();
+
+  // deny_write needs mandatory locking, which is not available here
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    Error::SetErrno(error, "open() failed: ", errno);
+    return false;
+  }
+
+  struct stat st = {};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    Error::SetStringView(error, "File is empty or size could not be determined.");
+    close(fd);
+    return false;
+  }
+
+  // mapping stays valid after the descriptor is closed
+  void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED)
+  {
+    Error::SetErrno(error, "mmap() failed: ", errno);
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(ptr);
+  m_size = static_cast<size_t>(st.st_size);
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (!m_data)
+    return;
+
+  munmap(const_cast<u8*>(m_data), m_size);
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const
+{
+  if (offset >= m_size)
+    return;
+
+  // madvise() needs a page-aligned start address
+  const uintptr_t start = reinterpret_cast<uintptr_t>(m_data + offset) & ~static_cast<uintptr_t>(HOST_PAGE_MASK);
+  const uintptr_t end = reinterpret_cast<uintptr_t>(m_data + offset + std::min(size, m_size - offset));
+  madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+}
+
+void MappedFile::SetAccessPattern(AccessPattern pattern, size_t offset, size_t size) const
+{
+  if (offset >= m_size)
+    return;
+
+  const uintptr_t start = reinterpret_cast<uintptr_t>(m_data + offset) & ~static_cast<uintptr_t>(HOST_PAGE_MASK);
+  const uintptr_t end = reinterpret_cast<uintptr_t>(m_data + offset + std::min(size, m_size - offset));
+  static constexpr const int advice[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM};
+  madvise(reinterpret_cast<void*>(start), end - start, advice[static_cast<size_t>(pattern)]);
+}
+
+#endif
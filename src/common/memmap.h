@@ -6,6 +6,7 @@
 #include "types.h"
 
 #include <map>
+#include <span>
 #include <string>
 
 #if defined(_WIN32)
@@ -56,6 +57,17 @@ u32 GetRuntimePageSize();
 
 std::string GetFileMappingName(const char* prefix);
 void* CreateSharedMemory(const char* name, size_t size, Error* error);
+
+/// Returns a mapping name which is the same in every process, for memory which is shared between processes.
+std::string GetSharedFileMappingName(const char* name);
+
+/// Opens a named shared memory object, or creates it with the specified size if it does not exist yet.
+/// created is set if this process created the object, in which case it is zero-filled.
+void* OpenSharedMemory(const char* name, size_t size, bool* created, Error* error);
+
+/// Closes a handle from OpenSharedMemory(). If no other process has the object open, the name is removed as well, so
+/// the next open creates a new object. Processes which exited without closing the object do not keep it alive.
+void CloseSharedMemory(void* handle, const char* name);
 void DeleteSharedMemory(const char* name);
 void DestroySharedMemory(void* ptr);
 void* MapSharedMemory(void* handle, size_t offset, void* baseaddr, size_t size, PageProtect mode);
@@ -126,3 +138,43 @@ private:
   PlaceholderMap m_placeholder_ranges;
 #endif
 };
+
+/// Read-only view of a file's contents, mapped into the address space.
+class MappedFile
+{
+public:
+  enum class AccessPattern : u8
+  {
+    Normal,
+    Sequential,
+    Random,
+  };
+
+  MappedFile();
+  MappedFile(MappedFile&& move);
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile();
+
+  MappedFile& operator=(MappedFile&& move);
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ALWAYS_INLINE bool IsOpen() const { return (m_data != nullptr); }
+  ALWAYS_INLINE const u8* GetData() const { return m_data; }
+  ALWAYS_INLINE size_t GetSize() const { return m_size; }
+  ALWAYS_INLINE std::span<const u8> GetSpan() const { return std::span<const u8>(m_data, m_size); }
+
+  /// Maps the entire file. Empty files can't be mapped, and will fail.
+  /// If deny_write is set, other handles can't open the file for writing while it is mapped. Only enforced on Windows.
+  bool Open(const char* path, bool deny_write, Error* error);
+  void Close();
+
+  /// Hints to the OS that the specified range will be read soon, so it can be paged in ahead of time.
+  void Prefetch(size_t offset, size_t size) const;
+
+  /// Hints to the OS how the specified range will be accessed, controlling readahead and how eagerly pages are dropped.
+  void SetAccessPattern(AccessPattern pattern, size_t offset, size_t size) const;
+
+private:
+  const u8* m_data = nullptr;
+  size_t m_size = 0;
+};
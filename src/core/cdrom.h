@@ -48,6 +48,9 @@ void DrawDebugWindow(float scale);
 
 void SetReadaheadSectors(u32 readahead_sectors);
 
+/// Saves the current access trace and reloads it according to the settings.
+void UpdateAccessTrace();
+
 /// Reads a frame from the audio FIFO, used by the SPU.
 std::tuple<s16, s16> GetAudioFrame();
 
@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "cdrom_access_trace.h"
+#include "settings.h"
+
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/heap_array.h"
+#include "common/log.h"
+#include "common/path.h"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+LOG_CHANNEL(CDROM);
+
+namespace {
+#pragma pack(push, 1)
+struct TraceFileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 num_entries;
+};
+#pragma pack(pop)
+} // namespace
+
+static constexpr u32 TRACE_FILE_MAGIC = 0x43525444; // DTRC
+static constexpr u32 TRACE_FILE_VERSION = 1;
+
+CDROMAccessTrace::CDROMAccessTrace() = default;
+
+CDROMAccessTrace::~CDROMAccessTrace() = default;
+
+std::string CDROMAccessTrace::GetPathForSerial(std::string_view serial)
+{
+  return Path::Combine(EmuFolders::Cache,
+                       fmt::format("disctrace" FS_OSPATH_SEPARATOR_STR "{}.trace", Path::SanitizeFileName(serial)));
+}
+
+void CDROMAccessTrace::Clear()
+{
+  m_entries.clear();
+}
+
+u32 CDROMAccessTrace::GetUniqueSectorCount() const
+{
+  std::vector<std::pair<u32, u32>> ranges;
+  ranges.reserve(m_entries.size());
+  for (const Entry& entry : m_entries)
+  {
+    if (entry.sector_count > 0)
+      ranges.emplace_back(entry.lba, entry.lba + entry.sector_count);
+  }
+  std::sort(ranges.begin(), ranges.end());
+
+  u32 count = 0;
+  u32 covered_end = 0;
+  for (const auto& [start, end] : ranges)
+  {
+    if (end <= covered_end)
+      continue;
+
+    count += end - std::max(start, covered_end);
+    covered_end = end;
+  }
+
+  return count;
+}
+
+void CDROMAccessTrace::AddRequest(RequestType type, u32 lba, u32 time_ms)
+{
+  if (!m_entries.empty())
+  {
+    // seek followed by read/play of the same position is a single request
+    Entry& last = m_entries.back();
+    if (last.lba == lba && last.sector_count == 0)
+    {
+      last.type = type;
+      return;
+    }
+  }
+
+  if (m_entries.size() >= MAX_ENTRIES) [[unlikely]]
+    return;
+
+  m_entries.push_back(Entry{lba, 0, type, 0, time_ms});
+}
+
+void CDROMAccessTrace::AddSector(u32 lba, u32 time_ms)
+{
+  if (!m_entries.empty())
+  {
+    Entry& last = m_entries.back();
+    if (lba >= last.lba && lba < (last.lba + last.sector_count))
+    {
+      // re-delivery of a sector we already have, e.g. after a missed INT1
+      return;
+    }
+    else if (lba == (last.lba + last.sector_count) && last.sector_count < std::numeric_limits<u16>::max())
+    {
+      last.sector_count++;
+      return;
+    }
+  }
+
+  // drive moved without a request, e.g. readahead hitting the end of a run
+  if (m_entries.size() >= MAX_ENTRIES) [[unlikely]]
+    return;
+
+  m_entries.push_back(Entry{lba, 1, RequestType::Read, 0, time_ms});
+}
+
+bool CDROMAccessTrace::LoadFromFile(const char* path, Error* error)
+{
+  std::optional<DynamicHeapArray<u8>> data = FileSystem::ReadBinaryFile(path, error);
+  if (!data.has_value())
+    return false;
+
+  TraceFileHeader header;
+  if (data->size() < sizeof(header))
+  {
+    Error::SetStringView(error, "Trace file is too short.");
+    return false;
+  }
+
+  std::memcpy(&header, data->data(), sizeof(header));
+  if (header.magic != TRACE_FILE_MAGIC || header.version != TRACE_FILE_VERSION)
+  {
+    Error::SetStringFmt(error, "Invalid trace header magic 0x{:08X} version {}", header.magic, header.version);
+    return false;
+  }
+
+  if (header.num_entries > MAX_ENTRIES || (data->size() - sizeof(header)) != (header.num_entries * sizeof(Entry)))
+  {
+    Error::SetStringFmt(error, "Invalid trace entry count {} for file size {}", header.num_entries, data->size());
+    return false;
+  }
+
+  m_entries.resize(header.num_entries);
+  std::memcpy(m_entries.data(), data->data() + sizeof(header), header.num_entries * sizeof(Entry));
+  return true;
+}
+
+bool CDROMAccessTrace::SaveToFile(const char* path, Error* error) const
+{
+  if (!FileSystem::EnsureDirectoryExists(std::string(Path::GetDirectory(path)).c_str(), false, error))
+    return false;
+
+  const TraceFileHeader header = {TRACE_FILE_MAGIC, TRACE_FILE_VERSION, static_cast<u32>(m_entries.size())};
+  DynamicHeapArray<u8> data(sizeof(header) + m_entries.size() * sizeof(Entry));
+  std::memcpy(data.data(), &header, sizeof(header));
+  std::memcpy(data.data() + sizeof(header), m_entries.data(), m_entries.size() * sizeof(Entry));
+  return FileSystem::WriteAtomicRenamedFile(path, data.cspan(), error);
+}
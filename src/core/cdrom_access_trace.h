@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#pragma once
+
+#include "types.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Error;
+
+/// Records the order in which a game reads the disc, so that the next boot can prefetch sectors before they're needed.
+class CDROMAccessTrace
+{
+public:
+  enum class RequestType : u8
+  {
+    Seek,
+    Read,
+    Play,
+  };
+
+  /// A run of contiguous sectors read after a single request.
+  struct Entry
+  {
+    u32 lba;
+    u16 sector_count;
+    RequestType type;
+    u8 pad;
+    u32 time_ms;
+  };
+  static_assert(sizeof(Entry) == 12);
+
+  /// Traces are capped to this many entries, anything after is dropped.
+  static constexpr u32 MAX_ENTRIES = 65536;
+
+  CDROMAccessTrace();
+  ~CDROMAccessTrace();
+
+  static std::string GetPathForSerial(std::string_view serial);
+
+  bool IsEmpty() const { return m_entries.empty(); }
+  u32 GetEntryCount() const { return static_cast<u32>(m_entries.size()); }
+  const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+  /// Returns the number of distinct sectors read, i.e. how much of the disc the trace covers.
+  u32 GetUniqueSectorCount() const;
+
+  void Clear();
+
+  /// Starts a new run for a seek/read/play command.
+  void AddRequest(RequestType type, u32 lba, u32 time_ms);
+
+  /// Extends the current run with a sector that was delivered to the CPU.
+  void AddSector(u32 lba, u32 time_ms);
+
+  bool LoadFromFile(const char* path, Error* error);
+  bool SaveToFile(const char* path, Error* error) const;
+
+private:
+  std::vector<Entry> m_entries;
+};
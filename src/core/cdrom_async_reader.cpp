@@ -2,9 +2,15 @@
 // SPDX-License-Identifier: CC-BY-NC-ND-4.0
 
 #include "cdrom_async_reader.h"
+#include "cdrom_access_trace.h"
+
 #include "common/assert.h"
+#include "common/error.h"
 #include "common/log.h"
 #include "common/timer.h"
+
+#include <algorithm>
+
 LOG_CHANNEL(CDROMAsyncReader);
 
 CDROMAsyncReader::CDROMAsyncReader() = default;
@@ -19,13 +25,20 @@ void CDROMAsyncReader::StartThread(u32 readahead_count)
   if (IsUsingThread())
     StopThread();
 
+  // buffers are sized for the largest window, the active window starts at the configured count
+  m_readahead_base = readahead_count;
+  m_readahead_min = std::max(readahead_count / 2u, 1u);
+  m_readahead_window.store(readahead_count);
+  m_sequential_hits = 0;
+  m_prefetch_pending = false;
+
   m_buffers.clear();
-  m_buffers.resize(readahead_count);
+  m_buffers.resize(readahead_count * MAX_READAHEAD_MULTIPLIER);
   EmptyBuffers();
 
   m_shutdown_flag.store(false);
   m_read_thread = std::thread(&CDROMAsyncReader::WorkerThreadEntryPoint, this);
-  INFO_LOG("Read thread started with readahead of {} sectors", readahead_count);
+  INFO_LOG("Read thread started with readahead of {}-{} sectors", readahead_count, m_buffers.size());
 }
 
 void CDROMAsyncReader::StopThread()
@@ -42,6 +55,36 @@ void CDROMAsyncReader::StopThread()
   m_read_thread.join();
   EmptyBuffers();
   m_buffers.clear();
+  m_readahead_base = 0;
+  m_readahead_window.store(0);
+  m_prefetch_pending = false;
+}
+
+CDROMAsyncReader::Stats CDROMAsyncReader::GetStats() const
+{
+  Stats ret;
+  ret.readahead_hits = m_stat_hits.load(std::memory_order_relaxed);
+  ret.readahead_misses = m_stat_misses.load(std::memory_order_relaxed);
+  ret.sequential_misses = m_stat_sequential_misses.load(std::memory_order_relaxed);
+  ret.prefetch_hits = m_stat_prefetch_hits.load(std::memory_order_relaxed);
+  ret.stalls = m_stat_stalls.load(std::memory_order_relaxed);
+  ret.warmed_sectors = m_stat_warmed_sectors.load(std::memory_order_relaxed);
+  ret.warm_hits = m_stat_warm_hits.load(std::memory_order_relaxed);
+  ret.stall_time_ms =
+    static_cast<float>(Timer::ConvertValueToMilliseconds(m_stat_stall_ticks.load(std::memory_order_relaxed)));
+  return ret;
+}
+
+void CDROMAsyncReader::ResetStats()
+{
+  m_stat_hits.store(0, std::memory_order_relaxed);
+  m_stat_misses.store(0, std::memory_order_relaxed);
+  m_stat_sequential_misses.store(0, std::memory_order_relaxed);
+  m_stat_prefetch_hits.store(0, std::memory_order_relaxed);
+  m_stat_stalls.store(0, std::memory_order_relaxed);
+  m_stat_warmed_sectors.store(0, std::memory_order_relaxed);
+  m_stat_warm_hits.store(0, std::memory_order_relaxed);
+  m_stat_stall_ticks.store(0, std::memory_order_relaxed);
 }
 
 void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
@@ -50,6 +93,7 @@ void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
     CancelReadahead();
 
   m_media = std::move(media);
+  ResetStats();
 }
 
 std::unique_ptr<CDImage> CDROMAsyncReader::RemoveMedia()
@@ -57,10 +101,21 @@ std::unique_ptr<CDImage> CDROMAsyncReader::RemoveMedia()
   if (IsUsingThread())
     CancelReadahead();
 
+  const Stats stats = GetStats();
+  if (stats.readahead_hits > 0 || stats.readahead_misses > 0)
+  {
+    INFO_LOG("Readahead stats: {} hits, {} misses ({} sequential), {} prefetch hits, {} stalls ({:.2f} msec)",
+             stats.readahead_hits, stats.readahead_misses, stats.sequential_misses, stats.prefetch_hits, stats.stalls,
+             stats.stall_time_ms);
+    if (stats.warmed_sectors > 0)
+      INFO_LOG("Trace prefetch stats: {} sectors warmed, {} used", stats.warmed_sectors, stats.warm_hits);
+  }
+
+  SetAccessTrace(nullptr);
   return std::move(m_media);
 }
 
-bool CDROMAsyncReader::Precache(ProgressCallback* callback)
+bool CDROMAsyncReader::Precache(ProgressCallback* callback, bool compressed, bool shared)
 {
   WaitForIdle();
 
@@ -70,33 +125,42 @@ bool CDROMAsyncReader::Precache(ProgressCallback* callback)
   else if (m_media->IsPrecached())
     return true;
 
+  // Shared copies are decompressed, so this takes priority over the image's own precache.
+  if (shared)
+  {
+    Error error;
+    if (std::unique_ptr<CDImage> shared_image = CDImage::CreateSharedMemoryImage(m_media.get(), callback, &error))
+      return ReplaceWithMemoryImage(std::move(shared_image));
+
+    WARNING_LOG("Failed to share preloaded image, using a private copy: {}", error.GetDescription());
+  }
+
   const CDImage::PrecacheResult res = m_media->Precache(callback);
   if (res == CDImage::PrecacheResult::Unsupported)
   {
     // fall back to copy precaching
-    std::unique_ptr<CDImage> memory_image = CDImage::CreateMemoryImage(m_media.get(), callback);
-    if (memory_image)
-    {
-      const CDImage::LBA lba = m_media->GetPositionOnDisc();
-      if (!memory_image->Seek(lba)) [[unlikely]]
-      {
-        ERROR_LOG("Failed to seek to LBA {} in memory image", lba);
-        return false;
-      }
-
-      m_media.reset();
-      m_media = std::move(memory_image);
-      return true;
-    }
-    else
-    {
-      return false;
-    }
+    std::unique_ptr<CDImage> memory_image = compressed ?
+                                              CDImage::CreateCompressedMemoryImage(m_media.get(), callback) :
+                                              CDImage::CreateMemoryImage(m_media.get(), callback);
+    return (memory_image && ReplaceWithMemoryImage(std::move(memory_image)));
   }
 
   return (res == CDImage::PrecacheResult::Success);
 }
 
+bool CDROMAsyncReader::ReplaceWithMemoryImage(std::unique_ptr<CDImage> memory_image)
+{
+  const CDImage::LBA lba = m_media->GetPositionOnDisc();
+  if (!memory_image->Seek(lba)) [[unlikely]]
+  {
+    ERROR_LOG("Failed to seek to LBA {} in memory image", lba);
+    return false;
+  }
+
+  m_media = std::move(memory_image);
+  return true;
+}
+
 void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
 {
   if (!IsUsingThread())
@@ -114,6 +178,13 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
     if (m_buffers[buffer_front].lba == lba)
     {
       DEBUG_LOG("Skipping re-reading same sector {}", lba);
+      if (m_prefetch_pending && m_prefetch_lba == lba)
+      {
+        DEBUG_LOG("Prefetch hit for sector {}", lba);
+        m_stat_prefetch_hits.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      m_prefetch_pending = false;
       return;
     }
 
@@ -125,20 +196,219 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
       DEBUG_LOG("Readahead buffer hit for sector {}", lba);
       m_buffer_front.store(next_buffer);
       m_buffer_count.fetch_sub(1);
+      m_stat_hits.fetch_add(1, std::memory_order_relaxed);
+      m_prefetch_pending = false;
+
+      // consumed a whole window without seeking? probably streaming, so read further ahead
+      if (++m_sequential_hits >= m_readahead_window.load(std::memory_order_relaxed))
+        GrowReadaheadWindow();
+
       m_can_readahead.store(true);
       m_do_read_cv.notify_one();
       return;
     }
+
+    // if the sector we want is the one after the current, the reader couldn't keep up, not random access
+    if (m_buffers[buffer_front].lba + 1 == lba)
+    {
+      DEBUG_LOG("Readahead underrun for sector {}", lba);
+      m_stat_sequential_misses.fetch_add(1, std::memory_order_relaxed);
+      GrowReadaheadWindow();
+    }
+    else
+    {
+      ShrinkReadaheadWindow();
+    }
+  }
+  else if (m_prefetch_pending && m_prefetch_lba == lba)
+  {
+    // seek was already started by the prefetch, the sector will be along shortly
+    DEBUG_LOG("Prefetch in progress for sector {}", lba);
+    m_stat_prefetch_hits.fetch_add(1, std::memory_order_relaxed);
+    m_prefetch_pending = false;
+    return;
+  }
+  else
+  {
+    ShrinkReadaheadWindow();
   }
 
   // we need to toss away our readahead and start fresh
   DEBUG_LOG("Readahead buffer miss, queueing seek to {}", lba);
+  m_stat_misses.fetch_add(1, std::memory_order_relaxed);
+  m_prefetch_pending = false;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_next_position_set.store(true);
+  m_next_position = lba;
+  PredictFromTrace(lba);
+  m_do_read_cv.notify_one();
+}
+
+void CDROMAsyncReader::PrefetchSector(CDImage::LBA lba)
+{
+  if (!IsUsingThread() || !m_media)
+    return;
+
+  // already buffered?
+  const u32 buffer_count = m_buffer_count.load();
+  const u32 buffer_front = m_buffer_front.load();
+  for (u32 i = 0; i < buffer_count; i++)
+  {
+    if (m_buffers[(buffer_front + i) % static_cast<u32>(m_buffers.size())].lba == lba)
+      return;
+  }
+
   std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_next_position_set.load())
+    return;
+
+  DEBUG_LOG("Prefetching sector {}", lba);
+  m_prefetch_lba = lba;
+  m_prefetch_pending = true;
   m_next_position_set.store(true);
   m_next_position = lba;
+  PredictFromTrace(lba);
   m_do_read_cv.notify_one();
 }
 
+void CDROMAsyncReader::SetAccessTrace(const CDROMAccessTrace* trace)
+{
+  std::unique_lock lock(m_mutex);
+
+  // wait until the read thread is idle, it's the only user of the warm cache
+  m_notify_read_complete_cv.wait(lock, [this]() { return !m_is_reading.load(); });
+
+  m_trace_runs.clear();
+  m_trace_index.clear();
+  m_trace_position = 0;
+  m_predicted_runs.clear();
+
+  if (!trace || trace->IsEmpty() || !IsUsingThread())
+  {
+    m_warm_cache = {};
+    return;
+  }
+
+  // only runs which actually read something are useful for prediction
+  m_trace_runs.reserve(trace->GetEntryCount());
+  for (const CDROMAccessTrace::Entry& entry : trace->GetEntries())
+  {
+    if (entry.sector_count > 0)
+      m_trace_runs.push_back(TraceRun{entry.lba, entry.sector_count});
+  }
+
+  m_trace_index.reserve(m_trace_runs.size());
+  for (u32 i = 0; i < static_cast<u32>(m_trace_runs.size()); i++)
+    m_trace_index.emplace_back(m_trace_runs[i].lba, i);
+  std::sort(m_trace_index.begin(), m_trace_index.end());
+
+  m_warm_cache.resize(WARM_CACHE_SIZE);
+  InvalidateWarmCache();
+
+  DEV_LOG("Using access trace with {} runs for prefetching", m_trace_runs.size());
+}
+
+void CDROMAsyncReader::PredictFromTrace(CDImage::LBA lba)
+{
+  if (m_trace_runs.empty())
+    return;
+
+  // games often read the same sector from several places, so prefer the occurrence after where we last were
+  m_predicted_runs.clear();
+  auto iter = std::lower_bound(m_trace_index.begin(), m_trace_index.end(), std::make_pair(lba, m_trace_position + 1));
+  if (iter == m_trace_index.end() || iter->first != lba)
+  {
+    iter = std::lower_bound(m_trace_index.begin(), m_trace_index.end(), std::make_pair(lba, 0u));
+    if (iter == m_trace_index.end() || iter->first != lba)
+      return;
+  }
+
+  m_trace_position = iter->second;
+
+  u32 total_sectors = 0;
+  for (u32 i = m_trace_position + 1;
+       i < static_cast<u32>(m_trace_runs.size()) && m_predicted_runs.size() < MAX_PREDICTED_RUNS &&
+       total_sectors < MAX_PREDICTED_SECTORS;
+       i++)
+  {
+    const TraceRun& run = m_trace_runs[i];
+    const u32 count = std::min(run.count, MAX_PREDICTED_SECTORS - total_sectors);
+    m_predicted_runs.push_back(TraceRun{run.lba, count});
+    total_sectors += count;
+  }
+
+  std::reverse(m_predicted_runs.begin(), m_predicted_runs.end());
+  DEBUG_LOG("Predicted {} sectors in {} runs after LBA {}", total_sectors, m_predicted_runs.size(), lba);
+}
+
+void CDROMAsyncReader::InvalidateWarmCache()
+{
+  for (BufferSlot& slot : m_warm_cache)
+  {
+    slot.lba = static_cast<CDImage::LBA>(-1);
+    slot.result = false;
+  }
+}
+
+void CDROMAsyncReader::WarmPredictedSectors(std::unique_lock<std::mutex>& lock)
+{
+  // readahead and seeks always take priority over warming
+  while (!m_predicted_runs.empty() && !m_shutdown_flag.load() && !m_next_position_set.load() &&
+         !m_can_readahead.load())
+  {
+    TraceRun& run = m_predicted_runs.back();
+    const CDImage::LBA lba = run.lba;
+    run.lba++;
+    if ((--run.count) == 0)
+      m_predicted_runs.pop_back();
+
+    BufferSlot& slot = m_warm_cache[lba % WARM_CACHE_SIZE];
+    if (slot.lba == lba && slot.result)
+      continue;
+
+    m_is_reading.store(true);
+    lock.unlock();
+
+    // reading the sector is what decompresses the CHD hunk/PBP block, the data itself goes into the warm cache
+    TRACE_LOG("Warming LBA {}...", lba);
+    slot.lba = lba;
+    slot.result = ((m_media->GetPositionOnDisc() == lba || m_media->Seek(lba)) &&
+                   m_media->ReadRawSector(slot.data.data(), &slot.subq));
+
+    lock.lock();
+    m_is_reading.store(false);
+    m_stat_warmed_sectors.fetch_add(1, std::memory_order_relaxed);
+    m_notify_read_complete_cv.notify_all();
+  }
+}
+
+void CDROMAsyncReader::GrowReadaheadWindow()
+{
+  m_sequential_hits = 0;
+
+  const u32 window = m_readahead_window.load(std::memory_order_relaxed);
+  const u32 new_window = std::min(window * 2u, static_cast<u32>(m_buffers.size()));
+  if (window == new_window)
+    return;
+
+  DEV_LOG("Growing readahead window from {} to {} sectors", window, new_window);
+  m_readahead_window.store(new_window, std::memory_order_relaxed);
+}
+
+void CDROMAsyncReader::ShrinkReadaheadWindow()
+{
+  m_sequential_hits = 0;
+
+  const u32 window = m_readahead_window.load(std::memory_order_relaxed);
+  const u32 new_window = std::max(window / 2u, m_readahead_min);
+  if (window == new_window)
+    return;
+
+  DEV_LOG("Shrinking readahead window from {} to {} sectors", window, new_window);
+  m_readahead_window.store(new_window, std::memory_order_relaxed);
+}
+
 bool CDROMAsyncReader::ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data)
 {
   if (!IsUsingThread())
@@ -200,7 +470,10 @@ bool CDROMAsyncReader::WaitForReadToComplete()
   }
 
   const u32 front = m_buffer_front.load();
-  const double wait_time = wait_timer.GetTimeMilliseconds();
+  const Timer::Value wait_ticks = Timer::GetCurrentValue() - wait_timer.GetStartValue();
+  const double wait_time = Timer::ConvertValueToMilliseconds(wait_ticks);
+  m_stat_stalls.fetch_add(1, std::memory_order_relaxed);
+  m_stat_stall_ticks.fetch_add(wait_ticks, std::memory_order_relaxed);
   if (wait_time > 1.0f) [[unlikely]]
     WARNING_LOG("Had to wait {:.2f} msec for LBA {}", wait_time, m_buffers[front].lba);
 
@@ -232,13 +505,36 @@ bool CDROMAsyncReader::ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock)
   m_buffer_back.store((slot + 1) % static_cast<u32>(m_buffers.size()));
 
   BufferSlot& buffer = m_buffers[slot];
-  buffer.lba = m_media->GetPositionOnDisc();
+  buffer.lba = m_next_read_lba++;
+
+  // already read by the trace prefetcher?
+  if (!m_warm_cache.empty())
+  {
+    const BufferSlot& warm = m_warm_cache[buffer.lba % WARM_CACHE_SIZE];
+    if (warm.lba == buffer.lba && warm.result)
+    {
+      TRACE_LOG("Using warmed LBA {}", buffer.lba);
+      buffer.data = warm.data;
+      buffer.subq = warm.subq;
+      buffer.result = true;
+      m_stat_warm_hits.fetch_add(1, std::memory_order_relaxed);
+      m_buffer_count.fetch_add(1);
+      m_notify_read_complete_cv.notify_all();
+      return true;
+    }
+  }
+
   m_is_reading.store(true);
   lock.unlock();
 
   TRACE_LOG("Reading LBA {}...", buffer.lba);
 
-  buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  // warming may have moved the image position
+  if (m_media->GetPositionOnDisc() != buffer.lba && !m_media->Seek(buffer.lba)) [[unlikely]]
+    buffer.result = false;
+  else
+    buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+
   if (buffer.result) [[likely]]
   {
     const double read_time = timer.GetTimeMilliseconds();
@@ -303,6 +599,9 @@ void CDROMAsyncReader::CancelReadahead()
 
   // prevent it from doing any more when it re-acquires the lock
   m_can_readahead.store(false);
+  m_prefetch_pending = false;
+  m_predicted_runs.clear();
+  InvalidateWarmCache();
   EmptyBuffers();
 }
 
@@ -312,8 +611,10 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
 
   for (;;)
   {
-    m_do_read_cv.wait(
-      lock, [this]() { return (m_shutdown_flag.load() || m_next_position_set.load() || m_can_readahead.load()); });
+    m_do_read_cv.wait(lock, [this]() {
+      return (m_shutdown_flag.load() || m_next_position_set.load() || m_can_readahead.load() ||
+              !m_predicted_runs.empty());
+    });
     if (m_shutdown_flag.load())
       break;
 
@@ -346,20 +647,23 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
           // add the error result, and don't try to read ahead
           WARNING_LOG("Seek to LBA {} failed", seek_location);
           m_seek_error.store(true);
+          m_predicted_runs.clear();
           m_notify_read_complete_cv.notify_all();
           break;
         }
 
         // go go read ahead!
+        m_next_read_lba = seek_location;
         m_can_readahead.store(true);
       }
 
       if (!m_can_readahead.load())
         break;
 
-      // readahead time! read as many sectors as we have space for
-      DEBUG_LOG("Reading ahead {} sectors...", static_cast<u32>(m_buffers.size()) - m_buffer_count.load());
-      while (m_buffer_count.load() < static_cast<u32>(m_buffers.size()))
+      // readahead time! read as many sectors as the current window allows
+      const u32 window = m_readahead_window.load(std::memory_order_relaxed);
+      DEBUG_LOG("Reading ahead {} sectors...", window - std::min(m_buffer_count.load(), window));
+      while (m_buffer_count.load() < m_readahead_window.load(std::memory_order_relaxed))
       {
         if (m_next_position_set.load())
         {
@@ -376,5 +680,8 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
       m_can_readahead.store(false);
       break;
     }
+
+    // nothing else to do, so get ahead of the game by reading what it's likely to ask for next
+    WarmPredictedSectors(lock);
   }
 }
@@ -8,8 +8,11 @@
 #include <atomic>
 #include <condition_variable>
 #include <thread>
+#include <utility>
+#include <vector>
 
 class ProgressCallback;
+class CDROMAccessTrace;
 
 class CDROMAsyncReader
 {
@@ -24,6 +27,28 @@ public:
     bool result;
   };
 
+  struct Stats
+  {
+    u32 readahead_hits;
+    u32 readahead_misses;
+    u32 sequential_misses;
+    u32 prefetch_hits;
+    u32 stalls;
+    u32 warmed_sectors;
+    u32 warm_hits;
+    float stall_time_ms;
+  };
+
+  /// Readahead window can grow up to this multiple of the configured readahead count during sequential streams.
+  static constexpr u32 MAX_READAHEAD_MULTIPLIER = 4;
+
+  /// Number of sectors predicted from the access trace that can be held at once, direct mapped by LBA.
+  static constexpr u32 WARM_CACHE_SIZE = 256;
+
+  /// Limits on how far ahead of a seek the access trace is followed.
+  static constexpr u32 MAX_PREDICTED_SECTORS = 192;
+  static constexpr u32 MAX_PREDICTED_RUNS = 16;
+
   CDROMAsyncReader();
   ~CDROMAsyncReader();
 
@@ -32,7 +57,11 @@ public:
   const CDImage::SubChannelQ& GetSectorSubQ() const { return m_buffers[m_buffer_front.load()].subq; }
   u32 GetBufferedSectorCount() const { return m_buffer_count.load(); }
   bool HasBufferedSectors() const { return (m_buffer_count.load() > 0); }
-  u32 GetReadaheadCount() const { return static_cast<u32>(m_buffers.size()); }
+  u32 GetReadaheadCount() const { return m_readahead_base; }
+  u32 GetReadaheadWindow() const { return m_readahead_window.load(std::memory_order_relaxed); }
+
+  Stats GetStats() const;
+  void ResetStats();
 
   bool HasMedia() const { return static_cast<bool>(m_media); }
   const CDImage* GetMedia() const { return m_media.get(); }
@@ -47,10 +76,20 @@ public:
   std::unique_ptr<CDImage> RemoveMedia();
 
   /// Precaches image, either to memory, or using the underlying image precache.
-  bool Precache(ProgressCallback* callback);
+  /// If compressed is set, images without their own precache are compressed in memory.
+  /// If shared is set, the image is copied to memory shared with other processes using the same image instead.
+  bool Precache(ProgressCallback* callback, bool compressed, bool shared);
 
   void QueueReadSector(CDImage::LBA lba);
 
+  /// Hints that the next read will be from the specified sector, e.g. after a Setloc, so the seek can be started
+  /// before the emulated seek is issued. Ignored if there is already a pending request.
+  void PrefetchSector(CDImage::LBA lba);
+
+  /// Sets the previously-recorded access trace used to predict and warm the sectors that follow a seek.
+  /// Passing null disables prediction.
+  void SetAccessTrace(const CDROMAccessTrace* trace);
+
   bool WaitForReadToComplete();
   void WaitForIdle();
 
@@ -58,11 +97,23 @@ public:
   bool ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
 
 private:
+  struct TraceRun
+  {
+    CDImage::LBA lba;
+    u32 count;
+  };
+
   void EmptyBuffers();
+  bool ReplaceWithMemoryImage(std::unique_ptr<CDImage> memory_image);
   bool ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock);
   void ReadSectorNonThreaded(CDImage::LBA lba);
   bool InternalReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
   void CancelReadahead();
+  void GrowReadaheadWindow();
+  void ShrinkReadaheadWindow();
+  void PredictFromTrace(CDImage::LBA lba);
+  void InvalidateWarmCache();
+  void WarmPredictedSectors(std::unique_lock<std::mutex>& lock);
 
   void WorkerThreadEntryPoint();
 
@@ -85,4 +136,27 @@ private:
   std::atomic<u32> m_buffer_front{0};
   std::atomic<u32> m_buffer_back{0};
   std::atomic<u32> m_buffer_count{0};
+  CDImage::LBA m_next_read_lba = 0;
+
+  u32 m_readahead_base = 0;
+  u32 m_readahead_min = 0;
+  std::atomic<u32> m_readahead_window{0};
+  u32 m_sequential_hits = 0;
+  CDImage::LBA m_prefetch_lba = 0;
+  bool m_prefetch_pending = false;
+
+  std::vector<TraceRun> m_trace_runs;
+  std::vector<std::pair<CDImage::LBA, u32>> m_trace_index;
+  u32 m_trace_position = 0;
+  std::vector<TraceRun> m_predicted_runs; // reverse order, consumed from the back
+  std::vector<BufferSlot> m_warm_cache;
+
+  std::atomic<u32> m_stat_hits{0};
+  std::atomic<u32> m_stat_misses{0};
+  std::atomic<u32> m_stat_sequential_misses{0};
+  std::atomic<u32> m_stat_prefetch_hits{0};
+  std::atomic<u32> m_stat_stalls{0};
+  std::atomic<u32> m_stat_warmed_sectors{0};
+  std::atomic<u32> m_stat_warm_hits{0};
+  std::atomic<u64> m_stat_stall_ticks{0};
 };
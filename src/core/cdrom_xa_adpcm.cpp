@@ -0,0 +1,351 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "cdrom_xa_adpcm.h"
+
+#include "common/bitfield.h"
+#include "common/gsvector.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace XAADPCM {
+namespace {
+
+enum : u32
+{
+  ZIGZAG_TABLE_SIZE = 29,
+  NUM_ZIGZAG_TABLES = 7,
+};
+
+union BlockHeader
+{
+  u8 bits;
+
+  BitField<u8, u8, 0, 4> shift;
+  BitField<u8, u8, 4, 4> filter;
+
+  // For both 4bit and 8bit ADPCM, reserved shift values 13..15 will act same as shift=9).
+  u8 GetShift() const
+  {
+    const u8 shift_value = shift;
+    return (shift_value > 12) ? 9 : shift_value;
+  }
+
+  u8 GetFilter() const { return filter; }
+};
+static_assert(sizeof(BlockHeader) == 1, "XA-ADPCM block header is one byte");
+
+} // namespace
+
+static s16 ApplyFilter(s32 sample, s32& prev0, s32& prev1, s32 filter_pos, s32 filter_neg);
+
+} // namespace XAADPCM
+
+void XAADPCM::ResamplerState::Reset()
+{
+  for (auto& buf : ring_buffer)
+    buf.fill(0);
+  p = 0;
+  sixstep = 6;
+}
+
+ALWAYS_INLINE s16 XAADPCM::ApplyFilter(s32 sample, s32& prev0, s32& prev1, s32 filter_pos, s32 filter_neg)
+{
+  // mix in previous values
+  const s32 interp_sample =
+    std::clamp<s32>(sample + ((prev0 * filter_pos) >> 6) + ((prev1 * filter_neg) >> 6), -32768, 32767);
+
+  // update previous values
+  prev1 = prev0;
+  prev0 = interp_sample;
+  return static_cast<s16>(interp_sample);
+}
+
+template<bool IS_STEREO, bool IS_8BIT>
+void XAADPCM::DecodeChunks(const u8* chunk_ptr, s16* samples, LastSamples& last_samples)
+{
+  static constexpr std::array<s8, 16> filter_table_pos = {{0, 60, 115, 98, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+  static constexpr std::array<s8, 16> filter_table_neg = {{0, 0, -52, -55, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+  // The data layout is annoying here. Each word of data is interleaved with the other blocks, requiring multiple
+  // passes to decode the whole chunk.
+  constexpr u32 NUM_CHUNKS = 18;
+  constexpr u32 CHUNK_SIZE_IN_BYTES = 128;
+  constexpr u32 WORDS_PER_CHUNK = 28;
+  constexpr u32 SAMPLES_PER_CHUNK = WORDS_PER_CHUNK * (IS_8BIT ? 4 : 8);
+  constexpr u32 NUM_BLOCKS = IS_8BIT ? 4 : 8;
+  constexpr u32 WORDS_PER_BLOCK = 28;
+  constexpr u32 BITS_PER_SAMPLE = IS_8BIT ? 8 : 4;
+  static constexpr GSVector4i sample_mask = GSVector4i::cxpr(static_cast<s32>(0xFFFFFFFFu << (32 - BITS_PER_SAMPLE)));
+
+  for (u32 i = 0; i < NUM_CHUNKS; i++)
+  {
+    const u8* headers_ptr = chunk_ptr + 4;
+    const u8* words_ptr = chunk_ptr + 16;
+
+    // Extract and shift the samples for every sound unit up front, four words at a time. Only the filter has to be
+    // applied serially, since each sample depends on the previous two.
+    std::array<u32, NUM_BLOCKS> block_shifts;
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
+      block_shifts[block] = 16 + BlockHeader{headers_ptr[block]}.GetShift();
+
+    std::array<std::array<s16, WORDS_PER_BLOCK>, NUM_BLOCKS> block_samples;
+    for (u32 word = 0; word < WORDS_PER_BLOCK; word += 4)
+    {
+      // NOTE: assumes LE
+      const GSVector4i words = GSVector4i::load<false>(&words_ptr[word * sizeof(u32)]);
+      for (u32 block = 0; block < NUM_BLOCKS; block++)
+      {
+        // Move the nibble/byte to the top of the word and drop the ones below it, then shift it down to the top of a
+        // s16 plus the block shift. Arithmetic shift, so the result is sign extended.
+        const GSVector4i block_words =
+          (words.sll32(32 - BITS_PER_SAMPLE * (block + 1)) & sample_mask).sra32(static_cast<s32>(block_shifts[block]));
+        GSVector4i::storel<false>(&block_samples[block][word], block_words.ps32());
+      }
+    }
+
+    // The filter is serial within a sound unit. But stereo units alternate between left and right, and the two
+    // channels are independent, so each pair is filtered together to overlap the dependency chains.
+    for (u32 block = 0; block < NUM_BLOCKS; block += (IS_STEREO ? 2 : 1))
+    {
+      const u8 left_filter = BlockHeader{headers_ptr[block]}.GetFilter();
+      const s32 left_filter_pos = filter_table_pos[left_filter];
+      const s32 left_filter_neg = filter_table_neg[left_filter];
+      s32 left_prev0 = last_samples[0];
+      s32 left_prev1 = last_samples[1];
+
+      s16* out_samples_ptr = &samples[block * WORDS_PER_BLOCK];
+      if constexpr (IS_STEREO)
+      {
+        const u8 right_filter = BlockHeader{headers_ptr[block + 1]}.GetFilter();
+        const s32 right_filter_pos = filter_table_pos[right_filter];
+        const s32 right_filter_neg = filter_table_neg[right_filter];
+        s32 right_prev0 = last_samples[2];
+        s32 right_prev1 = last_samples[3];
+
+        for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+        {
+          out_samples_ptr[0] =
+            ApplyFilter(block_samples[block][word], left_prev0, left_prev1, left_filter_pos, left_filter_neg);
+          out_samples_ptr[1] = ApplyFilter(block_samples[block + 1][word], right_prev0, right_prev1,
+                                                  right_filter_pos, right_filter_neg);
+          out_samples_ptr += 2;
+        }
+
+        last_samples[2] = right_prev0;
+        last_samples[3] = right_prev1;
+      }
+      else
+      {
+        for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+        {
+          *(out_samples_ptr++) =
+            ApplyFilter(block_samples[block][word], left_prev0, left_prev1, left_filter_pos, left_filter_neg);
+        }
+      }
+
+      last_samples[0] = left_prev0;
+      last_samples[1] = left_prev1;
+    }
+
+    samples += SAMPLES_PER_CHUNK;
+    chunk_ptr += CHUNK_SIZE_IN_BYTES;
+  }
+}
+
+template<bool STEREO>
+u32 XAADPCM::Resample(const s16* frames_in, u32 num_frames_in, ResamplerState& state, u32* frames_out)
+{
+  static constexpr std::array<std::array<s16, 29>, 7> tables = {
+    {{0,      0x0,     0x0,     0x0,    0x0,     -0x0002, 0x000A,  -0x0022, 0x0041, -0x0054,
+      0x0034, 0x0009,  -0x010A, 0x0400, -0x0A78, 0x234C,  0x6794,  -0x1780, 0x0BCD, -0x0623,
+      0x0350, -0x016D, 0x006B,  0x000A, -0x0010, 0x0011,  -0x0008, 0x0003,  -0x0001},
+     {0,       0x0,    0x0,     -0x0002, 0x0,    0x0003,  -0x0013, 0x003C,  -0x004B, 0x00A2,
+      -0x00E3, 0x0132, -0x0043, -0x0267, 0x0C9D, 0x74BB,  -0x11B4, 0x09B8,  -0x05BF, 0x0372,
+      -0x01A8, 0x00A6, -0x001B, 0x0005,  0x0006, -0x0008, 0x0003,  -0x0001, 0x0},
+     {0,      0x0,     -0x0001, 0x0003,  -0x0002, -0x0005, 0x001F,  -0x004A, 0x00B3, -0x0192,
+      0x02B1, -0x039E, 0x04F8,  -0x05A6, 0x7939,  -0x05A6, 0x04F8,  -0x039E, 0x02B1, -0x0192,
+      0x00B3, -0x004A, 0x001F,  -0x0005, -0x0002, 0x0003,  -0x0001, 0x0,     0x0},
+     {0,       -0x0001, 0x0003,  -0x0008, 0x0006, 0x0005,  -0x001B, 0x00A6, -0x01A8, 0x0372,
+      -0x05BF, 0x09B8,  -0x11B4, 0x74BB,  0x0C9D, -0x0267, -0x0043, 0x0132, -0x00E3, 0x00A2,
+      -0x004B, 0x003C,  -0x0013, 0x0003,  0x0,    -0x0002, 0x0,     0x0,    0x0},
+     {-0x0001, 0x0003,  -0x0008, 0x0011,  -0x0010, 0x000A, 0x006B,  -0x016D, 0x0350, -0x0623,
+      0x0BCD,  -0x1780, 0x6794,  0x234C,  -0x0A78, 0x0400, -0x010A, 0x0009,  0x0034, -0x0054,
+      0x0041,  -0x0022, 0x000A,  -0x0001, 0x0,     0x0001, 0x0,     0x0,     0x0},
+     {0x0002,  -0x0008, 0x0010,  -0x0023, 0x002B, 0x001A,  -0x00EB, 0x027B,  -0x0548, 0x0AFA,
+      -0x16FA, 0x53E0,  0x3C07,  -0x1249, 0x080E, -0x0347, 0x015B,  -0x0044, -0x0017, 0x0046,
+      -0x0023, 0x0011,  -0x0005, 0x0,     0x0,    0x0,     0x0,     0x0,     0x0},
+     {-0x0005, 0x0011,  -0x0023, 0x0046, -0x0017, -0x0044, 0x015B,  -0x0347, 0x080E, -0x1249,
+      0x3C07,  0x53E0,  -0x16FA, 0x0AFA, -0x0548, 0x027B,  -0x00EB, 0x001A,  0x002B, -0x0023,
+      0x0010,  -0x0008, 0x0002,  0x0,    0x0,     0x0,     0x0,     0x0,     0x0}}};
+
+  // Tables are reversed so the taps line up with the oldest sample first, and padded to a whole number of vectors.
+  alignas(VECTOR_ALIGNMENT) static constexpr std::array<std::array<s16, RESAMPLE_RING_BUFFER_SIZE>,
+                                                        NUM_ZIGZAG_TABLES> reversed_tables = []() {
+    std::array<std::array<s16, RESAMPLE_RING_BUFFER_SIZE>, NUM_ZIGZAG_TABLES> ret = {};
+    for (u32 i = 0; i < NUM_ZIGZAG_TABLES; i++)
+    {
+      for (u32 j = 0; j < ZIGZAG_TABLE_SIZE; j++)
+        ret[i][ZIGZAG_TABLE_SIZE - 1 - j] = tables[i][j];
+    }
+    return ret;
+  }();
+
+  static constexpr auto zigzag_interpolate = [](const s16* ringbuf, u32 table_index, u32 p) -> s16 {
+    // Each product is shifted individually, so they can't be accumulated in pairs.
+    const s16* samples = &ringbuf[(p - (ZIGZAG_TABLE_SIZE - 1)) % RESAMPLE_RING_BUFFER_SIZE];
+    const s16* table = reversed_tables[table_index].data();
+    GSVector4i sum = GSVector4i::zero();
+    for (u32 i = 0; i < RESAMPLE_RING_BUFFER_SIZE; i += 8)
+    {
+      const GSVector4i s = GSVector4i::load<false>(&samples[i]);
+      const GSVector4i t = GSVector4i::load<true>(&table[i]);
+      const GSVector4i lo = s.mul16l(t);
+      const GSVector4i hi = s.mul16hs(t);
+      sum = sum.add32(lo.upl16(hi).sra32<15>()).add32(lo.uph16(hi).sra32<15>());
+    }
+
+    return static_cast<s16>(std::clamp<s32>(sum.addv_s32(), -0x8000, 0x7FFF));
+  };
+
+  // The ring buffer is mirrored while resampling, so that the taps never have to wrap around.
+  alignas(VECTOR_ALIGNMENT) std::array<std::array<s16, RESAMPLE_RING_BUFFER_SIZE * 2>, 2> ringbufs;
+  for (u32 i = 0; i < (STEREO ? 2 : 1); i++)
+  {
+    std::memcpy(&ringbufs[i][0], state.ring_buffer[i].data(), sizeof(state.ring_buffer[i]));
+    std::memcpy(&ringbufs[i][RESAMPLE_RING_BUFFER_SIZE], state.ring_buffer[i].data(),
+                sizeof(state.ring_buffer[i]));
+  }
+
+  s16* const left_ringbuf = ringbufs[0].data();
+  [[maybe_unused]] s16* const right_ringbuf = ringbufs[1].data();
+  u32* const frames_out_start = frames_out;
+  u32 p = state.p;
+  u32 sixstep = state.sixstep;
+
+  for (u32 in_sample_index = 0; in_sample_index < num_frames_in; in_sample_index++)
+  {
+    left_ringbuf[p] = left_ringbuf[p + RESAMPLE_RING_BUFFER_SIZE] = *(frames_in++);
+    if constexpr (STEREO)
+      right_ringbuf[p] = right_ringbuf[p + RESAMPLE_RING_BUFFER_SIZE] = *(frames_in++);
+    p = (p + 1) % RESAMPLE_RING_BUFFER_SIZE;
+    sixstep--;
+
+    if (sixstep == 0)
+    {
+      sixstep = 6;
+      for (u32 j = 0; j < NUM_ZIGZAG_TABLES; j++)
+      {
+        const s16 left_interp = zigzag_interpolate(left_ringbuf, j, p);
+        const s16 right_interp = STEREO ? zigzag_interpolate(right_ringbuf, j, p) : left_interp;
+        *(frames_out++) = PackFrame(left_interp, right_interp);
+      }
+    }
+  }
+
+  for (u32 i = 0; i < (STEREO ? 2 : 1); i++)
+    std::memcpy(state.ring_buffer[i].data(), &ringbufs[i][0], sizeof(state.ring_buffer[i]));
+
+  state.p = Truncate8(p);
+  state.sixstep = Truncate8(sixstep);
+  return static_cast<u32>(frames_out - frames_out_start);
+}
+
+template<bool STEREO>
+u32 XAADPCM::Resample18900(const s16* frames_in, u32 num_frames_in, ResamplerState& state, u32* frames_out)
+{
+  // Weights originally from Mednafen's interpolator. It's unclear where these came from, perhaps it was calculated
+  // somehow. This doesn't appear to use a zigzag pattern like psx-spx suggests, therefore it is restricted to only
+  // 18900hz resampling. Duplicating the 18900hz samples to 37800hz sounds even more awful than lower sample rate audio
+  // should, with a big spike at ~16KHz, especially with music in FMVs. Fortunately, few games actually use 18900hz XA.
+  static constexpr std::array<std::array<s16, 25>, 7> tables = {{
+    {{0x0,     -0x5,  0x11,   -0x23, 0x46,  -0x17, -0x44, 0x15b, -0x347, 0x80e, -0x1249, 0x3c07, 0x53e0,
+      -0x16fa, 0xafa, -0x548, 0x27b, -0xeb, 0x1a,  0x2b,  -0x23, 0x10,   -0x8,  0x2,     0x0}},
+    {{0x0,     -0x2,  0xa,    -0x22, 0x41,   -0x54, 0x34, 0x9,   -0x10a, 0x400, -0xa78, 0x234c, 0x6794,
+      -0x1780, 0xbcd, -0x623, 0x350, -0x16d, 0x6b,  0xa,  -0x10, 0x11,   -0x8,  0x3,    -0x1}},
+    {{-0x2,    0x0,   0x3,    -0x13, 0x3c,   -0x4b, 0xa2,  -0xe3, 0x132, -0x43, -0x267, 0xc9d, 0x74bb,
+      -0x11b4, 0x9b8, -0x5bf, 0x372, -0x1a8, 0xa6,  -0x1b, 0x5,   0x6,   -0x8,  0x3,    -0x1}},
+    {{-0x1,   0x3,   -0x2,   -0x5,  0x1f,   -0x4a, 0xb3,  -0x192, 0x2b1, -0x39e, 0x4f8, -0x5a6, 0x7939,
+      -0x5a6, 0x4f8, -0x39e, 0x2b1, -0x192, 0xb3,  -0x4a, 0x1f,   -0x5,  -0x2,   0x3,   -0x1}},
+    {{-0x1,  0x3,    -0x8,  0x6,   0x5,   -0x1b, 0xa6,  -0x1a8, 0x372, -0x5bf, 0x9b8, -0x11b4, 0x74bb,
+      0xc9d, -0x267, -0x43, 0x132, -0xe3, 0xa2,  -0x4b, 0x3c,   -0x13, 0x3,    0x0,   -0x2}},
+    {{-0x1,   0x3,    -0x8,  0x11,   -0x10, 0xa,  0x6b,  -0x16d, 0x350, -0x623, 0xbcd, -0x1780, 0x6794,
+      0x234c, -0xa78, 0x400, -0x10a, 0x9,   0x34, -0x54, 0x41,   -0x22, 0xa,    -0x2,  0x0}},
+    {{0x0,    0x2,     -0x8,  0x10,   -0x23, 0x2b,  0x1a,  -0xeb, 0x27b, -0x548, 0xafa, -0x16fa, 0x53e0,
+      0x3c07, -0x1249, 0x80e, -0x347, 0x15b, -0x44, -0x17, 0x46,  -0x23, 0x11,   -0x5,  0x0}},
+  }};
+
+  // Padded to a whole number of vectors.
+  alignas(VECTOR_ALIGNMENT) static constexpr std::array<std::array<s16, RESAMPLE_RING_BUFFER_SIZE>, 7>
+    padded_tables = []() {
+      std::array<std::array<s16, RESAMPLE_RING_BUFFER_SIZE>, 7> ret = {};
+      for (u32 i = 0; i < tables.size(); i++)
+        std::copy(tables[i].begin(), tables[i].end(), ret[i].begin());
+      return ret;
+    }();
+
+  static constexpr auto interpolate = [](const s16* ringbuf, u32 table_index, u32 p) -> s16 {
+    // Products are summed before shifting, so pairs can be accumulated together.
+    const s16* samples = &ringbuf[(p + RESAMPLE_RING_BUFFER_SIZE - 25) % RESAMPLE_RING_BUFFER_SIZE];
+    const s16* table = padded_tables[table_index].data();
+    GSVector4i sum = GSVector4i::zero();
+    for (u32 i = 0; i < RESAMPLE_RING_BUFFER_SIZE; i += 8)
+      sum = sum.add32(GSVector4i::load<false>(&samples[i]).madd_s16(GSVector4i::load<true>(&table[i])));
+
+    return static_cast<s16>(std::clamp<s32>(sum.addv_s32() >> 15, -0x8000, 0x7FFF));
+  };
+
+  // The ring buffer is mirrored while resampling, so that the taps never have to wrap around.
+  alignas(VECTOR_ALIGNMENT) std::array<std::array<s16, RESAMPLE_RING_BUFFER_SIZE * 2>, 2> ringbufs;
+  for (u32 i = 0; i < (STEREO ? 2 : 1); i++)
+  {
+    std::memcpy(&ringbufs[i][0], state.ring_buffer[i].data(), sizeof(state.ring_buffer[i]));
+    std::memcpy(&ringbufs[i][RESAMPLE_RING_BUFFER_SIZE], state.ring_buffer[i].data(),
+                sizeof(state.ring_buffer[i]));
+  }
+
+  s16* const left_ringbuf = ringbufs[0].data();
+  [[maybe_unused]] s16* const right_ringbuf = ringbufs[1].data();
+  u32* const frames_out_start = frames_out;
+  u32 p = state.p;
+  u32 sixstep = state.sixstep;
+
+  for (u32 in_sample_index = 0; in_sample_index < num_frames_in;)
+  {
+    if (sixstep >= 7)
+    {
+      sixstep -= 7;
+      p = (p + 1) % RESAMPLE_RING_BUFFER_SIZE;
+
+      left_ringbuf[p] = left_ringbuf[p + RESAMPLE_RING_BUFFER_SIZE] = *(frames_in++);
+      if constexpr (STEREO)
+        right_ringbuf[p] = right_ringbuf[p + RESAMPLE_RING_BUFFER_SIZE] = *(frames_in++);
+
+      in_sample_index++;
+    }
+
+    const s16 left_interp = interpolate(left_ringbuf, sixstep, p);
+    const s16 right_interp = STEREO ? interpolate(right_ringbuf, sixstep, p) : left_interp;
+    *(frames_out++) = PackFrame(left_interp, right_interp);
+    sixstep += 3;
+  }
+
+  for (u32 i = 0; i < (STEREO ? 2 : 1); i++)
+    std::memcpy(state.ring_buffer[i].data(), &ringbufs[i][0], sizeof(state.ring_buffer[i]));
+
+  state.p = Truncate8(p);
+  state.sixstep = Truncate8(sixstep);
+  return static_cast<u32>(frames_out - frames_out_start);
+}
+
+template void XAADPCM::DecodeChunks<false, false>(const u8* chunk_ptr, s16* samples, LastSamples& last_samples);
+template void XAADPCM::DecodeChunks<false, true>(const u8* chunk_ptr, s16* samples, LastSamples& last_samples);
+template void XAADPCM::DecodeChunks<true, false>(const u8* chunk_ptr, s16* samples, LastSamples& last_samples);
+template void XAADPCM::DecodeChunks<true, true>(const u8* chunk_ptr, s16* samples, LastSamples& last_samples);
+template u32 XAADPCM::Resample<false>(const s16* frames_in, u32 num_frames_in, ResamplerState& state, u32* frames_out);
+template u32 XAADPCM::Resample<true>(const s16* frames_in, u32 num_frames_in, ResamplerState& state, u32* frames_out);
+template u32 XAADPCM::Resample18900<false>(const s16* frames_in, u32 num_frames_in, ResamplerState& state,
+                                           u32* frames_out);
+template u32 XAADPCM::Resample18900<true>(const s16* frames_in, u32 num_frames_in, ResamplerState& state,
+                                          u32* frames_out);
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#pragma once
+
+#include "common/bitutils.h"
+#include "common/types.h"
+
+#include <array>
+
+/// XA-ADPCM decoding and resampling to 44100hz, used by the CD-ROM controller for audio sectors.
+namespace XAADPCM {
+
+static constexpr u32 SAMPLES_PER_SECTOR_4BIT = 4032; // 28 words * 8 nibbles per word * 18 chunks
+static constexpr u32 SAMPLES_PER_SECTOR_8BIT = 2016; // 28 words * 4 bytes per word * 18 chunks
+static constexpr u32 RESAMPLE_RING_BUFFER_SIZE = 32;
+
+/// Upper bound on the frames produced by resampling one sector, 18900hz mono makes 7 frames for every 3 input.
+static constexpr u32 MAX_RESAMPLED_FRAMES_PER_SECTOR = SAMPLES_PER_SECTOR_4BIT * 7 / 3 + 8;
+
+/// Previous two samples of each channel, left first, carried between sectors by the prediction filter.
+using LastSamples = std::array<s32, 4>;
+
+/// Resampler history, carried between sectors.
+struct ResamplerState
+{
+  std::array<std::array<s16, RESAMPLE_RING_BUFFER_SIZE>, 2> ring_buffer;
+  u8 p;
+  u8 sixstep;
+
+  void Reset();
+};
+
+/// Decodes the XA-ADPCM samples in an audio sector. Stereo samples are interleaved with left first.
+template<bool IS_STEREO, bool IS_8BIT>
+void DecodeChunks(const u8* chunk_ptr, s16* samples, LastSamples& last_samples);
+
+/// Resamples 37800hz samples to 44100hz frames, packed with left in the low 16 bits. Returns the frame count.
+template<bool STEREO>
+u32 Resample(const s16* frames_in, u32 num_frames_in, ResamplerState& state, u32* frames_out);
+
+/// Resamples 18900hz samples to 44100hz frames, packed with left in the low 16 bits. Returns the frame count.
+template<bool STEREO>
+u32 Resample18900(const s16* frames_in, u32 num_frames_in, ResamplerState& state, u32* frames_out);
+
+/// Packs a frame the same way as the CD audio FIFO.
+ALWAYS_INLINE static u32 PackFrame(s16 left, s16 right)
+{
+  return ZeroExtend32(static_cast<u16>(left)) | (ZeroExtend32(static_cast<u16>(right)) << 16);
+}
+
+} // namespace XAADPCM
@@ -1203,7 +1203,7 @@ bool FullscreenUI::UserThemeableHorizontalButton(const std::string_view png_name
 ImGuiFullscreen::FileSelectorFilters FullscreenUI::GetDiscImageFilters()
 {
   return {"*.bin",   "*.cue",    "*.iso", "*.img", "*.chd", "*.ecm",     "*.mds", "*.cpe", "*.elf",
-          "*.psexe", "*.ps-exe", "*.exe", "*.psx", "*.psf", "*.minipsf", "*.m3u", "*.pbp"};
+          "*.psexe", "*.ps-exe", "*.exe", "*.psx", "*.psf", "*.minipsf", "*.m3u", "*.pbp", "*.zcd"};
 }
 
 ImGuiFullscreen::FileSelectorFilters FullscreenUI::GetImageFilters()
@@ -4174,10 +4174,22 @@ void FullscreenUI::DrawConsoleSettingsPage()
     bsi, FSUI_ICONSTR(ICON_FA_DOWNLOAD, "Preload Images to RAM"),
     FSUI_CSTR("Loads the game image into RAM. Useful for network paths that may become unreliable during gameplay."),
     "CDROM", "LoadImageToRAM", false);
+  DrawToggleSetting(
+    bsi, FSUI_ICONSTR(ICON_FA_COMPRESS, "Compress Preloaded Images"),
+    FSUI_CSTR("Compresses images preloaded to RAM, reducing memory usage at the cost of some CPU time when reading."),
+    "CDROM", "CompressImageInRAM", false, GetEffectiveBoolSetting(bsi, "CDROM", "LoadImageToRAM", false));
+  DrawToggleSetting(
+    bsi, FSUI_ICONSTR(ICON_FA_SHARE_ALT, "Share Preloaded Images"),
+    FSUI_CSTR("Shares images preloaded to RAM with other running instances, so each image is only stored once."),
+    "CDROM", "ShareImageInRAM", false, GetEffectiveBoolSetting(bsi, "CDROM", "LoadImageToRAM", false));
   DrawToggleSetting(
     bsi, FSUI_ICONSTR(ICON_FA_VEST_PATCHES, "Apply Image Patches"),
     FSUI_CSTR("Automatically applies patches to disc images when they are present, currently only PPF is supported."),
     "CDROM", "LoadImagePatches", false);
+  DrawToggleSetting(bsi, FSUI_ICONSTR(ICON_FA_HISTORY, "Learn Disc Access Patterns"),
+                    FSUI_CSTR("Records the order games read the disc in, and uses it to prefetch sectors on later "
+                              "boots. Reduces load stutter with compressed images. Requires asynchronous readahead."),
+                    "CDROM", "AccessTracePrefetch", false);
 
   EndMenuButtons();
 }
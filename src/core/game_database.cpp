@@ -10,22 +10,27 @@
 #include "util/imgui_manager.h"
 
 #include "common/assert.h"
-#include "common/binary_reader_writer.h"
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/heterogeneous_containers.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 #include "common/ryml_helpers.h"
 #include "common/string_util.h"
 #include "common/timer.h"
 
 #include "ryml.hpp"
+#include "xxhash.h"
 
+#include <algorithm>
 #include <bit>
+#include <cstring>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <type_traits>
 
@@ -40,15 +45,124 @@ namespace GameDatabase {
 enum : u32
 {
   GAME_DATABASE_CACHE_SIGNATURE = 0x45434C48,
-  GAME_DATABASE_CACHE_VERSION = 21,
+  GAME_DATABASE_CACHE_VERSION = 22,
+
+  // Hash-and-displace parameters. Average of four codes per bucket, ~90% slot load.
+  CACHE_CODES_PER_BUCKET = 4,
+  CACHE_MAX_DISPLACEMENT = 1u << 20,
 };
 
+namespace {
+
+// The cache is used in-place, either memory-mapped or from the buffer it was just built into, so all structures
+// are fixed-size and reference strings by offset into the string pool.
+struct CacheString
+{
+  u32 offset;
+  u32 length;
+};
+
+struct CacheHeader
+{
+  u32 signature;
+  u32 version;
+  u64 gamedb_timestamp;
+  u32 total_size;
+  u32 num_entries;
+  u32 num_codes;
+  u32 num_buckets;
+  u32 num_slots;
+  u32 num_disc_set_serials;
+  u32 entries_offset;
+  u32 disc_set_serials_offset;
+  u32 buckets_offset;
+  u32 slots_offset;
+  u32 strings_offset;
+  u32 strings_size;
+};
+static_assert(sizeof(CacheHeader) == 64);
+
+enum CacheOptionalField : u16
+{
+  CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET = (1 << 0),
+  CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET = (1 << 1),
+  CACHE_HAS_DISPLAY_LINE_START_OFFSET = (1 << 2),
+  CACHE_HAS_DISPLAY_LINE_END_OFFSET = (1 << 3),
+  CACHE_HAS_DISPLAY_CROP_MODE = (1 << 4),
+  CACHE_HAS_DISPLAY_DEINTERLACING_MODE = (1 << 5),
+  CACHE_HAS_GPU_LINE_DETECT_MODE = (1 << 6),
+  CACHE_HAS_DMA_MAX_SLICE_TICKS = (1 << 7),
+  CACHE_HAS_DMA_HALT_TICKS = (1 << 8),
+  CACHE_HAS_GPU_FIFO_SIZE = (1 << 9),
+  CACHE_HAS_GPU_MAX_RUN_AHEAD = (1 << 10),
+  CACHE_HAS_GPU_PGXP_TOLERANCE = (1 << 11),
+  CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD = (1 << 12),
+  CACHE_HAS_GPU_PGXP_PRESERVE_PROJ_FP = (1 << 13),
+};
+
+struct CacheEntry
+{
+  CacheString serial;
+  CacheString title;
+  CacheString genre;
+  CacheString developer;
+  CacheString publisher;
+  CacheString compatibility_version_tested;
+  CacheString compatibility_comments;
+  CacheString disc_set_name;
+  u64 release_date;
+  u32 traits;
+  u32 languages;
+  u32 disc_set_serials_start;
+  u32 disc_set_serials_count;
+  u32 dma_max_slice_ticks;
+  u32 dma_halt_ticks;
+  u32 gpu_fifo_size;
+  u32 gpu_max_run_ahead;
+  float gpu_pgxp_tolerance;
+  float gpu_pgxp_depth_threshold;
+  u16 optional_fields;
+  u16 supported_controllers;
+  s16 display_active_start_offset;
+  s16 display_active_end_offset;
+  s8 display_line_start_offset;
+  s8 display_line_end_offset;
+  u8 display_crop_mode;
+  u8 display_deinterlacing_mode;
+  u8 gpu_line_detect_mode;
+  u8 gpu_pgxp_preserve_proj_fp;
+  u8 compatibility;
+  u8 min_players;
+  u8 max_players;
+  u8 min_blocks;
+  u8 max_blocks;
+  u8 pad;
+};
+static_assert(sizeof(CacheEntry) == 136);
+static_assert(static_cast<u32>(Trait::MaxCount) <= 32 && static_cast<u32>(Language::MaxCount) <= 32,
+              "Traits/languages must fit in cache bitmasks");
+
+struct CacheCodeSlot
+{
+  CacheString code;
+  u32 entry_index;
+};
+
+} // namespace
+
 static const Entry* GetEntryForId(std::string_view code);
+static const Entry* GetEntryForIndex(u32 index);
 
+static u32 HashCacheCode(std::string_view code, u32 seed);
+static std::string_view GetCacheString(const CacheString& str);
+static const CacheEntry* GetCacheEntries();
+static bool ValidateCache(std::span<const u8> data, u64 gamedb_ts);
 static bool LoadFromCache();
-static bool SaveToCache();
+static bool BuildCache(const std::vector<Entry>& entries, const PreferUnorderedStringMap<u32>& code_lookup);
+static bool SaveToCache(std::span<const u8> data);
 
-static bool LoadGameDBYaml();
+static bool LoadGameDBYaml(std::vector<Entry>& entries, PreferUnorderedStringMap<u32>& code_lookup,
+                           DynamicHeapArray<u8>& gamedb_data);
 static bool ParseYamlEntry(Entry* entry, const ryml::ConstNodeRef& value);
 static bool ParseYamlCodes(PreferUnorderedStringMap<std::string_view>& lookup, const ryml::ConstNodeRef& value,
                            std::string_view serial);
@@ -145,9 +259,15 @@ static DisplayDeinterlacingMode DEFAULT_DEINTERLACING_MODE = DisplayDeinterlacin
 static bool s_loaded = false;
 static bool s_track_hashes_loaded = false;
 
-static DynamicHeapArray<u8> s_db_data; // we take strings from the data, so store a copy
-static std::vector<GameDatabase::Entry> s_entries;
-static PreferUnorderedStringMap<u32> s_code_lookup;
+// Backing for the cache, string_views in entries point into it.
+static MappedFile s_cache_file;
+static DynamicHeapArray<u8> s_cache_buffer;
+static std::span<const u8> s_cache_data;
+static const CacheHeader* s_cache_header = nullptr;
+
+// Entries are only constructed when they're looked up, most sessions only ever touch one or two.
+static std::mutex s_entries_mutex;
+static std::vector<std::unique_ptr<GameDatabase::Entry>> s_entries;
 
 static TrackHashesMap s_track_hashes_map;
 } // namespace GameDatabase
@@ -163,27 +283,30 @@ void GameDatabase::EnsureLoaded()
 
   if (!LoadFromCache())
   {
-    s_entries = {};
-    s_code_lookup = {};
-
-    if (LoadGameDBYaml())
-    {
-      SaveToCache();
-    }
-    else
+    std::vector<Entry> entries;
+    PreferUnorderedStringMap<u32> code_lookup;
+    DynamicHeapArray<u8> gamedb_data;
+    if (!LoadGameDBYaml(entries, code_lookup, gamedb_data) || !BuildCache(entries, code_lookup))
     {
-      s_entries = {};
-      s_code_lookup = {};
+      s_cache_buffer.deallocate();
+      s_cache_data = {};
+      s_cache_header = nullptr;
     }
   }
 
+  s_entries.resize(s_cache_header ? s_cache_header->num_entries : 0);
+
   INFO_LOG("Database load of {} entries took {:.0f}ms.", s_entries.size(), timer.GetTimeMilliseconds());
 }
 
 void GameDatabase::Unload()
 {
-  s_entries = {};
-  s_code_lookup = {};
+  s_entries.clear();
+  s_entries.shrink_to_fit();
+  s_cache_header = nullptr;
+  s_cache_data = {};
+  s_cache_buffer.deallocate();
+  s_cache_file.Close();
   s_loaded = false;
 }
 
@@ -193,9 +316,86 @@ const GameDatabase::Entry* GameDatabase::GetEntryForId(std::string_view code)
     return nullptr;
 
   EnsureLoaded();
+  if (!s_cache_header || s_cache_header->num_codes == 0)
+    return nullptr;
+
+  const u32* buckets = reinterpret_cast<const u32*>(s_cache_data.data() + s_cache_header->buckets_offset);
+  const CacheCodeSlot* slots = reinterpret_cast<const CacheCodeSlot*>(s_cache_data.data() + s_cache_header->slots_offset);
+
+  // zero displacement means an empty bucket
+  const u32 displacement = buckets[HashCacheCode(code, 0) % s_cache_header->num_buckets];
+  if (displacement == 0)
+    return nullptr;
 
-  auto iter = s_code_lookup.find(code);
-  return (iter != s_code_lookup.end()) ? &s_entries[iter->second] : nullptr;
+  // not a minimal hash, unknown codes can still land in an occupied slot
+  const CacheCodeSlot& slot = slots[HashCacheCode(code, displacement) % s_cache_header->num_slots];
+  if (slot.entry_index >= s_cache_header->num_entries || GetCacheString(slot.code) != code)
+    return nullptr;
+
+  return GetEntryForIndex(slot.entry_index);
+}
+
+const GameDatabase::Entry* GameDatabase::GetEntryForIndex(u32 index)
+{
+  std::unique_lock lock(s_entries_mutex);
+  std::unique_ptr<Entry>& entry = s_entries[index];
+  if (entry)
+    return entry.get();
+
+  const CacheEntry& ce = GetCacheEntries()[index];
+  entry = std::make_unique<Entry>();
+  entry->serial = GetCacheString(ce.serial);
+  entry->title = GetCacheString(ce.title);
+  entry->genre = GetCacheString(ce.genre);
+  entry->developer = GetCacheString(ce.developer);
+  entry->publisher = GetCacheString(ce.publisher);
+  entry->compatibility_version_tested = GetCacheString(ce.compatibility_version_tested);
+  entry->compatibility_comments = GetCacheString(ce.compatibility_comments);
+  entry->release_date = ce.release_date;
+  entry->min_players = ce.min_players;
+  entry->max_players = ce.max_players;
+  entry->min_blocks = ce.min_blocks;
+  entry->max_blocks = ce.max_blocks;
+  entry->supported_controllers = ce.supported_controllers;
+  entry->compatibility = static_cast<CompatibilityRating>(ce.compatibility);
+  entry->traits = decltype(entry->traits)(ce.traits);
+  entry->languages = decltype(entry->languages)(ce.languages);
+
+#define GET_OPTIONAL_FIELD(flag, field, type)                                                                          \
+  if (ce.optional_fields & flag)                                                                                       \
+    entry->field = static_cast<type>(ce.field);
+
+  GET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET, display_active_start_offset, s16);
+  GET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET, display_active_end_offset, s16);
+  GET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_LINE_START_OFFSET, display_line_start_offset, s8);
+  GET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_LINE_END_OFFSET, display_line_end_offset, s8);
+  GET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_CROP_MODE, display_crop_mode, DisplayCropMode);
+  GET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_DEINTERLACING_MODE, display_deinterlacing_mode, DisplayDeinterlacingMode);
+  GET_OPTIONAL_FIELD(CACHE_HAS_GPU_LINE_DETECT_MODE, gpu_line_detect_mode, GPULineDetectMode);
+  GET_OPTIONAL_FIELD(CACHE_HAS_DMA_MAX_SLICE_TICKS, dma_max_slice_ticks, u32);
+  GET_OPTIONAL_FIELD(CACHE_HAS_DMA_HALT_TICKS, dma_halt_ticks, u32);
+  GET_OPTIONAL_FIELD(CACHE_HAS_GPU_FIFO_SIZE, gpu_fifo_size, u32);
+  GET_OPTIONAL_FIELD(CACHE_HAS_GPU_MAX_RUN_AHEAD, gpu_max_run_ahead, u32);
+  GET_OPTIONAL_FIELD(CACHE_HAS_GPU_PGXP_TOLERANCE, gpu_pgxp_tolerance, float);
+  GET_OPTIONAL_FIELD(CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD, gpu_pgxp_depth_threshold, float);
+  GET_OPTIONAL_FIELD(CACHE_HAS_GPU_PGXP_PRESERVE_PROJ_FP, gpu_pgxp_preserve_proj_fp, bool);
+
+#undef GET_OPTIONAL_FIELD
+
+  entry->disc_set_name = GetCacheString(ce.disc_set_name);
+  if (ce.disc_set_serials_count > 0 &&
+      (static_cast<u64>(ce.disc_set_serials_start) + ce.disc_set_serials_count) <=
+        s_cache_header->num_disc_set_serials)
+  {
+    const CacheString* serials =
+      reinterpret_cast<const CacheString*>(s_cache_data.data() + s_cache_header->disc_set_serials_offset) +
+      ce.disc_set_serials_start;
+    entry->disc_set_serials.reserve(ce.disc_set_serials_count);
+    for (u32 i = 0; i < ce.disc_set_serials_count; i++)
+      entry->disc_set_serials.emplace_back(GetCacheString(serials[i]));
+  }
+
+  return entry.get();
 }
 
 std::string GameDatabase::GetSerialForDisc(CDImage* image)
@@ -261,11 +461,17 @@ const GameDatabase::Entry* GameDatabase::GetEntryForSerial(std::string_view seri
     return nullptr;
 
   EnsureLoaded();
+  if (!s_cache_header)
+    return nullptr;
 
-  const auto it =
-    std::lower_bound(s_entries.cbegin(), s_entries.cend(), serial,
-                     [](const Entry& entry, const std::string_view& search) { return (entry.serial < search); });
-  return (it != s_entries.end() && it->serial == serial) ? &(*it) : nullptr;
+  // entries are sorted by serial
+  const CacheEntry* begin = GetCacheEntries();
+  const CacheEntry* end = begin + s_cache_header->num_entries;
+  const CacheEntry* it = std::lower_bound(begin, end, serial, [](const CacheEntry& entry, std::string_view search) {
+    return (GetCacheString(entry.serial) < search);
+  });
+  return (it != end && GetCacheString(it->serial) == serial) ? GetEntryForIndex(static_cast<u32>(it - begin)) :
+                                                               nullptr;
 }
 
 const char* GameDatabase::GetTraitName(Trait trait)
@@ -901,220 +1107,293 @@ static std::string GetCacheFile()
   return Path::Combine(EmuFolders::Cache, "gamedb.cache");
 }
 
-bool GameDatabase::LoadFromCache()
+u32 GameDatabase::HashCacheCode(std::string_view code, u32 seed)
 {
-  Error error;
-  std::optional<DynamicHeapArray<u8>> db_data = FileSystem::ReadBinaryFile(GetCacheFile().c_str(), &error);
-  if (!db_data.has_value())
+  return XXH32(code.data(), code.size(), seed);
+}
+
+std::string_view GameDatabase::GetCacheString(const CacheString& str)
+{
+  if ((static_cast<u64>(str.offset) + str.length) > s_cache_header->strings_size) [[unlikely]]
+    return {};
+
+  return std::string_view(
+    reinterpret_cast<const char*>(s_cache_data.data() + s_cache_header->strings_offset + str.offset), str.length);
+}
+
+const GameDatabase::CacheEntry* GameDatabase::GetCacheEntries()
+{
+  return reinterpret_cast<const CacheEntry*>(s_cache_data.data() + s_cache_header->entries_offset);
+}
+
+bool GameDatabase::ValidateCache(std::span<const u8> data, u64 gamedb_ts)
+{
+  if (data.size() < sizeof(CacheHeader))
   {
-    DEV_LOG("Failed to read cache, loading full database: {}", error.GetDescription());
+    DEV_LOG("Cache is truncated.");
     return false;
   }
 
-  BinarySpanReader reader(db_data->cspan());
-  const u64 gamedb_ts = Host::GetResourceFileTimestamp("gamedb.yaml", false).value_or(0);
-
-  u32 signature, version, num_entries, num_codes;
-  u64 file_gamedb_ts;
-  if (!reader.ReadU32(&signature) || !reader.ReadU32(&version) || !reader.ReadU64(&file_gamedb_ts) ||
-      !reader.ReadU32(&num_entries) || !reader.ReadU32(&num_codes) || signature != GAME_DATABASE_CACHE_SIGNATURE ||
-      version != GAME_DATABASE_CACHE_VERSION)
+  const CacheHeader* hdr = reinterpret_cast<const CacheHeader*>(data.data());
+  if (hdr->signature != GAME_DATABASE_CACHE_SIGNATURE || hdr->version != GAME_DATABASE_CACHE_VERSION ||
+      hdr->total_size != data.size())
   {
     DEV_LOG("Cache header is corrupted or version mismatch.");
     return false;
   }
 
-  if (gamedb_ts != file_gamedb_ts)
+  if (hdr->gamedb_timestamp != gamedb_ts)
   {
     DEV_LOG("Cache is out of date, recreating.");
     return false;
   }
 
-  s_entries.reserve(num_entries);
-
-  for (u32 i = 0; i < num_entries; i++)
-  {
-    Entry& entry = s_entries.emplace_back();
-
-    constexpr u32 trait_num_bytes = (static_cast<u32>(Trait::MaxCount) + 7) / 8;
-    constexpr u32 language_num_bytes = (static_cast<u32>(Language::MaxCount) + 7) / 8;
-    std::array<u8, trait_num_bytes> trait_bits;
-    std::array<u8, language_num_bytes> language_bits;
-    u8 compatibility;
-    u32 num_disc_set_serials;
-
-    if (!reader.ReadSizePrefixedString(&entry.serial) || !reader.ReadSizePrefixedString(&entry.title) ||
-        !reader.ReadSizePrefixedString(&entry.genre) || !reader.ReadSizePrefixedString(&entry.developer) ||
-        !reader.ReadSizePrefixedString(&entry.publisher) ||
-        !reader.ReadSizePrefixedString(&entry.compatibility_version_tested) ||
-        !reader.ReadSizePrefixedString(&entry.compatibility_comments) || !reader.ReadU64(&entry.release_date) ||
-        !reader.ReadU8(&entry.min_players) || !reader.ReadU8(&entry.max_players) || !reader.ReadU8(&entry.min_blocks) ||
-        !reader.ReadU8(&entry.max_blocks) || !reader.ReadU16(&entry.supported_controllers) ||
-        !reader.ReadU8(&compatibility) || compatibility >= static_cast<u8>(GameDatabase::CompatibilityRating::Count) ||
-        !reader.Read(trait_bits.data(), trait_num_bytes) || !reader.Read(language_bits.data(), language_num_bytes) ||
-        !reader.ReadOptionalT(&entry.display_active_start_offset) ||
-        !reader.ReadOptionalT(&entry.display_active_end_offset) ||
-        !reader.ReadOptionalT(&entry.display_line_start_offset) ||
-        !reader.ReadOptionalT(&entry.display_line_end_offset) || !reader.ReadOptionalT(&entry.display_crop_mode) ||
-        !reader.ReadOptionalT(&entry.display_deinterlacing_mode) || !reader.ReadOptionalT(&entry.dma_max_slice_ticks) ||
-        !reader.ReadOptionalT(&entry.dma_halt_ticks) || !reader.ReadOptionalT(&entry.gpu_fifo_size) ||
-        !reader.ReadOptionalT(&entry.gpu_max_run_ahead) || !reader.ReadOptionalT(&entry.gpu_pgxp_tolerance) ||
-        !reader.ReadOptionalT(&entry.gpu_pgxp_depth_threshold) ||
-        !reader.ReadOptionalT(&entry.gpu_pgxp_preserve_proj_fp) || !reader.ReadOptionalT(&entry.gpu_line_detect_mode) ||
-        !reader.ReadSizePrefixedString(&entry.disc_set_name) || !reader.ReadU32(&num_disc_set_serials))
-    {
-      DEV_LOG("Cache entry is corrupted.");
-      return false;
-    }
-
-    if (num_disc_set_serials > 0)
-    {
-      entry.disc_set_serials.reserve(num_disc_set_serials);
-      for (u32 j = 0; j < num_disc_set_serials; j++)
-      {
-        if (!reader.ReadSizePrefixedString(&entry.disc_set_serials.emplace_back()))
-        {
-          DEV_LOG("Cache entry is corrupted.");
-          return false;
-        }
-      }
-    }
-
-    entry.compatibility = static_cast<GameDatabase::CompatibilityRating>(compatibility);
-    entry.traits.reset();
-    for (size_t j = 0; j < static_cast<size_t>(Trait::MaxCount); j++)
-    {
-      if ((trait_bits[j / 8] & (1u << (j % 8))) != 0)
-        entry.traits[j] = true;
-    }
-    for (size_t j = 0; j < static_cast<size_t>(Language::MaxCount); j++)
-    {
-      if ((language_bits[j / 8] & (1u << (j % 8))) != 0)
-        entry.languages[j] = true;
-    }
+  const auto check_range = [&data](u32 offset, u64 count, size_t element_size, size_t alignment) {
+    return ((offset % alignment) == 0 && (static_cast<u64>(offset) + count * element_size) <= data.size());
+  };
+  if (hdr->num_buckets == 0 || hdr->num_slots == 0 ||
+      !check_range(hdr->entries_offset, hdr->num_entries, sizeof(CacheEntry), alignof(CacheEntry)) ||
+      !check_range(hdr->disc_set_serials_offset, hdr->num_disc_set_serials, sizeof(CacheString),
+                   alignof(CacheString)) ||
+      !check_range(hdr->buckets_offset, hdr->num_buckets, sizeof(u32), alignof(u32)) ||
+      !check_range(hdr->slots_offset, hdr->num_slots, sizeof(CacheCodeSlot), alignof(CacheCodeSlot)) ||
+      !check_range(hdr->strings_offset, hdr->strings_size, sizeof(char), alignof(char)))
+  {
+    DEV_LOG("Cache layout is corrupted.");
+    return false;
   }
 
-  for (u32 i = 0; i < num_codes; i++)
-  {
-    std::string code;
-    u32 index;
-    if (!reader.ReadSizePrefixedString(&code) || !reader.ReadU32(&index) || index >= static_cast<u32>(s_entries.size()))
+  // Enums are used as table indices, so out-of-range values can't be allowed through.
+  const CacheEntry* entries = reinterpret_cast<const CacheEntry*>(data.data() + hdr->entries_offset);
+  for (u32 i = 0; i < hdr->num_entries; i++)
+  {
+    const CacheEntry& ce = entries[i];
+    if (ce.compatibility >= static_cast<u8>(CompatibilityRating::Count) ||
+        (static_cast<u64>(ce.traits) >> static_cast<u32>(Trait::MaxCount)) != 0 ||
+        (static_cast<u64>(ce.languages) >> static_cast<u32>(Language::MaxCount)) != 0 ||
+        ((ce.optional_fields & CACHE_HAS_DISPLAY_CROP_MODE) &&
+         ce.display_crop_mode >= static_cast<u8>(DisplayCropMode::MaxCount)) ||
+        ((ce.optional_fields & CACHE_HAS_DISPLAY_DEINTERLACING_MODE) &&
+         ce.display_deinterlacing_mode >= static_cast<u8>(DisplayDeinterlacingMode::Count)) ||
+        ((ce.optional_fields & CACHE_HAS_GPU_LINE_DETECT_MODE) &&
+         ce.gpu_line_detect_mode >= static_cast<u8>(GPULineDetectMode::Count)))
     {
-      DEV_LOG("Cache code entry is corrupted.");
+      DEV_LOG("Cache entry {} is corrupted.", i);
       return false;
     }
-
-    s_code_lookup.emplace(std::move(code), index);
   }
 
-  s_db_data = std::move(db_data.value());
   return true;
 }
 
-bool GameDatabase::SaveToCache()
+bool GameDatabase::LoadFromCache()
 {
-  const u64 gamedb_ts = Host::GetResourceFileTimestamp("gamedb.yaml", false).value_or(0);
-
   Error error;
-  FileSystem::AtomicRenamedFile file = FileSystem::CreateAtomicRenamedFile(GetCacheFile(), &error);
-  if (!file)
+  if (!s_cache_file.Open(GetCacheFile().c_str(), false, &error))
+  {
+    DEV_LOG("Failed to map cache, loading full database: {}", error.GetDescription());
+    return false;
+  }
+
+  const u64 gamedb_ts = Host::GetResourceFileTimestamp(GAMEDB_YAML_FILENAME, false).value_or(0);
+  if (!ValidateCache(s_cache_file.GetSpan(), gamedb_ts))
   {
-    ERROR_LOG("Failed to open cache file for writing: {}", error.GetDescription());
+    s_cache_file.Close();
     return false;
   }
 
-  BinaryFileWriter writer(file.get());
-  writer.WriteU32(GAME_DATABASE_CACHE_SIGNATURE);
-  writer.WriteU32(GAME_DATABASE_CACHE_VERSION);
-  writer.WriteU64(static_cast<u64>(gamedb_ts));
-
-  writer.WriteU32(static_cast<u32>(s_entries.size()));
-  writer.WriteU32(static_cast<u32>(s_code_lookup.size()));
-
-  for (const Entry& entry : s_entries)
-  {
-    writer.WriteSizePrefixedString(entry.serial);
-    writer.WriteSizePrefixedString(entry.title);
-    writer.WriteSizePrefixedString(entry.genre);
-    writer.WriteSizePrefixedString(entry.developer);
-    writer.WriteSizePrefixedString(entry.publisher);
-    writer.WriteSizePrefixedString(entry.compatibility_version_tested);
-    writer.WriteSizePrefixedString(entry.compatibility_comments);
-    writer.WriteU64(entry.release_date);
-    writer.WriteU8(entry.min_players);
-    writer.WriteU8(entry.max_players);
-    writer.WriteU8(entry.min_blocks);
-    writer.WriteU8(entry.max_blocks);
-    writer.WriteU16(entry.supported_controllers);
-    writer.WriteU8(static_cast<u8>(entry.compatibility));
-
-    constexpr u32 trait_num_bytes = (static_cast<u32>(Trait::MaxCount) + 7) / 8;
-    std::array<u8, trait_num_bytes> trait_bits = {};
-    for (size_t j = 0; j < static_cast<size_t>(Trait::MaxCount); j++)
+  s_cache_data = s_cache_file.GetSpan();
+  s_cache_header = reinterpret_cast<const CacheHeader*>(s_cache_data.data());
+  return true;
+}
+
+bool GameDatabase::BuildCache(const std::vector<Entry>& entries, const PreferUnorderedStringMap<u32>& code_lookup)
+{
+  std::string strings;
+  const auto add_string = [&strings](std::string_view str) {
+    const CacheString ret = {static_cast<u32>(strings.size()), static_cast<u32>(str.size())};
+    strings.append(str);
+    return ret;
+  };
+
+  std::vector<CacheEntry> cache_entries;
+  std::vector<CacheString> disc_set_serials;
+  cache_entries.reserve(entries.size());
+  for (const Entry& entry : entries)
+  {
+    CacheEntry& ce = cache_entries.emplace_back();
+    std::memset(&ce, 0, sizeof(ce));
+    ce.serial = add_string(entry.serial);
+    ce.title = add_string(entry.title);
+    ce.genre = add_string(entry.genre);
+    ce.developer = add_string(entry.developer);
+    ce.publisher = add_string(entry.publisher);
+    ce.compatibility_version_tested = add_string(entry.compatibility_version_tested);
+    ce.compatibility_comments = add_string(entry.compatibility_comments);
+    ce.disc_set_name = add_string(entry.disc_set_name);
+    ce.release_date = entry.release_date;
+    ce.traits = static_cast<u32>(entry.traits.to_ulong());
+    ce.languages = static_cast<u32>(entry.languages.to_ulong());
+    ce.disc_set_serials_start = static_cast<u32>(disc_set_serials.size());
+    ce.disc_set_serials_count = static_cast<u32>(entry.disc_set_serials.size());
+    for (const std::string& serial : entry.disc_set_serials)
+      disc_set_serials.push_back(add_string(serial));
+    ce.supported_controllers = entry.supported_controllers;
+    ce.compatibility = static_cast<u8>(entry.compatibility);
+    ce.min_players = entry.min_players;
+    ce.max_players = entry.max_players;
+    ce.min_blocks = entry.min_blocks;
+    ce.max_blocks = entry.max_blocks;
+
+#define SET_OPTIONAL_FIELD(flag, field, type)                                                                          \
+  if (entry.field.has_value())                                                                                         \
+  {                                                                                                                    \
+    ce.optional_fields |= flag;                                                                                        \
+    ce.field = static_cast<type>(entry.field.value());                                                                 \
+  }
+
+    SET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET, display_active_start_offset, s16);
+    SET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET, display_active_end_offset, s16);
+    SET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_LINE_START_OFFSET, display_line_start_offset, s8);
+    SET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_LINE_END_OFFSET, display_line_end_offset, s8);
+    SET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_CROP_MODE, display_crop_mode, u8);
+    SET_OPTIONAL_FIELD(CACHE_HAS_DISPLAY_DEINTERLACING_MODE, display_deinterlacing_mode, u8);
+    SET_OPTIONAL_FIELD(CACHE_HAS_GPU_LINE_DETECT_MODE, gpu_line_detect_mode, u8);
+    SET_OPTIONAL_FIELD(CACHE_HAS_DMA_MAX_SLICE_TICKS, dma_max_slice_ticks, u32);
+    SET_OPTIONAL_FIELD(CACHE_HAS_DMA_HALT_TICKS, dma_halt_ticks, u32);
+    SET_OPTIONAL_FIELD(CACHE_HAS_GPU_FIFO_SIZE, gpu_fifo_size, u32);
+    SET_OPTIONAL_FIELD(CACHE_HAS_GPU_MAX_RUN_AHEAD, gpu_max_run_ahead, u32);
+    SET_OPTIONAL_FIELD(CACHE_HAS_GPU_PGXP_TOLERANCE, gpu_pgxp_tolerance, float);
+    SET_OPTIONAL_FIELD(CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD, gpu_pgxp_depth_threshold, float);
+    SET_OPTIONAL_FIELD(CACHE_HAS_GPU_PGXP_PRESERVE_PROJ_FP, gpu_pgxp_preserve_proj_fp, u8);
+
+#undef SET_OPTIONAL_FIELD
+  }
+
+  // Hash and displace: codes are first split into buckets, then starting with the largest bucket, search for a
+  // displacement which places every code in the bucket into a free slot.
+  const u32 num_codes = static_cast<u32>(code_lookup.size());
+  const u32 num_buckets = std::max((num_codes + CACHE_CODES_PER_BUCKET - 1) / CACHE_CODES_PER_BUCKET, 1u);
+  const u32 num_slots = std::max(num_codes + (num_codes / 8), 1u);
+  std::vector<std::vector<std::pair<std::string_view, u32>>> bucket_codes(num_buckets);
+  for (const auto& [code, index] : code_lookup)
+    bucket_codes[HashCacheCode(code, 0) % num_buckets].emplace_back(code, index);
+
+  std::vector<u32> bucket_order(num_buckets);
+  for (u32 i = 0; i < num_buckets; i++)
+    bucket_order[i] = i;
+  std::stable_sort(bucket_order.begin(), bucket_order.end(), [&bucket_codes](u32 lhs, u32 rhs) {
+    return (bucket_codes[lhs].size() > bucket_codes[rhs].size());
+  });
+
+  static constexpr u32 EMPTY_SLOT = 0xFFFFFFFFu;
+  std::vector<u32> displacements(num_buckets, 0);
+  std::vector<CacheCodeSlot> slots(num_slots, CacheCodeSlot{{0, 0}, EMPTY_SLOT});
+  std::vector<u32> bucket_slots;
+  for (const u32 bucket : bucket_order)
+  {
+    const auto& codes = bucket_codes[bucket];
+    if (codes.empty())
+      break;
+
+    u32 displacement = 1;
+    for (; displacement < CACHE_MAX_DISPLACEMENT; displacement++)
     {
-      if (entry.traits[j])
-        trait_bits[j / 8] |= (1u << (j % 8));
-    }
+      bucket_slots.clear();
+      for (const auto& [code, index] : codes)
+      {
+        const u32 slot = HashCacheCode(code, displacement) % num_slots;
+        if (slots[slot].entry_index != EMPTY_SLOT ||
+            std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end())
+        {
+          break;
+        }
 
-    writer.Write(trait_bits.data(), trait_num_bytes);
+        bucket_slots.push_back(slot);
+      }
+
+      if (bucket_slots.size() == codes.size())
+        break;
+    }
 
-    constexpr u32 language_num_bytes = (static_cast<u32>(Language::MaxCount) + 7) / 8;
-    std::array<u8, language_num_bytes> language_bits = {};
-    for (size_t j = 0; j < static_cast<size_t>(Language::MaxCount); j++)
+    if (displacement == CACHE_MAX_DISPLACEMENT)
     {
-      if (entry.languages[j])
-        language_bits[j / 8] |= (1u << (j % 8));
+      ERROR_LOG("Failed to find displacement for code bucket {}", bucket);
+      return false;
     }
-    writer.Write(language_bits.data(), language_num_bytes);
-
-    writer.WriteOptionalT(entry.display_active_start_offset);
-    writer.WriteOptionalT(entry.display_active_end_offset);
-    writer.WriteOptionalT(entry.display_line_start_offset);
-    writer.WriteOptionalT(entry.display_line_end_offset);
-    writer.WriteOptionalT(entry.display_crop_mode);
-    writer.WriteOptionalT(entry.display_deinterlacing_mode);
-    writer.WriteOptionalT(entry.dma_max_slice_ticks);
-    writer.WriteOptionalT(entry.dma_halt_ticks);
-    writer.WriteOptionalT(entry.gpu_fifo_size);
-    writer.WriteOptionalT(entry.gpu_max_run_ahead);
-    writer.WriteOptionalT(entry.gpu_pgxp_tolerance);
-    writer.WriteOptionalT(entry.gpu_pgxp_depth_threshold);
-    writer.WriteOptionalT(entry.gpu_pgxp_preserve_proj_fp);
-    writer.WriteOptionalT(entry.gpu_line_detect_mode);
-
-    writer.WriteSizePrefixedString(entry.disc_set_name);
-    writer.WriteU32(static_cast<u32>(entry.disc_set_serials.size()));
-    for (const std::string& serial : entry.disc_set_serials)
-      writer.WriteSizePrefixedString(serial);
-  }
 
-  for (const auto& it : s_code_lookup)
+    displacements[bucket] = displacement;
+    for (size_t i = 0; i < codes.size(); i++)
+      slots[bucket_slots[i]] = CacheCodeSlot{add_string(codes[i].first), codes[i].second};
+  }
+
+  CacheHeader hdr = {};
+  hdr.signature = GAME_DATABASE_CACHE_SIGNATURE;
+  hdr.version = GAME_DATABASE_CACHE_VERSION;
+  hdr.gamedb_timestamp = Host::GetResourceFileTimestamp(GAMEDB_YAML_FILENAME, false).value_or(0);
+  hdr.num_entries = static_cast<u32>(cache_entries.size());
+  hdr.num_codes = num_codes;
+  hdr.num_buckets = num_buckets;
+  hdr.num_slots = num_slots;
+  hdr.num_disc_set_serials = static_cast<u32>(disc_set_serials.size());
+  hdr.entries_offset = sizeof(CacheHeader);
+  hdr.disc_set_serials_offset = hdr.entries_offset + hdr.num_entries * sizeof(CacheEntry);
+  hdr.buckets_offset = hdr.disc_set_serials_offset + hdr.num_disc_set_serials * sizeof(CacheString);
+  hdr.slots_offset = hdr.buckets_offset + hdr.num_buckets * sizeof(u32);
+  hdr.strings_offset = hdr.slots_offset + hdr.num_slots * sizeof(CacheCodeSlot);
+  hdr.strings_size = static_cast<u32>(strings.size());
+  hdr.total_size = hdr.strings_offset + hdr.strings_size;
+
+  s_cache_buffer.resize(hdr.total_size);
+  u8* ptr = s_cache_buffer.data();
+  std::memcpy(ptr, &hdr, sizeof(hdr));
+  std::memcpy(ptr + hdr.entries_offset, cache_entries.data(), cache_entries.size() * sizeof(CacheEntry));
+  std::memcpy(ptr + hdr.disc_set_serials_offset, disc_set_serials.data(), disc_set_serials.size() * sizeof(CacheString));
+  std::memcpy(ptr + hdr.buckets_offset, displacements.data(), displacements.size() * sizeof(u32));
+  std::memcpy(ptr + hdr.slots_offset, slots.data(), slots.size() * sizeof(CacheCodeSlot));
+  std::memcpy(ptr + hdr.strings_offset, strings.data(), strings.size());
+
+  s_cache_data = s_cache_buffer.cspan();
+  s_cache_header = reinterpret_cast<const CacheHeader*>(s_cache_data.data());
+
+  SaveToCache(s_cache_data);
+  return true;
+}
+
+bool GameDatabase::SaveToCache(std::span<const u8> data)
+{
+  Error error;
+  if (!FileSystem::WriteAtomicRenamedFile(GetCacheFile(), data, &error))
   {
-    writer.WriteSizePrefixedString(it.first);
-    writer.WriteU32(it.second);
+    ERROR_LOG("Failed to write cache file: {}", error.GetDescription());
+    return false;
   }
 
   return true;
 }
 
-bool GameDatabase::LoadGameDBYaml()
+bool GameDatabase::LoadGameDBYaml(std::vector<Entry>& entries, PreferUnorderedStringMap<u32>& code_lookup,
+                                  DynamicHeapArray<u8>& gamedb_data)
 {
   Error error;
-  std::optional<DynamicHeapArray<u8>> gamedb_data = Host::ReadResourceFile(GAMEDB_YAML_FILENAME, false, &error);
-  if (!gamedb_data.has_value())
+  std::optional<DynamicHeapArray<u8>> gamedb_file_data = Host::ReadResourceFile(GAMEDB_YAML_FILENAME, false, &error);
+  if (!gamedb_file_data.has_value())
   {
     ERROR_LOG("Failed to read game database: {}", error.GetDescription());
     return false;
   }
 
+  // entries reference strings in the data, so the caller needs to keep it around
+  gamedb_data = std::move(gamedb_file_data.value());
+
   SetRymlCallbacks();
 
-  const ryml::Tree tree = ryml::parse_in_place(
-    to_csubstr(GAMEDB_YAML_FILENAME), c4::substr(reinterpret_cast<char*>(gamedb_data->data()), gamedb_data->size()));
+  const ryml::Tree tree = ryml::parse_in_place(to_csubstr(GAMEDB_YAML_FILENAME),
+                                               c4::substr(reinterpret_cast<char*>(gamedb_data.data()), gamedb_data.size()));
   const ryml::ConstNodeRef root = tree.rootref();
-  s_entries.reserve(root.num_children());
+  entries.reserve(root.num_children());
 
-  PreferUnorderedStringMap<std::string_view> code_lookup;
+  PreferUnorderedStringMap<std::string_view> code_serial_lookup;
 
   for (const ryml::ConstNodeRef& current : root.cchildren())
   {
@@ -1125,46 +1404,44 @@ bool GameDatabase::LoadGameDBYaml()
       return false;
     }
 
-    Entry& entry = s_entries.emplace_back();
+    Entry& entry = entries.emplace_back();
     entry.serial = serial;
     if (!ParseYamlEntry(&entry, current))
     {
-      s_entries.pop_back();
+      entries.pop_back();
       continue;
     }
 
-    ParseYamlCodes(code_lookup, current, serial);
+    ParseYamlCodes(code_serial_lookup, current, serial);
   }
 
   // Sorting must be done before generating code lookup, because otherwise the indices won't match.
-  s_entries.shrink_to_fit();
-  std::sort(s_entries.begin(), s_entries.end(),
+  std::sort(entries.begin(), entries.end(),
             [](const Entry& lhs, const Entry& rhs) { return (lhs.serial < rhs.serial); });
 
   ryml::reset_callbacks();
 
-  for (const auto& [code, serial] : code_lookup)
+  for (const auto& [code, serial] : code_serial_lookup)
   {
     const auto it =
-      std::lower_bound(s_entries.cbegin(), s_entries.cend(), serial,
+      std::lower_bound(entries.cbegin(), entries.cend(), serial,
                        [](const Entry& entry, const std::string_view& search) { return (entry.serial < search); });
-    if (it == s_entries.end() || it->serial != serial)
+    if (it == entries.end() || it->serial != serial)
     {
       ERROR_LOG("Somehow we messed up our code lookup for {} and {}?!", code, serial);
       continue;
     }
 
-    if (!s_code_lookup.emplace(code, static_cast<u32>(std::distance(s_entries.cbegin(), it))).second)
+    if (!code_lookup.emplace(code, static_cast<u32>(std::distance(entries.cbegin(), it))).second)
       ERROR_LOG("Failed to insert code {}", code);
   }
 
-  if (s_entries.empty())
+  if (entries.empty())
   {
     ERROR_LOG("Game database is empty.");
     return false;
   }
 
-  s_db_data = std::move(gamedb_data.value());
   return true;
 }
 
@@ -12,6 +12,7 @@
 #include "system.h"
 
 #include "util/cd_image.h"
+#include "util/cd_image_hasher.h"
 #include "util/elf_file.h"
 #include "util/http_downloader.h"
 #include "util/image.h"
@@ -25,6 +26,8 @@
 #include "common/path.h"
 #include "common/progress_callback.h"
 #include "common/string_util.h"
+#include "common/task_queue.h"
+#include "common/threading.h"
 #include "common/thirdparty/SmallVector.h"
 #include "common/timer.h"
 
@@ -32,9 +35,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
+#include <condition_variable>
 #include <ctime>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -45,6 +51,13 @@ LOG_CHANNEL(GameList);
 #include "common/windows_headers.h"
 #endif
 
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 namespace GameList {
 namespace {
 
@@ -53,6 +66,16 @@ enum : u32
   GAME_LIST_CACHE_SIGNATURE = 0x45434C48,
   GAME_LIST_CACHE_VERSION = 37,
 
+  DIRECTORY_INDEX_SIGNATURE = 0x58444C47,
+  DIRECTORY_INDEX_VERSION = 1,
+
+  TRACK_HASH_CACHE_SIGNATURE = 0x48534854,
+  TRACK_HASH_CACHE_VERSION = 2,
+  MAX_TRACK_HASH_CACHE_ENTRIES = 4096,
+
+  // Scanning is mostly I/O bound, and too many concurrent readers thrash spinning disks.
+  DEFAULT_MAX_SCAN_THREADS = 4,
+
   PLAYED_TIME_SERIAL_LENGTH = 32,
   PLAYED_TIME_LAST_TIME_LENGTH = 20,  // uint64
   PLAYED_TIME_TOTAL_TIME_LENGTH = 20, // uint64
@@ -66,6 +89,26 @@ struct PlayedTimeEntry
   std::time_t total_played_time;
 };
 
+/// Directory listing snapshot, used to skip enumerating directories which have not changed since the last refresh.
+/// Only file names and modification times are persisted.
+struct DirectoryIndexEntry
+{
+  std::time_t modification_time;
+  FileSystem::FindResultsArray files;
+  FileSystem::FindResultsArray subdirectories;
+};
+
+struct WatcherState
+{
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::pair<std::string, std::time_t>> directories;
+  std::vector<std::string> dirty_directories;
+  bool directories_changed = false;
+  bool shutdown = false;
+};
+
 #pragma pack(push, 1)
 struct MemcardTimestampCacheEntry
 {
@@ -80,10 +123,21 @@ struct MemcardTimestampCacheEntry
 };
 #pragma pack(pop)
 
+struct TrackHashCacheEntry
+{
+  std::string path;
+  s64 file_size;
+  s64 modification_time;
+  s64 size_on_disk;
+  u64 fingerprint;
+  std::vector<std::array<u8, 16>> hashes;
+};
+
 } // namespace
 
 using CacheMap = PreferUnorderedStringMap<Entry>;
 using PlayedTimeMap = PreferUnorderedStringMap<PlayedTimeEntry>;
+using DirectoryIndex = PreferUnorderedStringMap<DirectoryIndexEntry>;
 
 static_assert(std::is_same_v<decltype(Entry::hash), GameHash>);
 
@@ -102,23 +156,41 @@ static bool GetGameListEntryFromCache(const std::string& path, Entry* entry,
                                       const INISettingsInterface& custom_attributes_ini,
                                       const Achievements::ProgressDatabase& achievements_progress);
 static Entry* GetMutableEntryForPath(std::string_view path);
+static void EnumerateDirectory(const std::string& path, bool recursive, const DirectoryIndex& old_index,
+                               DirectoryIndex& new_index, PreferUnorderedStringSet& visited_links,
+                               FileSystem::FindResultsArray& files);
 static void ScanDirectory(const char* path, bool recursive, bool only_cache,
                           const std::vector<std::string>& excluded_paths, const PlayedTimeMap& played_time_map,
                           const INISettingsInterface& custom_attributes_ini,
-                          const Achievements::ProgressDatabase& achievements_progress, BinaryFileWriter& cache_writer,
+                          const Achievements::ProgressDatabase& achievements_progress, const DirectoryIndex& old_index,
+                          DirectoryIndex& new_index, PreferUnorderedStringSet& seen_paths,
+                          BinaryFileWriter& cache_writer, std::optional<TaskQueue>& scan_queue,
                           ProgressCallback* progress);
 static bool AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map,
                              const INISettingsInterface& custom_attributes_ini,
-                             const Achievements::ProgressDatabase& achievements_progress);
-static void ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                     const PlayedTimeMap& played_time_map, const INISettingsInterface& custom_attributes_ini,
-                     const Achievements::ProgressDatabase& achievements_progress, BinaryFileWriter& cache_writer);
+                             const Achievements::ProgressDatabase& achievements_progress,
+                             std::vector<Entry>& cached_entries);
+static u32 GetScanThreadCount();
+static void ScanFile(std::string path, std::time_t timestamp, const PlayedTimeMap& played_time_map,
+                     const INISettingsInterface& custom_attributes_ini,
+                     const Achievements::ProgressDatabase& achievements_progress, BinaryFileWriter& cache_writer,
+                     std::mutex& cache_writer_mutex);
 
 static bool LoadOrInitializeCache(std::FILE* fp, bool invalidate_cache);
 static bool LoadEntriesFromCache(BinaryFileReader& reader);
 static bool WriteEntryToCache(const Entry* entry, BinaryFileWriter& writer);
 static void CreateDiscSetEntries(const std::vector<std::string>& excluded_paths, const PlayedTimeMap& played_time_map);
 
+static std::string GetDirectoryIndexFile();
+static DirectoryIndex LoadDirectoryIndex();
+static void SaveDirectoryIndex(const DirectoryIndex& index);
+
+static bool ShouldWatchDirectories();
+static void UpdateWatcher(const DirectoryIndex& index);
+static std::vector<std::string> TakeDirtyDirectories();
+static void WatcherThreadEntryPoint();
+static bool PollWatchedDirectories(std::unique_lock<std::mutex>& lock);
+
 static std::string GetPlayedTimeFile();
 static bool ParsePlayedTimeLine(char* line, std::string& serial, PlayedTimeEntry& entry);
 static std::string MakePlayedTimeLine(const std::string& serial, const PlayedTimeEntry& entry);
@@ -134,10 +206,15 @@ static bool PutCustomPropertiesField(INISettingsInterface& ini, const std::strin
 static FileSystem::ManagedCFilePtr OpenMemoryCardTimestampCache(bool for_write);
 static bool UpdateMemcardTimestampCache(const MemcardTimestampCacheEntry& entry);
 
+static std::string GetTrackHashCachePath();
+static std::vector<TrackHashCacheEntry> LoadTrackHashCache();
+
 static EntryList s_entries;
 static std::recursive_mutex s_mutex;
 static CacheMap s_cache_map;
 static std::vector<MemcardTimestampCacheEntry> s_memcard_timestamp_cache_entries;
+static WatcherState s_watcher;
+static std::mutex s_track_hash_cache_mutex;
 
 static bool s_game_list_loaded = false;
 
@@ -526,17 +603,17 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
                              const std::vector<std::string>& excluded_paths, const PlayedTimeMap& played_time_map,
                              const INISettingsInterface& custom_attributes_ini,
                              const Achievements::ProgressDatabase& achievements_progress,
-                             BinaryFileWriter& cache_writer, ProgressCallback* progress)
+                             const DirectoryIndex& old_index, DirectoryIndex& new_index,
+                             PreferUnorderedStringSet& seen_paths, BinaryFileWriter& cache_writer,
+                             std::optional<TaskQueue>& scan_queue, ProgressCallback* progress)
 {
   VERBOSE_LOG("Scanning {}{}", path, recursive ? " (recursively)" : "");
 
   progress->SetStatusText(SmallString::from_format(TRANSLATE_FS("GameList", "Scanning directory '{}'..."), path));
 
   FileSystem::FindResultsArray files;
-  FileSystem::FindFiles(path, "*",
-                        recursive ? (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES | FILESYSTEM_FIND_RECURSIVE) :
-                                    (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES),
-                        &files);
+  PreferUnorderedStringSet visited_links;
+  EnumerateDirectory(path, recursive, old_index, new_index, visited_links, files);
   if (files.empty())
     return;
 
@@ -544,37 +621,169 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
   progress->SetProgressRange(static_cast<u32>(files.size()));
   progress->SetProgressValue(0);
 
+  // Cached entries are collected and added in one go, anything else gets deferred to the worker pool. Paths are
+  // checked against the set of files seen so far in this refresh, rather than searching the entry list for every file.
+  // The cache map is only used by the refresh, so the list lock is only needed to merge the results.
+  std::vector<std::pair<std::string, std::time_t>> files_to_scan;
+  std::vector<Entry> cached_entries;
   u32 files_scanned = 0;
   for (FILESYSTEM_FIND_DATA& ffd : files)
   {
-    files_scanned++;
-
-    if (progress->IsCancelled() || !IsScannableFilename(ffd.FileName) || IsPathExcluded(excluded_paths, ffd.FileName))
-      continue;
-
-    std::unique_lock lock(s_mutex);
-    if (GetEntryForPath(ffd.FileName) ||
+    if (progress->IsCancelled() || !IsScannableFilename(ffd.FileName) || IsPathExcluded(excluded_paths, ffd.FileName) ||
+        !seen_paths.insert(ffd.FileName).second ||
         AddFileFromCache(ffd.FileName, ffd.ModificationTime, played_time_map, custom_attributes_ini,
-                         achievements_progress) ||
+                         achievements_progress, cached_entries) ||
         only_cache)
     {
+      files_scanned++;
       continue;
     }
 
-    progress->SetStatusText(SmallString::from_format(TRANSLATE_FS("GameList", "Scanning '{}'..."),
-                                                     FileSystem::GetDisplayNameFromPath(ffd.FileName)));
-    ScanFile(std::move(ffd.FileName), ffd.ModificationTime, lock, played_time_map, custom_attributes_ini,
-             achievements_progress, cache_writer);
-    progress->SetProgressValue(files_scanned);
+    files_to_scan.emplace_back(std::move(ffd.FileName), ffd.ModificationTime);
+  }
+
+  if (!cached_entries.empty())
+  {
+    std::unique_lock lock(s_mutex);
+    s_entries.insert(s_entries.end(), std::make_move_iterator(cached_entries.begin()),
+                     std::make_move_iterator(cached_entries.end()));
   }
 
   progress->SetProgressValue(files_scanned);
+
+  if (!files_to_scan.empty())
+  {
+    // Progress callbacks are not thread-safe, so updates are serialized.
+    std::mutex progress_mutex;
+    std::mutex cache_writer_mutex;
+
+    // The database is lazily loaded, make sure that doesn't happen concurrently on the workers.
+    GameDatabase::EnsureLoaded();
+
+    // The pool is shared by every directory in the refresh, and only started once there's something to scan. With zero
+    // workers, WaitForAll() runs every task on this thread.
+    if (!scan_queue.has_value())
+    {
+      const u32 num_threads = GetScanThreadCount();
+      scan_queue.emplace();
+      scan_queue->SetWorkerCount((num_threads > 1) ? num_threads : 0);
+      VERBOSE_LOG("Scanning with {} thread(s)", num_threads);
+    }
+
+    for (auto& [file_path, timestamp] : files_to_scan)
+    {
+      scan_queue->SubmitTask([&file_path, timestamp, &files_scanned, &progress_mutex, &cache_writer_mutex,
+                              &played_time_map, &custom_attributes_ini, &achievements_progress, &cache_writer,
+                              progress]() {
+        {
+          std::unique_lock lock(progress_mutex);
+          if (progress->IsCancelled())
+            return;
+
+          progress->SetStatusText(SmallString::from_format(TRANSLATE_FS("GameList", "Scanning '{}'..."),
+                                                           FileSystem::GetDisplayNameFromPath(file_path)));
+        }
+
+        ScanFile(std::move(file_path), timestamp, played_time_map, custom_attributes_ini, achievements_progress,
+                 cache_writer, cache_writer_mutex);
+
+        std::unique_lock lock(progress_mutex);
+        progress->SetProgressValue(++files_scanned);
+      });
+    }
+
+    scan_queue->WaitForAll();
+  }
+
+  progress->SetProgressValue(static_cast<u32>(files.size()));
   progress->PopState();
 }
 
+u32 GameList::GetScanThreadCount()
+{
+  const u32 max_threads =
+    std::max(std::min(std::thread::hardware_concurrency(), static_cast<u32>(DEFAULT_MAX_SCAN_THREADS)), 1u);
+  return std::max(Host::GetBaseUIntSettingValue("GameList", "ScanThreads", max_threads), 1u);
+}
+
+void GameList::EnumerateDirectory(const std::string& path, bool recursive, const DirectoryIndex& old_index,
+                                  DirectoryIndex& new_index, PreferUnorderedStringSet& visited_links,
+                                  FileSystem::FindResultsArray& files)
+{
+  // already visited, e.g. overlapping recursive directories or links
+  if (new_index.contains(path))
+    return;
+
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(path.c_str(), &sd) || !(sd.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY))
+    return;
+
+  // Adding, removing or renaming an entry bumps the modification time of the directory itself, so if it matches the
+  // index, the previous listing can be used without enumerating the directory. Files rewritten in-place don't change
+  // the directory, so they still need to be stat'ed, but that is much cheaper than a full listing.
+  DirectoryIndexEntry entry;
+  const auto old_iter = old_index.find(path);
+  if (old_iter != old_index.end() && old_iter->second.modification_time == sd.ModificationTime)
+  {
+    entry = old_iter->second;
+    for (auto it = entry.files.begin(); it != entry.files.end();)
+    {
+      FILESYSTEM_STAT_DATA fsd;
+      if (!FileSystem::StatFile(it->FileName.c_str(), &fsd))
+      {
+        it = entry.files.erase(it);
+        continue;
+      }
+
+      it->ModificationTime = fsd.ModificationTime;
+      it->Size = fsd.Size;
+      ++it;
+    }
+  }
+  else
+  {
+    DEV_LOG("Enumerating changed directory '{}'", path);
+
+    FileSystem::FindResultsArray results;
+    FileSystem::FindFiles(path.c_str(), "*", FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_FOLDERS | FILESYSTEM_FIND_HIDDEN_FILES,
+                          &results);
+    for (FILESYSTEM_FIND_DATA& fd : results)
+    {
+      if (fd.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY)
+        entry.subdirectories.push_back(std::move(fd));
+      else
+        entry.files.push_back(std::move(fd));
+    }
+  }
+
+  // Timestamps only have second granularity, so a directory modified in the same second as it was listed could
+  // change again without the timestamp moving. Don't trust those listings next time.
+  entry.modification_time = (sd.ModificationTime >= (std::time(nullptr) - 1)) ? 0 : sd.ModificationTime;
+
+  const DirectoryIndexEntry& added = new_index.emplace(path, std::move(entry)).first->second;
+  files.insert(files.end(), added.files.begin(), added.files.end());
+
+  if (recursive)
+  {
+    for (const FILESYSTEM_FIND_DATA& subdir : added.subdirectories)
+    {
+      // same loop protection as FindFiles()
+      if (subdir.Attributes & FILESYSTEM_FILE_ATTRIBUTE_LINK)
+      {
+        std::string real_path = Path::RealPath(subdir.FileName);
+        if (!real_path.empty() && !visited_links.insert(std::move(real_path)).second)
+          continue;
+      }
+
+      EnumerateDirectory(subdir.FileName, true, old_index, new_index, visited_links, files);
+    }
+  }
+}
+
 bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map,
                                 const INISettingsInterface& custom_attributes_ini,
-                                const Achievements::ProgressDatabase& achievements_progress)
+                                const Achievements::ProgressDatabase& achievements_progress,
+                                std::vector<Entry>& cached_entries)
 {
   Entry entry;
   if (!GetGameListEntryFromCache(path, &entry, custom_attributes_ini, achievements_progress) ||
@@ -594,17 +803,16 @@ bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp,
     entry.total_played_time = iter->second.total_played_time;
   }
 
-  s_entries.push_back(std::move(entry));
+  cached_entries.push_back(std::move(entry));
   return true;
 }
 
-void GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                        const PlayedTimeMap& played_time_map, const INISettingsInterface& custom_attributes_ini,
-                        const Achievements::ProgressDatabase& achievements_progress, BinaryFileWriter& cache_writer)
+void GameList::ScanFile(std::string path, std::time_t timestamp, const PlayedTimeMap& played_time_map,
+                        const INISettingsInterface& custom_attributes_ini,
+                        const Achievements::ProgressDatabase& achievements_progress, BinaryFileWriter& cache_writer,
+                        std::mutex& cache_writer_mutex)
 {
-  // don't block UI while scanning
-  lock.unlock();
-
+  // called from worker threads, the list lock is only taken to merge the result, so the UI isn't blocked
   VERBOSE_LOG("Scanning '{}'...", path);
 
   Entry entry;
@@ -630,22 +838,19 @@ void GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_loc
   entry.path = std::move(path);
   entry.last_modified_time = timestamp;
 
-  if (cache_writer.IsOpen() && !WriteEntryToCache(&entry, cache_writer)) [[unlikely]]
-    WARNING_LOG("Failed to write entry '{}' to cache", entry.path);
-
-  lock.lock();
+  {
+    std::unique_lock cache_lock(cache_writer_mutex);
+    if (cache_writer.IsOpen() && !WriteEntryToCache(&entry, cache_writer)) [[unlikely]]
+      WARNING_LOG("Failed to write entry '{}' to cache", entry.path);
+  }
 
   // don't add invalid entries to the list
   if (!entry.IsValid())
     return;
 
-  // replace if present
-  auto it = std::find_if(s_entries.begin(), s_entries.end(),
-                         [&entry](const Entry& existing_entry) { return (existing_entry.path == entry.path); });
-  if (it != s_entries.end())
-    *it = std::move(entry);
-  else
-    s_entries.push_back(std::move(entry));
+  // paths are unique within a refresh, so there's nothing to replace
+  std::unique_lock lock(s_mutex);
+  s_entries.push_back(std::move(entry));
 }
 
 bool GameList::RescanCustomAttributesForPath(const std::string& path, const INISettingsInterface& custom_attributes_ini)
@@ -983,6 +1188,15 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
 #endif
   BinaryFileWriter cache_writer(cache_file.get());
 
+  // directories the watcher saw change need to be enumerated again
+  DirectoryIndex old_index, new_index;
+  PreferUnorderedStringSet seen_paths;
+  std::optional<TaskQueue> scan_queue;
+  if (!invalidate_cache)
+    old_index = LoadDirectoryIndex();
+  for (const std::string& dir : TakeDirtyDirectories())
+    old_index.erase(dir);
+
   // don't delete the old entries, since the frontend might still access them
   std::vector<Entry> old_entries;
   {
@@ -1021,7 +1235,8 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
         break;
 
       ScanDirectory(dir.c_str(), false, only_cache, excluded_paths, played_time, custom_attributes_ini,
-                    achievements_progress, cache_writer, progress);
+                    achievements_progress, old_index, new_index, seen_paths, cache_writer, scan_queue,
+                    progress);
       progress->SetProgressValue(++directory_counter);
     }
     for (const std::string& dir : recursive_dirs)
@@ -1030,7 +1245,8 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
         break;
 
       ScanDirectory(dir.c_str(), true, only_cache, excluded_paths, played_time, custom_attributes_ini,
-                    achievements_progress, cache_writer, progress);
+                    achievements_progress, old_index, new_index, seen_paths, cache_writer, scan_queue,
+                    progress);
       progress->SetProgressValue(++directory_counter);
     }
   }
@@ -1040,6 +1256,320 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
 
   // merge multi-disc games
   CreateDiscSetEntries(excluded_paths, played_time);
+
+  // partial index would cause the skipped directories to be enumerated again, so keep the old one
+  if (!progress->IsCancelled())
+    SaveDirectoryIndex(new_index);
+
+  if (!only_cache && ShouldWatchDirectories())
+    UpdateWatcher(new_index);
+}
+
+std::string GameList::GetDirectoryIndexFile()
+{
+  return Path::Combine(EmuFolders::Cache, "gamelist_dirs.cache");
+}
+
+GameList::DirectoryIndex GameList::LoadDirectoryIndex()
+{
+  DirectoryIndex index;
+
+  FileSystem::ManagedCFilePtr fp = FileSystem::OpenManagedCFile(GetDirectoryIndexFile().c_str(), "rb");
+  if (!fp)
+    return index;
+
+  BinaryFileReader reader(fp.get());
+  u32 signature, version;
+  if (!reader.ReadU32(&signature) || !reader.ReadU32(&version) || signature != DIRECTORY_INDEX_SIGNATURE ||
+      version != DIRECTORY_INDEX_VERSION)
+  {
+    WARNING_LOG("Game list directory index is corrupted");
+    return index;
+  }
+
+  while (!reader.IsAtEnd())
+  {
+    std::string path;
+    DirectoryIndexEntry entry;
+    u32 num_files, num_subdirectories;
+    if (!reader.ReadSizePrefixedString(&path) || !reader.ReadS64(reinterpret_cast<s64*>(&entry.modification_time)) ||
+        !reader.ReadU32(&num_files) || !reader.ReadU32(&num_subdirectories))
+    {
+      WARNING_LOG("Game list directory index entry is corrupted");
+      index.clear();
+      return index;
+    }
+
+    entry.files.resize(num_files);
+    for (FILESYSTEM_FIND_DATA& fd : entry.files)
+    {
+      if (!reader.ReadSizePrefixedString(&fd.FileName) ||
+          !reader.ReadS64(reinterpret_cast<s64*>(&fd.ModificationTime))) [[unlikely]]
+      {
+        index.clear();
+        return index;
+      }
+    }
+
+    entry.subdirectories.resize(num_subdirectories);
+    for (FILESYSTEM_FIND_DATA& fd : entry.subdirectories)
+    {
+      if (!reader.ReadSizePrefixedString(&fd.FileName) || !reader.ReadU32(&fd.Attributes)) [[unlikely]]
+      {
+        index.clear();
+        return index;
+      }
+    }
+
+    index.insert_or_assign(std::move(path), std::move(entry));
+  }
+
+  return index;
+}
+
+void GameList::SaveDirectoryIndex(const DirectoryIndex& index)
+{
+  Error error;
+  FileSystem::AtomicRenamedFile fp = FileSystem::CreateAtomicRenamedFile(GetDirectoryIndexFile(), &error);
+  if (!fp)
+  {
+    ERROR_LOG("Failed to create game list directory index: {}", error.GetDescription());
+    return;
+  }
+
+  BinaryFileWriter writer(fp.get());
+  writer.WriteU32(DIRECTORY_INDEX_SIGNATURE);
+  writer.WriteU32(DIRECTORY_INDEX_VERSION);
+  for (const auto& [path, entry] : index)
+  {
+    writer.WriteSizePrefixedString(path);
+    writer.WriteS64(static_cast<s64>(entry.modification_time));
+    writer.WriteU32(static_cast<u32>(entry.files.size()));
+    writer.WriteU32(static_cast<u32>(entry.subdirectories.size()));
+    for (const FILESYSTEM_FIND_DATA& fd : entry.files)
+    {
+      writer.WriteSizePrefixedString(fd.FileName);
+      writer.WriteS64(static_cast<s64>(fd.ModificationTime));
+    }
+    for (const FILESYSTEM_FIND_DATA& fd : entry.subdirectories)
+    {
+      writer.WriteSizePrefixedString(fd.FileName);
+      writer.WriteU32(fd.Attributes);
+    }
+  }
+
+  if (!writer.Flush(&error) || !FileSystem::CommitAtomicRenamedFile(fp, &error))
+  {
+    ERROR_LOG("Failed to write game list directory index: {}", error.GetDescription());
+    FileSystem::DiscardAtomicRenamedFile(fp);
+  }
+}
+
+bool GameList::ShouldWatchDirectories()
+{
+  return Host::GetBaseBoolSettingValue("GameList", "WatchDirectories", true);
+}
+
+void GameList::UpdateWatcher(const DirectoryIndex& index)
+{
+  std::unique_lock lock(s_watcher.mutex);
+  s_watcher.directories.clear();
+  s_watcher.directories.reserve(index.size());
+  for (const auto& [path, entry] : index)
+    s_watcher.directories.emplace_back(path, entry.modification_time);
+  s_watcher.directories_changed = true;
+
+  if (!s_watcher.thread.joinable())
+  {
+    s_watcher.shutdown = false;
+    s_watcher.thread = std::thread(&GameList::WatcherThreadEntryPoint);
+  }
+  else
+  {
+    s_watcher.cv.notify_one();
+  }
+}
+
+void GameList::StopWatcher()
+{
+  std::unique_lock lock(s_watcher.mutex);
+  if (!s_watcher.thread.joinable())
+    return;
+
+  s_watcher.shutdown = true;
+  s_watcher.cv.notify_one();
+  lock.unlock();
+
+  s_watcher.thread.join();
+
+  lock.lock();
+  s_watcher.thread = {};
+  s_watcher.directories.clear();
+}
+
+std::vector<std::string> GameList::TakeDirtyDirectories()
+{
+  std::unique_lock lock(s_watcher.mutex);
+  return std::exchange(s_watcher.dirty_directories, {});
+}
+
+bool GameList::PollWatchedDirectories(std::unique_lock<std::mutex>& lock)
+{
+  // stat without holding the lock, the list is only replaced from Refresh()
+  // Only directory timestamps are compared, files rewritten in-place are picked up by the next refresh instead of
+  // having to stat every file in the list every poll.
+  std::vector<std::pair<std::string, std::time_t>> directories = s_watcher.directories;
+  lock.unlock();
+
+  PreferUnorderedStringSet changed;
+  for (const auto& [path, modification_time] : directories)
+  {
+    FILESYSTEM_STAT_DATA sd;
+    if (modification_time >= 0 &&
+        (!FileSystem::StatFile(path.c_str(), &sd) || sd.ModificationTime != modification_time))
+    {
+      changed.insert(path);
+    }
+  }
+
+  lock.lock();
+  if (changed.empty())
+    return false;
+
+  // don't keep reporting the same directories until they've been rescanned
+  for (auto& [path, modification_time] : s_watcher.directories)
+  {
+    if (changed.contains(path))
+      modification_time = -1;
+  }
+
+  s_watcher.dirty_directories.insert(s_watcher.dirty_directories.end(), changed.begin(), changed.end());
+  return true;
+}
+
+void GameList::WatcherThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Game List Watcher");
+
+  // Changes tend to come in bursts (copying a multi-track game, extracting an archive), so wait for things to
+  // settle down before refreshing. Without change notifications, directory timestamps are polled instead.
+  static constexpr auto DEBOUNCE_TIME = std::chrono::seconds(2);
+  static constexpr auto POLL_INTERVAL = std::chrono::seconds(10);
+
+  std::unique_lock lock(s_watcher.mutex);
+
+#ifdef __linux__
+  static constexpr int INOTIFY_POLL_TIMEOUT_MS = 250;
+  static constexpr u32 INOTIFY_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE |
+                                      IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+  const int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd < 0)
+    WARNING_LOG("inotify_init1() failed: {}, falling back to polling", errno);
+
+  std::unordered_map<int, std::string> watch_descriptors;
+  alignas(struct inotify_event) char event_buffer[16384];
+  bool change_pending = false;
+  auto last_change_time = std::chrono::steady_clock::now();
+
+  while (inotify_fd >= 0 && !s_watcher.shutdown)
+  {
+    if (s_watcher.directories_changed)
+    {
+      s_watcher.directories_changed = false;
+      for (const auto& [wd, path] : watch_descriptors)
+        inotify_rm_watch(inotify_fd, wd);
+      watch_descriptors.clear();
+
+      for (const auto& [path, modification_time] : s_watcher.directories)
+      {
+        const int wd = inotify_add_watch(inotify_fd, path.c_str(), INOTIFY_MASK);
+        if (wd < 0)
+        {
+          // probably hit max_user_watches, at least some directories are watched
+          WARNING_LOG("inotify_add_watch('{}') failed: {}", path, errno);
+          continue;
+        }
+
+        watch_descriptors.emplace(wd, path);
+      }
+
+      VERBOSE_LOG("Watching {} directories for changes", watch_descriptors.size());
+    }
+
+    lock.unlock();
+
+    pollfd pfd = {inotify_fd, POLLIN, 0};
+    if (poll(&pfd, 1, INOTIFY_POLL_TIMEOUT_MS) > 0 && (pfd.revents & POLLIN))
+    {
+      ssize_t len;
+      while ((len = read(inotify_fd, event_buffer, sizeof(event_buffer))) > 0)
+      {
+        for (const char* ptr = event_buffer; ptr < (event_buffer + len);)
+        {
+          const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+          ptr += sizeof(inotify_event) + event->len;
+
+          // ignore changes to non-game files, e.g. save files next to the image
+          if (!(event->mask & (IN_ISDIR | IN_DELETE_SELF | IN_MOVE_SELF | IN_Q_OVERFLOW)) &&
+              (event->len == 0 || !IsScannableFilename(event->name)))
+          {
+            continue;
+          }
+
+          const auto iter = watch_descriptors.find(event->wd);
+          lock.lock();
+          if (event->mask & IN_Q_OVERFLOW)
+          {
+            for (const auto& [path, modification_time] : s_watcher.directories)
+              s_watcher.dirty_directories.push_back(path);
+          }
+          else if (iter != watch_descriptors.end())
+          {
+            s_watcher.dirty_directories.push_back(iter->second);
+          }
+          lock.unlock();
+
+          change_pending = true;
+          last_change_time = std::chrono::steady_clock::now();
+        }
+      }
+    }
+
+    if (change_pending && (std::chrono::steady_clock::now() - last_change_time) >= DEBOUNCE_TIME)
+    {
+      INFO_LOG("Game directories changed, refreshing game list.");
+      change_pending = false;
+      Host::RefreshGameListAsync(false);
+    }
+
+    lock.lock();
+  }
+
+  if (inotify_fd >= 0)
+  {
+    lock.unlock();
+    close(inotify_fd);
+    return;
+  }
+#endif
+
+  while (!s_watcher.shutdown)
+  {
+    s_watcher.cv.wait_for(lock, POLL_INTERVAL, []() { return s_watcher.shutdown; });
+    if (s_watcher.shutdown || !PollWatchedDirectories(lock))
+      continue;
+
+    // give copies a chance to finish before refreshing
+    s_watcher.cv.wait_for(lock, DEBOUNCE_TIME, []() { return s_watcher.shutdown; });
+    if (s_watcher.shutdown)
+      break;
+
+    INFO_LOG("Game directories changed, refreshing game list.");
+    lock.unlock();
+    Host::RefreshGameListAsync(false);
+    lock.lock();
+  }
 }
 
 GameList::EntryList GameList::TakeEntryList()
@@ -2104,3 +2634,137 @@ bool GameList::UpdateMemcardTimestampCache(const MemcardTimestampCacheEntry& ent
   // append it.
   return (std::fwrite(&entry, sizeof(entry), 1, fp.get()) == 1);
 }
+
+std::string GameList::GetTrackHashCachePath()
+{
+  return Path::Combine(EmuFolders::Cache, "trackhashes.cache");
+}
+
+std::vector<GameList::TrackHashCacheEntry> GameList::LoadTrackHashCache()
+{
+  std::vector<TrackHashCacheEntry> entries;
+
+  const std::optional<DynamicHeapArray<u8>> data = FileSystem::ReadBinaryFile(GetTrackHashCachePath().c_str());
+  if (!data.has_value())
+    return entries;
+
+  BinarySpanReader reader(data->cspan());
+  u32 signature, version;
+  if (!reader.ReadU32(&signature) || !reader.ReadU32(&version) || signature != TRACK_HASH_CACHE_SIGNATURE ||
+      version != TRACK_HASH_CACHE_VERSION)
+  {
+    WARNING_LOG("Track hash cache is corrupted or outdated");
+    return entries;
+  }
+
+  while (reader.GetBufferRemaining() > 0)
+  {
+    TrackHashCacheEntry& entry = entries.emplace_back();
+    u8 num_tracks;
+    if (!reader.ReadSizePrefixedString(&entry.path) || !reader.ReadS64(&entry.file_size) ||
+        !reader.ReadS64(&entry.modification_time) || !reader.ReadS64(&entry.size_on_disk) ||
+        !reader.ReadU64(&entry.fingerprint) ||
+        !reader.ReadU8(&num_tracks))
+    {
+      WARNING_LOG("Track hash cache entry is corrupted");
+      entries.pop_back();
+      break;
+    }
+
+    entry.hashes.resize(num_tracks);
+    if (!reader.Read(entry.hashes.data(), entry.hashes.size() * sizeof(std::array<u8, 16>)))
+    {
+      WARNING_LOG("Track hash cache entry is corrupted");
+      entries.pop_back();
+      break;
+    }
+  }
+
+  return entries;
+}
+
+bool GameList::GetCachedTrackHashes(const std::string& path, CDImage* image, std::vector<std::array<u8, 16>>* hashes)
+{
+  // The cue/m3u may be unchanged while the track files are replaced, so their total size is checked too.
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(path.c_str(), &sd))
+    return false;
+
+  const s64 size_on_disk = image->GetSizeOnDisk();
+  const std::optional<u64> fingerprint = CDImageHasher::GetImageFingerprint(image);
+  if (!fingerprint.has_value())
+    return false;
+
+  std::unique_lock lock(s_track_hash_cache_mutex);
+  std::vector<TrackHashCacheEntry> entries = LoadTrackHashCache();
+  for (TrackHashCacheEntry& entry : entries)
+  {
+    if (entry.path != path)
+      continue;
+
+    if (entry.file_size != sd.Size || entry.modification_time != static_cast<s64>(sd.ModificationTime) ||
+        entry.size_on_disk != size_on_disk || entry.fingerprint != fingerprint.value() ||
+        entry.hashes.size() != image->GetTrackCount())
+    {
+      DEV_LOG("Cached track hashes for '{}' are stale", Path::GetFileName(path));
+      return false;
+    }
+
+    *hashes = std::move(entry.hashes);
+    return true;
+  }
+
+  return false;
+}
+
+void GameList::AddCachedTrackHashes(const std::string& path, CDImage* image,
+                                    std::span<const std::array<u8, 16>> hashes)
+{
+  FILESYSTEM_STAT_DATA sd;
+  if (hashes.empty() || hashes.size() > std::numeric_limits<u8>::max() || !FileSystem::StatFile(path.c_str(), &sd))
+    return;
+
+  const std::optional<u64> fingerprint = CDImageHasher::GetImageFingerprint(image);
+  if (!fingerprint.has_value())
+    return;
+
+  std::unique_lock lock(s_track_hash_cache_mutex);
+  std::vector<TrackHashCacheEntry> entries = LoadTrackHashCache();
+  std::erase_if(entries, [&path](const TrackHashCacheEntry& entry) { return (entry.path == path); });
+
+  // oldest entries are at the front
+  if (entries.size() >= MAX_TRACK_HASH_CACHE_ENTRIES)
+    entries.erase(entries.begin(), entries.begin() + (entries.size() - MAX_TRACK_HASH_CACHE_ENTRIES + 1));
+
+  entries.push_back(TrackHashCacheEntry{path, sd.Size, static_cast<s64>(sd.ModificationTime), image->GetSizeOnDisk(),
+                                        fingerprint.value(),
+                                        std::vector<std::array<u8, 16>>(hashes.begin(), hashes.end())});
+
+  Error error;
+  FileSystem::AtomicRenamedFile fp = FileSystem::CreateAtomicRenamedFile(GetTrackHashCachePath(), &error);
+  if (!fp)
+  {
+    ERROR_LOG("Failed to open track hash cache: {}", error.GetDescription());
+    return;
+  }
+
+  BinaryFileWriter writer(fp.get());
+  writer.WriteU32(TRACK_HASH_CACHE_SIGNATURE);
+  writer.WriteU32(TRACK_HASH_CACHE_VERSION);
+  for (const TrackHashCacheEntry& entry : entries)
+  {
+    writer.WriteSizePrefixedString(entry.path);
+    writer.WriteS64(entry.file_size);
+    writer.WriteS64(entry.modification_time);
+    writer.WriteS64(entry.size_on_disk);
+    writer.WriteU64(entry.fingerprint);
+    writer.WriteU8(static_cast<u8>(entry.hashes.size()));
+    writer.Write(entry.hashes.data(), entry.hashes.size() * sizeof(std::array<u8, 16>));
+  }
+
+  if (!writer.Flush(&error) || !FileSystem::CommitAtomicRenamedFile(fp, &error))
+  {
+    ERROR_LOG("Failed to write track hash cache: {}", error.GetDescription());
+    FileSystem::DiscardAtomicRenamedFile(fp);
+  }
+}
@@ -10,11 +10,13 @@
 
 #include "common/small_string.h"
 
+#include <array>
 #include <ctime>
 #include <functional>
 #include <mutex>
 #include <span>
 #include <string>
+#include <vector>
 
 class ProgressCallback;
 
@@ -110,6 +112,10 @@ bool IsGameListLoaded();
 /// If only_cache is set, no new files will be scanned, only those present in the cache.
 void Refresh(bool invalidate_cache, bool only_cache = false, ProgressCallback* progress = nullptr);
 
+/// Stops watching the game list directories for changes. Refresh() starts the watcher when the GameList/WatchDirectories
+/// setting is enabled, so this must be called before the host shuts down.
+void StopWatcher();
+
 /// Moves the current game list, which can be temporarily displayed in the UI until refresh completes.
 /// The caller **must** call Refresh() afterward, otherwise it will be permanently lost.
 EntryList TakeEntryList();
@@ -155,6 +161,12 @@ std::optional<DiscRegion> GetCustomRegionForPath(const std::string_view path);
 std::string GetGameIconPath(std::string_view serial, std::string_view path);
 void ReloadMemcardTimestampCache();
 
+/// Track hashes from verifying a disc are cached so that the image can be identified again without hashing. Cached
+/// hashes are only returned if the size and modification time of the image file, the size of all of its track files,
+/// and the image fingerprint all match. They should not be used in place of hashing for verification.
+bool GetCachedTrackHashes(const std::string& path, CDImage* image, std::vector<std::array<u8, 16>>* hashes);
+void AddCachedTrackHashes(const std::string& path, CDImage* image, std::span<const std::array<u8, 16>> hashes);
+
 /// Updates game list with new achievement unlocks.
 void UpdateAchievementData(const std::span<u8, 16> hash, u32 game_id, u32 num_achievements, u32 num_unlocked,
                            u32 num_unlocked_hardcore);
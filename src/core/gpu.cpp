@@ -247,8 +247,10 @@ bool GPU::DoState(StateWrapper& sw)
 {
   if (sw.IsWriting())
   {
-    // Need to ensure our copy of VRAM is good.
-    ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+    // Need to ensure our copy of VRAM is good. The GPU thread also writes the CLUT, which isn't covered by the VRAM
+    // write tracking, so wait for everything queued rather than only the commands that overlap VRAM.
+    ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT, GPUThread::SyncReason::SaveState);
+    GPUBackend::SyncGPUThread(true, GPUThread::SyncReason::SaveState);
   }
 
   sw.Do(&m_GPUSTAT.bits);
@@ -1908,12 +1910,13 @@ void GPU::CalculateDrawRect(u32 window_width, u32 window_height, u32 crtc_displa
     GSVector4(left_padding, top_padding, left_padding + display_width * scale, top_padding + display_height * scale));
 }
 
-void GPU::ReadVRAM(u16 x, u16 y, u16 width, u16 height)
+void GPU::ReadVRAM(u16 x, u16 y, u16 width, u16 height, GPUThread::SyncReason reason)
 {
-  // If we're using the software renderer, we only need to sync the thread.
+  // If we're using the software renderer, the CPU copy of VRAM is kept up to date by the GPU thread, so we only need
+  // to wait for any queued commands which overlap the area being read.
   if (!GPUBackend::IsUsingHardwareBackend() || g_settings.gpu_use_software_renderer_for_readbacks)
   {
-    GPUBackend::SyncGPUThread(true);
+    GPUThread::SyncGPUThreadForVRAMRead(x, y, width, height, true, reason);
     return;
   }
 
@@ -1922,7 +1925,7 @@ void GPU::ReadVRAM(u16 x, u16 y, u16 width, u16 height)
   cmd->y = y;
   cmd->width = width;
   cmd->height = height;
-  GPUBackend::PushCommandAndSync(cmd, true);
+  GPUBackend::PushCommandAndSync(cmd, true, reason);
 }
 
 void GPU::UpdateVRAM(u16 x, u16 y, u16 width, u16 height, const void* data, bool set_mask, bool check_mask)
@@ -2027,7 +2030,7 @@ u8 GPU::CalculateAutomaticResolutionScale() const
 
 bool GPU::DumpVRAMToFile(const char* filename)
 {
-  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT, GPUThread::SyncReason::Debug);
 
   const char* extension = std::strrchr(filename, '.');
   if (extension && StringUtil::Strcasecmp(extension, ".png") == 0)
@@ -2143,7 +2146,7 @@ bool GPU::StartRecordingGPUDump(const char* path, u32 num_frames /* = 1 */)
   }
 
   // ensure vram is up to date
-  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT, GPUThread::SyncReason::Debug);
 
   std::string osd_key = fmt::format("GPUDump_{}", Path::GetFileName(path));
   Error error;
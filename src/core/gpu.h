@@ -41,6 +41,10 @@ class Player;
 } // namespace GPUDump
 
 class GPUBackend;
+
+namespace GPUThread {
+enum class SyncReason : u8;
+}
 struct Settings;
 
 namespace System {
@@ -308,7 +312,7 @@ private:
   void InvalidateCLUT();
   bool IsCLUTValid() const;
 
-  void ReadVRAM(u16 x, u16 y, u16 width, u16 height);
+  void ReadVRAM(u16 x, u16 y, u16 width, u16 height, GPUThread::SyncReason reason);
   void UpdateVRAM(u16 x, u16 y, u16 width, u16 height, const void* data, bool set_mask, bool check_mask);
 
   void PrepareForDraw();
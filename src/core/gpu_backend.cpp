@@ -27,6 +27,8 @@
 #include "IconsFontAwesome5.h"
 #include "fmt/format.h"
 
+#include <numeric>
+
 LOG_CHANNEL(GPU);
 
 namespace {
@@ -47,9 +49,42 @@ struct ALIGN_TO_CACHE_LINE CPUThreadState
 
 GPUBackend::Counters GPUBackend::s_counters = {};
 GPUBackend::Stats GPUBackend::s_stats = {};
+GPUBackend::Counters GPUBackend::s_dump_base_counters = {};
+GPUBackend::Counters GPUBackend::s_last_dump_counters = {};
 
 static CPUThreadState s_cpu_thread_state = {};
 
+namespace {
+struct StatisticsDumpState
+{
+  std::string path;
+  FileSystem::ManagedCFilePtr fp;
+  bool open_failed = false;
+
+  // Draw count at the time of the last row, rows contain the delta. The base is carried over device resets.
+  u32 base_host_num_draws = 0;
+  u32 last_host_num_draws = 0;
+};
+} // namespace
+
+static StatisticsDumpState s_statistics_dump;
+
+static constexpr const std::array<const char*, GPUBackend::NUM_FLUSH_REASONS> s_flush_reason_names = {{
+    "TexturePageChange",
+    "BlendingChange",
+    "RenderStateChange",
+    "VRAMWriteOverlap",
+    "VRAMFill",
+    "VRAMCopy",
+    "VRAMWrite",
+    "Readback",
+    "DisplayUpdate",
+    "DrawingAreaChange",
+    "DepthBufferClear",
+    "BufferFull",
+    "Other",
+  }};
+
 GPUBackend::GPUBackend(GPUPresenter& presenter) : m_presenter(presenter)
 {
   GPU_SW_Rasterizer::SelectImplementation();
@@ -122,6 +157,20 @@ void GPUBackend::UpdatePostProcessingSettings(bool force_reload)
 {
 }
 
+void GPUBackend::GameSerialChanged()
+{
+}
+
+bool GPUBackend::GetCPUDisplaySize(u32* width, u32* height) const
+{
+  return false;
+}
+
+bool GPUBackend::RenderDisplayToBuffer(void* buffer, u32 pitch, u32 width, u32 height)
+{
+  return false;
+}
+
 GPUThreadCommand* GPUBackend::NewClearVRAMCommand()
 {
   return static_cast<GPUThreadCommand*>(
@@ -250,14 +299,14 @@ void GPUBackend::PushCommandAndWakeThread(GPUThreadCommand* cmd)
   GPUThread::PushCommandAndWakeThread(cmd);
 }
 
-void GPUBackend::PushCommandAndSync(GPUThreadCommand* cmd, bool spin)
+void GPUBackend::PushCommandAndSync(GPUThreadCommand* cmd, bool spin, GPUThread::SyncReason reason)
 {
-  GPUThread::PushCommandAndSync(cmd, spin);
+  GPUThread::PushCommandAndSync(cmd, spin, reason);
 }
 
-void GPUBackend::SyncGPUThread(bool spin)
+void GPUBackend::SyncGPUThread(bool spin, GPUThread::SyncReason reason)
 {
-  GPUThread::SyncGPUThread(spin);
+  GPUThread::SyncGPUThread(spin, reason);
 }
 
 bool GPUBackend::IsUsingHardwareBackend()
@@ -342,12 +391,16 @@ bool GPUBackend::AllocateMemorySaveStates(std::span<System::MemorySaveState> sta
   bool result;
   GPUThread::RunOnBackend(
     [states, error, &result](GPUBackend* backend) {
-      // Free old textures first.
-      for (size_t i = 0; i < states.size(); i++)
-        g_gpu_device->RecycleTexture(std::move(states[i].vram_texture));
+      // Software renderer states have no textures, and may not have a device.
+      if (g_gpu_device)
+      {
+        // Free old textures first.
+        for (size_t i = 0; i < states.size(); i++)
+          g_gpu_device->RecycleTexture(std::move(states[i].vram_texture));
 
-      // Maximize potential for texture reuse by flushing the current command buffer.
-      g_gpu_device->WaitForGPUIdle();
+        // Maximize potential for texture reuse by flushing the current command buffer.
+        g_gpu_device->WaitForGPUIdle();
+      }
 
       for (size_t i = 0; i < states.size(); i++)
       {
@@ -452,6 +505,7 @@ void GPUBackend::HandleCommand(const GPUThreadCommand* cmd)
     case GPUBackendCommandType::FillVRAM:
     {
       const GPUBackendFillVRAMCommand* ccmd = static_cast<const GPUBackendFillVRAMCommand*>(cmd);
+      s_counters.num_fills++;
       FillVRAM(ZeroExtend32(ccmd->x), ZeroExtend32(ccmd->y), ZeroExtend32(ccmd->width), ZeroExtend32(ccmd->height),
                ccmd->color, ccmd->interlaced_rendering, ccmd->active_line_lsb);
     }
@@ -558,7 +612,10 @@ void GPUBackend::HandleSubmitFrameCommand(const GPUBackendFramePresentationParam
   // For regtest.
   Host::FrameDoneOnGPUThread(this, cmd->frame_number);
 
-  if (cmd->media_capture)
+  if (!s_statistics_dump.path.empty())
+    WriteStatisticsDumpRow(cmd->frame_number);
+
+  if (cmd->media_capture && g_gpu_device)
     m_presenter.SendDisplayToMediaCapture(cmd->media_capture);
 
   // If this returns false, our backend object is deleted and replaced with null, so bail out.
@@ -585,23 +642,25 @@ void GPUBackend::GetStatsString(SmallStringBase& str) const
   {
     if (g_gpu_settings.gpu_pgxp_depth_buffer)
     {
-      str.format("{}{} HW | {} P | {} DC | {} B | {} RP | {} RB | {} C | {} W | {} DBC",
+      str.format("{}{} HW | {} P | {} DC | {} MB | {} B | {} RP | {} RB | {} C | {} W | {} DBC",
                  GPUDevice::RenderAPIToString(g_gpu_device->GetRenderAPI()), g_gpu_settings.gpu_use_thread ? "-MT" : "",
-                 s_stats.num_primitives, s_stats.host_num_draws, s_stats.host_num_barriers,
-                 s_stats.host_num_render_passes, s_stats.host_num_downloads, s_stats.num_copies, s_stats.num_writes,
-                 s_stats.num_depth_buffer_clears);
+                 s_stats.num_primitives, s_stats.host_num_draws, s_stats.num_merged_batches,
+                 s_stats.host_num_barriers, s_stats.host_num_render_passes, s_stats.host_num_downloads,
+                 s_stats.num_copies, s_stats.num_writes, s_stats.num_depth_buffer_clears);
     }
     else
     {
-      str.format("{}{} HW | {} P | {} DC | {} B | {} RP | {} RB | {} C | {} W",
+      str.format("{}{} HW | {} P | {} DC | {} MB | {} B | {} RP | {} RB | {} C | {} W",
                  GPUDevice::RenderAPIToString(g_gpu_device->GetRenderAPI()), g_gpu_settings.gpu_use_thread ? "-MT" : "",
-                 s_stats.num_primitives, s_stats.host_num_draws, s_stats.host_num_barriers,
-                 s_stats.host_num_render_passes, s_stats.host_num_downloads, s_stats.num_copies, s_stats.num_writes);
+                 s_stats.num_primitives, s_stats.host_num_draws, s_stats.num_merged_batches,
+                 s_stats.host_num_barriers, s_stats.host_num_render_passes, s_stats.host_num_downloads,
+                 s_stats.num_copies, s_stats.num_writes);
     }
   }
   else
   {
-    str.format("{}{} SW | {} P | {} R | {} C | {} W", GPUDevice::RenderAPIToString(g_gpu_device->GetRenderAPI()),
+    str.format("{}{} SW | {} P | {} R | {} C | {} W",
+               GPUDevice::RenderAPIToString(g_gpu_device ? g_gpu_device->GetRenderAPI() : RenderAPI::None),
                g_gpu_settings.gpu_use_thread ? "-MT" : "", s_stats.num_primitives, s_stats.num_reads,
                s_stats.num_copies, s_stats.num_writes);
   }
@@ -609,22 +668,123 @@ void GPUBackend::GetStatsString(SmallStringBase& str) const
 
 void GPUBackend::GetMemoryStatsString(SmallStringBase& str) const
 {
-  const u32 vram_usage_mb = static_cast<u32>((g_gpu_device->GetVRAMUsage() + (1048576 - 1)) / 1048576);
+  const size_t vram_usage = g_gpu_device ? g_gpu_device->GetVRAMUsage() : 0;
+  const u32 vram_usage_mb = static_cast<u32>((vram_usage + (1048576 - 1)) / 1048576);
   const u32 stream_kb = static_cast<u32>((s_stats.host_buffer_streamed + (1024 - 1)) / 1024);
 
   str.format("{} MB VRAM | {} KB STR | {} TC | {} TU", vram_usage_mb, stream_kb, s_stats.host_num_copies,
              s_stats.host_num_uploads);
 }
 
+void GPUBackend::GetFlushStatsString(SmallStringBase& str) const
+{
+  const u32 num_flushes = std::accumulate(s_stats.num_flushes.begin(), s_stats.num_flushes.end(), 0u);
+  const float vertices_per_batch =
+    (s_stats.num_batches > 0) ?
+      (static_cast<float>(s_stats.num_batch_vertices) / static_cast<float>(s_stats.num_batches)) :
+      0.0f;
+  str.format("{} FL | {:.1f} V/B | {} F | {}/{} TC", num_flushes, vertices_per_batch, s_stats.num_fills,
+             s_stats.num_texture_cache_hits, s_stats.num_texture_cache_misses);
+
+  // Only show reasons which occurred, there's too many to fit otherwise.
+  for (u32 i = 0; i < NUM_FLUSH_REASONS; i++)
+  {
+    if (s_stats.num_flushes[i] > 0)
+      str.append_format(" | {} {}", s_stats.num_flushes[i], s_flush_reason_names[i]);
+  }
+}
+
+void GPUBackend::SetStatisticsDumpPath(std::string path)
+{
+  s_statistics_dump.path = std::move(path);
+  s_statistics_dump.fp.reset();
+  s_statistics_dump.open_failed = false;
+}
+
+void GPUBackend::WriteStatisticsDumpRow(u32 frame_number)
+{
+  if (!s_statistics_dump.fp)
+  {
+    if (s_statistics_dump.open_failed)
+      return;
+
+    Error error;
+    s_statistics_dump.fp = FileSystem::OpenManagedCFile(s_statistics_dump.path.c_str(), "wb", &error);
+    if (!s_statistics_dump.fp)
+    {
+      ERROR_LOG("Failed to open statistics dump '{}': {}", s_statistics_dump.path, error.GetDescription());
+      s_statistics_dump.open_failed = true;
+      return;
+    }
+
+    std::string header = "frame,primitives,vertices,batches,batch_vertices,merged_batches,host_draws,reads,writes,"
+                         "copies,fills,tc_hits,tc_misses";
+    for (const char* name : s_flush_reason_names)
+      fmt::format_to(std::back_inserter(header), ",flush_{}", name);
+    header.push_back('\n');
+    std::fwrite(header.data(), header.size(), 1, s_statistics_dump.fp.get());
+  }
+
+  Counters cur = s_dump_base_counters;
+  AddCounters(cur, s_counters);
+  const Counters& last = s_last_dump_counters;
+  const u32 host_num_draws =
+    s_statistics_dump.base_host_num_draws + (g_gpu_device ? g_gpu_device->GetStatistics().num_draws : 0);
+
+  std::string row = fmt::format(
+    "{},{},{},{},{},{},{},{},{},{},{},{},{}", frame_number, cur.num_primitives - last.num_primitives,
+    cur.num_vertices - last.num_vertices, cur.num_batches - last.num_batches,
+    cur.num_batch_vertices - last.num_batch_vertices, cur.num_merged_batches - last.num_merged_batches,
+    host_num_draws - s_statistics_dump.last_host_num_draws, cur.num_reads - last.num_reads,
+    cur.num_writes - last.num_writes, cur.num_copies - last.num_copies, cur.num_fills - last.num_fills,
+    cur.num_texture_cache_hits - last.num_texture_cache_hits,
+    cur.num_texture_cache_misses - last.num_texture_cache_misses);
+  for (u32 i = 0; i < NUM_FLUSH_REASONS; i++)
+    fmt::format_to(std::back_inserter(row), ",{}", cur.num_flushes[i] - last.num_flushes[i]);
+  row.push_back('\n');
+  std::fwrite(row.data(), row.size(), 1, s_statistics_dump.fp.get());
+
+  s_last_dump_counters = cur;
+  s_statistics_dump.last_host_num_draws = host_num_draws;
+}
+
+void GPUBackend::AddCounters(Counters& dst, const Counters& src)
+{
+  dst.num_reads += src.num_reads;
+  dst.num_writes += src.num_writes;
+  dst.num_copies += src.num_copies;
+  dst.num_fills += src.num_fills;
+  dst.num_vertices += src.num_vertices;
+  dst.num_primitives += src.num_primitives;
+  dst.num_depth_buffer_clears += src.num_depth_buffer_clears;
+  dst.num_merged_batches += src.num_merged_batches;
+  dst.num_batches += src.num_batches;
+  dst.num_batch_vertices += src.num_batch_vertices;
+  dst.num_texture_cache_hits += src.num_texture_cache_hits;
+  dst.num_texture_cache_misses += src.num_texture_cache_misses;
+  for (u32 i = 0; i < NUM_FLUSH_REASONS; i++)
+    dst.num_flushes[i] += src.num_flushes[i];
+}
+
 void GPUBackend::ResetStatistics()
 {
+  // Keep running totals for the dump, otherwise anything counted since its last row would be lost.
+  if (!s_statistics_dump.path.empty())
+  {
+    AddCounters(s_dump_base_counters, s_counters);
+    if (g_gpu_device)
+      s_statistics_dump.base_host_num_draws += g_gpu_device->GetStatistics().num_draws;
+  }
+
   s_counters = {};
-  g_gpu_device->ResetStatistics();
+  if (g_gpu_device)
+    g_gpu_device->ResetStatistics();
 }
 
 void GPUBackend::UpdateStatistics(u32 frame_count)
 {
-  const GPUDevice::Statistics& stats = g_gpu_device->GetStatistics();
+  static constexpr GPUDevice::Statistics no_device_stats = {};
+  const GPUDevice::Statistics& stats = g_gpu_device ? g_gpu_device->GetStatistics() : no_device_stats;
   const u32 round = (frame_count - 1);
 
 #define UPDATE_COUNTER(x) s_stats.x = (s_counters.x + round) / frame_count
@@ -635,7 +795,15 @@ void GPUBackend::UpdateStatistics(u32 frame_count)
   UPDATE_COUNTER(num_copies);
   UPDATE_COUNTER(num_vertices);
   UPDATE_COUNTER(num_primitives);
+  UPDATE_COUNTER(num_fills);
   UPDATE_COUNTER(num_depth_buffer_clears);
+  UPDATE_COUNTER(num_merged_batches);
+  UPDATE_COUNTER(num_batches);
+  UPDATE_COUNTER(num_batch_vertices);
+  UPDATE_COUNTER(num_texture_cache_hits);
+  UPDATE_COUNTER(num_texture_cache_misses);
+  for (u32 i = 0; i < NUM_FLUSH_REASONS; i++)
+    UPDATE_COUNTER(num_flushes[i]);
 
   // UPDATE_COUNTER(num_read_texture_updates);
   // UPDATE_COUNTER(num_ubo_updates);
@@ -666,6 +834,12 @@ bool GPUBackend::RenderScreenshotToBuffer(u32 width, u32 height, bool postfx, bo
         result = false;
         return;
       }
+      else if (!g_gpu_device)
+      {
+        Error::SetStringView(error, "No GPU device.");
+        result = false;
+        return;
+      }
 
       // Post-processing requires that the size match the window.
       const bool really_postfx = postfx && g_gpu_device->HasMainSwapChain();
@@ -699,7 +873,7 @@ void GPUBackend::RenderScreenshotToFile(const std::string_view path, DisplayScre
 {
   GPUThread::RunOnBackend(
     [path = std::string(path), mode, quality, show_osd_message](GPUBackend* backend) mutable {
-      if (!backend)
+      if (!backend || !g_gpu_device)
         return;
 
       const GSVector2i size = backend->GetPresenter().CalculateScreenshotSize(mode);
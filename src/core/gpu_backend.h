@@ -7,7 +7,9 @@
 
 #include "gpu_thread_commands.h"
 
+#include <array>
 #include <memory>
+#include <string>
 
 class Error;
 class SmallStringBase;
@@ -24,12 +26,37 @@ namespace System {
 struct MemorySaveState;
 }
 
+namespace GPUThread {
+enum class SyncReason : u8;
+}
+
 // DESIGN NOTE: Only static methods should be called on the CPU thread.
 // You specifically don't have a global pointer available for this reason.
 
 class ALIGN_TO_CACHE_LINE GPUBackend
 {
 public:
+  /// Why a batch of primitives had to be ended and submitted to the host GPU.
+  enum class FlushReason : u8
+  {
+    TexturePageChange,
+    BlendingChange,
+    RenderStateChange,
+    VRAMWriteOverlap,
+    VRAMFill,
+    VRAMCopy,
+    VRAMWrite,
+    Readback,
+    DisplayUpdate,
+    DrawingAreaChange,
+    DepthBufferClear,
+    BufferFull,
+    Other,
+    MaxCount
+  };
+
+  static constexpr u32 NUM_FLUSH_REASONS = static_cast<u32>(FlushReason::MaxCount);
+
   static GPUThreadCommand* NewClearVRAMCommand();
   static GPUThreadCommand* NewClearDisplayCommand();
   static GPUBackendUpdateDisplayCommand* NewUpdateDisplayCommand();
@@ -49,8 +76,8 @@ public:
   static GPUBackendDrawPreciseLineCommand* NewDrawPreciseLineCommand(u32 num_vertices);
   static void PushCommand(GPUThreadCommand* cmd);
   static void PushCommandAndWakeThread(GPUThreadCommand* cmd);
-  static void PushCommandAndSync(GPUThreadCommand* cmd, bool spin);
-  static void SyncGPUThread(bool spin);
+  static void PushCommandAndSync(GPUThreadCommand* cmd, bool spin, GPUThread::SyncReason reason);
+  static void SyncGPUThread(bool spin, GPUThread::SyncReason reason);
 
   static bool IsUsingHardwareBackend();
 
@@ -81,6 +108,9 @@ public:
   virtual bool UpdateSettings(const GPUSettings& old_settings, Error* error);
   virtual void UpdatePostProcessingSettings(bool force_reload);
 
+  /// Called on the GPU thread when the running game changes.
+  virtual void GameSerialChanged();
+
   /// Returns the current resolution scale.
   virtual u32 GetResolutionScale() const = 0;
 
@@ -91,15 +121,27 @@ public:
   /// Ensures all pending draws are flushed to the host GPU.
   virtual void FlushRender() = 0;
 
+  /// Returns the size of the current display when it can be produced on the CPU, without the GPU device.
+  /// Only supported by the software renderer, returns false otherwise or when the display is disabled.
+  virtual bool GetCPUDisplaySize(u32* width, u32* height) const;
+
+  /// Writes the current display to a caller-provided RGBA8 buffer, scaling to the requested size if needed.
+  virtual bool RenderDisplayToBuffer(void* buffer, u32 pitch, u32 width, u32 height);
+
   /// Main command handler for GPU thread.
   void HandleCommand(const GPUThreadCommand* cmd);
 
   void GetStatsString(SmallStringBase& str) const;
   void GetMemoryStatsString(SmallStringBase& str) const;
 
+  void GetFlushStatsString(SmallStringBase& str) const;
+
   void ResetStatistics();
   void UpdateStatistics(u32 frame_count);
 
+  /// Writes renderer counters to a CSV file, one row per frame. Must be called before the backend is created.
+  static void SetStatisticsDumpPath(std::string path);
+
   /// Screen-aligned vertex type for various draw types.
   struct ScreenVertex
   {
@@ -131,9 +173,16 @@ protected:
     u32 num_reads;
     u32 num_writes;
     u32 num_copies;
+    u32 num_fills;
     u32 num_vertices;
     u32 num_primitives;
     u32 num_depth_buffer_clears;
+    u32 num_merged_batches;
+    u32 num_batches;
+    u32 num_batch_vertices;
+    u32 num_texture_cache_hits;
+    u32 num_texture_cache_misses;
+    std::array<u32, NUM_FLUSH_REASONS> num_flushes;
   };
 
   struct Stats : Counters
@@ -183,6 +232,13 @@ protected:
 
 private:
   static void ReleaseQueuedFrame();
+  static void WriteStatisticsDumpRow(u32 frame_number);
+  static void AddCounters(Counters& dst, const Counters& src);
+
+  // Counters from before the last ResetStatistics(), the dump adds these to s_counters so rows aren't affected by the
+  // overlay's update interval.
+  static Counters s_dump_base_counters;
+  static Counters s_last_dump_counters;
 };
 
 namespace Host {
@@ -5,6 +5,7 @@
 #include "gpu.h"
 #include "gpu_backend.h"
 #include "gpu_dump.h"
+#include "gpu_thread.h"
 #include "gpu_thread_commands.h"
 #include "interrupt_controller.h"
 #include "system.h"
@@ -1071,7 +1072,8 @@ bool GPU::HandleCopyRectangleVRAMToCPUCommand()
   DebugAssert(m_vram_transfer.col == 0 && m_vram_transfer.row == 0);
 
   // ensure VRAM shadow is up to date
-  ReadVRAM(m_vram_transfer.x, m_vram_transfer.y, m_vram_transfer.width, m_vram_transfer.height);
+  ReadVRAM(m_vram_transfer.x, m_vram_transfer.y, m_vram_transfer.width, m_vram_transfer.height,
+           GPUThread::SyncReason::VRAMReadback);
 
   if (g_settings.gpu_dump_vram_to_cpu_copies)
   {
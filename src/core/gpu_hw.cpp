@@ -8,6 +8,7 @@
 #include "gpu_hw_shadergen.h"
 #include "gpu_presenter.h"
 #include "gpu_sw_rasterizer.h"
+#include "gpu_thread.h"
 #include "gte_types.h"
 #include "host.h"
 #include "imgui_overlays.h"
@@ -22,10 +23,13 @@
 #include "common/align.h"
 #include "common/assert.h"
 #include "common/error.h"
+#include "common/file_system.h"
 #include "common/gsvector_formatter.h"
 #include "common/log.h"
+#include "common/path.h"
 #include "common/scoped_guard.h"
 #include "common/string_util.h"
+#include "common/task_queue.h"
 #include "common/timer.h"
 
 #include "IconsEmoji.h"
@@ -33,9 +37,13 @@
 #include "fmt/format.h"
 #include "imgui.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <limits>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <tuple>
 
 LOG_CHANNEL(GPU_HW);
@@ -133,27 +141,6 @@ ALWAYS_INLINE static bool IsBlendedTextureFiltering(GPUTextureFilter filter)
   return ((static_cast<u8>(filter) & 1u) == 1u);
 }
 
-/// Computes the area affected by a VRAM transfer, including wrap-around of X.
-ALWAYS_INLINE_RELEASE static GSVector4i GetVRAMTransferBounds(u32 x, u32 y, u32 width, u32 height)
-{
-  GSVector4i ret;
-  ret.left = x % VRAM_WIDTH;
-  ret.top = y % VRAM_HEIGHT;
-  ret.right = ret.left + width;
-  ret.bottom = ret.top + height;
-  if (ret.right > static_cast<s32>(VRAM_WIDTH))
-  {
-    ret.left = 0;
-    ret.right = static_cast<s32>(VRAM_WIDTH);
-  }
-  if (ret.bottom > static_cast<s32>(VRAM_HEIGHT))
-  {
-    ret.top = 0;
-    ret.bottom = static_cast<s32>(VRAM_HEIGHT);
-  }
-  return ret;
-}
-
 namespace {
 class ShaderCompileProgressTracker
 {
@@ -201,6 +188,116 @@ private:
   u32 m_progress;
   u32 m_total;
 };
+
+/// Generates and compiles shaders on worker threads when the device allows it, otherwise on the calling thread.
+/// Progress and cancellation are still handled on the calling thread.
+class ShaderCompileQueue
+{
+public:
+  using GenerateFunction = std::function<std::string()>;
+
+  static constexpr u32 MAX_WORKER_THREADS = 16;
+
+  explicit ShaderCompileQueue(ShaderCompileProgressTracker& progress) : m_progress(progress)
+  {
+    const u32 num_threads = std::min(std::thread::hardware_concurrency(), MAX_WORKER_THREADS);
+    m_threaded = (g_gpu_device->GetFeatures().concurrent_shader_compile && num_threads > 1);
+    if (m_threaded)
+      m_queue.SetWorkerCount(num_threads);
+  }
+
+  ~ShaderCompileQueue()
+  {
+    // Tasks reference the caller's shader arrays, make sure they're done before returning.
+    m_cancelled.store(true, std::memory_order_relaxed);
+    m_queue.WaitForAll();
+  }
+
+  bool Compile(std::unique_ptr<GPUShader>* dest, GPUShaderStage stage, GPUShaderLanguage language,
+               GenerateFunction generate, Error* error)
+  {
+    if (!m_threaded)
+    {
+      if (!(*dest = g_gpu_device->CreateShader(stage, language, generate(), error)))
+        return false;
+
+      return m_progress.Increment(1, error);
+    }
+
+    m_submitted++;
+    m_queue.SubmitTask([this, dest, stage, language, generate = std::move(generate)]() {
+      if (!m_cancelled.load(std::memory_order_relaxed))
+      {
+        Error task_error;
+        if (!(*dest = g_gpu_device->CreateShader(stage, language, generate(), &task_error)))
+        {
+          std::unique_lock lock(m_error_mutex);
+          if (!m_cancelled.exchange(true, std::memory_order_relaxed))
+            m_error = std::move(task_error);
+        }
+      }
+
+      m_completed.fetch_add(1, std::memory_order_release);
+    });
+
+    return UpdateProgress(error);
+  }
+
+  bool WaitForAll(Error* error)
+  {
+    if (!m_threaded)
+      return true;
+
+    while (m_completed.load(std::memory_order_acquire) != m_submitted)
+    {
+      if (!UpdateProgress(error))
+        return false;
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    m_queue.WaitForAll();
+    return UpdateProgress(error);
+  }
+
+private:
+  bool UpdateProgress(Error* error)
+  {
+    if (m_cancelled.load(std::memory_order_relaxed))
+      return GetWorkerError(error);
+
+    const u32 completed = m_completed.load(std::memory_order_acquire);
+    if (!m_progress.Increment(completed - std::exchange(m_reported, completed), error))
+    {
+      m_cancelled.store(true, std::memory_order_relaxed);
+      return false;
+    }
+
+    return true;
+  }
+
+  bool GetWorkerError(Error* error)
+  {
+    m_queue.WaitForAll();
+
+    std::unique_lock lock(m_error_mutex);
+    if (error)
+      *error = m_error;
+
+    return false;
+  }
+
+  ShaderCompileProgressTracker& m_progress;
+  TaskQueue m_queue;
+  std::mutex m_error_mutex;
+  Error m_error;
+  std::atomic<u32> m_completed{0};
+  std::atomic_bool m_cancelled{false};
+  u32 m_submitted = 0;
+  u32 m_reported = 0;
+  bool m_threaded = false;
+};
+
 } // namespace
 
 GPU_HW::GPU_HW(GPUPresenter& presenter) : GPUBackend(presenter)
@@ -212,6 +309,9 @@ GPU_HW::GPU_HW(GPUPresenter& presenter) : GPUBackend(presenter)
 
 GPU_HW::~GPU_HW()
 {
+  WaitForBatchShaderWarmup(true);
+  SaveBatchPipelineUsage();
+
   GPUTextureCache::Shutdown();
 }
 
@@ -440,6 +540,7 @@ bool GPU_HW::UpdateSettings(const GPUSettings& old_settings, Error* error)
     return false;
 
   FlushRender();
+  WaitForBatchShaderWarmup(true);
 
   const GPUDevice::Features features = g_gpu_device->GetFeatures();
 
@@ -469,7 +570,8 @@ bool GPU_HW::UpdateSettings(const GPUSettings& old_settings, Error* error)
       g_gpu_settings.gpu_pgxp_color_correction != old_settings.gpu_pgxp_color_correction) ||
      m_allow_sprite_mode != ShouldAllowSpriteMode(m_resolution_scale, g_gpu_settings.gpu_texture_filter,
                                                   g_gpu_settings.gpu_sprite_texture_filter) ||
-     (!old_settings.gpu_texture_cache && g_gpu_settings.gpu_texture_cache));
+     (!old_settings.gpu_texture_cache && g_gpu_settings.gpu_texture_cache) ||
+     g_gpu_settings.gpu_lazy_pipeline_creation != old_settings.gpu_lazy_pipeline_creation);
   const bool resolution_dependent_shaders_changed =
     (m_resolution_scale != resolution_scale || m_multisamples != multisamples);
   const bool downsampling_shaders_changed =
@@ -1044,6 +1146,9 @@ bool GPU_HW::CompileCommonShaders(Error* error)
 
 bool GPU_HW::CompilePipelines(Error* error)
 {
+  // Background compiles read the current configuration.
+  WaitForBatchShaderWarmup(true);
+
   const GPUDevice::Features features = g_gpu_device->GetFeatures();
   const bool upscaled = (m_resolution_scale > 1);
   const bool msaa = (m_multisamples > 1);
@@ -1093,6 +1198,21 @@ bool GPU_HW::CompilePipelines(Error* error)
   INFO_LOG("Using real depth buffer: {}", needs_real_depth_buffer ? "YES" : "NO");
   INFO_LOG("Using feedback loops: {}", needs_feedback_loop ? "YES" : "NO");
 
+  m_batch_shader_config = {.upscaled = upscaled,
+                           .msaa = msaa,
+                           .per_sample_shading = per_sample_shading,
+                           .force_round_texcoords = force_round_texcoords,
+                           .true_color = true_color,
+                           .scaled_dithering = scaled_dithering,
+                           .disable_color_perspective = disable_color_perspective,
+                           .needs_page_texture = needs_page_texture,
+                           .force_progressive_scan = force_progressive_scan,
+                           .needs_rov_depth = needs_rov_depth,
+                           .needs_real_depth_buffer = needs_real_depth_buffer,
+                           .needs_feedback_loop = needs_feedback_loop,
+                           .depth_buffer_format = depth_buffer_format};
+  m_lazy_batch_pipelines = g_gpu_settings.gpu_lazy_pipeline_creation;
+
   // Start generating shaders.
   const GPU_HW_ShaderGen shadergen(g_gpu_device->GetRenderAPI(), m_supports_dual_source_blend,
                                    m_supports_framebuffer_fetch);
@@ -1106,10 +1226,10 @@ bool GPU_HW::CompilePipelines(Error* error)
     ((m_allow_sprite_mode ? 7 : 4) - (BoolToUInt32(!needs_page_texture) * (BoolToUInt32(m_allow_sprite_mode) + 1)));
   const u32 total_fragment_shaders = ((1 + BoolToUInt32(needs_rov_depth)) * 5 * 5 * num_active_texture_modes * 2 *
                                       (1 + BoolToUInt32(!true_color)) * (1 + BoolToUInt32(!force_progressive_scan)));
+  const u32 total_batch_pipelines = ((m_pgxp_depth_buffer ? 2 : 1) * 5 * 5 * num_active_texture_modes * 2 *
+                                     (1 + BoolToUInt32(!true_color)) * (1 + BoolToUInt32(!force_progressive_scan)));
   const u32 total_items =
-    total_vertex_shaders + total_fragment_shaders +
-    ((m_pgxp_depth_buffer ? 2 : 1) * 5 * 5 * num_active_texture_modes * 2 * (1 + BoolToUInt32(!true_color)) *
-     (1 + BoolToUInt32(!force_progressive_scan))) +              // batch pipelines
+    (m_lazy_batch_pipelines ? 0 : (total_vertex_shaders + total_fragment_shaders + total_batch_pipelines)) +
     ((m_wireframe_mode != GPUWireframeMode::Disabled) ? 1 : 0) + // wireframe
     (2 * 2) +                                                    // vram fill
     (1 + BoolToUInt32(m_write_mask_as_depth)) +                  // vram copy
@@ -1118,8 +1238,11 @@ bool GPU_HW::CompilePipelines(Error* error)
     (m_write_mask_as_depth ? 1 : 0) +                            // mask -> depth
     1;                                                           // resolution dependent shaders
 
-  INFO_LOG("Compiling {} vertex shaders, {} fragment shaders, and {} pipelines.", total_vertex_shaders,
-           total_fragment_shaders, total_items);
+  if (m_lazy_batch_pipelines)
+    INFO_LOG("Batch pipelines will be created on demand, compiling {} pipelines.", total_items);
+  else
+    INFO_LOG("Compiling {} vertex shaders, {} fragment shaders, and {} pipelines.", total_vertex_shaders,
+             total_fragment_shaders, total_items);
 
   // destroy old pipelines, if any
   m_wireframe_pipeline.reset();
@@ -1133,347 +1256,213 @@ bool GPU_HW::CompilePipelines(Error* error)
   m_vram_write_replacement_pipeline.reset();
   m_clear_depth_pipeline.reset();
   m_copy_depth_pipeline.reset();
+  DestroyBatchShaders();
 
   ShaderCompileProgressTracker progress("Compiling Pipelines", total_items);
 
-  // vertex shaders - [textured/palette/sprite]
-  // fragment shaders - [depth_test][render_mode][transparency_mode][texture_mode][check_mask][dithering][interlacing]
-  static constexpr auto destroy_shader = [](std::unique_ptr<GPUShader>& s) { s.reset(); };
-  DimensionalArray<std::unique_ptr<GPUShader>, 2, 3, 2> batch_vertex_shaders{};
-  DimensionalArray<std::unique_ptr<GPUShader>, 2, 2, 2, NUM_TEXTURE_MODES, 5, 5, 2> batch_fragment_shaders{};
-  ScopedGuard batch_shader_guard([&batch_vertex_shaders, &batch_fragment_shaders]() {
-    batch_vertex_shaders.enumerate(destroy_shader);
-    batch_fragment_shaders.enumerate(destroy_shader);
+  // Batch shaders are kept around when pipelines are created lazily.
+  ScopedGuard batch_shader_guard([this]() {
+    if (!m_lazy_batch_pipelines)
+      DestroyBatchShaders();
   });
 
-  for (u8 textured = 0; textured < 2; textured++)
+  if (!m_lazy_batch_pipelines)
   {
-    for (u8 palette = 0; palette < 3; palette++)
-    {
-      if (palette && !textured)
-        continue;
-      if (palette == 2 && !needs_page_texture)
-        continue;
+    // Shader generation and compilation is independent for each permutation, so it can be done in parallel.
+    // Pipelines are still created on this thread, backends share render pass/layout caches between them.
+    ShaderCompileQueue compile_queue(progress);
 
-      for (u8 sprite = 0; sprite < 2; sprite++)
+    for (u8 textured = 0; textured < 2; textured++)
+    {
+      for (u8 palette = 0; palette < 3; palette++)
       {
-        if (sprite && (!textured || !m_allow_sprite_mode))
+        if (palette && !textured)
+          continue;
+        if (palette == 2 && !needs_page_texture)
           continue;
 
-        const bool uv_limits = ShouldClampUVs(sprite ? m_sprite_texture_filtering : m_texture_filtering);
-        const std::string vs = shadergen.GenerateBatchVertexShader(
-          upscaled, msaa, per_sample_shading, textured != 0, palette == 1, palette == 2, uv_limits,
-          !sprite && force_round_texcoords, m_pgxp_depth_buffer, disable_color_perspective);
-        if (!(batch_vertex_shaders[textured][palette][sprite] =
-                g_gpu_device->CreateShader(GPUShaderStage::Vertex, shadergen.GetLanguage(), vs, error)))
+        for (u8 sprite = 0; sprite < 2; sprite++)
         {
-          return false;
-        }
+          if (sprite && (!textured || !m_allow_sprite_mode))
+            continue;
 
-        if (!progress.Increment(1, error)) [[unlikely]]
-          return false;
+          if (!compile_queue.Compile(&m_batch_vertex_shaders[textured][palette][sprite], GPUShaderStage::Vertex,
+                                     shadergen.GetLanguage(),
+                                     [this, shadergen, textured, palette, sprite]() {
+                                       return GenerateBatchVertexShader(shadergen, textured, palette, sprite);
+                                     },
+                                     error)) [[unlikely]]
+          {
+            return false;
+          }
+        }
       }
     }
-  }
 
-  for (u8 depth_test = 0; depth_test < 2; depth_test++)
-  {
-    if (depth_test && !needs_rov_depth)
+    for (u8 depth_test = 0; depth_test < 2; depth_test++)
     {
-      // Don't need to do depth testing in the shader.
-      continue;
-    }
+      if (depth_test && !needs_rov_depth)
+      {
+        // Don't need to do depth testing in the shader.
+        continue;
+      }
 
-    for (u8 render_mode = 0; render_mode < 5; render_mode++)
-    {
-      for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
+      for (u8 render_mode = 0; render_mode < 5; render_mode++)
       {
-        if (
-          // Can't generate shader blending.
-          ((render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend) && !m_allow_shader_blend) ||
-           (render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend) &&
-            transparency_mode != static_cast<u8>(GPUTransparencyMode::Disabled))) ||
-          // Don't need multipass shaders if we're preferring shader blend or have (free) FBFetch.
-          ((m_supports_framebuffer_fetch || m_prefer_shader_blend) &&
-           (render_mode == static_cast<u8>(BatchRenderMode::OnlyOpaque) ||
-            render_mode == static_cast<u8>(BatchRenderMode::OnlyTransparent))) ||
-          // If using ROV depth, we only draw with shader blending.
-          (needs_rov_depth && render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend)))
+        for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
         {
-          if (!progress.Increment(num_active_texture_modes * 2 * (1 + BoolToUInt32(!true_color)) *
-                                    (1 + BoolToUInt32(!force_progressive_scan)),
-                                  error)) [[unlikely]]
+          if (
+            // Can't generate shader blending.
+            ((render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend) && !m_allow_shader_blend) ||
+             (render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend) &&
+              transparency_mode != static_cast<u8>(GPUTransparencyMode::Disabled))) ||
+            // Don't need multipass shaders if we're preferring shader blend or have (free) FBFetch.
+            ((m_supports_framebuffer_fetch || m_prefer_shader_blend) &&
+             (render_mode == static_cast<u8>(BatchRenderMode::OnlyOpaque) ||
+              render_mode == static_cast<u8>(BatchRenderMode::OnlyTransparent))) ||
+            // If using ROV depth, we only draw with shader blending.
+            (needs_rov_depth && render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend)))
           {
-            return false;
-          }
-
-          continue;
-        }
+            if (!progress.Increment(num_active_texture_modes * 2 * (1 + BoolToUInt32(!true_color)) *
+                                      (1 + BoolToUInt32(!force_progressive_scan)),
+                                    error)) [[unlikely]]
+            {
+              return false;
+            }
 
-        for (u8 texture_mode = 0; texture_mode < max_active_texture_modes; texture_mode++)
-        {
-          if (!needs_page_texture && (texture_mode == static_cast<u8>(BatchTextureMode::PageTexture) ||
-                                      texture_mode == static_cast<u8>(BatchTextureMode::SpritePageTexture)))
-          {
             continue;
           }
 
-          for (u8 check_mask = 0; check_mask < 2; check_mask++)
+          for (u8 texture_mode = 0; texture_mode < max_active_texture_modes; texture_mode++)
           {
-            if (check_mask && render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend))
+            if (!needs_page_texture && (texture_mode == static_cast<u8>(BatchTextureMode::PageTexture) ||
+                                        texture_mode == static_cast<u8>(BatchTextureMode::SpritePageTexture)))
             {
-              // mask bit testing is only valid with shader blending.
-              if (!progress.Increment((1 + BoolToUInt32(!true_color)) * (1 + BoolToUInt32(!force_progressive_scan)),
-                                      error)) [[unlikely]]
-              {
-                return false;
-              }
-
               continue;
             }
 
-            for (u8 dithering = 0; dithering < 2; dithering++)
+            for (u8 check_mask = 0; check_mask < 2; check_mask++)
             {
-              // Never going to draw with dithering on in true color.
-              if (dithering && true_color)
+              if (check_mask && render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend))
+              {
+                // mask bit testing is only valid with shader blending.
+                if (!progress.Increment((1 + BoolToUInt32(!true_color)) * (1 + BoolToUInt32(!force_progressive_scan)),
+                                        error)) [[unlikely]]
+                {
+                  return false;
+                }
+
                 continue;
+              }
 
-              for (u8 interlacing = 0; interlacing < 2; interlacing++)
+              for (u8 dithering = 0; dithering < 2; dithering++)
               {
-                // Never going to draw with line skipping in force progressive.
-                if (interlacing && force_progressive_scan)
+                // Never going to draw with dithering on in true color.
+                if (dithering && true_color)
                   continue;
 
-                const bool sprite = (static_cast<BatchTextureMode>(texture_mode) >= BatchTextureMode::SpriteStart);
-                const bool uv_limits = ShouldClampUVs(sprite ? m_sprite_texture_filtering : m_texture_filtering);
-                const BatchTextureMode shader_texmode = static_cast<BatchTextureMode>(
-                  texture_mode - (sprite ? static_cast<u8>(BatchTextureMode::SpriteStart) : 0));
-                const bool use_rov =
-                  (render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend) && m_use_rov_for_shader_blend);
-                const bool rov_depth_test = (use_rov && depth_test != 0);
-                const bool rov_depth_write = (rov_depth_test && static_cast<GPUTransparencyMode>(transparency_mode) ==
-                                                                  GPUTransparencyMode::Disabled);
-                const std::string fs = shadergen.GenerateBatchFragmentShader(
-                  static_cast<BatchRenderMode>(render_mode), static_cast<GPUTransparencyMode>(transparency_mode),
-                  shader_texmode, sprite ? m_sprite_texture_filtering : m_texture_filtering, upscaled, msaa,
-                  per_sample_shading, uv_limits, !sprite && force_round_texcoords, true_color,
-                  ConvertToBoolUnchecked(dithering), scaled_dithering, disable_color_perspective,
-                  ConvertToBoolUnchecked(interlacing), ConvertToBoolUnchecked(check_mask), m_write_mask_as_depth,
-                  use_rov, needs_rov_depth, rov_depth_test, rov_depth_write);
-
-                if (!(batch_fragment_shaders[depth_test][render_mode][transparency_mode][texture_mode][check_mask]
-                                            [dithering][interlacing] = g_gpu_device->CreateShader(
-                                              GPUShaderStage::Fragment, shadergen.GetLanguage(), fs, error)))
+                for (u8 interlacing = 0; interlacing < 2; interlacing++)
                 {
-                  return false;
+                  // Never going to draw with line skipping in force progressive.
+                  if (interlacing && force_progressive_scan)
+                    continue;
+
+                  if (!compile_queue.Compile(
+                        &m_batch_fragment_shaders[depth_test][render_mode][transparency_mode][texture_mode][check_mask]
+                                                 [dithering][interlacing],
+                        GPUShaderStage::Fragment, shadergen.GetLanguage(),
+                        [this, shadergen, depth_test, render_mode, transparency_mode, texture_mode, check_mask,
+                         dithering, interlacing]() {
+                          return GenerateBatchFragmentShader(shadergen, depth_test, render_mode, transparency_mode,
+                                                             texture_mode, check_mask, dithering, interlacing);
+                        },
+                        error)) [[unlikely]]
+                  {
+                    return false;
+                  }
                 }
-
-                if (!progress.Increment(1, error)) [[unlikely]]
-                  return false;
               }
             }
           }
         }
       }
     }
-  }
 
-  static constexpr GPUPipeline::VertexAttribute vertex_attributes[] = {
-    GPUPipeline::VertexAttribute::Make(0, GPUPipeline::VertexAttribute::Semantic::Position, 0,
-                                       GPUPipeline::VertexAttribute::Type::Float, 4, OFFSETOF(BatchVertex, x)),
-    GPUPipeline::VertexAttribute::Make(1, GPUPipeline::VertexAttribute::Semantic::Color, 0,
-                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, OFFSETOF(BatchVertex, color)),
-    GPUPipeline::VertexAttribute::Make(2, GPUPipeline::VertexAttribute::Semantic::TexCoord, 0,
-                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, OFFSETOF(BatchVertex, u)),
-    GPUPipeline::VertexAttribute::Make(3, GPUPipeline::VertexAttribute::Semantic::TexCoord, 1,
-                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, OFFSETOF(BatchVertex, texpage)),
-    GPUPipeline::VertexAttribute::Make(4, GPUPipeline::VertexAttribute::Semantic::TexCoord, 2,
-                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, OFFSETOF(BatchVertex, uv_limits)),
-  };
-  static constexpr u32 NUM_BATCH_VERTEX_ATTRIBUTES = 2;
-  static constexpr u32 NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES = 4;
-  static constexpr u32 NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES = 5;
-
-  GPUPipeline::GraphicsConfig plconfig = {};
-  plconfig.layout = GPUPipeline::Layout::SingleTextureAndUBO;
-  plconfig.input_layout.vertex_stride = sizeof(BatchVertex);
-  plconfig.rasterization = GPUPipeline::RasterizationState::GetNoCullState();
-  plconfig.primitive = GPUPipeline::Primitive::Triangles;
-  plconfig.geometry_shader = nullptr;
-  plconfig.samples = m_multisamples;
-  plconfig.per_sample_shading = per_sample_shading;
-  plconfig.depth = GPUPipeline::DepthState::GetNoTestsState();
+    if (!compile_queue.WaitForAll(error))
+      return false;
 
-  // [depth_test][transparency_mode][render_mode][texture_mode][dithering][interlacing][check_mask]
-  for (u8 depth_test = 0; depth_test < 2; depth_test++)
-  {
-    if (depth_test && !m_pgxp_depth_buffer)
+    // [depth_test][transparency_mode][render_mode][texture_mode][dithering][interlacing][check_mask]
+    for (u8 depth_test = 0; depth_test < 2; depth_test++)
     {
-      // Not used.
-      continue;
-    }
+      if (depth_test && !m_pgxp_depth_buffer)
+      {
+        // Not used.
+        continue;
+      }
 
-    for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
-    {
-      for (u8 render_mode = 0; render_mode < 5; render_mode++)
+      for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
       {
-        if (
-          // Can't generate shader blending.
-          (render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend) && !m_allow_shader_blend) ||
-          // Don't need multipass shaders.
-          ((m_supports_framebuffer_fetch || m_prefer_shader_blend) &&
-           (render_mode == static_cast<u8>(BatchRenderMode::OnlyOpaque) ||
-            render_mode == static_cast<u8>(BatchRenderMode::OnlyTransparent))) ||
-          // If using ROV depth, we only draw with shader blending.
-          (needs_rov_depth && render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend)))
+        for (u8 render_mode = 0; render_mode < 5; render_mode++)
         {
-          if (!progress.Increment(num_active_texture_modes * 2 * (1 + BoolToUInt32(!true_color)) *
-                                    (1 + BoolToUInt32(!force_progressive_scan)),
-                                  error)) [[unlikely]]
+          if (
+            // Can't generate shader blending.
+            (render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend) && !m_allow_shader_blend) ||
+            // Don't need multipass shaders.
+            ((m_supports_framebuffer_fetch || m_prefer_shader_blend) &&
+             (render_mode == static_cast<u8>(BatchRenderMode::OnlyOpaque) ||
+              render_mode == static_cast<u8>(BatchRenderMode::OnlyTransparent))) ||
+            // If using ROV depth, we only draw with shader blending.
+            (needs_rov_depth && render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend)))
           {
-            return false;
-          }
-
-          continue;
-        }
+            if (!progress.Increment(num_active_texture_modes * 2 * (1 + BoolToUInt32(!true_color)) *
+                                      (1 + BoolToUInt32(!force_progressive_scan)),
+                                    error)) [[unlikely]]
+            {
+              return false;
+            }
 
-        for (u8 texture_mode = 0; texture_mode < max_active_texture_modes; texture_mode++)
-        {
-          if (!needs_page_texture && (texture_mode == static_cast<u8>(BatchTextureMode::PageTexture) ||
-                                      texture_mode == static_cast<u8>(BatchTextureMode::SpritePageTexture)))
-          {
             continue;
           }
 
-          for (u8 dithering = 0; dithering < 2; dithering++)
+          for (u8 texture_mode = 0; texture_mode < max_active_texture_modes; texture_mode++)
           {
-            // Never going to draw with dithering on in true color.
-            if (dithering && true_color)
+            if (!needs_page_texture && (texture_mode == static_cast<u8>(BatchTextureMode::PageTexture) ||
+                                        texture_mode == static_cast<u8>(BatchTextureMode::SpritePageTexture)))
+            {
               continue;
+            }
 
-            for (u8 interlacing = 0; interlacing < 2; interlacing++)
+            for (u8 dithering = 0; dithering < 2; dithering++)
             {
-              // Never going to draw with line skipping in force progressive.
-              if (interlacing && force_progressive_scan)
+              // Never going to draw with dithering on in true color.
+              if (dithering && true_color)
                 continue;
 
-              for (u8 check_mask = 0; check_mask < 2; check_mask++)
+              for (u8 interlacing = 0; interlacing < 2; interlacing++)
               {
-                const bool textured = (static_cast<BatchTextureMode>(texture_mode) != BatchTextureMode::Disabled);
-                const bool palette =
-                  (static_cast<BatchTextureMode>(texture_mode) == BatchTextureMode::Palette4Bit ||
-                   static_cast<BatchTextureMode>(texture_mode) == BatchTextureMode::Palette8Bit ||
-                   static_cast<BatchTextureMode>(texture_mode) == BatchTextureMode::SpritePalette4Bit ||
-                   static_cast<BatchTextureMode>(texture_mode) == BatchTextureMode::SpritePalette8Bit);
-                const bool page_texture =
-                  (static_cast<BatchTextureMode>(texture_mode) == BatchTextureMode::PageTexture ||
-                   static_cast<BatchTextureMode>(texture_mode) == BatchTextureMode::SpritePageTexture);
-                const bool sprite = (static_cast<BatchTextureMode>(texture_mode) >= BatchTextureMode::SpriteStart);
-                const bool uv_limits = ShouldClampUVs(sprite ? m_sprite_texture_filtering : m_texture_filtering);
-                const bool use_shader_blending = (render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend));
-                const bool use_rov = (use_shader_blending && m_use_rov_for_shader_blend);
-                plconfig.input_layout.vertex_attributes =
-                  textured ?
-                    (uv_limits ? std::span<const GPUPipeline::VertexAttribute>(
-                                   vertex_attributes, NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES) :
-                                 std::span<const GPUPipeline::VertexAttribute>(vertex_attributes,
-                                                                               NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES)) :
-                    std::span<const GPUPipeline::VertexAttribute>(vertex_attributes, NUM_BATCH_VERTEX_ATTRIBUTES);
-
-                plconfig.vertex_shader =
-                  batch_vertex_shaders[BoolToUInt8(textured)][page_texture ? 2 : BoolToUInt8(palette)]
-                                      [BoolToUInt8(sprite)]
-                                        .get();
-                plconfig.fragment_shader =
-                  batch_fragment_shaders[BoolToUInt8(depth_test && needs_rov_depth)][render_mode]
-                                        [use_shader_blending ? transparency_mode :
-                                                               static_cast<u8>(GPUTransparencyMode::Disabled)]
-                                        [texture_mode][use_shader_blending ? check_mask : 0][dithering][interlacing]
-                                          .get();
-                Assert(plconfig.vertex_shader && plconfig.fragment_shader);
-
-                if (needs_real_depth_buffer)
-                {
-                  plconfig.depth.depth_test =
-                    m_pgxp_depth_buffer ?
-                      (depth_test ? GPUPipeline::DepthFunc::LessEqual : GPUPipeline::DepthFunc::Always) :
-                      (check_mask ? GPUPipeline::DepthFunc::GreaterEqual : GPUPipeline::DepthFunc::Always);
-
-                  // Don't write for transparent, but still test.
-                  plconfig.depth.depth_write =
-                    !m_pgxp_depth_buffer ||
-                    (depth_test && transparency_mode == static_cast<u8>(GPUTransparencyMode::Disabled));
-                }
-
-                plconfig.SetTargetFormats(use_rov ? GPUTexture::Format::Unknown : VRAM_RT_FORMAT,
-                                          needs_rov_depth ? GPUTexture::Format::Unknown : depth_buffer_format);
-                plconfig.color_formats[1] = needs_rov_depth ? VRAM_DS_COLOR_FORMAT : GPUTexture::Format::Unknown;
-                plconfig.render_pass_flags =
-                  use_rov ? GPUPipeline::BindRenderTargetsAsImages :
-                            (needs_feedback_loop ? GPUPipeline::ColorFeedbackLoop : GPUPipeline::NoRenderPassFlags);
-
-                plconfig.blend = GPUPipeline::BlendState::GetNoBlendingState();
+                // Never going to draw with line skipping in force progressive.
+                if (interlacing && force_progressive_scan)
+                  continue;
 
-                if (use_rov)
-                {
-                  plconfig.blend.write_mask = 0;
-                }
-                else if (!use_shader_blending &&
-                         ((static_cast<GPUTransparencyMode>(transparency_mode) != GPUTransparencyMode::Disabled &&
-                           (static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                            static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)) ||
-                          (textured &&
-                           IsBlendedTextureFiltering(sprite ? m_sprite_texture_filtering : m_texture_filtering))))
+                for (u8 check_mask = 0; check_mask < 2; check_mask++)
                 {
-                  plconfig.blend.enable = true;
-                  plconfig.blend.src_alpha_blend = GPUPipeline::BlendFunc::One;
-                  plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::Zero;
-                  plconfig.blend.alpha_blend_op = GPUPipeline::BlendOp::Add;
-
-                  if (m_supports_dual_source_blend)
+                  BatchPipelineKey key = {};
+                  key.depth_test = ConvertToBoolUnchecked(depth_test);
+                  key.transparency_mode = transparency_mode;
+                  key.render_mode = render_mode;
+                  key.texture_mode = texture_mode;
+                  key.dithering = ConvertToBoolUnchecked(dithering);
+                  key.interlacing = ConvertToBoolUnchecked(interlacing);
+                  key.check_mask = ConvertToBoolUnchecked(check_mask);
+                  if (!(m_batch_pipelines[depth_test][transparency_mode][render_mode][texture_mode][dithering]
+                                         [interlacing][check_mask] = CreateBatchPipeline(key, error)))
                   {
-                    plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
-                    plconfig.blend.dst_blend = GPUPipeline::BlendFunc::SrcAlpha1;
-                    plconfig.blend.blend_op =
-                      (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                         GPUTransparencyMode::BackgroundMinusForeground &&
-                       static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                       static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
-                        GPUPipeline::BlendOp::ReverseSubtract :
-                        GPUPipeline::BlendOp::Add;
+                    return false;
                   }
-                  else
-                  {
-                    // TODO: This isn't entirely accurate, 127.5 versus 128.
-                    // But if we use fbfetch on Mali, it doesn't matter.
-                    plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
-                    plconfig.blend.dst_blend = GPUPipeline::BlendFunc::One;
-                    if (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                        GPUTransparencyMode::HalfBackgroundPlusHalfForeground)
-                    {
-                      plconfig.blend.dst_blend = GPUPipeline::BlendFunc::ConstantColor;
-                      plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::ConstantColor;
-                      plconfig.blend.constant = 0x00808080u;
-                    }
-
-                    plconfig.blend.blend_op =
-                      (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                         GPUTransparencyMode::BackgroundMinusForeground &&
-                       static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                       static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
-                        GPUPipeline::BlendOp::ReverseSubtract :
-                        GPUPipeline::BlendOp::Add;
-                  }
-                }
 
-                if (!(m_batch_pipelines[depth_test][transparency_mode][render_mode][texture_mode][dithering]
-                                       [interlacing][check_mask] = g_gpu_device->CreatePipeline(plconfig, error)))
-                {
-                  return false;
+                  if (!progress.Increment(1, error)) [[unlikely]]
+                    return false;
                 }
-
-                if (!progress.Increment(1, error)) [[unlikely]]
-                  return false;
               }
             }
           }
@@ -1482,29 +1471,40 @@ bool GPU_HW::CompilePipelines(Error* error)
     }
   }
 
+  GPUPipeline::GraphicsConfig plconfig = {};
+  plconfig.layout = GPUPipeline::Layout::SingleTextureAndUBO;
+  plconfig.input_layout.vertex_stride = sizeof(BatchVertex);
+  plconfig.rasterization = GPUPipeline::RasterizationState::GetNoCullState();
+  plconfig.primitive = GPUPipeline::Primitive::Triangles;
+  plconfig.geometry_shader = nullptr;
+  plconfig.samples = m_multisamples;
+  plconfig.per_sample_shading = per_sample_shading;
+  plconfig.depth = GPUPipeline::DepthState::GetNoTestsState();
   plconfig.SetTargetFormats(VRAM_RT_FORMAT, needs_rov_depth ? GPUTexture::Format::Unknown : depth_buffer_format);
   plconfig.render_pass_flags = needs_feedback_loop ? GPUPipeline::ColorFeedbackLoop : GPUPipeline::NoRenderPassFlags;
 
   if (m_wireframe_mode != GPUWireframeMode::Disabled)
   {
+    BatchPipelineKey vs_key = {};
+    vs_key.texture_mode = static_cast<u8>(BatchTextureMode::Disabled);
+    GPUShader* vs = GetBatchVertexShader(vs_key, error);
     std::unique_ptr<GPUShader> gs = g_gpu_device->CreateShader(GPUShaderStage::Geometry, shadergen.GetLanguage(),
                                                                shadergen.GenerateWireframeGeometryShader(), error);
     std::unique_ptr<GPUShader> fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment, shadergen.GetLanguage(),
                                                                shadergen.GenerateWireframeFragmentShader(), error);
-    if (!gs || !fs)
+    if (!vs || !gs || !fs)
       return false;
 
     GL_OBJECT_NAME(gs, "Batch Wireframe Geometry Shader");
     GL_OBJECT_NAME(fs, "Batch Wireframe Fragment Shader");
 
-    plconfig.input_layout.vertex_attributes =
-      std::span<const GPUPipeline::VertexAttribute>(vertex_attributes, NUM_BATCH_VERTEX_ATTRIBUTES);
+    plconfig.input_layout.vertex_attributes = GetBatchVertexAttributes(false, false);
     plconfig.blend = (m_wireframe_mode == GPUWireframeMode::OverlayWireframe) ?
                        GPUPipeline::BlendState::GetAlphaBlendingState() :
                        GPUPipeline::BlendState::GetNoBlendingState();
     plconfig.blend.write_mask = 0x7;
     plconfig.depth = GPUPipeline::DepthState::GetNoTestsState();
-    plconfig.vertex_shader = batch_vertex_shaders[0][0][0].get();
+    plconfig.vertex_shader = vs;
     plconfig.geometry_shader = gs.get();
     plconfig.fragment_shader = fs.get();
 
@@ -1713,9 +1713,522 @@ bool GPU_HW::CompilePipelines(Error* error)
 #undef UPDATE_PROGRESS
 
   INFO_LOG("Pipeline creation took {:.2f} ms.", progress.GetElapsedMilliseconds());
+
+  if (m_lazy_batch_pipelines)
+    StartBatchPipelineWarmup();
+
   return true;
 }
 
+std::span<const GPUPipeline::VertexAttribute> GPU_HW::GetBatchVertexAttributes(bool textured, bool uv_limits)
+{
+  static constexpr GPUPipeline::VertexAttribute vertex_attributes[] = {
+    GPUPipeline::VertexAttribute::Make(0, GPUPipeline::VertexAttribute::Semantic::Position, 0,
+                                       GPUPipeline::VertexAttribute::Type::Float, 4, OFFSETOF(BatchVertex, x)),
+    GPUPipeline::VertexAttribute::Make(1, GPUPipeline::VertexAttribute::Semantic::Color, 0,
+                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, OFFSETOF(BatchVertex, color)),
+    GPUPipeline::VertexAttribute::Make(2, GPUPipeline::VertexAttribute::Semantic::TexCoord, 0,
+                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, OFFSETOF(BatchVertex, u)),
+    GPUPipeline::VertexAttribute::Make(3, GPUPipeline::VertexAttribute::Semantic::TexCoord, 1,
+                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, OFFSETOF(BatchVertex, texpage)),
+    GPUPipeline::VertexAttribute::Make(4, GPUPipeline::VertexAttribute::Semantic::TexCoord, 2,
+                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, OFFSETOF(BatchVertex, uv_limits)),
+  };
+  static constexpr u32 NUM_BATCH_VERTEX_ATTRIBUTES = 2;
+  static constexpr u32 NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES = 4;
+  static constexpr u32 NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES = 5;
+
+  return std::span<const GPUPipeline::VertexAttribute>(
+    vertex_attributes, textured ? (uv_limits ? NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES :
+                                               NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES) :
+                                  NUM_BATCH_VERTEX_ATTRIBUTES);
+}
+
+std::string GPU_HW::GenerateBatchVertexShader(const GPU_HW_ShaderGen& shadergen, u8 textured, u8 palette,
+                                              u8 sprite) const
+{
+  const BatchShaderConfig& cfg = m_batch_shader_config;
+  const bool uv_limits = ShouldClampUVs(sprite ? m_sprite_texture_filtering : m_texture_filtering);
+  return shadergen.GenerateBatchVertexShader(cfg.upscaled, cfg.msaa, cfg.per_sample_shading, textured != 0,
+                                             palette == 1, palette == 2, uv_limits,
+                                             !sprite && cfg.force_round_texcoords, m_pgxp_depth_buffer,
+                                             cfg.disable_color_perspective);
+}
+
+std::string GPU_HW::GenerateBatchFragmentShader(const GPU_HW_ShaderGen& shadergen, u8 depth_test, u8 render_mode,
+                                                u8 transparency_mode, u8 texture_mode, u8 check_mask, u8 dithering,
+                                                u8 interlacing) const
+{
+  const BatchShaderConfig& cfg = m_batch_shader_config;
+  const bool sprite = (static_cast<BatchTextureMode>(texture_mode) >= BatchTextureMode::SpriteStart);
+  const bool uv_limits = ShouldClampUVs(sprite ? m_sprite_texture_filtering : m_texture_filtering);
+  const BatchTextureMode shader_texmode =
+    static_cast<BatchTextureMode>(texture_mode - (sprite ? static_cast<u8>(BatchTextureMode::SpriteStart) : 0));
+  const bool use_rov = (render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend) && m_use_rov_for_shader_blend);
+  const bool rov_depth_test = (use_rov && depth_test != 0);
+  const bool rov_depth_write =
+    (rov_depth_test && static_cast<GPUTransparencyMode>(transparency_mode) == GPUTransparencyMode::Disabled);
+  const GPUTextureFilter texture_filter = sprite ? m_sprite_texture_filtering : m_texture_filtering;
+  return shadergen.GenerateBatchFragmentShader(
+    static_cast<BatchRenderMode>(render_mode), static_cast<GPUTransparencyMode>(transparency_mode), shader_texmode,
+    texture_filter, cfg.upscaled, cfg.msaa, cfg.per_sample_shading, uv_limits, !sprite && cfg.force_round_texcoords,
+    cfg.true_color, ConvertToBoolUnchecked(dithering), cfg.scaled_dithering, cfg.disable_color_perspective,
+    ConvertToBoolUnchecked(interlacing), ConvertToBoolUnchecked(check_mask), m_write_mask_as_depth, use_rov,
+    cfg.needs_rov_depth, rov_depth_test, rov_depth_write);
+}
+
+GPU_HW::BatchPipelineKey GPU_HW::GetBatchVertexShaderKey(BatchPipelineKey key)
+{
+  // Vertex shaders only depend on whether the texture mode is textured, paletted or a sprite. Both palette depths
+  // share a shader, so canonicalize them, otherwise warm-up would compile the same shader slot concurrently.
+  BatchTextureMode texture_mode = static_cast<BatchTextureMode>(key.texture_mode.GetValue());
+  if (texture_mode == BatchTextureMode::Palette8Bit)
+    texture_mode = BatchTextureMode::Palette4Bit;
+  else if (texture_mode == BatchTextureMode::SpritePalette8Bit)
+    texture_mode = BatchTextureMode::SpritePalette4Bit;
+
+  BatchPipelineKey ret = {};
+  ret.texture_mode = static_cast<u8>(texture_mode);
+  return ret;
+}
+
+GPU_HW::BatchPipelineKey GPU_HW::GetBatchFragmentShaderKey(BatchPipelineKey key) const
+{
+  // Only shader blending uses the transparency mode/mask bit in the shader, and depth testing is only needed for ROV.
+  const bool use_shader_blending = (key.render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend));
+  BatchPipelineKey ret = {};
+  ret.depth_test = (key.depth_test && m_batch_shader_config.needs_rov_depth);
+  ret.render_mode = key.render_mode.GetValue();
+  ret.transparency_mode =
+    use_shader_blending ? key.transparency_mode.GetValue() : static_cast<u8>(GPUTransparencyMode::Disabled);
+  ret.texture_mode = key.texture_mode.GetValue();
+  ret.check_mask = (use_shader_blending && key.check_mask);
+  ret.dithering = key.dithering.GetValue();
+  ret.interlacing = key.interlacing.GetValue();
+  return ret;
+}
+
+GPUShader* GPU_HW::GetBatchVertexShader(BatchPipelineKey key, Error* error)
+{
+  const BatchTextureMode texture_mode = static_cast<BatchTextureMode>(key.texture_mode.GetValue());
+  const u8 textured = BoolToUInt8(texture_mode != BatchTextureMode::Disabled);
+  const u8 palette = (texture_mode == BatchTextureMode::PageTexture ||
+                      texture_mode == BatchTextureMode::SpritePageTexture) ?
+                       2 :
+                       BoolToUInt8(texture_mode == BatchTextureMode::Palette4Bit ||
+                                   texture_mode == BatchTextureMode::Palette8Bit ||
+                                   texture_mode == BatchTextureMode::SpritePalette4Bit ||
+                                   texture_mode == BatchTextureMode::SpritePalette8Bit);
+  const u8 sprite = BoolToUInt8(texture_mode >= BatchTextureMode::SpriteStart);
+
+  std::unique_ptr<GPUShader>& shader = m_batch_vertex_shaders[textured][palette][sprite];
+  {
+    const std::unique_lock lock(m_batch_shader_mutex);
+    if (shader)
+      return shader.get();
+  }
+
+  const GPU_HW_ShaderGen shadergen(g_gpu_device->GetRenderAPI(), m_supports_dual_source_blend,
+                                   m_supports_framebuffer_fetch);
+  return PublishBatchShader(shader,
+                            g_gpu_device->CreateShader(GPUShaderStage::Vertex, shadergen.GetLanguage(),
+                                                       GenerateBatchVertexShader(shadergen, textured, palette, sprite),
+                                                       error));
+}
+
+GPUShader* GPU_HW::GetBatchFragmentShader(BatchPipelineKey key, Error* error)
+{
+  const BatchPipelineKey fs_key = GetBatchFragmentShaderKey(key);
+  const u8 depth_test = BoolToUInt8(fs_key.depth_test);
+  const u8 render_mode = fs_key.render_mode;
+  const u8 transparency_mode = fs_key.transparency_mode;
+  const u8 texture_mode = fs_key.texture_mode;
+  const u8 check_mask = BoolToUInt8(fs_key.check_mask);
+  const u8 dithering = BoolToUInt8(fs_key.dithering);
+  const u8 interlacing = BoolToUInt8(fs_key.interlacing);
+
+  std::unique_ptr<GPUShader>& shader =
+    m_batch_fragment_shaders[depth_test][render_mode][transparency_mode][texture_mode][check_mask][dithering]
+                            [interlacing];
+  {
+    const std::unique_lock lock(m_batch_shader_mutex);
+    if (shader)
+      return shader.get();
+  }
+
+  const GPU_HW_ShaderGen shadergen(g_gpu_device->GetRenderAPI(), m_supports_dual_source_blend,
+                                   m_supports_framebuffer_fetch);
+  return PublishBatchShader(shader, g_gpu_device->CreateShader(
+                                      GPUShaderStage::Fragment, shadergen.GetLanguage(),
+                                      GenerateBatchFragmentShader(shadergen, depth_test, render_mode, transparency_mode,
+                                                                  texture_mode, check_mask, dithering, interlacing),
+                                      error));
+}
+
+GPUShader* GPU_HW::PublishBatchShader(std::unique_ptr<GPUShader>& slot, std::unique_ptr<GPUShader> shader)
+{
+  if (!shader)
+    return nullptr;
+
+  // The GPU thread and the warm-up queue can both compile the same shader, keep whichever finished first.
+  const std::unique_lock lock(m_batch_shader_mutex);
+  if (!slot)
+    slot = std::move(shader);
+
+  return slot.get();
+}
+
+bool GPU_HW::IsBatchPipelineNeeded(BatchPipelineKey key) const
+{
+  const BatchShaderConfig& cfg = m_batch_shader_config;
+  const u8 render_mode = key.render_mode;
+  const u8 texture_mode = key.texture_mode;
+
+  // Mirrors the permutations skipped in CompilePipelines().
+  return !(
+    render_mode >= static_cast<u8>(BatchRenderMode::MaxCount) || key.transparency_mode > 4 ||
+    texture_mode >= NUM_TEXTURE_MODES || (key.depth_test && !m_pgxp_depth_buffer) ||
+    (render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend) && !m_allow_shader_blend) ||
+    ((m_supports_framebuffer_fetch || m_prefer_shader_blend) &&
+     (render_mode == static_cast<u8>(BatchRenderMode::OnlyOpaque) ||
+      render_mode == static_cast<u8>(BatchRenderMode::OnlyTransparent))) ||
+    (cfg.needs_rov_depth && render_mode != static_cast<u8>(BatchRenderMode::ShaderBlend)) ||
+    (!m_allow_sprite_mode && texture_mode >= static_cast<u8>(BatchTextureMode::SpriteStart)) ||
+    (!cfg.needs_page_texture && (texture_mode == static_cast<u8>(BatchTextureMode::PageTexture) ||
+                                 texture_mode == static_cast<u8>(BatchTextureMode::SpritePageTexture))) ||
+    (key.dithering && cfg.true_color) || (key.interlacing && cfg.force_progressive_scan));
+}
+
+std::unique_ptr<GPUPipeline> GPU_HW::CreateBatchPipeline(BatchPipelineKey key, Error* error)
+{
+  const BatchShaderConfig& cfg = m_batch_shader_config;
+  const u8 depth_test = BoolToUInt8(key.depth_test);
+  const u8 transparency_mode = key.transparency_mode;
+  const u8 render_mode = key.render_mode;
+  const u8 texture_mode = key.texture_mode;
+  const u8 check_mask = BoolToUInt8(key.check_mask);
+
+  GPUPipeline::GraphicsConfig plconfig = {};
+  plconfig.layout = GPUPipeline::Layout::SingleTextureAndUBO;
+  plconfig.input_layout.vertex_stride = sizeof(BatchVertex);
+  plconfig.rasterization = GPUPipeline::RasterizationState::GetNoCullState();
+  plconfig.primitive = GPUPipeline::Primitive::Triangles;
+  plconfig.geometry_shader = nullptr;
+  plconfig.samples = m_multisamples;
+  plconfig.per_sample_shading = cfg.per_sample_shading;
+  plconfig.depth = GPUPipeline::DepthState::GetNoTestsState();
+
+  const bool textured = (static_cast<BatchTextureMode>(texture_mode) != BatchTextureMode::Disabled);
+  const bool sprite = (static_cast<BatchTextureMode>(texture_mode) >= BatchTextureMode::SpriteStart);
+  const bool uv_limits = ShouldClampUVs(sprite ? m_sprite_texture_filtering : m_texture_filtering);
+  const bool use_shader_blending = (render_mode == static_cast<u8>(BatchRenderMode::ShaderBlend));
+  const bool use_rov = (use_shader_blending && m_use_rov_for_shader_blend);
+  plconfig.input_layout.vertex_attributes = GetBatchVertexAttributes(textured, uv_limits);
+
+  plconfig.vertex_shader = GetBatchVertexShader(key, error);
+  plconfig.fragment_shader = GetBatchFragmentShader(key, error);
+  if (!plconfig.vertex_shader || !plconfig.fragment_shader)
+    return {};
+
+  if (cfg.needs_real_depth_buffer)
+  {
+    plconfig.depth.depth_test =
+      m_pgxp_depth_buffer ? (depth_test ? GPUPipeline::DepthFunc::LessEqual : GPUPipeline::DepthFunc::Always) :
+                            (check_mask ? GPUPipeline::DepthFunc::GreaterEqual : GPUPipeline::DepthFunc::Always);
+
+    // Don't write for transparent, but still test.
+    plconfig.depth.depth_write =
+      !m_pgxp_depth_buffer || (depth_test && transparency_mode == static_cast<u8>(GPUTransparencyMode::Disabled));
+  }
+
+  plconfig.SetTargetFormats(use_rov ? GPUTexture::Format::Unknown : VRAM_RT_FORMAT,
+                            cfg.needs_rov_depth ? GPUTexture::Format::Unknown : cfg.depth_buffer_format);
+  plconfig.color_formats[1] = cfg.needs_rov_depth ? VRAM_DS_COLOR_FORMAT : GPUTexture::Format::Unknown;
+  plconfig.render_pass_flags =
+    use_rov ? GPUPipeline::BindRenderTargetsAsImages :
+              (cfg.needs_feedback_loop ? GPUPipeline::ColorFeedbackLoop : GPUPipeline::NoRenderPassFlags);
+
+  plconfig.blend = GPUPipeline::BlendState::GetNoBlendingState();
+
+  if (use_rov)
+  {
+    plconfig.blend.write_mask = 0;
+  }
+  else if (!use_shader_blending &&
+           ((static_cast<GPUTransparencyMode>(transparency_mode) != GPUTransparencyMode::Disabled &&
+             (static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
+              static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)) ||
+            (textured && IsBlendedTextureFiltering(sprite ? m_sprite_texture_filtering : m_texture_filtering))))
+  {
+    plconfig.blend.enable = true;
+    plconfig.blend.src_alpha_blend = GPUPipeline::BlendFunc::One;
+    plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::Zero;
+    plconfig.blend.alpha_blend_op = GPUPipeline::BlendOp::Add;
+
+    if (m_supports_dual_source_blend)
+    {
+      plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
+      plconfig.blend.dst_blend = GPUPipeline::BlendFunc::SrcAlpha1;
+      plconfig.blend.blend_op =
+        (static_cast<GPUTransparencyMode>(transparency_mode) == GPUTransparencyMode::BackgroundMinusForeground &&
+         static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
+         static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
+          GPUPipeline::BlendOp::ReverseSubtract :
+          GPUPipeline::BlendOp::Add;
+    }
+    else
+    {
+      // TODO: This isn't entirely accurate, 127.5 versus 128.
+      // But if we use fbfetch on Mali, it doesn't matter.
+      plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
+      plconfig.blend.dst_blend = GPUPipeline::BlendFunc::One;
+      if (static_cast<GPUTransparencyMode>(transparency_mode) == GPUTransparencyMode::HalfBackgroundPlusHalfForeground)
+      {
+        plconfig.blend.dst_blend = GPUPipeline::BlendFunc::ConstantColor;
+        plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::ConstantColor;
+        plconfig.blend.constant = 0x00808080u;
+      }
+
+      plconfig.blend.blend_op =
+        (static_cast<GPUTransparencyMode>(transparency_mode) == GPUTransparencyMode::BackgroundMinusForeground &&
+         static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
+         static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
+          GPUPipeline::BlendOp::ReverseSubtract :
+          GPUPipeline::BlendOp::Add;
+    }
+  }
+
+  return g_gpu_device->CreatePipeline(plconfig, error);
+}
+
+GPUPipeline* GPU_HW::CreateLazyBatchPipeline(BatchPipelineKey key)
+{
+  std::unique_ptr<GPUPipeline>& pipeline =
+    m_batch_pipelines[BoolToUInt8(key.depth_test)][key.transparency_mode][key.render_mode][key.texture_mode]
+                     [BoolToUInt8(key.dithering)][BoolToUInt8(key.interlacing)][BoolToUInt8(key.check_mask)];
+  if (pipeline)
+    return pipeline.get();
+
+  // Shaders for the warm-up list may still be compiling in the background. Only this pipeline's shaders are compiled
+  // here if they're missing, rather than waiting for the whole list.
+  Error error;
+  const Timer::Value start_time = Timer::GetCurrentValue();
+  if (!(pipeline = CreateBatchPipeline(key, &error))) [[unlikely]]
+  {
+    ERROR_LOG("Failed to create batch pipeline {:04X}: {}", key.bits, error.GetDescription());
+    return nullptr;
+  }
+
+  DEV_LOG("Created batch pipeline {:04X} in {:.2f} ms.", key.bits,
+          Timer::ConvertValueToMilliseconds(Timer::GetCurrentValue() - start_time));
+
+  if (!m_batch_pipeline_usage_set.test(key.bits))
+  {
+    m_batch_pipeline_usage_set.set(key.bits);
+    m_batch_pipeline_usage.push_back(key.bits);
+    m_batch_pipeline_usage_dirty = true;
+  }
+
+  return pipeline.get();
+}
+
+void GPU_HW::DestroyBatchShaders()
+{
+  static constexpr auto destroy_shader = [](std::unique_ptr<GPUShader>& s) { s.reset(); };
+  m_batch_vertex_shaders.enumerate(destroy_shader);
+  m_batch_fragment_shaders.enumerate(destroy_shader);
+}
+
+std::string GPU_HW::GetBatchPipelineUsagePath() const
+{
+  return Path::Combine(EmuFolders::Cache,
+                       fmt::format("pipelines_{}.bin", Path::SanitizeFileName(m_batch_pipeline_usage_serial)));
+}
+
+void GPU_HW::LoadBatchPipelineUsage()
+{
+  m_batch_pipeline_usage_serial = GPUThread::GetGameSerial();
+  m_batch_pipeline_usage.clear();
+  m_batch_pipeline_usage_set.reset();
+  m_batch_pipeline_usage_dirty = false;
+  if (m_batch_pipeline_usage_serial.empty())
+    return;
+
+  const std::string path = GetBatchPipelineUsagePath();
+  if (!FileSystem::FileExists(path.c_str()))
+    return;
+
+  Error error;
+  std::optional<DynamicHeapArray<u8>> data = FileSystem::ReadBinaryFile(path.c_str(), &error);
+  if (!data.has_value())
+  {
+    WARNING_LOG("Failed to read {}: {}", Path::GetFileName(path), error.GetDescription());
+    return;
+  }
+
+  BatchPipelineUsageHeader header = {};
+  if (data->size() >= sizeof(header))
+    std::memcpy(&header, data->data(), sizeof(header));
+  if (header.magic != BATCH_PIPELINE_USAGE_MAGIC || header.version != BATCH_PIPELINE_USAGE_VERSION ||
+      data->size() != (sizeof(header) + header.count * sizeof(u16)))
+  {
+    WARNING_LOG("Ignoring invalid or outdated pipeline list {}", Path::GetFileName(path));
+    return;
+  }
+
+  m_batch_pipeline_usage.reserve(header.count);
+  for (u32 i = 0; i < header.count; i++)
+  {
+    u16 bits;
+    std::memcpy(&bits, data->data() + sizeof(header) + i * sizeof(u16), sizeof(bits));
+    if (!m_batch_pipeline_usage_set.test(bits))
+    {
+      m_batch_pipeline_usage_set.set(bits);
+      m_batch_pipeline_usage.push_back(bits);
+    }
+  }
+  DEV_LOG("Loaded {} batch pipelines from {}", header.count, Path::GetFileName(path));
+}
+
+void GPU_HW::SaveBatchPipelineUsage()
+{
+  if (!m_batch_pipeline_usage_dirty || m_batch_pipeline_usage_serial.empty())
+    return;
+
+  m_batch_pipeline_usage_dirty = false;
+
+  const BatchPipelineUsageHeader header = {BATCH_PIPELINE_USAGE_MAGIC, BATCH_PIPELINE_USAGE_VERSION,
+                                           static_cast<u32>(m_batch_pipeline_usage.size())};
+  DynamicHeapArray<u8> data(sizeof(header) + m_batch_pipeline_usage.size() * sizeof(u16));
+  std::memcpy(data.data(), &header, sizeof(header));
+  std::memcpy(data.data() + sizeof(header), m_batch_pipeline_usage.data(), m_batch_pipeline_usage.size() * sizeof(u16));
+
+  const std::string path = GetBatchPipelineUsagePath();
+  Error error;
+  if (!FileSystem::WriteAtomicRenamedFile(path, data.cspan(), &error))
+  {
+    ERROR_LOG("Failed to write {}: {}", Path::GetFileName(path), error.GetDescription());
+    return;
+  }
+
+  DEV_LOG("Saved {} batch pipelines to {}", header.count, Path::GetFileName(path));
+}
+
+void GPU_HW::StartBatchPipelineWarmup()
+{
+  if (m_batch_pipeline_usage_serial != GPUThread::GetGameSerial())
+  {
+    SaveBatchPipelineUsage();
+    LoadBatchPipelineUsage();
+  }
+
+  m_batch_pipeline_warmup_keys.clear();
+  for (const u16 bits : m_batch_pipeline_usage)
+  {
+    // Drop anything that isn't valid for the current configuration.
+    const BatchPipelineKey key = {bits};
+    if (IsBatchPipelineNeeded(key))
+      m_batch_pipeline_warmup_keys.push_back(bits);
+  }
+  if (m_batch_pipeline_warmup_keys.empty())
+    return;
+
+  INFO_LOG("Warming up {} batch pipelines for {}.", m_batch_pipeline_warmup_keys.size(),
+           m_batch_pipeline_usage_serial);
+
+  // Without concurrent compiles, shaders are compiled along with the pipelines at the end of each frame.
+  if (!g_gpu_device->GetFeatures().concurrent_shader_compile)
+    return;
+
+  // Pipelines share shaders, make sure each one is only compiled once.
+  std::vector<u16> vs_keys, fs_keys;
+  vs_keys.reserve(m_batch_pipeline_warmup_keys.size());
+  fs_keys.reserve(m_batch_pipeline_warmup_keys.size());
+  for (const u16 bits : m_batch_pipeline_warmup_keys)
+  {
+    const BatchPipelineKey key = {bits};
+    vs_keys.push_back(GetBatchVertexShaderKey(key).bits);
+    fs_keys.push_back(GetBatchFragmentShaderKey(key).bits);
+  }
+  for (std::vector<u16>* keys : {&vs_keys, &fs_keys})
+  {
+    std::sort(keys->begin(), keys->end());
+    keys->erase(std::unique(keys->begin(), keys->end()), keys->end());
+  }
+
+  const u32 num_threads =
+    std::clamp(std::thread::hardware_concurrency() / 4u, 1u, static_cast<u32>(MAX_BATCH_SHADER_WARMUP_THREADS));
+  m_batch_shader_warmup_queue.SetWorkerCount(num_threads);
+  m_batch_shader_warmup_cancelled.store(false, std::memory_order_relaxed);
+  m_batch_shader_warmup_remaining.store(static_cast<u32>(vs_keys.size() + fs_keys.size()), std::memory_order_release);
+
+  for (const u16 bits : vs_keys)
+  {
+    m_batch_shader_warmup_queue.SubmitTask([this, bits]() {
+      if (!m_batch_shader_warmup_cancelled.load(std::memory_order_relaxed))
+      {
+        Error error;
+        if (!GetBatchVertexShader(BatchPipelineKey{bits}, &error))
+          WARNING_LOG("Failed to warm up batch vertex shader {:04X}: {}", bits, error.GetDescription());
+      }
+
+      m_batch_shader_warmup_remaining.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  for (const u16 bits : fs_keys)
+  {
+    m_batch_shader_warmup_queue.SubmitTask([this, bits]() {
+      if (!m_batch_shader_warmup_cancelled.load(std::memory_order_relaxed))
+      {
+        Error error;
+        if (!GetBatchFragmentShader(BatchPipelineKey{bits}, &error))
+          WARNING_LOG("Failed to warm up batch fragment shader {:04X}: {}", bits, error.GetDescription());
+      }
+
+      m_batch_shader_warmup_remaining.fetch_sub(1, std::memory_order_release);
+    });
+  }
+}
+
+void GPU_HW::WaitForBatchShaderWarmup(bool cancel)
+{
+  if (m_batch_shader_warmup_remaining.load(std::memory_order_acquire) == 0)
+    return;
+
+  if (cancel)
+    m_batch_shader_warmup_cancelled.store(true, std::memory_order_relaxed);
+
+  m_batch_shader_warmup_queue.WaitForAll();
+}
+
+void GPU_HW::UpdateBatchPipelineWarmup()
+{
+  // Let the shaders finish compiling in the background first, then create a few pipelines each frame.
+  if (m_batch_pipeline_warmup_keys.empty() || m_batch_shader_warmup_remaining.load(std::memory_order_acquire) != 0)
+    return;
+
+  const Timer::Value start_time = Timer::GetCurrentValue();
+  const Timer::Value time_budget = Timer::ConvertMillisecondsToValue(BATCH_PIPELINE_WARMUP_TIME_BUDGET_MS);
+  do
+  {
+    const BatchPipelineKey key = {m_batch_pipeline_warmup_keys.back()};
+    m_batch_pipeline_warmup_keys.pop_back();
+    CreateLazyBatchPipeline(key);
+  } while (!m_batch_pipeline_warmup_keys.empty() && (Timer::GetCurrentValue() - start_time) < time_budget);
+
+  if (m_batch_pipeline_warmup_keys.empty())
+    DEV_LOG("Batch pipeline warm-up complete.");
+}
+
+void GPU_HW::GameSerialChanged()
+{
+  if (!m_lazy_batch_pipelines)
+    return;
+
+  WaitForBatchShaderWarmup(true);
+  StartBatchPipelineWarmup();
+}
+
 bool GPU_HW::CompileResolutionDependentPipelines(Error* error)
 {
   Timer timer;
@@ -2067,8 +2580,10 @@ void GPU_HW::MapGPUBuffer(u32 required_vertices, u32 required_indices)
   m_batch_vertex_space = Truncate16(std::min<u32>(vb_space, std::numeric_limits<u16>::max()));
 
   u32 ib_space;
-  g_gpu_device->MapIndexBuffer(required_indices, &m_batch_index_ptr, &ib_space, &m_batch_base_index);
+  g_gpu_device->MapIndexBuffer(required_indices, &m_batch_index_map, &ib_space, &m_batch_base_index);
   m_batch_index_space = Truncate16(std::min<u32>(ib_space, std::numeric_limits<u16>::max()));
+  m_batch_index_ptr = m_batch_index_map;
+  m_batch_index_start = 0;
 }
 
 void GPU_HW::UnmapGPUBuffer(u32 used_vertices, u32 used_indices)
@@ -2080,8 +2595,12 @@ void GPU_HW::UnmapGPUBuffer(u32 used_vertices, u32 used_indices)
   m_batch_vertex_count = 0;
   m_batch_vertex_space = 0;
   m_batch_index_ptr = nullptr;
+  m_batch_index_map = nullptr;
   m_batch_index_count = 0;
   m_batch_index_space = 0;
+  m_batch_index_start = 0;
+  m_num_pending_batches = 0;
+  m_num_pending_batch_runs = 0;
 }
 
 ALWAYS_INLINE_RELEASE void GPU_HW::DrawBatchVertices(BatchRenderMode render_mode, u32 num_indices, u32 base_index,
@@ -2094,9 +2613,27 @@ ALWAYS_INLINE_RELEASE void GPU_HW::DrawBatchVertices(BatchRenderMode render_mode
                               0));
   const u8 depth_test = BoolToUInt8(m_batch.use_depth_buffer);
   const u8 check_mask = BoolToUInt8(m_batch.check_mask_before_draw);
-  g_gpu_device->SetPipeline(m_batch_pipelines[depth_test][static_cast<u8>(m_batch.transparency_mode)][static_cast<u8>(
-    render_mode)][texture_mode][BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)][check_mask]
-                              .get());
+  GPUPipeline* pipeline =
+    m_batch_pipelines[depth_test][static_cast<u8>(m_batch.transparency_mode)][static_cast<u8>(render_mode)]
+                     [texture_mode][BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)][check_mask]
+                       .get();
+  if (!pipeline) [[unlikely]]
+  {
+    DebugAssert(m_lazy_batch_pipelines);
+
+    BatchPipelineKey key = {};
+    key.depth_test = m_batch.use_depth_buffer;
+    key.transparency_mode = static_cast<u8>(m_batch.transparency_mode);
+    key.render_mode = static_cast<u8>(render_mode);
+    key.texture_mode = texture_mode;
+    key.dithering = m_batch.dithering;
+    key.interlacing = m_batch.interlacing;
+    key.check_mask = m_batch.check_mask_before_draw;
+    if (!(pipeline = CreateLazyBatchPipeline(key)))
+      return;
+  }
+
+  g_gpu_device->SetPipeline(pipeline);
 
   if (m_use_texture_cache && texture_mode != static_cast<u8>(BatchTextureMode::Disabled))
   {
@@ -2447,7 +2984,7 @@ void GPU_HW::SetBatchDepthBuffer(const GPUBackendDrawCommand* cmd, bool enabled)
 
   if (m_batch_index_count > 0)
   {
-    FlushRender();
+    DeferRender(FlushReason::RenderStateChange);
     EnsureVertexBufferSpaceForCommand(cmd);
   }
 
@@ -2469,7 +3006,7 @@ void GPU_HW::CheckForDepthClear(const GPUBackendDrawCommand* cmd, const BatchVer
                m_last_depth_z * static_cast<float>(GTE::MAX_Z),
                g_gpu_settings.gpu_pgxp_depth_clear_threshold * static_cast<float>(GTE::MAX_Z));
 
-    FlushRender();
+    FlushRender(FlushReason::DepthBufferClear);
     CopyAndClearDepthBuffer(true);
     EnsureVertexBufferSpaceForCommand(cmd);
   }
@@ -2484,7 +3021,7 @@ void GPU_HW::SetBatchSpriteMode(const GPUBackendDrawCommand* cmd, bool enabled)
 
   if (m_batch_index_count > 0)
   {
-    FlushRender();
+    DeferRender(FlushReason::RenderStateChange);
     EnsureVertexBufferSpaceForCommand(cmd);
   }
 
@@ -3097,9 +3634,9 @@ ALWAYS_INLINE_RELEASE void GPU_HW::CheckForTexPageOverlap(const GPUBackendDrawCo
       if (GPUTextureCache::AreSourcePagesDrawn(m_texture_cache_key, m_current_uv_rect))
       {
         // UVs intersect with drawn area, can't use TC
-        if (m_batch_index_count > 0)
+        if (!IsFlushed())
         {
-          FlushRender();
+          FlushRender(FlushReason::VRAMWriteOverlap);
           EnsureVertexBufferSpaceForCommand(cmd);
         }
 
@@ -3139,9 +3676,9 @@ ALWAYS_INLINE_RELEASE void GPU_HW::CheckForTexPageOverlap(const GPUBackendDrawCo
 
     if (update_drawn || update_written)
     {
-      if (m_batch_index_count > 0)
+      if (!IsFlushed())
       {
-        FlushRender();
+        FlushRender(FlushReason::VRAMWriteOverlap);
         EnsureVertexBufferSpaceForCommand(cmd);
       }
 
@@ -3157,7 +3694,7 @@ bool GPU_HW::ShouldCheckForTexPageOverlap() const
 
 ALWAYS_INLINE bool GPU_HW::IsFlushed() const
 {
-  return (m_batch_index_count == 0);
+  return (m_batch_index_count == 0 && m_num_pending_batches == 0);
 }
 
 ALWAYS_INLINE_RELEASE bool GPU_HW::NeedsTwoPassRendering() const
@@ -3189,7 +3726,7 @@ void GPU_HW::EnsureVertexBufferSpace(u32 required_vertices, u32 required_indices
     if (m_batch_vertex_space >= required_vertices && m_batch_index_space >= required_indices)
       return;
 
-    FlushRender();
+    FlushRender(FlushReason::BufferFull);
   }
 
   MapGPUBuffer(required_vertices, required_indices);
@@ -3227,7 +3764,7 @@ void GPU_HW::EnsureVertexBufferSpaceForCommand(const GPUBackendDrawCommand* cmd)
   // can we fit these vertices in the current depth buffer range?
   if ((m_current_depth + required_vertices) > MAX_BATCH_VERTEX_COUNTER_IDS)
   {
-    FlushRender();
+    FlushRender(FlushReason::BufferFull);
     ResetBatchVertexDepth();
     MapGPUBuffer(required_vertices, required_indices);
     return;
@@ -3253,7 +3790,7 @@ ALWAYS_INLINE float GPU_HW::GetCurrentNormalizedVertexDepth() const
 
 void GPU_HW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color, bool interlaced_rendering, u8 active_line_lsb)
 {
-  FlushRender();
+  FlushRender(FlushReason::VRAMFill);
   DeactivateROV();
 
   GL_SCOPE_FMT("FillVRAM({},{} => {},{} ({}x{}) with 0x{:08X}", x, y, x + width, y + height, width, height, color);
@@ -3322,7 +3859,7 @@ void GPU_HW::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 
 void GPU_HW::DownloadVRAMFromGPU(u32 x, u32 y, u32 width, u32 height)
 {
-  FlushRender();
+  FlushRender(FlushReason::Readback);
 
   // TODO: Only read if it's in the drawn area
 
@@ -3373,7 +3910,7 @@ void GPU_HW::DownloadVRAMFromGPU(u32 x, u32 y, u32 width, u32 height)
 
 void GPU_HW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask)
 {
-  FlushRender();
+  FlushRender(FlushReason::VRAMWrite);
 
   GL_SCOPE_FMT("UpdateVRAM({},{} => {},{} ({}x{})", x, y, x + width, y + height, width, height);
 
@@ -3478,7 +4015,7 @@ void GPU_HW::UpdateVRAMOnGPU(u32 x, u32 y, u32 width, u32 height, const void* da
 
 void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height, bool set_mask, bool check_mask)
 {
-  FlushRender();
+  FlushRender(FlushReason::VRAMCopy);
 
   GL_SCOPE_FMT("CopyVRAM({}x{} @ {},{} => {},{}", width, height, src_x, src_y, dst_x, dst_y);
 
@@ -3644,7 +4181,7 @@ void GPU_HW::PrepareDraw(const GPUBackendDrawCommand* cmd)
           {
             GL_INS("Palette in VRAM dirty area, flushing cache");
             if (!IsFlushed())
-              FlushRender();
+              FlushRender(FlushReason::VRAMWriteOverlap);
 
             UpdateVRAMReadTexture(update_drawn, update_written);
           }
@@ -3716,15 +4253,22 @@ void GPU_HW::PrepareDraw(const GPUBackendDrawCommand* cmd)
   const GPUTransparencyMode transparency_mode =
     cmd->transparency_enable ? cmd->draw_mode.transparency_mode : GPUTransparencyMode::Disabled;
   const bool dithering_enable = (!m_true_color && cmd->dither_enable);
-  if (!IsFlushed())
+  if (m_batch_index_count > 0)
   {
-    if (texture_mode != m_batch.texture_mode || transparency_mode != m_batch.transparency_mode ||
-        (!m_allow_shader_blend && NeedsTwoPassRendering()) || dithering_enable != m_batch.dithering ||
-        m_texture_window_bits != cmd->window || m_batch.check_mask_before_draw != cmd->check_mask_before_draw ||
-        m_batch.set_mask_while_drawing != cmd->set_mask_while_drawing ||
+    if (texture_mode != m_batch.texture_mode ||
         (texture_mode == BatchTextureMode::PageTexture && m_texture_cache_key != texture_cache_key))
     {
-      FlushRender();
+      DeferRender(FlushReason::TexturePageChange);
+    }
+    else if (transparency_mode != m_batch.transparency_mode || (!m_allow_shader_blend && NeedsTwoPassRendering()))
+    {
+      DeferRender(FlushReason::BlendingChange);
+    }
+    else if (dithering_enable != m_batch.dithering || m_texture_window_bits != cmd->window ||
+             m_batch.check_mask_before_draw != cmd->check_mask_before_draw ||
+             m_batch.set_mask_while_drawing != cmd->set_mask_while_drawing)
+    {
+      DeferRender(FlushReason::RenderStateChange);
     }
   }
 
@@ -3786,7 +4330,7 @@ void GPU_HW::PrepareDraw(const GPUBackendDrawCommand* cmd)
 
       if (m_pgxp_depth_buffer && m_last_depth_z < 1.0f)
       {
-        FlushRender();
+        FlushRender(FlushReason::DepthBufferClear);
         CopyAndClearDepthBuffer(false);
         EnsureVertexBufferSpaceForCommand(cmd);
       }
@@ -3799,12 +4343,32 @@ void GPU_HW::PrepareDraw(const GPUBackendDrawCommand* cmd)
 
 void GPU_HW::FlushRender()
 {
+  FlushRender(FlushReason::Other);
+}
+
+void GPU_HW::FlushRender(FlushReason reason)
+{
+  DebugAssert((m_batch_vertex_ptr != nullptr) == (m_batch_index_ptr != nullptr));
+  if (!m_batch_vertex_ptr)
+    return;
+
+  if (m_num_pending_batches > 0)
+  {
+    s_counters.num_flushes[static_cast<size_t>(reason)]++;
+    FlushPendingBatches();
+    return;
+  }
+
   const u32 base_vertex = m_batch_base_vertex;
   const u32 base_index = m_batch_base_index;
   const u32 index_count = m_batch_index_count;
-  DebugAssert((m_batch_vertex_ptr != nullptr) == (m_batch_index_ptr != nullptr));
-  if (m_batch_vertex_ptr)
-    UnmapGPUBuffer(m_batch_vertex_count, index_count);
+  DebugAssert(m_batch_index_start == 0);
+  if (index_count > 0)
+  {
+    s_counters.num_flushes[static_cast<size_t>(reason)]++;
+    s_counters.num_batch_vertices += m_batch_vertex_count;
+  }
+  UnmapGPUBuffer(m_batch_vertex_count, index_count);
   if (index_count == 0)
     return;
 
@@ -3818,12 +4382,7 @@ void GPU_HW::FlushRender()
 
   const GPUTextureCache::Source* texture = nullptr;
   if (m_batch.texture_mode == BatchTextureMode::PageTexture)
-  {
-    texture = LookupSource(m_texture_cache_key, m_current_uv_rect,
-                           m_batch.transparency_mode != GPUTransparencyMode::Disabled ?
-                             GPUTextureCache::PaletteRecordFlags::HasSemiTransparentDraws :
-                             GPUTextureCache::PaletteRecordFlags::None);
-  }
+    texture = LookupBatchTextureSource(m_batch.transparency_mode, m_current_uv_rect);
 
   if (m_batch_ubo_dirty)
   {
@@ -3835,21 +4394,43 @@ void GPU_HW::FlushRender()
   m_current_draw_rect = INVALID_RECT;
   m_current_uv_rect = INVALID_RECT;
 
+  DrawBatch(index_count, base_index, base_vertex, texture);
+}
+
+const GPUTextureCache::Source* GPU_HW::LookupBatchTextureSource(GPUTransparencyMode transparency_mode,
+                                                                 const GSVector4i uv_rect)
+{
+  bool hit;
+  const GPUTextureCache::Source* source =
+    LookupSource(m_texture_cache_key, uv_rect,
+                 (transparency_mode != GPUTransparencyMode::Disabled) ?
+                   GPUTextureCache::PaletteRecordFlags::HasSemiTransparentDraws :
+                   GPUTextureCache::PaletteRecordFlags::None,
+                 &hit);
+  s_counters.num_texture_cache_hits += BoolToUInt32(hit);
+  s_counters.num_texture_cache_misses += BoolToUInt32(!hit);
+  return source;
+}
+
+void GPU_HW::DrawBatch(u32 num_indices, u32 base_index, u32 base_vertex, const GPUTextureCache::Source* texture)
+{
+  s_counters.num_batches++;
+
   if (m_wireframe_mode != GPUWireframeMode::OnlyWireframe)
   {
     if (NeedsShaderBlending(m_batch.transparency_mode, m_batch.texture_mode, m_batch.check_mask_before_draw) ||
         m_rov_active || (m_use_rov_for_shader_blend && m_pgxp_depth_buffer))
     {
-      DrawBatchVertices(BatchRenderMode::ShaderBlend, index_count, base_index, base_vertex, texture);
+      DrawBatchVertices(BatchRenderMode::ShaderBlend, num_indices, base_index, base_vertex, texture);
     }
     else if (NeedsTwoPassRendering())
     {
-      DrawBatchVertices(BatchRenderMode::OnlyOpaque, index_count, base_index, base_vertex, texture);
-      DrawBatchVertices(BatchRenderMode::OnlyTransparent, index_count, base_index, base_vertex, texture);
+      DrawBatchVertices(BatchRenderMode::OnlyOpaque, num_indices, base_index, base_vertex, texture);
+      DrawBatchVertices(BatchRenderMode::OnlyTransparent, num_indices, base_index, base_vertex, texture);
     }
     else
     {
-      DrawBatchVertices(m_batch.GetRenderMode(), index_count, base_index, base_vertex, texture);
+      DrawBatchVertices(m_batch.GetRenderMode(), num_indices, base_index, base_vertex, texture);
     }
   }
 
@@ -3858,19 +4439,166 @@ void GPU_HW::FlushRender()
     // This'll be less than ideal, but wireframe is for debugging, so take the perf hit.
     DeactivateROV();
     g_gpu_device->SetPipeline(m_wireframe_pipeline.get());
-    g_gpu_device->DrawIndexed(index_count, base_index, base_vertex);
+    g_gpu_device->DrawIndexed(num_indices, base_index, base_vertex);
+  }
+}
+
+bool GPU_HW::CanDeferBatch() const
+{
+  // Only batches which draw purely through the blender can be reordered. Anything which reads the framebuffer in the
+  // shader, depends on the mask/depth test, or samples the texture cache has to stay in submission order.
+  return (m_batch.texture_mode != BatchTextureMode::PageTexture && !m_batch.check_mask_before_draw &&
+          !m_batch.use_depth_buffer && !m_rov_active && !(m_use_rov_for_shader_blend && m_pgxp_depth_buffer) &&
+          !NeedsTwoPassRendering() &&
+          !NeedsShaderBlending(m_batch.transparency_mode, m_batch.texture_mode, m_batch.check_mask_before_draw));
+}
+
+void GPU_HW::DeferRender(FlushReason reason)
+{
+  if (m_batch_index_count == 0)
+    return;
+
+  if (!CanDeferBatch())
+  {
+    FlushRender(reason);
+    return;
+  }
+
+  PushPendingBatch(true);
+
+  // Always leave space for the batch which is current at flush time.
+  if (m_num_pending_batches == MAX_PENDING_BATCHES || m_num_pending_batch_runs == MAX_PENDING_BATCH_RUNS)
+    FlushRender(reason);
+}
+
+void GPU_HW::PushPendingBatch(bool allow_merge)
+{
+  DebugAssert(m_num_pending_batches < MAX_PENDING_BATCHES && m_num_pending_batch_runs < MAX_PENDING_BATCH_RUNS);
+
+  const GSVector4i draw_rect = m_current_draw_rect;
+  u32 batch_index = m_num_pending_batches;
+  if (allow_merge)
+  {
+    // Moving this batch's primitives in front of later pending batches is only safe if they don't overlap, so stop
+    // searching as soon as we hit one that does.
+    for (u32 i = m_num_pending_batches; i > 0;)
+    {
+      const PendingBatch& pb = m_pending_batches[--i];
+      if (pb.can_merge && pb.config == m_batch &&
+          std::memcmp(&pb.ubo_data, &m_batch_ubo_data, sizeof(m_batch_ubo_data)) == 0)
+      {
+        batch_index = i;
+        break;
+      }
+
+      if (pb.draw_rect.rintersects(draw_rect))
+        break;
+    }
+  }
+
+  if (batch_index == m_num_pending_batches)
+  {
+    PendingBatch& pb = m_pending_batches[m_num_pending_batches++];
+    pb.draw_rect = draw_rect;
+    pb.config = m_batch;
+    pb.ubo_data = m_batch_ubo_data;
+    pb.ubo_dirty = m_batch_ubo_dirty;
+    pb.can_merge = allow_merge;
+  }
+  else
+  {
+    GL_INS_FMT("Merging batch {} into pending batch {}", draw_rect, batch_index);
+    PendingBatch& pb = m_pending_batches[batch_index];
+    pb.draw_rect = pb.draw_rect.runion(draw_rect);
+    s_counters.num_merged_batches++;
+  }
+
+  m_pending_batch_runs[m_num_pending_batch_runs++] = {batch_index, m_batch_index_start, m_batch_index_count};
+
+  // Only the first run is already where it needs to be in the index buffer, anything after it may be reordered.
+  m_batch_index_start += m_batch_index_count;
+  m_batch_index_ptr = &m_batch_index_staging[m_batch_index_start];
+  m_batch_index_count = 0;
+  m_current_draw_rect = INVALID_RECT;
+  m_current_uv_rect = INVALID_RECT;
+}
+
+void GPU_HW::FlushPendingBatches()
+{
+  // The current batch goes last, unless it can be merged into an earlier batch.
+  const GSVector4i current_uv_rect = m_current_uv_rect;
+  if (m_batch_index_count > 0)
+    PushPendingBatch(CanDeferBatch());
+
+  // Copy the indices to the GPU grouped by batch, so each batch is a single draw. The first run belongs to the first
+  // batch and was written straight to the index buffer, the rest were staged.
+  DebugAssert(m_pending_batch_runs[0].batch == 0 && m_pending_batch_runs[0].start == 0);
+  const u32 base_vertex = m_batch_base_vertex;
+  u32 num_indices = m_pending_batch_runs[0].count;
+  for (u32 i = 0; i < m_num_pending_batches; i++)
+  {
+    PendingBatch& pb = m_pending_batches[i];
+    pb.base_index = (i == 0) ? m_batch_base_index : (m_batch_base_index + num_indices);
+    for (u32 j = 1; j < m_num_pending_batch_runs; j++)
+    {
+      const PendingBatchRun& run = m_pending_batch_runs[j];
+      if (run.batch != i)
+        continue;
+
+      std::memcpy(m_batch_index_map + num_indices, &m_batch_index_staging[run.start],
+                  sizeof(GPUDevice::DrawIndex) * run.count);
+      num_indices += run.count;
+    }
+    pb.num_indices = m_batch_base_index + num_indices - pb.base_index;
   }
+
+  const u32 num_batches = m_num_pending_batches;
+  s_counters.num_batch_vertices += m_batch_vertex_count;
+  UnmapGPUBuffer(m_batch_vertex_count, num_indices);
+
+#if defined(_DEBUG) || defined(_DEVEL)
+  GL_SCOPE_FMT("Hardware Draw {}: {} batches", ++s_draw_number, num_batches);
+#endif
+
+  GL_INS_FMT("Dirty draw area: {}", m_vram_dirty_draw_rect);
+
+  // Only the last batch can use the texture cache, since those batches are never deferred.
+  const PendingBatch& last_batch = m_pending_batches[num_batches - 1];
+  const GPUTextureCache::Source* texture = nullptr;
+  if (last_batch.config.texture_mode == BatchTextureMode::PageTexture)
+  {
+    DebugAssert(!last_batch.can_merge);
+    texture = LookupBatchTextureSource(last_batch.config.transparency_mode, current_uv_rect);
+  }
+
+  const BatchConfig current_batch = m_batch;
+  const BatchUBOData* last_ubo_data = nullptr;
+  for (u32 i = 0; i < num_batches; i++)
+  {
+    const PendingBatch& pb = m_pending_batches[i];
+    if (last_ubo_data ? (std::memcmp(last_ubo_data, &pb.ubo_data, sizeof(pb.ubo_data)) != 0) : pb.ubo_dirty)
+      g_gpu_device->UploadUniformBuffer(&pb.ubo_data, sizeof(pb.ubo_data));
+    last_ubo_data = &pb.ubo_data;
+
+    m_batch = pb.config;
+    DrawBatch(pb.num_indices, pb.base_index, base_vertex, (&pb == &last_batch) ? texture : nullptr);
+  }
+
+  m_batch = current_batch;
+  m_batch_ubo_dirty = (std::memcmp(last_ubo_data, &m_batch_ubo_data, sizeof(m_batch_ubo_data)) != 0);
+  m_current_draw_rect = INVALID_RECT;
+  m_current_uv_rect = INVALID_RECT;
 }
 
 void GPU_HW::DrawingAreaChanged()
 {
-  FlushRender();
+  FlushRender(FlushReason::DrawingAreaChange);
   m_drawing_area_changed = true;
 }
 
 void GPU_HW::UpdateDisplay(const GPUBackendUpdateDisplayCommand* cmd)
 {
-  FlushRender();
+  FlushRender(FlushReason::DisplayUpdate);
   DeactivateROV();
 
   GL_SCOPE("UpdateDisplay()");
@@ -4069,6 +4797,9 @@ void GPU_HW::OnBufferSwapped()
 {
   GL_INS("OnBufferSwapped()");
   m_depth_was_copied = false;
+
+  if (m_lazy_batch_pipelines)
+    UpdateBatchPipelineWarmup();
 }
 
 void GPU_HW::DownsampleFramebuffer()
@@ -8,12 +8,22 @@
 
 #include "util/gpu_device.h"
 
+#include "common/bitfield.h"
 #include "common/dimensional_array.h"
 #include "common/gsvector.h"
+#include "common/heap_array.h"
+#include "common/task_queue.h"
 
+#include <atomic>
+#include <bitset>
 #include <limits>
+#include <mutex>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
+
+class GPU_HW_ShaderGen;
 
 namespace PostProcessing {
 class Chain;
@@ -70,6 +80,7 @@ public:
 
   void RestoreDeviceContext() override;
   void FlushRender() override;
+  void FlushRender(FlushReason reason);
 
   bool UpdateSettings(const GPUSettings& old_settings, Error* error) override;
   void UpdatePostProcessingSettings(bool force_reload) override;
@@ -81,6 +92,7 @@ public:
                 bool check_mask) override;
   void ClearCache() override;
   void OnBufferSwapped() override;
+  void GameSerialChanged() override;
 
   void DrawPolygon(const GPUBackendDrawPolygonCommand* cmd) override;
   void DrawPrecisePolygon(const GPUBackendDrawPrecisePolygonCommand* cmd) override;
@@ -106,7 +118,15 @@ private:
                                  (((MAX_PRIMITIVE_HEIGHT + (TEXTURE_PAGE_HEIGHT - 1)) / TEXTURE_PAGE_HEIGHT) + 1u),
     NUM_TEXTURE_MODES = static_cast<u32>(BatchTextureMode::MaxCount),
     INVALID_DRAW_MODE_BITS = 0xFFFFFFFFu,
+    BATCH_PIPELINE_USAGE_MAGIC = 0x4C505344, // DSPL
+    BATCH_PIPELINE_USAGE_VERSION = 1,
+    MAX_BATCH_SHADER_WARMUP_THREADS = 4,
+    MAX_PENDING_BATCHES = 8,
+    MAX_PENDING_BATCH_RUNS = 32,
+    BATCH_INDEX_STAGING_SIZE = 65536,
   };
+
+  static constexpr float BATCH_PIPELINE_WARMUP_TIME_BUDGET_MS = 2.0f;
   enum : u8
   {
     TEXPAGE_DIRTY_DRAWN_RECT = (1 << 0),
@@ -117,6 +137,45 @@ private:
 
   static_assert(GPUDevice::MIN_TEXEL_BUFFER_ELEMENTS >= (VRAM_WIDTH * VRAM_HEIGHT));
 
+  /// Identifies a single batch pipeline permutation, used for lazy creation and the per-game warm-up list.
+  union BatchPipelineKey
+  {
+    u16 bits;
+
+    BitField<u16, bool, 0, 1> depth_test;
+    BitField<u16, u8, 1, 3> transparency_mode;
+    BitField<u16, u8, 4, 3> render_mode;
+    BitField<u16, u8, 7, 4> texture_mode;
+    BitField<u16, bool, 11, 1> dithering;
+    BitField<u16, bool, 12, 1> interlacing;
+    BitField<u16, bool, 13, 1> check_mask;
+  };
+
+  struct BatchPipelineUsageHeader
+  {
+    u32 magic;
+    u32 version;
+    u32 count;
+  };
+
+  /// Configuration shared by all batch shaders/pipelines, computed in CompilePipelines().
+  struct BatchShaderConfig
+  {
+    bool upscaled;
+    bool msaa;
+    bool per_sample_shading;
+    bool force_round_texcoords;
+    bool true_color;
+    bool scaled_dithering;
+    bool disable_color_perspective;
+    bool needs_page_texture;
+    bool force_progressive_scan;
+    bool needs_rov_depth;
+    bool needs_real_depth_buffer;
+    bool needs_feedback_loop;
+    GPUTexture::Format depth_buffer_format;
+  };
+
   struct alignas(16) BatchVertex
   {
     float x;
@@ -148,6 +207,8 @@ private:
 
     // Returns the render mode for this batch.
     BatchRenderMode GetRenderMode() const;
+
+    bool operator==(const BatchConfig& rhs) const = default;
   };
 
   struct BatchUBOData
@@ -162,6 +223,26 @@ private:
     float u_resolution_scale_minus_one;
   };
 
+  /// Batch which has been ended, but not yet drawn, so later batches with the same state can be merged into it.
+  struct PendingBatch
+  {
+    GSVector4i draw_rect;
+    BatchConfig config;
+    BatchUBOData ubo_data;
+    u32 base_index;
+    u32 num_indices;
+    bool ubo_dirty;
+    bool can_merge;
+  };
+
+  /// Range of staged indices belonging to a pending batch.
+  struct PendingBatchRun
+  {
+    u32 batch;
+    u32 start;
+    u32 count;
+  };
+
   struct RendererStats
   {
     u32 num_batches;
@@ -179,6 +260,28 @@ private:
   bool CompileCommonShaders(Error* error);
   bool CompilePipelines(Error* error);
   bool CompileResolutionDependentPipelines(Error* error);
+
+  std::string GenerateBatchVertexShader(const GPU_HW_ShaderGen& shadergen, u8 textured, u8 palette, u8 sprite) const;
+  std::string GenerateBatchFragmentShader(const GPU_HW_ShaderGen& shadergen, u8 depth_test, u8 render_mode,
+                                          u8 transparency_mode, u8 texture_mode, u8 check_mask, u8 dithering,
+                                          u8 interlacing) const;
+  static std::span<const GPUPipeline::VertexAttribute> GetBatchVertexAttributes(bool textured, bool uv_limits);
+  static BatchPipelineKey GetBatchVertexShaderKey(BatchPipelineKey key);
+  BatchPipelineKey GetBatchFragmentShaderKey(BatchPipelineKey key) const;
+  GPUShader* GetBatchVertexShader(BatchPipelineKey key, Error* error);
+  GPUShader* GetBatchFragmentShader(BatchPipelineKey key, Error* error);
+  GPUShader* PublishBatchShader(std::unique_ptr<GPUShader>& slot, std::unique_ptr<GPUShader> shader);
+  bool IsBatchPipelineNeeded(BatchPipelineKey key) const;
+  std::unique_ptr<GPUPipeline> CreateBatchPipeline(BatchPipelineKey key, Error* error);
+  GPUPipeline* CreateLazyBatchPipeline(BatchPipelineKey key);
+  void DestroyBatchShaders();
+
+  std::string GetBatchPipelineUsagePath() const;
+  void LoadBatchPipelineUsage();
+  void SaveBatchPipelineUsage();
+  void StartBatchPipelineWarmup();
+  void WaitForBatchShaderWarmup(bool cancel);
+  void UpdateBatchPipelineWarmup();
   bool CompileDownsamplePipelines(Error* error);
 
   void PrintSettingsToLog();
@@ -217,6 +320,15 @@ private:
 
   bool IsFlushed() const;
 
+  /// Ends the current batch without drawing it, if its state allows it to be merged with later batches.
+  void DeferRender(FlushReason reason);
+  bool CanDeferBatch() const;
+  void PushPendingBatch(bool allow_merge);
+  void FlushPendingBatches();
+  void DrawBatch(u32 num_indices, u32 base_index, u32 base_vertex, const GPUTextureCache::Source* texture);
+  const GPUTextureCache::Source* LookupBatchTextureSource(GPUTransparencyMode transparency_mode,
+                                                         const GSVector4i uv_rect);
+
   void EnsureVertexBufferSpace(u32 required_vertices, u32 required_indices);
   void EnsureVertexBufferSpaceForCommand(const GPUBackendDrawCommand* cmd);
   void PrepareDraw(const GPUBackendDrawCommand* cmd);
@@ -287,6 +399,7 @@ private:
   u16 m_batch_index_count = 0;
   u16 m_batch_vertex_space = 0;
   u16 m_batch_index_space = 0;
+  u32 m_batch_index_start = 0;
   s32 m_current_depth = 0;
   float m_last_depth_z = 1.0f;
 
@@ -327,6 +440,15 @@ private:
   // Changed state
   BatchUBOData m_batch_ubo_data = {};
 
+  // Indices are written straight to the index buffer until a batch is deferred. After that they're staged in system
+  // memory, and copied to the index buffer grouped by batch at flush time.
+  FixedHeapArray<GPUDevice::DrawIndex, BATCH_INDEX_STAGING_SIZE> m_batch_index_staging;
+  GPUDevice::DrawIndex* m_batch_index_map = nullptr;
+  u32 m_num_pending_batches = 0;
+  u32 m_num_pending_batch_runs = 0;
+  std::array<PendingBatch, MAX_PENDING_BATCHES> m_pending_batches;
+  std::array<PendingBatchRun, MAX_PENDING_BATCH_RUNS> m_pending_batch_runs;
+
   // Bounding box of VRAM area that the GPU has drawn into.
   GSVector4i m_vram_dirty_draw_rect = INVALID_RECT;
   GSVector4i m_vram_dirty_write_rect = INVALID_RECT; // TODO: Don't use in TC mode, should be kept at zero.
@@ -379,6 +501,28 @@ private:
   // [depth_test][transparency_mode][render_mode][texture_mode][dithering][interlacing][check_mask]
   DimensionalArray<std::unique_ptr<GPUPipeline>, 2, 2, 2, NUM_TEXTURE_MODES, 5, 5, 2> m_batch_pipelines{};
 
+  // Only kept around after CompilePipelines() when creating batch pipelines lazily.
+  // vertex shaders - [textured][palette][sprite]
+  // fragment shaders - [depth_test][render_mode][transparency_mode][texture_mode][check_mask][dithering][interlacing]
+  DimensionalArray<std::unique_ptr<GPUShader>, 2, 3, 2> m_batch_vertex_shaders{};
+  DimensionalArray<std::unique_ptr<GPUShader>, 2, 2, 2, NUM_TEXTURE_MODES, 5, 5, 2> m_batch_fragment_shaders{};
+  BatchShaderConfig m_batch_shader_config = {};
+  bool m_lazy_batch_pipelines = false;
+
+  // Batch pipelines used by the current game, saved so they can be warmed up next time.
+  bool m_batch_pipeline_usage_dirty = false;
+  std::string m_batch_pipeline_usage_serial;
+  std::vector<u16> m_batch_pipeline_usage;
+  std::bitset<std::numeric_limits<u16>::max() + 1> m_batch_pipeline_usage_set;
+  std::vector<u16> m_batch_pipeline_warmup_keys;
+
+  // Shaders for the warm-up list are compiled in the background, pipelines are created on the GPU thread. The shader
+  // arrays are guarded by m_batch_shader_mutex while the queue is running.
+  TaskQueue m_batch_shader_warmup_queue;
+  std::mutex m_batch_shader_mutex;
+  std::atomic<u32> m_batch_shader_warmup_remaining{0};
+  std::atomic_bool m_batch_shader_warmup_cancelled{false};
+
   // common shaders
   std::unique_ptr<GPUShader> m_fullscreen_quad_vertex_shader;
   std::unique_ptr<GPUShader> m_screen_quad_vertex_shader;
@@ -1420,7 +1420,7 @@ void GPUTextureCache::DecodeTexture(u8 page, GPUTexturePaletteReg palette, GPUTe
 }
 
 const GPUTextureCache::Source* GPUTextureCache::LookupSource(SourceKey key, const GSVector4i rect,
-                                                             PaletteRecordFlags flags)
+                                                             PaletteRecordFlags flags, bool* hit)
 {
   GL_SCOPE_FMT("TC: Lookup source {}", SourceKeyToString(key));
 
@@ -1431,10 +1431,12 @@ const GPUTextureCache::Source* GPUTextureCache::LookupSource(SourceKey key, cons
     {
       GL_INS("TC: Source hit");
       ListMoveToFront(&list, n);
+      *hit = true;
       return ReturnSource(n->ref, rect, flags);
     }
   }
 
+  *hit = false;
   return ReturnSource(CreateSource(key), rect, flags);
 }
 
@@ -122,7 +122,7 @@ void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height,
 void WriteVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask,
                const GSVector4i bounds);
 
-const Source* LookupSource(SourceKey key, const GSVector4i uv_rect, PaletteRecordFlags flags);
+const Source* LookupSource(SourceKey key, const GSVector4i uv_rect, PaletteRecordFlags flags, bool* hit);
 
 bool IsRectDrawn(const GSVector4i rect);
 bool AreSourcePagesDrawn(SourceKey key, const GSVector4i rect);
@@ -45,6 +45,10 @@ GPUPresenter::GPUPresenter() = default;
 
 GPUPresenter::~GPUPresenter()
 {
+  // Nothing was created if the software renderer ran without a device.
+  if (!g_gpu_device)
+    return;
+
   DestroyDeinterlaceTextures();
   g_gpu_device->RecycleTexture(std::move(m_chroma_smoothing_texture));
 }
@@ -822,6 +826,9 @@ void GPUPresenter::SendDisplayToMediaCapture(MediaCapture* cap)
 
 void GPUPresenter::DestroyDeinterlaceTextures()
 {
+  if (!g_gpu_device)
+    return;
+
   for (std::unique_ptr<GPUTexture>& tex : m_deinterlace_buffers)
     g_gpu_device->RecycleTexture(std::move(tex));
   g_gpu_device->RecycleTexture(std::move(m_deinterlace_texture));
@@ -1023,6 +1030,10 @@ void GPUPresenter::CalculateDrawRect(s32 window_width, s32 window_height, bool a
 
 bool GPUPresenter::PresentFrame(GPUPresenter* presenter, GPUBackend* backend, bool allow_skip_present, u64 present_time)
 {
+  // Without a device, the host displays the software renderer's output itself from FrameDoneOnGPUThread().
+  if (!g_gpu_device)
+    return true;
+
   const bool skip_present = (!g_gpu_device->HasMainSwapChain() ||
                              (allow_skip_present && g_gpu_device->GetMainSwapChain()->ShouldSkipPresentingFrame() &&
                               presenter && presenter->m_skipped_present_count < MAX_SKIPPED_PRESENT_COUNT));
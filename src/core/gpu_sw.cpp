@@ -37,16 +37,26 @@ bool GPU_SW::Initialize(bool upload_vram, Error* error)
   if (!GPUBackend::Initialize(upload_vram, error))
     return false;
 
-  static constexpr const std::array formats_for_16bit = {GPUTexture::Format::RGB5A1, GPUTexture::Format::A1BGR5,
-                                                         GPUTexture::Format::RGB565, GPUTexture::Format::RGBA8};
-  for (const GPUTexture::Format format : formats_for_16bit)
+  if (g_gpu_device)
   {
-    if (g_gpu_device->SupportsTextureFormat(format))
+    static constexpr const std::array formats_for_16bit = {GPUTexture::Format::RGB5A1, GPUTexture::Format::A1BGR5,
+                                                           GPUTexture::Format::RGB565, GPUTexture::Format::RGBA8};
+    for (const GPUTexture::Format format : formats_for_16bit)
     {
-      m_16bit_display_format = format;
-      break;
+      if (g_gpu_device->SupportsTextureFormat(format))
+      {
+        m_16bit_display_format = format;
+        break;
+      }
     }
   }
+  else
+  {
+    // Nothing is uploaded without a device, the display is only produced by RenderDisplayToBuffer(), so keep the
+    // field history from the first frame.
+    m_16bit_display_format = GPUTexture::Format::RGBA8;
+    m_cpu_display_active = true;
+  }
 
   // RGBA8 will always be supported, hence we'll find one.
   INFO_LOG("Using {} format for 16-bit display", GPUTexture::GetFormatName(m_16bit_display_format));
@@ -220,18 +230,11 @@ GPUTexture* GPU_SW::GetDisplayTexture(u32 width, u32 height, GPUTexture::Format
 }
 
 template<GPUTexture::Format display_format>
-ALWAYS_INLINE_RELEASE bool GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 line_skip)
+ALWAYS_INLINE_RELEASE void GPU_SW::CopyOut15BitToBuffer(u8* dst_ptr, u32 dst_stride, u32 src_x, u32 src_y, u32 width,
+                                                        u32 height, u32 line_skip)
 {
-  GPUTexture* texture = GetDisplayTexture(width, height, display_format);
-  if (!texture) [[unlikely]]
-    return false;
-
-  u32 dst_stride = Common::AlignUpPow2(width * texture->GetPixelSize(), 4);
-  u8* dst_ptr = m_upload_buffer.data();
-  const bool mapped = texture->Map(reinterpret_cast<void**>(&dst_ptr), &dst_stride, 0, 0, width, height);
-
   // Fast path when not wrapping around.
-  if ((src_x + width) <= VRAM_WIDTH && (src_y + height) <= VRAM_HEIGHT)
+  if ((src_x + width) <= VRAM_WIDTH && (src_y + (height << line_skip)) <= VRAM_HEIGHT)
   {
     [[maybe_unused]] constexpr u32 pixels_per_vec = 8;
     [[maybe_unused]] const u32 aligned_width = Common::AlignDownPow2(width, pixels_per_vec);
@@ -276,25 +279,11 @@ ALWAYS_INLINE_RELEASE bool GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width,
       dst_ptr += dst_stride;
     }
   }
-
-  if (mapped)
-    texture->Unmap();
-  else
-    texture->Update(0, 0, width, height, m_upload_buffer.data(), dst_stride);
-
-  return true;
 }
 
-ALWAYS_INLINE_RELEASE bool GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height, u32 line_skip)
+ALWAYS_INLINE_RELEASE void GPU_SW::CopyOut24BitToBuffer(u8* dst_ptr, u32 dst_stride, u32 src_x, u32 src_y, u32 skip_x,
+                                                        u32 width, u32 height, u32 line_skip)
 {
-  GPUTexture* texture = GetDisplayTexture(width, height, FORMAT_FOR_24BIT);
-  if (!texture) [[unlikely]]
-    return false;
-
-  u32 dst_stride = width * sizeof(u32);
-  u8* dst_ptr = m_upload_buffer.data();
-  const bool mapped = texture->Map(reinterpret_cast<void**>(&dst_ptr), &dst_stride, 0, 0, width, height);
-
   if ((src_x + width) <= VRAM_WIDTH && (src_y + (height << line_skip)) <= VRAM_HEIGHT)
   {
     const u8* src_ptr = reinterpret_cast<const u8*>(&g_vram[src_y * VRAM_WIDTH + src_x]) + (skip_x * 3);
@@ -339,6 +328,40 @@ ALWAYS_INLINE_RELEASE bool GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x
       dst_ptr += dst_stride;
     }
   }
+}
+
+template<GPUTexture::Format display_format>
+ALWAYS_INLINE_RELEASE bool GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 line_skip)
+{
+  GPUTexture* texture = GetDisplayTexture(width, height, display_format);
+  if (!texture) [[unlikely]]
+    return false;
+
+  u32 dst_stride = Common::AlignUpPow2(width * texture->GetPixelSize(), 4);
+  u8* dst_ptr = m_upload_buffer.data();
+  const bool mapped = texture->Map(reinterpret_cast<void**>(&dst_ptr), &dst_stride, 0, 0, width, height);
+
+  CopyOut15BitToBuffer<display_format>(dst_ptr, dst_stride, src_x, src_y, width, height, line_skip);
+
+  if (mapped)
+    texture->Unmap();
+  else
+    texture->Update(0, 0, width, height, m_upload_buffer.data(), dst_stride);
+
+  return true;
+}
+
+ALWAYS_INLINE_RELEASE bool GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height, u32 line_skip)
+{
+  GPUTexture* texture = GetDisplayTexture(width, height, FORMAT_FOR_24BIT);
+  if (!texture) [[unlikely]]
+    return false;
+
+  u32 dst_stride = width * sizeof(u32);
+  u8* dst_ptr = m_upload_buffer.data();
+  const bool mapped = texture->Map(reinterpret_cast<void**>(&dst_ptr), &dst_stride, 0, 0, width, height);
+
+  CopyOut24BitToBuffer(dst_ptr, dst_stride, src_x, src_y, skip_x, width, height, line_skip);
 
   if (mapped)
     texture->Unmap();
@@ -387,6 +410,7 @@ void GPU_SW::UpdateDisplay(const GPUBackendUpdateDisplayCommand* cmd)
   {
     if (cmd->display_disabled)
     {
+      m_cpu_display.valid = false;
       m_presenter.ClearDisplayTexture();
       return;
     }
@@ -400,6 +424,24 @@ void GPU_SW::UpdateDisplay(const GPUBackendUpdateDisplayCommand* cmd)
     const u32 width = cmd->display_vram_width;
     const u32 height = cmd->display_vram_height;
 
+    m_cpu_display = {.src_x = static_cast<u16>(src_x),
+                     .src_y = static_cast<u16>(src_y),
+                     .skip_x = static_cast<u16>(skip_x),
+                     .width = static_cast<u16>(width),
+                     .height = static_cast<u16>(height),
+                     .line_skip = static_cast<u8>(cmd->interlaced_display_enabled ? line_skip : 0),
+                     .field = static_cast<u8>(field),
+                     .is_24bit = is_24bit,
+                     .interlaced = cmd->interlaced_display_enabled,
+                     .valid = true};
+    m_cpu_display_field_captured = false;
+    if (m_cpu_display_active && UseCPUDisplayFieldHistory())
+      CaptureCPUDisplayField();
+
+    // The host reads the display back itself when there's no device to upload to.
+    if (!g_gpu_device)
+      return;
+
     GL_INS_FMT("Software scanout {}x{} from {},{} line_skip={}", width, height, src_x, src_y, line_skip);
 
     if (cmd->interlaced_display_enabled)
@@ -430,11 +472,229 @@ void GPU_SW::UpdateDisplay(const GPUBackendUpdateDisplayCommand* cmd)
   }
   else
   {
-    if (CopyOut(0, 0, 0, VRAM_WIDTH, VRAM_HEIGHT, 0, false))
+    m_cpu_display = {.src_x = 0,
+                     .src_y = 0,
+                     .skip_x = 0,
+                     .width = VRAM_WIDTH,
+                     .height = VRAM_HEIGHT,
+                     .line_skip = 0,
+                     .field = 0,
+                     .is_24bit = false,
+                     .interlaced = false,
+                     .valid = true};
+
+    if (g_gpu_device && CopyOut(0, 0, 0, VRAM_WIDTH, VRAM_HEIGHT, 0, false))
       m_presenter.SetDisplayTexture(m_upload_texture.get(), 0, 0, VRAM_WIDTH, VRAM_HEIGHT);
   }
 }
 
+bool GPU_SW::UseCPUDisplayFieldHistory() const
+{
+  const CPUDisplayState& ds = m_cpu_display;
+  if (!ds.interlaced)
+    return false;
+
+  // Fields have to be captured as they are displayed when they are combined with previous fields, or need smoothing.
+  // Interleaved fields are both present in VRAM, so they can be woven without keeping any history.
+  const bool chroma_smoothing = (ds.is_24bit && g_gpu_settings.display_24bit_chroma_smoothing);
+  switch (g_gpu_settings.display_deinterlacing_mode)
+  {
+    case DisplayDeinterlacingMode::Weave:
+      return (ds.line_skip == 0 || chroma_smoothing);
+
+    case DisplayDeinterlacingMode::Blend:
+    case DisplayDeinterlacingMode::Adaptive:
+      return true;
+
+    default:
+      return chroma_smoothing;
+  }
+}
+
+void GPU_SW::CopyOutCPUDisplay(u8* dst_ptr, u32 dst_stride, u32 src_y, u32 height, u32 line_skip) const
+{
+  const CPUDisplayState& ds = m_cpu_display;
+  if (ds.is_24bit)
+  {
+    CopyOut24BitToBuffer(dst_ptr, dst_stride, ds.src_x, src_y, ds.skip_x, ds.width, height, line_skip);
+  }
+  else
+  {
+    CopyOut15BitToBuffer<GPUTexture::Format::RGBA8>(dst_ptr, dst_stride, ds.src_x, src_y, ds.width, height,
+                                                    line_skip);
+  }
+}
+
+void GPU_SW::CaptureCPUDisplayField()
+{
+  const CPUDisplayState& ds = m_cpu_display;
+  const u32 stride = ZeroExtend32(ds.width) * sizeof(u32);
+  const u32 size = ZeroExtend32(ds.width) * ZeroExtend32(ds.height);
+
+  m_cpu_display_field_index = (m_cpu_display_field_index + 1) % NUM_CPU_DISPLAY_FIELDS;
+  DynamicHeapArray<u32>& buffer = m_cpu_display_fields[m_cpu_display_field_index];
+  if (buffer.size() != size)
+  {
+    // Like the presenter's field textures, contents are undefined after a size change.
+    buffer.resize(size);
+    std::memset(buffer.data(), 0, buffer.size() * sizeof(u32));
+  }
+
+  u8* const buffer_ptr = reinterpret_cast<u8*>(buffer.data());
+  if (ds.is_24bit && g_gpu_settings.display_24bit_chroma_smoothing)
+  {
+    m_cpu_display_scratch.resize(size * sizeof(u32));
+    CopyOutCPUDisplay(m_cpu_display_scratch.data(), stride, ds.src_y, ds.height, ds.line_skip);
+    GPU_SW_Display::ApplyChromaSmoothing(buffer_ptr, stride, m_cpu_display_scratch.data(), stride, ds.width,
+                                         ds.height, m_cpu_chroma_smoothing_buffer);
+  }
+  else
+  {
+    CopyOutCPUDisplay(buffer_ptr, stride, ds.src_y, ds.height, ds.line_skip);
+  }
+
+  m_cpu_display_field_captured = true;
+}
+
+void GPU_SW::RenderCPUDisplay(u8* dst_ptr, u32 dst_stride)
+{
+  const CPUDisplayState& ds = m_cpu_display;
+  const bool chroma_smoothing = (ds.is_24bit && g_gpu_settings.display_24bit_chroma_smoothing);
+  if (!ds.interlaced)
+  {
+    if (!chroma_smoothing)
+    {
+      CopyOutCPUDisplay(dst_ptr, dst_stride, ds.src_y, ds.height, 0);
+      return;
+    }
+
+    const u32 stride = ZeroExtend32(ds.width) * sizeof(u32);
+    m_cpu_display_scratch.resize(stride * ds.height);
+    CopyOutCPUDisplay(m_cpu_display_scratch.data(), stride, ds.src_y, ds.height, 0);
+    GPU_SW_Display::ApplyChromaSmoothing(dst_ptr, dst_stride, m_cpu_display_scratch.data(), stride, ds.width,
+                                         ds.height, m_cpu_chroma_smoothing_buffer);
+    return;
+  }
+
+  const DisplayDeinterlacingMode mode = g_gpu_settings.display_deinterlacing_mode;
+  if (!UseCPUDisplayFieldHistory())
+  {
+    if (mode == DisplayDeinterlacingMode::Weave)
+    {
+      // Both fields are in VRAM, read every line starting from the even field.
+      const u32 src_y = (ZeroExtend32(ds.src_y) + VRAM_HEIGHT - ds.field) % VRAM_HEIGHT;
+      CopyOutCPUDisplay(dst_ptr, dst_stride, src_y, ZeroExtend32(ds.height) * 2, 0);
+    }
+    else
+    {
+      CopyOutCPUDisplay(dst_ptr, dst_stride, ds.src_y, ds.height, ds.line_skip);
+    }
+
+    return;
+  }
+
+  // History is only kept once something is consuming the CPU display, so the current field may not be there yet.
+  if (!m_cpu_display_field_captured)
+    CaptureCPUDisplayField();
+
+  const u32* fields[NUM_CPU_DISPLAY_FIELDS];
+  for (u32 i = 0; i < NUM_CPU_DISPLAY_FIELDS; i++)
+  {
+    const DynamicHeapArray<u32>& buffer =
+      m_cpu_display_fields[(m_cpu_display_field_index + NUM_CPU_DISPLAY_FIELDS - i) % NUM_CPU_DISPLAY_FIELDS];
+
+    // Older fields of a different size are treated as black, much like the presenter's recreated textures.
+    if (buffer.size() != m_cpu_display_fields[m_cpu_display_field_index].size())
+    {
+      m_cpu_display_scratch.resize(ZeroExtend32(ds.width) * ds.height * sizeof(u32));
+      std::memset(m_cpu_display_scratch.data(), 0, m_cpu_display_scratch.size());
+      fields[i] = reinterpret_cast<const u32*>(m_cpu_display_scratch.data());
+    }
+    else
+    {
+      fields[i] = buffer.data();
+    }
+  }
+
+  switch (mode)
+  {
+    case DisplayDeinterlacingMode::Weave:
+      GPU_SW_Display::DeinterlaceWeave(dst_ptr, dst_stride, fields[0], fields[1], ds.width, ds.height, ds.field);
+      break;
+
+    case DisplayDeinterlacingMode::Blend:
+      GPU_SW_Display::DeinterlaceBlend(dst_ptr, dst_stride, fields[0], fields[1], ds.width, ds.height);
+      break;
+
+    case DisplayDeinterlacingMode::Adaptive:
+      GPU_SW_Display::DeinterlaceAdaptive(dst_ptr, dst_stride, fields, ds.width, ds.height, ds.field);
+      break;
+
+    default:
+    {
+      for (u32 row = 0; row < ds.height; row++)
+        std::memcpy(dst_ptr + row * dst_stride, fields[0] + row * ds.width, ds.width * sizeof(u32));
+    }
+    break;
+  }
+}
+
+bool GPU_SW::GetCPUDisplaySize(u32* width, u32* height) const
+{
+  if (!m_cpu_display.valid)
+    return false;
+
+  // Weave and adaptive deinterlacing produce full frames, other modes produce a single field like the presenter.
+  const DisplayDeinterlacingMode mode = g_gpu_settings.display_deinterlacing_mode;
+  const bool full_frame =
+    (m_cpu_display.interlaced && (mode == DisplayDeinterlacingMode::Weave || mode == DisplayDeinterlacingMode::Adaptive));
+  *width = m_cpu_display.width;
+  *height = ZeroExtend32(m_cpu_display.height) << BoolToUInt32(full_frame);
+  return true;
+}
+
+bool GPU_SW::RenderDisplayToBuffer(void* buffer, u32 pitch, u32 width, u32 height)
+{
+  u32 display_width, display_height;
+  if (!GetCPUDisplaySize(&display_width, &display_height))
+    return false;
+
+  // Start keeping field history for deinterlacing now that there is a consumer.
+  m_cpu_display_active = true;
+
+  // Write straight to the caller's buffer if no scaling is needed.
+  if (width == display_width && height == display_height)
+  {
+    RenderCPUDisplay(static_cast<u8*>(buffer), pitch);
+    return true;
+  }
+
+  const u32 src_stride = display_width * sizeof(u32);
+  if ((src_stride * display_height) > m_upload_buffer.size()) [[unlikely]]
+  {
+    ERROR_LOG("Display {}x{} is too large to scale on the CPU", display_width, display_height);
+    return false;
+  }
+
+  RenderCPUDisplay(m_upload_buffer.data(), src_stride);
+
+  // Nearest-neighbour scale, this also takes care of line doubling single fields.
+  const u32 x_step = (display_width << 16) / width;
+  const u32 y_step = (display_height << 16) / height;
+  u8* dst_ptr = static_cast<u8*>(buffer);
+  for (u32 row = 0, src_row_fp = 0; row < height; row++, src_row_fp += y_step)
+  {
+    const u32* src_row_ptr = reinterpret_cast<const u32*>(m_upload_buffer.data() + (src_row_fp >> 16) * src_stride);
+    u32* dst_row_ptr = reinterpret_cast<u32*>(dst_ptr);
+    for (u32 col = 0, src_col_fp = 0; col < width; col++, src_col_fp += x_step)
+      dst_row_ptr[col] = src_row_ptr[src_col_fp >> 16];
+
+    dst_ptr += pitch;
+  }
+
+  return true;
+}
+
 std::unique_ptr<GPUBackend> GPUBackend::CreateSoftwareBackend(GPUPresenter& presenter)
 {
   return std::make_unique<GPU_SW>(presenter);
@@ -5,11 +5,14 @@
 
 #include "gpu.h"
 #include "gpu_backend.h"
+#include "gpu_sw_display.h"
 
 #include "util/gpu_device.h"
 
+#include "common/gsvector.h"
 #include "common/heap_array.h"
 
+#include <array>
 #include <memory>
 
 // TODO: Move to cpp
@@ -25,6 +28,9 @@ public:
   void RestoreDeviceContext() override;
   void FlushRender() override;
 
+  bool GetCPUDisplaySize(u32* width, u32* height) const override;
+  bool RenderDisplayToBuffer(void* buffer, u32 pitch, u32 width, u32 height) override;
+
   u32 GetResolutionScale() const override;
 
   void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
@@ -54,6 +60,30 @@ public:
 private:
   static constexpr GPUTexture::Format FORMAT_FOR_24BIT = GPUTexture::Format::RGBA8; // RGBA8 always supported.
 
+  /// Number of previous fields kept by the CPU display path, matches the presenter's adaptive deinterlacer.
+  static constexpr u32 NUM_CPU_DISPLAY_FIELDS = 4;
+
+  /// Display area as read by the CPU display path. When interlaced, height is the height of a single field.
+  struct CPUDisplayState
+  {
+    u16 src_x;
+    u16 src_y;
+    u16 skip_x;
+    u16 width;
+    u16 height;
+    u8 line_skip;
+    u8 field;
+    bool is_24bit;
+    bool interlaced;
+    bool valid;
+  };
+
+  template<GPUTexture::Format display_format>
+  static void CopyOut15BitToBuffer(u8* dst_ptr, u32 dst_stride, u32 src_x, u32 src_y, u32 width, u32 height,
+                                   u32 line_skip);
+  static void CopyOut24BitToBuffer(u8* dst_ptr, u32 dst_stride, u32 src_x, u32 src_y, u32 skip_x, u32 width,
+                                   u32 height, u32 line_skip);
+
   template<GPUTexture::Format display_format>
   bool CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 line_skip);
 
@@ -63,7 +93,19 @@ private:
 
   GPUTexture* GetDisplayTexture(u32 width, u32 height, GPUTexture::Format format);
 
+  bool UseCPUDisplayFieldHistory() const;
+  void CopyOutCPUDisplay(u8* dst_ptr, u32 dst_stride, u32 src_y, u32 height, u32 line_skip) const;
+  void CaptureCPUDisplayField();
+  void RenderCPUDisplay(u8* dst_ptr, u32 dst_stride);
+
   FixedHeapArray<u8, GPU_MAX_DISPLAY_WIDTH * GPU_MAX_DISPLAY_HEIGHT * sizeof(u32)> m_upload_buffer;
   GPUTexture::Format m_16bit_display_format = GPUTexture::Format::Unknown;
   std::unique_ptr<GPUTexture> m_upload_texture;
+  CPUDisplayState m_cpu_display = {};
+  bool m_cpu_display_active = false;
+  bool m_cpu_display_field_captured = false;
+  u32 m_cpu_display_field_index = 0;
+  std::array<DynamicHeapArray<u32>, NUM_CPU_DISPLAY_FIELDS> m_cpu_display_fields;
+  DynamicHeapArray<u8> m_cpu_display_scratch;
+  GPU_SW_Display::ChromaSmoothingBuffer m_cpu_chroma_smoothing_buffer;
 };
@@ -0,0 +1,236 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "gpu_sw_display.h"
+
+#include "common/align.h"
+#include "common/assert.h"
+#include "common/gsvector.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace GPU_SW_Display {
+
+// Stands in for the rows past the top/bottom of a field, which read as zero from the shader's textures.
+static constexpr std::array<u32, MAX_WIDTH> s_zero_row = {};
+
+} // namespace GPU_SW_Display
+
+void GPU_SW_Display::DeinterlaceWeave(u8* dst_ptr, u32 dst_stride, const u32* cur_field, const u32* prev_field,
+                                      u32 width, u32 field_height, u32 field)
+{
+  // Lines from the previous field fill in the gaps, the same as the weave shader preserving the old target contents.
+  const u32 height = field_height * 2;
+  for (u32 row = 0; row < height; row++)
+  {
+    const u32* src_ptr = (((row & 1u) == field) ? cur_field : prev_field) + (row / 2) * width;
+    std::memcpy(dst_ptr, src_ptr, width * sizeof(u32));
+    dst_ptr += dst_stride;
+  }
+}
+
+void GPU_SW_Display::DeinterlaceBlend(u8* dst_ptr, u32 dst_stride, const u32* cur_field, const u32* prev_field,
+                                      u32 width, u32 field_height)
+{
+  constexpr u32 pixels_per_vec = 4;
+  const u32 aligned_width = Common::AlignDownPow2(width, pixels_per_vec);
+
+  for (u32 row = 0; row < field_height; row++)
+  {
+    u32* dst_row_ptr = reinterpret_cast<u32*>(dst_ptr);
+    u32 x = 0;
+    for (; x < aligned_width; x += pixels_per_vec)
+    {
+      GSVector4i::store<false>(&dst_row_ptr[x],
+                               GSVector4i::load<false>(&cur_field[x]).avg8(GSVector4i::load<false>(&prev_field[x])));
+    }
+    for (; x < width; x++)
+      GSVector4i::store32(&dst_row_ptr[x], GSVector4i::load32(&cur_field[x]).avg8(GSVector4i::load32(&prev_field[x])));
+
+    cur_field += width;
+    prev_field += width;
+    dst_ptr += dst_stride;
+  }
+}
+
+void GPU_SW_Display::DeinterlaceAdaptive(u8* dst_ptr, u32 dst_stride, const u32* const* fields, u32 width,
+                                         u32 field_height, u32 field)
+{
+  // Same as the FastMAD reconstruction shader: a missing line is interpolated from the lines above and below when
+  // any channel around the pixel moved by more than the sensitivity (0.08) between the previous fields, otherwise
+  // it is taken from the previous field. Lines past the top/bottom of the field read as zero, like texture loads.
+  const GSVector4i threshold = GSVector4i::cxpr(0x14141414);
+  const GSVector4i rgb_mask = GSVector4i::cxpr(0x00FFFFFF);
+  const GSVector4i alpha = GSVector4i::cxpr(static_cast<s32>(0xFF000000u));
+  const auto moved = [&threshold](const GSVector4i& n, const GSVector4i& o) {
+    return (n.subus8(o) | o.subus8(n)).subus8(threshold);
+  };
+  const auto reconstruct = [&](const u32* cur_above, const u32* cur_below, const u32* prev, const u32* old_above,
+                               const u32* old_below, const u32* old, u32 x, auto load) {
+    const GSVector4i hn = load(&cur_above[x]);
+    const GSVector4i ln = load(&cur_below[x]);
+    const GSVector4i cn = load(&prev[x]);
+    const GSVector4i motion =
+      moved(hn, load(&old_above[x])) | moved(cn, load(&old[x])) | moved(ln, load(&old_below[x]));
+    const GSVector4i mask = (motion & rgb_mask).eq32(GSVector4i::zero());
+    return hn.avg8(ln).blend8(cn, mask) | alpha;
+  };
+
+  DebugAssert(width <= MAX_WIDTH);
+
+  constexpr u32 pixels_per_vec = 4;
+  const u32 aligned_width = Common::AlignDownPow2(width, pixels_per_vec);
+  const u32 height = field_height * 2;
+  for (u32 row = 0; row < height; row++)
+  {
+    const u32 field_row = row / 2;
+    u32* dst_row_ptr = reinterpret_cast<u32*>(dst_ptr);
+    dst_ptr += dst_stride;
+
+    if ((row & 1u) == field || row == 0)
+    {
+      const u32* src_row_ptr = fields[((row & 1u) == field) ? 0 : 1] + field_row * width;
+      u32 x = 0;
+      for (; x < aligned_width; x += pixels_per_vec)
+        GSVector4i::store<false>(&dst_row_ptr[x], GSVector4i::load<false>(&src_row_ptr[x]) | alpha);
+      for (; x < width; x++)
+        dst_row_ptr[x] = src_row_ptr[x] | 0xFF000000u;
+      continue;
+    }
+
+    const bool has_above = (field_row > 0);
+    const bool has_below = ((field_row + 1) < field_height);
+    const u32 offset = field_row * width;
+    const u32* cur_above = has_above ? (fields[0] + offset - width) : s_zero_row.data();
+    const u32* cur_below = has_below ? (fields[0] + offset + width) : s_zero_row.data();
+    const u32* prev = fields[1] + offset;
+    const u32* old_above = has_above ? (fields[2] + offset - width) : s_zero_row.data();
+    const u32* old_below = has_below ? (fields[2] + offset + width) : s_zero_row.data();
+    const u32* old = fields[3] + offset;
+
+    u32 x = 0;
+    for (; x < aligned_width; x += pixels_per_vec)
+    {
+      GSVector4i::store<false>(&dst_row_ptr[x],
+                               reconstruct(cur_above, cur_below, prev, old_above, old_below, old, x,
+                                           [](const u32* p) { return GSVector4i::load<false>(p); }));
+    }
+    for (; x < width; x++)
+    {
+      GSVector4i::store32(&dst_row_ptr[x], reconstruct(cur_above, cur_below, prev, old_above, old_below, old, x,
+                                                       [](const u32* p) { return GSVector4i::load32(p); }));
+    }
+  }
+}
+
+void GPU_SW_Display::ApplyChromaSmoothing(u8* dst_ptr, u32 dst_stride, const u8* src_ptr, u32 src_stride, u32 width,
+                                          u32 height, ChromaSmoothingBuffer& buffer)
+{
+  // Mirrors the chroma smoothing shader: chroma is bilinearly interpolated from 2x2 block averages, luma is kept from
+  // the original pixel. The 2x2 averages at the right/bottom edge read zero past the edge, like texture loads.
+  //
+  // Converting the interpolated colour to YUV, replacing Y, and converting back is the same as adding the difference
+  // in luma to every channel, so that's all that is done here, in 16-bit fixed point with two pixels per vector. The
+  // interpolated colour is scaled by 64, 4 from summing the block instead of averaging it, and 4 for each of the
+  // horizontal and vertical 1/4 and 3/4 weights. Luma uses BT.601 weights scaled by 32768.
+  static constexpr GSVector4i luma_weights = GSVector4i::cxpr16(9798, 19235, 3735, 0, 9798, 19235, 3735, 0);
+  static constexpr GSVector4i luma_round = GSVector4i::cxpr(1 << 14);
+  static constexpr GSVector4i output_round = GSVector4i::cxpr16(32);
+  static constexpr GSVector4i alpha = GSVector4i::cxpr(static_cast<s32>(0xFF000000u));
+  static constexpr u32 ENTRY_SIZE = 4;
+
+  if (width == 0 || height == 0) [[unlikely]]
+    return;
+
+  // Block sums, then the two horizontally interpolated block rows the current line interpolates between.
+  buffer.resize(width * ENTRY_SIZE * 3);
+  u16* const block_sums = buffer.data();
+  u16* const h_rows[2] = {buffer.data() + width * ENTRY_SIZE, buffer.data() + width * ENTRY_SIZE * 2};
+  s32 h_row_ys[2] = {-1, -1};
+
+  // 16-bit channels of the pixel pair at (x, y), the second pixel reads as zero past the right edge.
+  const auto load_pair = [src_ptr, src_stride, width](u32 x, u32 y) {
+    const u8* ptr = src_ptr + y * src_stride + x * sizeof(u32);
+    return (((x + 1) < width) ? GSVector4i::loadl<false>(ptr) : GSVector4i::load32(ptr)).u8to16();
+  };
+
+  // Weights of 1/4 and 3/4 towards the second value, times 4.
+  const auto lerp = [](const GSVector4i& a, const GSVector4i& b, bool odd) {
+    return a.add16(b).add16((odd ? b : a).sll16<1>());
+  };
+
+  const auto get_h_row = [&](u32 by) -> const u16* {
+    for (u32 i = 0; i < 2; i++)
+    {
+      if (h_row_ys[i] == static_cast<s32>(by))
+        return h_rows[i];
+    }
+
+    // Replace whichever row isn't the other one needed for this line, i.e. the older one.
+    const u32 index = (h_row_ys[0] < h_row_ys[1]) ? 0 : 1;
+    u16* const row = h_rows[index];
+    h_row_ys[index] = static_cast<s32>(by);
+
+    // Only even columns and the last column are ever sampled.
+    const bool has_below = ((by + 1) < height);
+    const auto compute = [&](u32 bx) {
+      GSVector4i sum = load_pair(bx, by);
+      if (has_below)
+        sum = sum.add16(load_pair(bx, by + 1));
+      GSVector4i::storel<false>(&block_sums[bx * ENTRY_SIZE], sum.add16(sum.zwzw()));
+    };
+    for (u32 bx = 0; bx < width; bx += 2)
+      compute(bx);
+    if ((width & 1u) == 0)
+      compute(width - 1);
+
+    for (u32 x = 0; x < width; x++)
+    {
+      const u32 base_x = (x == 0) ? 1 : (x - 1);
+      const u32 low_x = std::min(base_x & ~1u, width - 1);
+      const u32 high_x = std::min(low_x + 2, width - 1);
+      GSVector4i::storel<false>(&row[x * ENTRY_SIZE],
+                                lerp(GSVector4i::loadl<false>(&block_sums[low_x * ENTRY_SIZE]),
+                                     GSVector4i::loadl<false>(&block_sums[high_x * ENTRY_SIZE]), (base_x & 1u) != 0));
+    }
+
+    return row;
+  };
+
+  const auto smooth = [](const GSVector4i& p, const GSVector4i& s) {
+    const GSVector4i diff = p.sll16<6>().sub16(s).madd_s16(luma_weights);
+    const GSVector4i luma = diff.add32(diff.yxwz()).add32(luma_round).sra32<15>().ps32();
+    return s.add16(luma.upl16(luma)).add16(output_round).sra16<6>().pu16() | alpha;
+  };
+
+  for (u32 y = 0; y < height; y++)
+  {
+    const u32 base_y = (y == 0) ? 1 : (y - 1);
+    const u32 low_y = std::min(base_y & ~1u, height - 1);
+    const u32 high_y = std::min(low_y + 2, height - 1);
+    const bool odd_y = ((base_y & 1u) != 0);
+    const u16* low_row = get_h_row(low_y);
+    const u16* high_row = get_h_row(high_y);
+
+    const u8* src_row_ptr = src_ptr + y * src_stride;
+    u32 x = 0;
+    for (; (x + 1) < width; x += 2)
+    {
+      const GSVector4i s = lerp(GSVector4i::load<false>(&low_row[x * ENTRY_SIZE]),
+                                GSVector4i::load<false>(&high_row[x * ENTRY_SIZE]), odd_y);
+      const GSVector4i p = GSVector4i::loadl<false>(src_row_ptr + x * sizeof(u32)).u8to16();
+      GSVector4i::storel<false>(dst_ptr + x * sizeof(u32), smooth(p, s));
+    }
+    if (x < width)
+    {
+      const GSVector4i s = lerp(GSVector4i::loadl<false>(&low_row[x * ENTRY_SIZE]),
+                                GSVector4i::loadl<false>(&high_row[x * ENTRY_SIZE]), odd_y);
+      const GSVector4i p = GSVector4i::load32(src_row_ptr + x * sizeof(u32)).u8to16();
+      GSVector4i::store32(dst_ptr + x * sizeof(u32), smooth(p, s));
+    }
+
+    dst_ptr += dst_stride;
+  }
+}
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#pragma once
+
+#include "common/heap_array.h"
+#include "common/types.h"
+
+/// CPU versions of the presenter's deinterlacing and chroma smoothing shaders, used by the software renderer when the
+/// display is read back without a GPU device. Fields and images are RGBA8, with rows of width pixels.
+namespace GPU_SW_Display {
+
+/// Widest field the functions accept, lines past the top/bottom of a field are read from a zero row of this size.
+static constexpr u32 MAX_WIDTH = 1024;
+
+/// Scratch buffer for ApplyChromaSmoothing(), kept by the caller so it isn't reallocated every frame.
+using ChromaSmoothingBuffer = DynamicHeapArray<u16, 16>;
+
+/// Interleaves the current field with the lines of the previous field, producing field_height * 2 lines.
+void DeinterlaceWeave(u8* dst_ptr, u32 dst_stride, const u32* cur_field, const u32* prev_field, u32 width,
+                      u32 field_height, u32 field);
+
+/// Averages the current and previous fields, producing field_height lines.
+void DeinterlaceBlend(u8* dst_ptr, u32 dst_stride, const u32* cur_field, const u32* prev_field, u32 width,
+                      u32 field_height);
+
+/// FastMAD reconstruction from the last four fields, newest first, producing field_height * 2 lines.
+void DeinterlaceAdaptive(u8* dst_ptr, u32 dst_stride, const u32* const* fields, u32 width, u32 field_height,
+                         u32 field);
+
+/// Replaces the chroma of each pixel with an interpolation of the 2x2 block averages around it, keeping its luma.
+void ApplyChromaSmoothing(u8* dst_ptr, u32 dst_stride, const u8* src_ptr, u32 src_stride, u32 width, u32 height,
+                          ChromaSmoothingBuffer& buffer);
+
+} // namespace GPU_SW_Display
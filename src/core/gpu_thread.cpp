@@ -3,6 +3,7 @@
 
 #include "gpu_thread.h"
 #include "fullscreen_ui.h"
+#include "gpu.h"
 #include "gpu_backend.h"
 #include "gpu_hw_texture_cache.h"
 #include "gpu_presenter.h"
@@ -66,6 +67,12 @@ template<class T, typename... Args>
 T* AllocateCommand(GPUBackendCommandType type, Args... args);
 
 static u32 GetPendingCommandSize();
+static void UpdatePushStatistics(u32 size, u32 pending);
+static void RecordSync(SyncReason reason, Timer::Value spin_ticks, Timer::Value sleep_ticks);
+static void TrackVRAMWrites(const GPUThreadCommand* cmd);
+static void AddPendingVRAMWrite(const GSVector4i rect, u64 sequence);
+static void PrunePendingVRAMWrites(u64 completed_sequence);
+static void CompleteCommand();
 static void ResetCommandFIFO();
 static bool IsCommandFIFOEmpty();
 static void WakeGPUThread();
@@ -73,6 +80,8 @@ static bool SleepGPUThread(bool allow_sleep);
 
 static bool CreateDeviceOnThread(RenderAPI api, bool fullscreen, bool clear_fsui_state_on_failure, Error* error);
 static void DestroyDeviceOnThread(bool clear_fsui_state);
+static bool AcquireHeadlessWindowOnThread(bool fullscreen, Error* error);
+static void ReleaseHeadlessWindowOnThread();
 static void ResizeDisplayWindowOnThread(u32 width, u32 height, float scale);
 static void UpdateDisplayWindowOnThread(bool fullscreen, bool allow_exclusive_fullscreen);
 static void DisplayWindowResizedOnThread();
@@ -90,6 +99,56 @@ static void UpdateRunIdle();
 
 namespace {
 
+/// Counters are only ever written by one thread, so increments don't need to be locked.
+template<typename T>
+ALWAYS_INLINE static void IncrementCounter(std::atomic<T>& counter, T value = 1)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+struct FIFOCounters
+{
+  // Written by CPU thread.
+  std::atomic<u64> commands_pushed{0};
+  std::atomic<u64> bytes_pushed{0};
+  std::atomic<u64> occupancy_sum{0};
+  std::atomic<u32> peak_occupancy{0};
+  std::atomic<u32> interval_peak_occupancy{0};
+  std::atomic<u64> wraparounds{0};
+  std::atomic<u64> wakeups{0};
+  std::atomic<u64> fifo_full_waits{0};
+  std::atomic<u64> fifo_full_wait_ticks{0};
+  std::array<std::atomic<u64>, FIFOStatistics::NUM_OCCUPANCY_BUCKETS> occupancy_histogram = {};
+  std::array<std::atomic<u64>, FIFOStatistics::NUM_SYNC_REASONS> sync_count = {};
+  std::array<std::atomic<u64>, FIFOStatistics::NUM_SYNC_REASONS> sync_stall_count = {};
+  std::array<std::atomic<u64>, FIFOStatistics::NUM_SYNC_REASONS> sync_spin_ticks = {};
+  std::array<std::atomic<u64>, FIFOStatistics::NUM_SYNC_REASONS> sync_sleep_ticks = {};
+  std::atomic<u64> shadow_vram_readbacks{0};
+  std::atomic<u64> shadow_vram_partial_waits{0};
+
+  // Written by GPU thread.
+  ALIGN_TO_CACHE_LINE std::atomic<u64> gpu_thread_sleeps{0};
+};
+
+/// Counted on every push by the CPU thread without atomics, and added to FIFOCounters once per frame.
+struct PushCounters
+{
+  u64 commands_pushed = 0;
+  u64 bytes_pushed = 0;
+  u64 occupancy_sum = 0;
+  u32 peak_occupancy = 0;
+  std::array<u32, FIFOStatistics::NUM_OCCUPANCY_BUCKETS> occupancy_histogram = {};
+};
+
+/// Area of VRAM that will be modified by a command which the GPU thread may not have executed yet.
+struct PendingVRAMWrite
+{
+  GSVector4i rect;
+  u64 sequence;
+};
+
+static constexpr u32 MAX_PENDING_VRAM_WRITES = 32;
+
 struct ALIGN_TO_CACHE_LINE State
 {
   // Owned by CPU thread.
@@ -100,6 +159,12 @@ struct ALIGN_TO_CACHE_LINE State
   std::optional<GPURenderer> requested_renderer; // TODO: Non thread safe accessof this
   bool use_gpu_thread = false;
 
+  // Shadow VRAM write tracking, lets readbacks skip draining the FIFO when the area is already up to date.
+  u32 num_pending_vram_writes = 0;
+  u64 submitted_sequence = 0;
+  GSVector4i drawing_area_rect = GSVector4i::cxpr(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  std::array<PendingVRAMWrite, MAX_PENDING_VRAM_WRITES> pending_vram_writes;
+
   // Hot variables between both threads.
   ALIGN_TO_CACHE_LINE std::atomic<u32> command_fifo_write_ptr{0};
   std::atomic<s32> thread_wake_count{0}; // <0 = sleeping, >= 0 = has work
@@ -110,17 +175,31 @@ struct ALIGN_TO_CACHE_LINE State
   ALIGN_TO_CACHE_LINE std::unique_ptr<GPUBackend> gpu_backend;
   ALIGN_TO_CACHE_LINE std::unique_ptr<GPUPresenter> gpu_presenter;
   std::atomic<u32> command_fifo_read_ptr{0};
+  std::atomic<u64> completed_sequence{0};
   u8 run_idle_reasons = 0;
   bool run_idle_flag = false;
   GPUVSyncMode requested_vsync = GPUVSyncMode::Disabled;
   bool requested_allow_present_throttle = false;
   bool requested_fullscreen_ui = false;
+  bool has_headless_window = false;
   std::string game_serial;
 };
 
 } // namespace
 
 static State s_state;
+static FIFOCounters s_counters;
+static PushCounters s_push_counters;
+
+static constexpr const std::array<const char*, static_cast<size_t>(SyncReason::MaxCount)> s_sync_reason_names = {{
+  "VRAMReadback",
+  "SaveState",
+  "SettingsChange",
+  "Reconfigure",
+  "BackendCall",
+  "Debug",
+  "Shutdown",
+}};
 
 } // namespace GPUThread
 
@@ -148,7 +227,7 @@ void GPUThread::Internal::ProcessStartup()
 void GPUThread::Internal::RequestShutdown()
 {
   INFO_LOG("Shutting down GPU thread...");
-  SyncGPUThread(false);
+  SyncGPUThread(false, SyncReason::Shutdown);
 
   // Thread must be enabled to shut it down.
   SetThreadEnabled(true);
@@ -166,11 +245,18 @@ GPUThreadCommand* GPUThread::AllocateCommand(GPUBackendCommandType command, u32
     if (read_ptr > write_ptr)
     {
       u32 available_size = read_ptr - write_ptr;
-      while (available_size < (size + sizeof(GPUBackendCommandType)))
+      if (available_size < (size + sizeof(GPUBackendCommandType))) [[unlikely]]
       {
-        WakeGPUThread();
-        read_ptr = s_state.command_fifo_read_ptr.load(std::memory_order_acquire);
-        available_size = (read_ptr > write_ptr) ? (read_ptr - write_ptr) : (COMMAND_QUEUE_SIZE - write_ptr);
+        const Timer::Value wait_start = Timer::GetCurrentValue();
+        while (available_size < (size + sizeof(GPUBackendCommandType)))
+        {
+          WakeGPUThread();
+          read_ptr = s_state.command_fifo_read_ptr.load(std::memory_order_acquire);
+          available_size = (read_ptr > write_ptr) ? (read_ptr - write_ptr) : (COMMAND_QUEUE_SIZE - write_ptr);
+        }
+
+        IncrementCounter<u64>(s_counters.fifo_full_waits);
+        IncrementCounter<u64>(s_counters.fifo_full_wait_ticks, Timer::GetCurrentValue() - wait_start);
       }
     }
     else
@@ -183,6 +269,7 @@ GPUThreadCommand* GPUThread::AllocateCommand(GPUBackendCommandType command, u32
         dummy_cmd->type = GPUBackendCommandType::Wraparound;
         dummy_cmd->size = available_size;
         s_state.command_fifo_write_ptr.store(0, std::memory_order_release);
+        IncrementCounter<u64>(s_counters.wraparounds);
         continue;
       }
     }
@@ -223,6 +310,201 @@ u32 GPUThread::GetPendingCommandSize()
   return (write_ptr >= read_ptr) ? (write_ptr - read_ptr) : (COMMAND_QUEUE_SIZE - read_ptr + write_ptr);
 }
 
+ALWAYS_INLINE_RELEASE void GPUThread::UpdatePushStatistics(u32 size, u32 pending)
+{
+  PushCounters& pc = s_push_counters;
+  pc.commands_pushed++;
+  pc.bytes_pushed += size;
+  pc.occupancy_sum += pending;
+  pc.occupancy_histogram[std::min<u32>(
+    static_cast<u32>((static_cast<u64>(pending) * FIFOStatistics::NUM_OCCUPANCY_BUCKETS) / COMMAND_QUEUE_SIZE),
+    FIFOStatistics::NUM_OCCUPANCY_BUCKETS - 1)]++;
+  pc.peak_occupancy = std::max(pc.peak_occupancy, pending);
+}
+
+void GPUThread::PublishPushStatistics()
+{
+  PushCounters& pc = s_push_counters;
+  if (pc.commands_pushed == 0)
+    return;
+
+  IncrementCounter<u64>(s_counters.commands_pushed, pc.commands_pushed);
+  IncrementCounter<u64>(s_counters.bytes_pushed, pc.bytes_pushed);
+  IncrementCounter<u64>(s_counters.occupancy_sum, pc.occupancy_sum);
+  for (u32 i = 0; i < FIFOStatistics::NUM_OCCUPANCY_BUCKETS; i++)
+    IncrementCounter<u64>(s_counters.occupancy_histogram[i], pc.occupancy_histogram[i]);
+  if (pc.peak_occupancy > s_counters.peak_occupancy.load(std::memory_order_relaxed))
+    s_counters.peak_occupancy.store(pc.peak_occupancy, std::memory_order_relaxed);
+  if (pc.peak_occupancy > s_counters.interval_peak_occupancy.load(std::memory_order_relaxed))
+    s_counters.interval_peak_occupancy.store(pc.peak_occupancy, std::memory_order_relaxed);
+
+  pc = {};
+}
+
+void GPUThread::RecordSync(SyncReason reason, Timer::Value spin_ticks, Timer::Value sleep_ticks)
+{
+  const size_t index = static_cast<size_t>(reason);
+  IncrementCounter<u64>(s_counters.sync_count[index]);
+  if (spin_ticks == 0 && sleep_ticks == 0)
+    return;
+
+  IncrementCounter<u64>(s_counters.sync_stall_count[index]);
+  IncrementCounter<u64>(s_counters.sync_spin_ticks[index], spin_ticks);
+  IncrementCounter<u64>(s_counters.sync_sleep_ticks[index], sleep_ticks);
+}
+
+u32 GPUThread::TakeFIFOIntervalPeakOccupancy()
+{
+  return s_counters.interval_peak_occupancy.exchange(0, std::memory_order_relaxed);
+}
+
+GPUThread::FIFOStatistics GPUThread::GetFIFOStatistics()
+{
+  FIFOStatistics ret;
+  ret.commands_pushed = s_counters.commands_pushed.load(std::memory_order_relaxed);
+  ret.bytes_pushed = s_counters.bytes_pushed.load(std::memory_order_relaxed);
+  ret.occupancy_sum = s_counters.occupancy_sum.load(std::memory_order_relaxed);
+  ret.peak_occupancy = s_counters.peak_occupancy.load(std::memory_order_relaxed);
+  ret.fifo_size = COMMAND_QUEUE_SIZE;
+  ret.wraparounds = s_counters.wraparounds.load(std::memory_order_relaxed);
+  ret.wakeups = s_counters.wakeups.load(std::memory_order_relaxed);
+  ret.gpu_thread_sleeps = s_counters.gpu_thread_sleeps.load(std::memory_order_relaxed);
+  ret.fifo_full_waits = s_counters.fifo_full_waits.load(std::memory_order_relaxed);
+  ret.shadow_vram_readbacks = s_counters.shadow_vram_readbacks.load(std::memory_order_relaxed);
+  ret.shadow_vram_partial_waits = s_counters.shadow_vram_partial_waits.load(std::memory_order_relaxed);
+  ret.fifo_full_wait_ms =
+    Timer::ConvertValueToMilliseconds(s_counters.fifo_full_wait_ticks.load(std::memory_order_relaxed));
+  for (u32 i = 0; i < FIFOStatistics::NUM_OCCUPANCY_BUCKETS; i++)
+    ret.occupancy_histogram[i] = s_counters.occupancy_histogram[i].load(std::memory_order_relaxed);
+  for (u32 i = 0; i < FIFOStatistics::NUM_SYNC_REASONS; i++)
+  {
+    ret.sync_count[i] = s_counters.sync_count[i].load(std::memory_order_relaxed);
+    ret.sync_stall_count[i] = s_counters.sync_stall_count[i].load(std::memory_order_relaxed);
+    ret.sync_spin_ms[i] = Timer::ConvertValueToMilliseconds(s_counters.sync_spin_ticks[i].load(std::memory_order_relaxed));
+    ret.sync_sleep_ms[i] =
+      Timer::ConvertValueToMilliseconds(s_counters.sync_sleep_ticks[i].load(std::memory_order_relaxed));
+  }
+  return ret;
+}
+
+const char* GPUThread::GetSyncReasonName(SyncReason reason)
+{
+  return s_sync_reason_names[static_cast<size_t>(reason)];
+}
+
+void GPUThread::TrackVRAMWrites(const GPUThreadCommand* cmd)
+{
+  const u64 sequence = ++s_state.submitted_sequence;
+  switch (cmd->type)
+  {
+    case GPUBackendCommandType::DrawPolygon:
+    case GPUBackendCommandType::DrawPrecisePolygon:
+    case GPUBackendCommandType::DrawRectangle:
+    case GPUBackendCommandType::DrawLine:
+    case GPUBackendCommandType::DrawPreciseLine:
+    {
+      // Primitives are clipped to the drawing area, so consecutive draws usually collapse into one entry.
+      AddPendingVRAMWrite(s_state.drawing_area_rect, sequence);
+    }
+    break;
+
+    case GPUBackendCommandType::FillVRAM:
+    {
+      const GPUBackendFillVRAMCommand* ccmd = static_cast<const GPUBackendFillVRAMCommand*>(cmd);
+      AddPendingVRAMWrite(GetVRAMTransferBounds(ccmd->x, ccmd->y, ccmd->width, ccmd->height), sequence);
+    }
+    break;
+
+    case GPUBackendCommandType::UpdateVRAM:
+    {
+      const GPUBackendUpdateVRAMCommand* ccmd = static_cast<const GPUBackendUpdateVRAMCommand*>(cmd);
+      AddPendingVRAMWrite(GetVRAMTransferBounds(ccmd->x, ccmd->y, ccmd->width, ccmd->height), sequence);
+    }
+    break;
+
+    case GPUBackendCommandType::CopyVRAM:
+    {
+      const GPUBackendCopyVRAMCommand* ccmd = static_cast<const GPUBackendCopyVRAMCommand*>(cmd);
+      AddPendingVRAMWrite(GetVRAMTransferBounds(ccmd->dst_x, ccmd->dst_y, ccmd->width, ccmd->height), sequence);
+    }
+    break;
+
+    case GPUBackendCommandType::SetDrawingArea:
+    {
+      const GPUBackendSetDrawingAreaCommand* ccmd = static_cast<const GPUBackendSetDrawingAreaCommand*>(cmd);
+      s_state.drawing_area_rect = GPU::GetClampedDrawingArea(ccmd->new_area);
+    }
+    break;
+
+    case GPUBackendCommandType::ClearDisplay:
+    case GPUBackendCommandType::UpdateDisplay:
+    case GPUBackendCommandType::SubmitFrame:
+    case GPUBackendCommandType::BufferSwapped:
+    case GPUBackendCommandType::SaveMemoryState:
+    case GPUBackendCommandType::ReadVRAM:
+    case GPUBackendCommandType::UpdateCLUT:
+    case GPUBackendCommandType::ClearCache:
+      break;
+
+    default:
+    {
+      // Anything else could touch the whole of VRAM, including the drawing area the GPU thread is using.
+      s_state.drawing_area_rect = GSVector4i::cxpr(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+      s_state.num_pending_vram_writes = 0;
+      AddPendingVRAMWrite(s_state.drawing_area_rect, sequence);
+    }
+    break;
+  }
+}
+
+void GPUThread::AddPendingVRAMWrite(const GSVector4i rect, u64 sequence)
+{
+  if (s_state.num_pending_vram_writes > 0)
+  {
+    PendingVRAMWrite& last = s_state.pending_vram_writes[s_state.num_pending_vram_writes - 1];
+    if (last.rect.rcontains(rect))
+    {
+      last.sequence = sequence;
+      return;
+    }
+  }
+
+  if (s_state.num_pending_vram_writes == MAX_PENDING_VRAM_WRITES) [[unlikely]]
+  {
+    PrunePendingVRAMWrites(s_state.completed_sequence.load(std::memory_order_acquire));
+    if (s_state.num_pending_vram_writes == MAX_PENDING_VRAM_WRITES)
+    {
+      // Still full, fold everything into one entry. Less precise, but still correct.
+      GSVector4i merged_rect = rect;
+      for (const PendingVRAMWrite& pw : s_state.pending_vram_writes)
+        merged_rect = merged_rect.runion(pw.rect);
+      s_state.pending_vram_writes[0] = PendingVRAMWrite{merged_rect, sequence};
+      s_state.num_pending_vram_writes = 1;
+      return;
+    }
+  }
+
+  s_state.pending_vram_writes[s_state.num_pending_vram_writes++] = PendingVRAMWrite{rect, sequence};
+}
+
+void GPUThread::PrunePendingVRAMWrites(u64 completed_sequence)
+{
+  u32 remaining = 0;
+  for (u32 i = 0; i < s_state.num_pending_vram_writes; i++)
+  {
+    if (s_state.pending_vram_writes[i].sequence > completed_sequence)
+      s_state.pending_vram_writes[remaining++] = s_state.pending_vram_writes[i];
+  }
+  s_state.num_pending_vram_writes = remaining;
+}
+
+ALWAYS_INLINE_RELEASE void GPUThread::CompleteCommand()
+{
+  // Only the GPU thread writes this, the release pairs with the acquire in SyncGPUThreadForVRAMRead().
+  s_state.completed_sequence.store(s_state.completed_sequence.load(std::memory_order_relaxed) + 1,
+                                   std::memory_order_release);
+}
+
 bool GPUThread::IsCommandFIFOEmpty()
 {
   const u32 read_ptr = s_state.command_fifo_read_ptr.load(std::memory_order_acquire);
@@ -239,10 +521,14 @@ void GPUThread::PushCommand(GPUThreadCommand* cmd)
     return;
   }
 
+  TrackVRAMWrites(cmd);
+
   const u32 new_write_ptr = s_state.command_fifo_write_ptr.fetch_add(cmd->size, std::memory_order_release) + cmd->size;
   DebugAssert(new_write_ptr <= COMMAND_QUEUE_SIZE);
   UNREFERENCED_VARIABLE(new_write_ptr);
-  if (GetPendingCommandSize() >= THRESHOLD_TO_WAKE_GPU) // TODO:FIXME: maybe purge this?
+  const u32 pending = GetPendingCommandSize();
+  UpdatePushStatistics(cmd->size, pending);
+  if (pending >= THRESHOLD_TO_WAKE_GPU) // TODO:FIXME: maybe purge this?
     WakeGPUThread();
 }
 
@@ -255,13 +541,16 @@ void GPUThread::PushCommandAndWakeThread(GPUThreadCommand* cmd)
     return;
   }
 
+  TrackVRAMWrites(cmd);
+
   const u32 new_write_ptr = s_state.command_fifo_write_ptr.fetch_add(cmd->size, std::memory_order_release) + cmd->size;
   DebugAssert(new_write_ptr <= COMMAND_QUEUE_SIZE);
   UNREFERENCED_VARIABLE(new_write_ptr);
+  UpdatePushStatistics(cmd->size, GetPendingCommandSize());
   WakeGPUThread();
 }
 
-void GPUThread::PushCommandAndSync(GPUThreadCommand* cmd, bool spin)
+void GPUThread::PushCommandAndSync(GPUThreadCommand* cmd, bool spin, SyncReason reason)
 {
   if (!s_state.use_gpu_thread) [[unlikely]]
   {
@@ -270,11 +559,14 @@ void GPUThread::PushCommandAndSync(GPUThreadCommand* cmd, bool spin)
     return;
   }
 
+  TrackVRAMWrites(cmd);
+
   const u32 new_write_ptr = s_state.command_fifo_write_ptr.fetch_add(cmd->size, std::memory_order_release) + cmd->size;
   DebugAssert(new_write_ptr <= COMMAND_QUEUE_SIZE);
   UNREFERENCED_VARIABLE(new_write_ptr);
+  UpdatePushStatistics(cmd->size, GetPendingCommandSize());
   WakeGPUThread();
-  SyncGPUThread(spin);
+  SyncGPUThread(spin, reason);
 }
 
 ALWAYS_INLINE s32 GetThreadWakeCount(s32 state)
@@ -287,21 +579,28 @@ void GPUThread::WakeGPUThread()
   // If sleeping, state will be <0, otherwise this will increment the pending work count.
   // We add 2 so that there's a positive work count if we were sleeping, otherwise the thread would go to sleep.
   if (s_state.thread_wake_count.fetch_add(2, std::memory_order_release) < 0)
+  {
     s_state.thread_wake_semaphore.Post();
+    IncrementCounter<u64>(s_counters.wakeups);
+  }
 }
 
-void GPUThread::SyncGPUThread(bool spin)
+void GPUThread::SyncGPUThread(bool spin, SyncReason reason)
 {
   if (!s_state.use_gpu_thread)
     return;
 
+  Timer::Value spin_ticks = 0;
   if (spin)
   {
     // Check if the GPU thread is done/sleeping.
     if (GetThreadWakeCount(s_state.thread_wake_count.load(std::memory_order_acquire)) < 0)
     {
       if (IsCommandFIFOEmpty())
+      {
+        RecordSync(reason, 0, 0);
         return;
+      }
 
       WakeGPUThread();
     }
@@ -314,7 +613,10 @@ void GPUThread::SyncGPUThread(bool spin)
       if (GetThreadWakeCount(s_state.thread_wake_count.load(std::memory_order_acquire)) < 0)
       {
         if (IsCommandFIFOEmpty())
+        {
+          RecordSync(reason, std::max<Timer::Value>(Timer::GetCurrentValue() - start_time, 1), 0);
           return;
+        }
 
         WakeGPUThread();
         continue;
@@ -325,6 +627,8 @@ void GPUThread::SyncGPUThread(bool spin)
 
       current_time = Timer::GetCurrentValue();
     } while ((current_time - start_time) < s_state.thread_spin_time);
+
+    spin_ticks = current_time - start_time;
   }
 
   // s_thread_wake_count |= THREAD_WAKE_COUNT_CPU_THREAD_IS_WAITING if not zero
@@ -336,14 +640,72 @@ void GPUThread::SyncGPUThread(bool spin)
     if (GetThreadWakeCount(value) < 0)
     {
       if (IsCommandFIFOEmpty())
+      {
+        RecordSync(reason, spin_ticks, 0);
         return;
+      }
 
       WakeGPUThread();
       continue;
     }
   } while (!s_state.thread_wake_count.compare_exchange_weak(value, value | THREAD_WAKE_COUNT_CPU_THREAD_IS_WAITING,
                                                             std::memory_order_acq_rel, std::memory_order_relaxed));
+
+  const Timer::Value sleep_start = Timer::GetCurrentValue();
   s_state.thread_is_done_semaphore.Wait();
+  RecordSync(reason, spin_ticks, std::max<Timer::Value>(Timer::GetCurrentValue() - sleep_start, 1));
+}
+
+void GPUThread::SyncGPUThreadForVRAMRead(u32 x, u32 y, u32 width, u32 height, bool spin, SyncReason reason)
+{
+  if (!s_state.use_gpu_thread)
+    return;
+
+  // Only the commands that write to the area being read need to have executed.
+  const GSVector4i rect = GetVRAMTransferBounds(x, y, width, height);
+  PrunePendingVRAMWrites(s_state.completed_sequence.load(std::memory_order_acquire));
+
+  u64 wait_sequence = 0;
+  for (u32 i = 0; i < s_state.num_pending_vram_writes; i++)
+  {
+    const PendingVRAMWrite& pw = s_state.pending_vram_writes[i];
+    if (pw.rect.rintersects(rect))
+      wait_sequence = std::max(wait_sequence, pw.sequence);
+  }
+
+  if (wait_sequence == 0)
+  {
+    IncrementCounter<u64>(s_counters.shadow_vram_readbacks);
+    RecordSync(reason, 0, 0);
+    return;
+  }
+
+  if (spin)
+  {
+    WakeGPUThread();
+
+    const Timer::Value start_time = Timer::GetCurrentValue();
+    Timer::Value current_time = start_time;
+    do
+    {
+      if (s_state.completed_sequence.load(std::memory_order_acquire) >= wait_sequence)
+      {
+        IncrementCounter<u64>(s_counters.shadow_vram_readbacks);
+        IncrementCounter<u64>(s_counters.shadow_vram_partial_waits);
+        RecordSync(reason, std::max<Timer::Value>(Timer::GetCurrentValue() - start_time, 1), 0);
+        return;
+      }
+
+      MultiPause();
+      current_time = Timer::GetCurrentValue();
+    } while ((current_time - start_time) < s_state.thread_spin_time);
+
+    IncrementCounter<u64>(s_counters.sync_spin_ticks[static_cast<size_t>(reason)], current_time - start_time);
+  }
+
+  // Took too long, fall back to waiting for the thread to go idle.
+  SyncGPUThread(false, reason);
+  s_state.num_pending_vram_writes = 0;
 }
 
 bool GPUThread::SleepGPUThread(bool allow_sleep)
@@ -372,7 +734,10 @@ bool GPUThread::SleepGPUThread(bool allow_sleep)
 
     // Sleep until more work is queued.
     if (allow_sleep)
+    {
+      IncrementCounter<u64>(s_counters.gpu_thread_sleeps);
       s_state.thread_wake_semaphore.Wait();
+    }
     else
       return false;
   }
@@ -415,6 +780,7 @@ void GPUThread::Internal::GPUThreadEntryPoint()
       {
         DebugAssert(s_state.gpu_backend);
         s_state.gpu_backend->HandleCommand(cmd);
+        CompleteCommand();
         continue;
       }
 
@@ -436,6 +802,7 @@ void GPUThread::Internal::GPUThreadEntryPoint()
           GPUThreadAsyncCallCommand* acmd = static_cast<GPUThreadAsyncCallCommand*>(cmd);
           acmd->func();
           acmd->~GPUThreadAsyncCallCommand();
+          CompleteCommand();
         }
         break;
 
@@ -444,6 +811,7 @@ void GPUThread::Internal::GPUThreadEntryPoint()
           GPUThreadAsyncBackendCallCommand* acmd = static_cast<GPUThreadAsyncBackendCallCommand*>(cmd);
           acmd->func(s_state.gpu_backend.get());
           acmd->~GPUThreadAsyncBackendCallCommand();
+          CompleteCommand();
         }
         break;
 
@@ -452,6 +820,7 @@ void GPUThread::Internal::GPUThreadEntryPoint()
           GPUThreadReconfigureCommand* ccmd = static_cast<GPUThreadReconfigureCommand*>(cmd);
           ReconfigureOnThread(ccmd);
           ccmd->~GPUThreadReconfigureCommand();
+          CompleteCommand();
         }
         break;
 
@@ -460,6 +829,7 @@ void GPUThread::Internal::GPUThreadEntryPoint()
           GPUThreadUpdateSettingsCommand* ccmd = static_cast<GPUThreadUpdateSettingsCommand*>(cmd);
           UpdateSettingsOnThread(std::move(ccmd->settings));
           ccmd->~GPUThreadUpdateSettingsCommand();
+          CompleteCommand();
         }
         break;
 
@@ -521,7 +891,7 @@ bool GPUThread::Reconfigure(std::string serial, std::optional<GPURenderer> rende
   if (!s_state.use_gpu_thread) [[unlikely]]
     ReconfigureOnThread(cmd);
   else
-    PushCommandAndSync(cmd, false);
+    PushCommandAndSync(cmd, false, SyncReason::Reconfigure);
 
   return result;
 }
@@ -690,6 +1060,7 @@ bool GPUThread::CreateDeviceOnThread(RenderAPI api, bool fullscreen, bool clear_
 
 void GPUThread::DestroyDeviceOnThread(bool clear_fsui_state)
 {
+  ReleaseHeadlessWindowOnThread();
   if (!g_gpu_device)
     return;
 
@@ -712,6 +1083,35 @@ void GPUThread::DestroyDeviceOnThread(bool clear_fsui_state)
   std::atomic_thread_fence(std::memory_order_release);
 }
 
+bool GPUThread::AcquireHeadlessWindowOnThread(bool fullscreen, Error* error)
+{
+  DebugAssert(!g_gpu_device);
+  if (s_state.has_headless_window)
+    return true;
+
+  // The host presents the software renderer's output itself, so the window isn't tied to any API.
+  INFO_LOG("Running software renderer without a GPU device.");
+  std::optional<WindowInfo> wi = Host::AcquireRenderWindow(RenderAPI::None, fullscreen, false, error);
+  if (!wi.has_value())
+    return false;
+
+  s_state.render_window_info = std::move(wi.value());
+  s_state.has_headless_window = true;
+  std::atomic_thread_fence(std::memory_order_release);
+  return true;
+}
+
+void GPUThread::ReleaseHeadlessWindowOnThread()
+{
+  if (!s_state.has_headless_window)
+    return;
+
+  Host::ReleaseRenderWindow();
+  s_state.has_headless_window = false;
+  s_state.render_window_info = WindowInfo();
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
 bool GPUThread::CreateGPUBackendOnThread(GPURenderer renderer, bool upload_vram, Error* error)
 {
   Error local_error;
@@ -720,15 +1120,20 @@ bool GPUThread::CreateGPUBackendOnThread(GPURenderer renderer, bool upload_vram,
   if (!s_state.gpu_presenter)
   {
     s_state.gpu_presenter = std::make_unique<GPUPresenter>();
-    if (!s_state.gpu_presenter->Initialize(&local_error))
+
+    // Nothing to compile without a device, the software renderer's display is read back by the host instead.
+    if (g_gpu_device)
     {
-      ERROR_LOG("Failed to create presenter: {}", local_error.GetDescription());
-      Error::SetStringFmt(error, "Failed to create presenter: {}", local_error.GetDescription());
-      s_state.gpu_presenter.reset();
-      return false;
-    }
+      if (!s_state.gpu_presenter->Initialize(&local_error))
+      {
+        ERROR_LOG("Failed to create presenter: {}", local_error.GetDescription());
+        Error::SetStringFmt(error, "Failed to create presenter: {}", local_error.GetDescription());
+        s_state.gpu_presenter.reset();
+        return false;
+      }
 
-    ImGuiManager::UpdateDebugWindowConfig();
+      ImGuiManager::UpdateDebugWindowConfig();
+    }
   }
 
   const bool is_hardware = (renderer != GPURenderer::Software);
@@ -765,7 +1170,8 @@ bool GPUThread::CreateGPUBackendOnThread(GPURenderer renderer, bool upload_vram,
     }
   }
 
-  g_gpu_device->SetGPUTimingEnabled(g_gpu_settings.display_show_gpu_usage);
+  if (g_gpu_device)
+    g_gpu_device->SetGPUTimingEnabled(g_gpu_settings.display_show_gpu_usage);
   s_state.gpu_backend->RestoreDeviceContext();
   SetRunIdleReason(RunIdleReason::NoGPUBackend, false);
   std::atomic_thread_fence(std::memory_order_release);
@@ -811,19 +1217,36 @@ void GPUThread::ReconfigureOnThread(GPUThreadReconfigureCommand* cmd)
     DestroyGPUBackendOnThread();
 
   // Device recreation?
+  // The software renderer can run without a device when nothing else needs one, i.e. the fullscreen UI.
+  const bool headless = (cmd->renderer.has_value() && cmd->renderer.value() == GPURenderer::Software &&
+                         g_gpu_settings.gpu_headless_software_renderer && !s_state.requested_fullscreen_ui);
   const RenderAPI current_api = g_gpu_device ? g_gpu_device->GetRenderAPI() : RenderAPI::None;
   const RenderAPI expected_api =
-    (cmd->renderer.has_value() && cmd->renderer.value() == GPURenderer::Software && current_api != RenderAPI::None) ?
-      current_api :
-      Settings::GetRenderAPIForRenderer(s_state.requested_renderer.value_or(g_gpu_settings.gpu_renderer));
-  if (cmd->force_recreate_device || !GPUDevice::IsSameRenderAPI(current_api, expected_api))
+    headless ? RenderAPI::None :
+               ((cmd->renderer.has_value() && cmd->renderer.value() == GPURenderer::Software &&
+                 current_api != RenderAPI::None) ?
+                  current_api :
+                  Settings::GetRenderAPIForRenderer(s_state.requested_renderer.value_or(g_gpu_settings.gpu_renderer)));
+  if (cmd->force_recreate_device || !GPUDevice::IsSameRenderAPI(current_api, expected_api) ||
+      (headless && !s_state.has_headless_window))
   {
     const bool fullscreen = cmd->fullscreen.value_or(Host::IsFullscreen());
     DestroyGPUPresenterOnThread();
     DestroyDeviceOnThread(false);
 
     Error local_error;
-    if (!CreateDeviceOnThread(expected_api, fullscreen, false, &local_error))
+    if (headless)
+    {
+      if (!AcquireHeadlessWindowOnThread(fullscreen, &local_error))
+      {
+        if (cmd->error_ptr)
+          *cmd->error_ptr = local_error;
+
+        *cmd->out_result = false;
+        return;
+      }
+    }
+    else if (!CreateDeviceOnThread(expected_api, fullscreen, false, &local_error))
     {
       Host::AddIconOSDMessage(
         "DeviceSwitchFailed", ICON_FA_PAINT_ROLLER,
@@ -945,12 +1368,12 @@ void GPUThread::SetThreadEnabled(bool enabled)
 
   if (s_state.use_gpu_thread)
   {
-    SyncGPUThread(false);
+    SyncGPUThread(false, SyncReason::SettingsChange);
     std::atomic_thread_fence(std::memory_order_acquire);
   }
 
   // Was anything active?
-  if (!g_gpu_device)
+  if (!g_gpu_device && !s_state.has_headless_window)
   {
     // Thread should be idle. Just reset the FIFO.
     s_state.use_gpu_thread = enabled;
@@ -1011,18 +1434,18 @@ void GPUThread::UpdateSettingsOnThread(GPUSettings&& new_settings)
 
   if (s_state.gpu_backend)
   {
-    if (g_gpu_settings.display_show_gpu_usage != old_settings.display_show_gpu_usage)
+    if (g_gpu_device && g_gpu_settings.display_show_gpu_usage != old_settings.display_show_gpu_usage)
       g_gpu_device->SetGPUTimingEnabled(g_gpu_settings.display_show_gpu_usage);
 
     Error error;
-    if (!s_state.gpu_presenter->UpdateSettings(old_settings, &error) ||
+    if ((g_gpu_device && !s_state.gpu_presenter->UpdateSettings(old_settings, &error)) ||
         !s_state.gpu_backend->UpdateSettings(old_settings, &error)) [[unlikely]]
     {
       ReportFatalErrorAndShutdown(fmt::format("Failed to update settings: {}", error.GetDescription()));
       return;
     }
 
-    if (ImGuiManager::UpdateDebugWindowConfig())
+    if (g_gpu_device && ImGuiManager::UpdateDebugWindowConfig())
       Internal::PresentFrameAndRestoreContext();
     else
       s_state.gpu_backend->RestoreDeviceContext();
@@ -1053,7 +1476,7 @@ void GPUThread::RunOnBackend(AsyncBackendCallType func, bool sync, bool spin_or_
   GPUThreadAsyncBackendCallCommand* cmd =
     AllocateCommand<GPUThreadAsyncBackendCallCommand>(GPUBackendCommandType::AsyncBackendCall, std::move(func));
   if (sync)
-    PushCommandAndSync(cmd, spin_or_wake);
+    PushCommandAndSync(cmd, spin_or_wake, SyncReason::BackendCall);
   else if (spin_or_wake)
     PushCommandAndWakeThread(cmd);
   else
@@ -1163,6 +1586,17 @@ void GPUThread::ResizeDisplayWindow(s32 width, s32 height, float scale)
 
 void GPUThread::ResizeDisplayWindowOnThread(u32 width, u32 height, float scale)
 {
+  // The host presents to a headless window itself, it only needs the new size.
+  if (s_state.has_headless_window)
+  {
+    DEV_LOG("Headless display window resized to {}x{}", width, height);
+    s_state.render_window_info.surface_width = static_cast<u16>(width);
+    s_state.render_window_info.surface_height = static_cast<u16>(height);
+    s_state.render_window_info.surface_scale = scale;
+    std::atomic_thread_fence(std::memory_order_release);
+    return;
+  }
+
   // We should _not_ be getting this without a device, since we should have shut down.
   if (!g_gpu_device || !g_gpu_device->HasMainSwapChain())
     return;
@@ -1307,7 +1741,7 @@ void GPUThread::SetVSync(GPUVSyncMode mode, bool allow_present_throttle)
     s_state.requested_vsync = mode;
     s_state.requested_allow_present_throttle = allow_present_throttle;
 
-    if (!g_gpu_device->HasMainSwapChain())
+    if (!g_gpu_device || !g_gpu_device->HasMainSwapChain())
       return;
 
     Error error;
@@ -1321,7 +1755,7 @@ void GPUThread::SetVSync(GPUVSyncMode mode, bool allow_present_throttle)
   // If we're turning on vsync or turning off present throttle, we want to drain the GPU thread.
   // Otherwise if it is currently behind, it'll be permanently stuck behind.
   if (mode != GPUVSyncMode::Disabled)
-    SyncGPUThread(false);
+    SyncGPUThread(false, SyncReason::SettingsChange);
 }
 
 void GPUThread::PresentCurrentFrame()
@@ -1399,6 +1833,8 @@ void GPUThread::SetGameSerial(std::string serial)
     s_state.game_serial = std::move(serial);
     if (changed)
     {
+      if (s_state.gpu_backend)
+        s_state.gpu_backend->GameSerialChanged();
       GPUTextureCache::GameSerialChanged();
       if (SaveStateSelectorUI::IsOpen())
         SaveStateSelectorUI::RefreshList();
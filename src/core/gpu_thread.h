@@ -5,6 +5,7 @@
 
 #include "common/types.h"
 
+#include <array>
 #include <functional>
 #include <optional>
 #include <utility>
@@ -39,6 +40,47 @@ enum class RunIdleReason : u8
   LoadingScreenActive = (1 << 3),
 };
 
+/// Why the CPU thread had to wait for the GPU thread, used for stall attribution.
+enum class SyncReason : u8
+{
+  VRAMReadback,
+  SaveState,
+  SettingsChange,
+  Reconfigure,
+  BackendCall,
+  Debug,
+  Shutdown,
+  MaxCount
+};
+
+/// Command FIFO telemetry. Counters are cumulative since startup.
+struct FIFOStatistics
+{
+  static constexpr u32 NUM_OCCUPANCY_BUCKETS = 10;
+  static constexpr u32 NUM_SYNC_REASONS = static_cast<u32>(SyncReason::MaxCount);
+
+  u64 commands_pushed;
+  u64 bytes_pushed;
+  u64 occupancy_sum;    // pending bytes summed at each push, divide by commands_pushed for the average
+  u32 peak_occupancy;   // bytes
+  u32 fifo_size;        // bytes
+  u64 wraparounds;
+  u64 wakeups;          // CPU thread woke a sleeping GPU thread
+  u64 gpu_thread_sleeps;
+  u64 fifo_full_waits;  // CPU thread had to wait for space
+  double fifo_full_wait_ms;
+  u64 shadow_vram_readbacks;     // readbacks served from the shadow VRAM without draining the FIFO
+  u64 shadow_vram_partial_waits; // of the above, those which had to wait for overlapping writes
+
+  // Sampled at each push, bucketed by fraction of the FIFO in use.
+  std::array<u64, NUM_OCCUPANCY_BUCKETS> occupancy_histogram;
+
+  std::array<u64, NUM_SYNC_REASONS> sync_count;
+  std::array<u64, NUM_SYNC_REASONS> sync_stall_count; // syncs where the GPU thread still had work
+  std::array<double, NUM_SYNC_REASONS> sync_spin_ms;
+  std::array<double, NUM_SYNC_REASONS> sync_sleep_ms;
+};
+
 /// Starts Big Picture UI.
 bool StartFullscreenUI(bool fullscreen, Error* error);
 bool IsFullscreenUIRequested();
@@ -89,8 +131,22 @@ const std::string& GetGameSerial();
 GPUThreadCommand* AllocateCommand(GPUBackendCommandType command, u32 size);
 void PushCommand(GPUThreadCommand* cmd);
 void PushCommandAndWakeThread(GPUThreadCommand* cmd);
-void PushCommandAndSync(GPUThreadCommand* cmd, bool spin);
-void SyncGPUThread(bool spin);
+void PushCommandAndSync(GPUThreadCommand* cmd, bool spin, SyncReason reason);
+void SyncGPUThread(bool spin, SyncReason reason);
+
+/// Waits only for queued commands which write to the specified VRAM area. Requires that the GPU thread keeps the
+/// CPU copy of VRAM up to date, i.e. the software renderer, or software rendering for readbacks.
+void SyncGPUThreadForVRAMRead(u32 x, u32 y, u32 width, u32 height, bool spin, SyncReason reason);
+
+/// FIFO telemetry, safe to call from any thread. Values may be slightly out of date.
+FIFOStatistics GetFIFOStatistics();
+
+/// Adds the push counters batched on the CPU thread to the FIFO telemetry, called once per frame.
+void PublishPushStatistics();
+
+/// Returns the peak FIFO occupancy in bytes since the last call, and resets it.
+u32 TakeFIFOIntervalPeakOccupancy();
+const char* GetSyncReasonName(SyncReason reason);
 
 namespace Internal {
 const Threading::ThreadHandle& GetThreadHandle();
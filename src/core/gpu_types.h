@@ -442,6 +442,27 @@ ALWAYS_INLINE static constexpr GSVector4i VRAMPageRect(u32 pn)
   return VRAMPageRect(pn % VRAM_PAGES_WIDE, pn / VRAM_PAGES_WIDE);
 }
 
+/// Computes the area affected by a VRAM transfer, including wrap-around of X.
+ALWAYS_INLINE static GSVector4i GetVRAMTransferBounds(u32 x, u32 y, u32 width, u32 height)
+{
+  GSVector4i ret;
+  ret.left = x % VRAM_WIDTH;
+  ret.top = y % VRAM_HEIGHT;
+  ret.right = ret.left + width;
+  ret.bottom = ret.top + height;
+  if (ret.right > static_cast<s32>(VRAM_WIDTH))
+  {
+    ret.left = 0;
+    ret.right = static_cast<s32>(VRAM_WIDTH);
+  }
+  if (ret.bottom > static_cast<s32>(VRAM_HEIGHT))
+  {
+    ret.top = 0;
+    ret.bottom = static_cast<s32>(VRAM_HEIGHT);
+  }
+  return ret;
+}
+
 ALWAYS_INLINE static constexpr u32 VRAMCoordinateToPage(u32 x, u32 y)
 {
   return VRAMPageIndex(x / VRAM_PAGE_WIDTH, y / VRAM_PAGE_HEIGHT);
@@ -18,6 +18,7 @@
 #include "settings.h"
 #include "spu.h"
 #include "system.h"
+#include "timing_event.h"
 
 #include "util/gpu_device.h"
 #include "util/imgui_animated.h"
@@ -108,7 +109,7 @@ static void UpdateInputOverlay(void* buffer);
 
 #ifndef __ANDROID__
 
-static constexpr size_t NUM_DEBUG_WINDOWS = 7;
+static constexpr size_t NUM_DEBUG_WINDOWS = 8;
 static constexpr const char* DEBUG_WINDOW_CONFIG_SECTION = "DebugWindows";
 static constexpr const std::array<DebugWindowInfo, NUM_DEBUG_WINDOWS> s_debug_window_info = {{
   {"Freecam", "Free Camera", ":icons/applications-system.png", &GTE::DrawFreecamWindow, 500, 425},
@@ -118,6 +119,7 @@ static constexpr const std::array<DebugWindowInfo, NUM_DEBUG_WINDOWS> s_debug_wi
   {"DMA", "DMA State", ":icons/applications-system.png", &DMA::DrawDebugStateWindow, 860, 180},
   {"MDEC", "MDEC State", ":icons/applications-system.png", &MDEC::DrawDebugStateWindow, 300, 350},
   {"Timers", "Timers State", ":icons/applications-system.png", &Timers::DrawDebugStateWindow, 800, 95},
+  {"TimingEvents", "Timing Events", ":icons/applications-system.png", &TimingEvents::DrawDebugWindow, 700, 500},
 }};
 static std::array<ImGuiManager::AuxiliaryRenderWindowState, NUM_DEBUG_WINDOWS> s_debug_window_state = {};
 
@@ -368,6 +370,12 @@ void ImGuiManager::DrawPerformanceOverlay(const GPUBackend* gpu, float& position
       gpu->GetStatsString(text);
       DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
 
+      if (GPUBackend::IsUsingHardwareBackend())
+      {
+        gpu->GetFlushStatsString(text);
+        DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      }
+
       gpu->GetMemoryStatsString(text);
       DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
     }
@@ -446,6 +454,14 @@ void ImGuiManager::DrawPerformanceOverlay(const GPUBackend* gpu, float& position
         FormatProcessorStat(text, PerformanceCounters::GetGPUThreadUsage(),
                             PerformanceCounters::GetGPUThreadAverageTime());
         DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+
+        text.format("FIFO: {:.1f}% avg, {:.1f}% peak, {} wraps", PerformanceCounters::GetFIFOAverageOccupancy(),
+                    PerformanceCounters::GetFIFOPeakOccupancy(), PerformanceCounters::GetFIFOWraparounds());
+        DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+
+        text.format("SYNC: {} ({:.2f}ms spin, {:.2f}ms wait)", PerformanceCounters::GetGPUThreadSyncCount(),
+                    PerformanceCounters::GetGPUThreadSyncSpinTime(), PerformanceCounters::GetGPUThreadSyncWaitTime());
+        DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
       }
 
 #ifndef __ANDROID__
@@ -453,6 +469,8 @@ void ImGuiManager::DrawPerformanceOverlay(const GPUBackend* gpu, float& position
       {
         text.assign("CAP: ");
         FormatProcessorStat(text, cap->GetCaptureThreadUsage(), cap->GetCaptureThreadTime());
+        if (const u32 stall_count = cap->GetCaptureStallCount(); stall_count > 0)
+          text.append_format(", {} stalls ({:.2f}ms)", stall_count, cap->GetCaptureStallTime());
         DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
       }
 #endif
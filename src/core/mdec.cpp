@@ -13,11 +13,15 @@
 #include "common/bitfield.h"
 #include "common/fifo_queue.h"
 #include "common/gsvector.h"
+#include "common/intrin.h"
 #include "common/log.h"
+#include "common/threading.h"
+#include "common/timer.h"
 
 #include "imgui.h"
 
 #include <array>
+#include <atomic>
 #include <memory>
 
 LOG_CHANNEL(MDEC);
@@ -29,6 +33,7 @@ static constexpr u32 DATA_IN_FIFO_SIZE = 1024;
 static constexpr u32 DATA_OUT_FIFO_SIZE = 768;
 static constexpr u32 NUM_BLOCKS = 6;
 static constexpr TickCount TICKS_PER_BLOCK = 448;
+static constexpr u32 DECODE_SPIN_TIME_US = 50;
 
 enum DataOutputDepth : u8
 {
@@ -113,6 +118,15 @@ static bool DecodeColoredMacroblock();
 static void ScheduleBlockCopyOut(TickCount ticks);
 static void CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late);
 
+static void StartDecodeThread();
+static void StopDecodeThread();
+static void DecodeThreadEntryPoint();
+static void SignalDecodeFlag(std::atomic_bool& flag, std::atomic_bool& sleeping, Threading::KernelSemaphore& sema);
+static void WaitForDecodeFlag(std::atomic_bool& flag, std::atomic_bool& sleeping, Threading::KernelSemaphore& sema);
+static void QueueBlockOutput(bool colored, u32 first_idct_block);
+static void WaitForBlockOutput();
+static void ConvertBlockOutput(bool colored, bool output_signed, u32 first_idct_block);
+
 static bool DecodeRLE_Old(s16* blk, const u8* qt);
 static void IDCT_Old(s16* blk);
 static void YUVToRGB_Old(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
@@ -121,9 +135,9 @@ static void YUVToRGB_Old(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const
 static bool DecodeRLE_New(s16* blk, const u8* qt);
 static void IDCT_New(s16* blk);
 static void YUVToRGB_New(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                         const std::array<s16, 64>& Yblk);
+                         const std::array<s16, 64>& Yblk, bool output_signed);
 
-static void YUVToMono(const std::array<s16, 64>& Yblk);
+static void YUVToMono(const std::array<s16, 64>& Yblk, bool output_signed);
 
 namespace {
 struct MDECState
@@ -148,11 +162,29 @@ struct MDECState
   u32 current_block = 0;        // block (0-5)
   u32 current_coefficient = 64; // k (in block)
   u16 current_q_scale = 0;
+  u32 idct_blocks = 0; // leading blocks which have already been through the IDCT
 
   alignas(VECTOR_ALIGNMENT) std::array<u32, 256> block_rgb{};
   TimingEvent block_copy_out_event{"MDEC Block Copy Out", 1, 1, &MDEC::CopyOutBlock, nullptr};
 
   u32 total_blocks_decoded = 0;
+
+  // Asynchronous decoding. The IDCT and colour conversion for a macroblock runs on the worker thread between the
+  // point where all coefficients have been received and CopyOutBlock(), which joins with the worker.
+  // Both sides spin briefly before sleeping, so the semaphores are only touched when one side is actually idle.
+  Threading::Thread decode_thread;
+  Threading::KernelSemaphore decode_work_sema;
+  Threading::KernelSemaphore decode_done_sema;
+  Timer::Value decode_spin_time = 0;
+  std::atomic_bool decode_work_ready{false};
+  std::atomic_bool decode_done{false};
+  std::atomic_bool decode_thread_sleeping{false};
+  std::atomic_bool decode_cpu_sleeping{false};
+  std::atomic_bool decode_thread_shutdown{false};
+  bool decode_pending = false;
+  bool decode_colored = false;
+  bool decode_output_signed = false;
+  u32 decode_first_idct_block = 0;
 };
 } // namespace
 
@@ -163,10 +195,22 @@ void MDEC::Initialize()
 {
   s_state.total_blocks_decoded = 0;
   Reset();
+
+  if (g_settings.mdec_async_decoding)
+    StartDecodeThread();
+}
+
+void MDEC::UpdateSettings(const Settings& old_settings)
+{
+  if (g_settings.mdec_async_decoding)
+    StartDecodeThread();
+  else
+    StopDecodeThread();
 }
 
 void MDEC::Shutdown()
 {
+  StopDecodeThread();
   s_state.block_copy_out_event.Deactivate();
 }
 
@@ -178,6 +222,9 @@ void MDEC::Reset()
 
 bool MDEC::DoState(StateWrapper& sw)
 {
+  // Output has to be complete before the block buffers are saved or overwritten.
+  WaitForBlockOutput();
+
   sw.Do(&s_state.status.bits);
   sw.Do(&s_state.enable_dma_in);
   sw.Do(&s_state.enable_dma_out);
@@ -203,6 +250,17 @@ bool MDEC::DoState(StateWrapper& sw)
   sw.Do(&s_state.current_block);
   sw.Do(&s_state.current_coefficient);
   sw.Do(&s_state.current_q_scale);
+
+  if (sw.GetVersion() >= 80)
+  {
+    sw.Do(&s_state.idct_blocks);
+  }
+  else if (sw.IsReading())
+  {
+    // Older versions ran the IDCT on each block as soon as its coefficients were decoded.
+    s_state.idct_blocks = (s_state.state == State::DecodingMacroblock) ? s_state.current_block : 0;
+  }
+
   sw.Do(&s_state.block_rgb);
 
   bool block_copy_out_pending = HasPendingBlockCopyOut();
@@ -306,6 +364,8 @@ bool MDEC::HasPendingBlockCopyOut()
 
 void MDEC::SoftReset()
 {
+  WaitForBlockOutput();
+
   s_state.status.bits = 0;
   s_state.enable_dma_in = false;
   s_state.enable_dma_out = false;
@@ -325,6 +385,7 @@ void MDEC::ResetDecoder()
   s_state.current_block = 0;
   s_state.current_coefficient = 64;
   s_state.current_q_scale = 0;
+  s_state.idct_blocks = 0;
 }
 
 void MDEC::UpdateStatus()
@@ -536,15 +597,16 @@ bool MDEC::DecodeMonoMacroblock()
   {
     if (!DecodeRLE_New(s_state.blocks[0].data(), s_state.iq_y.data()))
       return false;
-
-    IDCT_New(s_state.blocks[0].data());
   }
 
   DEBUG_LOG("Decoded mono macroblock, {} words remaining", s_state.remaining_halfwords / 2);
   ResetDecoder();
   s_state.state = State::WritingMacroblock;
 
-  YUVToMono(s_state.blocks[0]);
+  if (g_settings.use_old_mdec_routines) [[unlikely]]
+    YUVToMono(s_state.blocks[0], s_state.status.data_output_signed);
+  else
+    QueueBlockOutput(false, 0);
 
   ScheduleBlockCopyOut(TICKS_PER_BLOCK * 6);
 
@@ -556,6 +618,10 @@ bool MDEC::DecodeColoredMacroblock()
 {
   if (g_settings.use_old_mdec_routines) [[unlikely]]
   {
+    // State may have been saved by the new routines, which defer the IDCT.
+    for (; s_state.idct_blocks < s_state.current_block; s_state.idct_blocks++)
+      IDCT_Old(s_state.blocks[s_state.idct_blocks].data());
+
     for (; s_state.current_block < NUM_BLOCKS; s_state.current_block++)
     {
       if (!DecodeRLE_Old(s_state.blocks[s_state.current_block].data(),
@@ -563,6 +629,7 @@ bool MDEC::DecodeColoredMacroblock()
         return false;
 
       IDCT_Old(s_state.blocks[s_state.current_block].data());
+      s_state.idct_blocks = s_state.current_block + 1;
     }
 
     if (!s_state.data_out_fifo.IsEmpty())
@@ -580,13 +647,13 @@ bool MDEC::DecodeColoredMacroblock()
   }
   else
   {
+    // IDCT is deferred to ConvertBlockOutput(), since the blocks are independent of each other. Blocks from a state
+    // saved by the old routines or an older version may have been transformed already.
     for (; s_state.current_block < NUM_BLOCKS; s_state.current_block++)
     {
       if (!DecodeRLE_New(s_state.blocks[s_state.current_block].data(),
                          (s_state.current_block >= 2) ? s_state.iq_y.data() : s_state.iq_uv.data()))
         return false;
-
-      IDCT_New(s_state.blocks[s_state.current_block].data());
     }
 
     if (!s_state.data_out_fifo.IsEmpty())
@@ -594,13 +661,11 @@ bool MDEC::DecodeColoredMacroblock()
 
     // done decoding
     DEBUG_LOG("Decoded colored macroblock, {} words remaining", s_state.remaining_halfwords / 2);
+    const u32 first_idct_block = s_state.idct_blocks;
     ResetDecoder();
     s_state.state = State::WritingMacroblock;
 
-    YUVToRGB_New(0, 0, s_state.blocks[0], s_state.blocks[1], s_state.blocks[2]);
-    YUVToRGB_New(8, 0, s_state.blocks[0], s_state.blocks[1], s_state.blocks[3]);
-    YUVToRGB_New(0, 8, s_state.blocks[0], s_state.blocks[1], s_state.blocks[4]);
-    YUVToRGB_New(8, 8, s_state.blocks[0], s_state.blocks[1], s_state.blocks[5]);
+    QueueBlockOutput(true, first_idct_block);
   }
 
   s_state.total_blocks_decoded += 4;
@@ -621,6 +686,7 @@ void MDEC::CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late)
 {
   Assert(s_state.state == State::WritingMacroblock);
   s_state.block_copy_out_event.Deactivate();
+  WaitForBlockOutput();
 
   switch (s_state.status.data_output_depth)
   {
@@ -824,6 +890,123 @@ void MDEC::CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late)
   Execute();
 }
 
+void MDEC::StartDecodeThread()
+{
+  if (s_state.decode_thread.Joinable())
+    return;
+
+  s_state.decode_spin_time = Timer::ConvertNanosecondsToValue(DECODE_SPIN_TIME_US * 1000.0);
+  s_state.decode_work_ready.store(false, std::memory_order_relaxed);
+  s_state.decode_done.store(false, std::memory_order_relaxed);
+  s_state.decode_thread_shutdown.store(false, std::memory_order_release);
+  s_state.decode_thread.Start(&MDEC::DecodeThreadEntryPoint);
+  INFO_LOG("MDEC decode thread started.");
+}
+
+void MDEC::StopDecodeThread()
+{
+  if (!s_state.decode_thread.Joinable())
+    return;
+
+  WaitForBlockOutput();
+
+  s_state.decode_thread_shutdown.store(true, std::memory_order_release);
+  SignalDecodeFlag(s_state.decode_work_ready, s_state.decode_thread_sleeping, s_state.decode_work_sema);
+  s_state.decode_thread.Join();
+  INFO_LOG("MDEC decode thread stopped.");
+}
+
+void MDEC::DecodeThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("MDEC Decode Thread");
+
+  for (;;)
+  {
+    WaitForDecodeFlag(s_state.decode_work_ready, s_state.decode_thread_sleeping, s_state.decode_work_sema);
+    if (s_state.decode_thread_shutdown.load(std::memory_order_acquire))
+      break;
+
+    ConvertBlockOutput(s_state.decode_colored, s_state.decode_output_signed, s_state.decode_first_idct_block);
+    SignalDecodeFlag(s_state.decode_done, s_state.decode_cpu_sleeping, s_state.decode_done_sema);
+  }
+}
+
+void MDEC::SignalDecodeFlag(std::atomic_bool& flag, std::atomic_bool& sleeping, Threading::KernelSemaphore& sema)
+{
+  // Only kick the semaphore if the other side gave up spinning.
+  flag.store(true, std::memory_order_seq_cst);
+  if (sleeping.exchange(false, std::memory_order_seq_cst))
+    sema.Post();
+}
+
+void MDEC::WaitForDecodeFlag(std::atomic_bool& flag, std::atomic_bool& sleeping, Threading::KernelSemaphore& sema)
+{
+  const Timer::Value start_time = Timer::GetCurrentValue();
+  while (!flag.load(std::memory_order_acquire))
+  {
+    if ((Timer::GetCurrentValue() - start_time) < s_state.decode_spin_time)
+    {
+      MultiPause();
+      continue;
+    }
+
+    // Recheck after publishing that we're asleep, otherwise the signal could be missed. A stale post from a signal
+    // that raced with the recheck just causes a spurious wakeup on the next wait.
+    sleeping.store(true, std::memory_order_seq_cst);
+    if (!flag.load(std::memory_order_seq_cst))
+      sema.Wait();
+    sleeping.store(false, std::memory_order_relaxed);
+  }
+
+  flag.store(false, std::memory_order_relaxed);
+}
+
+void MDEC::QueueBlockOutput(bool colored, u32 first_idct_block)
+{
+  DebugAssert(!s_state.decode_pending);
+
+  // Status register can change while the worker is running, so capture the bits it needs.
+  const bool output_signed = s_state.status.data_output_signed;
+  if (!s_state.decode_thread.Joinable())
+  {
+    ConvertBlockOutput(colored, output_signed, first_idct_block);
+    return;
+  }
+
+  s_state.decode_colored = colored;
+  s_state.decode_output_signed = output_signed;
+  s_state.decode_first_idct_block = first_idct_block;
+  s_state.decode_pending = true;
+  SignalDecodeFlag(s_state.decode_work_ready, s_state.decode_thread_sleeping, s_state.decode_work_sema);
+}
+
+void MDEC::WaitForBlockOutput()
+{
+  if (!s_state.decode_pending)
+    return;
+
+  WaitForDecodeFlag(s_state.decode_done, s_state.decode_cpu_sleeping, s_state.decode_done_sema);
+  s_state.decode_pending = false;
+}
+
+void MDEC::ConvertBlockOutput(bool colored, bool output_signed, u32 first_idct_block)
+{
+  if (!colored)
+  {
+    IDCT_New(s_state.blocks[0].data());
+    YUVToMono(s_state.blocks[0], output_signed);
+    return;
+  }
+
+  for (u32 i = first_idct_block; i < NUM_BLOCKS; i++)
+    IDCT_New(s_state.blocks[i].data());
+
+  YUVToRGB_New(0, 0, s_state.blocks[0], s_state.blocks[1], s_state.blocks[2], output_signed);
+  YUVToRGB_New(8, 0, s_state.blocks[0], s_state.blocks[1], s_state.blocks[3], output_signed);
+  YUVToRGB_New(0, 8, s_state.blocks[0], s_state.blocks[1], s_state.blocks[4], output_signed);
+  YUVToRGB_New(8, 8, s_state.blocks[0], s_state.blocks[1], s_state.blocks[5], output_signed);
+}
+
 bool MDEC::DecodeRLE_Old(s16* blk, const u8* qt)
 {
   static constexpr std::array<u8, 64> zagzig = {{0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
@@ -1043,9 +1226,9 @@ void MDEC::IDCT_New(s16* blk)
 }
 
 void MDEC::YUVToRGB_New(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                        const std::array<s16, 64>& Yblk)
+                        const std::array<s16, 64>& Yblk, bool output_signed)
 {
-  const GSVector4i addval = s_state.status.data_output_signed ? GSVector4i::cxpr(0) : GSVector4i::cxpr(0x80808080);
+  const GSVector4i addval = output_signed ? GSVector4i::cxpr(0) : GSVector4i::cxpr(0x80808080);
   for (u32 y = 0; y < 8; y++)
   {
     const GSVector4i Cr = GSVector4i::loadl<false>(&Crblk[(xx / 2) + ((y + yy) / 2) * 8]).s16to32();
@@ -1080,9 +1263,9 @@ void MDEC::YUVToRGB_New(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const
   }
 }
 
-void MDEC::YUVToMono(const std::array<s16, 64>& Yblk)
+void MDEC::YUVToMono(const std::array<s16, 64>& Yblk, bool output_signed)
 {
-  const s32 addval = s_state.status.data_output_signed ? 0 : 0x80;
+  const s32 addval = output_signed ? 0 : 0x80;
   for (u32 i = 0; i < 64; i++)
     s_state.block_rgb[i] = static_cast<u32>(std::clamp(SignExtendN<9, s32>(Yblk[i]), -128, 127) + addval);
 }
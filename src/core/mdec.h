@@ -7,9 +7,12 @@
 
 class StateWrapper;
 
+struct Settings;
+
 namespace MDEC {
 
 void Initialize();
+void UpdateSettings(const Settings& old_settings);
 void Shutdown();
 void Reset();
 bool DoState(StateWrapper& sw);
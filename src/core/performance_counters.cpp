@@ -55,6 +55,14 @@ struct State
   float accumulated_gpu_time;
   float gpu_usage;
 
+  GPUThread::FIFOStatistics last_fifo_stats;
+  float fifo_average_occupancy;
+  float fifo_peak_occupancy;
+  u32 fifo_wraparounds;
+  u32 sync_count;
+  float sync_spin_time;
+  float sync_wait_time;
+
   FrameTimeHistory frame_time_history;
   u32 frame_time_history_pos;
 };
@@ -127,6 +135,36 @@ float PerformanceCounters::GetGPUAverageTime()
   return s_state.average_gpu_time;
 }
 
+float PerformanceCounters::GetFIFOAverageOccupancy()
+{
+  return s_state.fifo_average_occupancy;
+}
+
+float PerformanceCounters::GetFIFOPeakOccupancy()
+{
+  return s_state.fifo_peak_occupancy;
+}
+
+u32 PerformanceCounters::GetFIFOWraparounds()
+{
+  return s_state.fifo_wraparounds;
+}
+
+u32 PerformanceCounters::GetGPUThreadSyncCount()
+{
+  return s_state.sync_count;
+}
+
+float PerformanceCounters::GetGPUThreadSyncSpinTime()
+{
+  return s_state.sync_spin_time;
+}
+
+float PerformanceCounters::GetGPUThreadSyncWaitTime()
+{
+  return s_state.sync_wait_time;
+}
+
 const PerformanceCounters::FrameTimeHistory& PerformanceCounters::GetFrameTimeHistory()
 {
   return s_state.frame_time_history;
@@ -153,6 +191,8 @@ void PerformanceCounters::Reset()
   s_state.last_internal_frame_number = System::GetInternalFrameNumber();
   s_state.last_cpu_time = System::GetCPUThreadHandle().GetCPUTime();
   s_state.last_gpu_thread_time = GPUThread::Internal::GetThreadHandle().GetCPUTime();
+  s_state.last_fifo_stats = GPUThread::GetFIFOStatistics();
+  GPUThread::TakeFIFOIntervalPeakOccupancy();
 
   s_state.average_frame_time_accumulator = 0.0f;
   s_state.minimum_frame_time_accumulator = 0.0f;
@@ -218,7 +258,30 @@ void PerformanceCounters::Update(GPUBackend* gpu, u32 frame_number, u32 internal
   if (MediaCapture* cap = System::GetMediaCapture())
     cap->UpdateCaptureThreadUsage(pct_divider, time_divider);
 
-  if (g_gpu_device->IsGPUTimingEnabled())
+  // FIFO counters are cumulative, so report the delta over the interval.
+  const GPUThread::FIFOStatistics fifo_stats = GPUThread::GetFIFOStatistics();
+  const GPUThread::FIFOStatistics& last_fifo_stats = s_state.last_fifo_stats;
+  const u64 commands_delta = fifo_stats.commands_pushed - last_fifo_stats.commands_pushed;
+  const double fifo_size = static_cast<double>(std::max(fifo_stats.fifo_size, 1u));
+  s_state.fifo_average_occupancy =
+    (commands_delta > 0) ? static_cast<float>(static_cast<double>(fifo_stats.occupancy_sum - last_fifo_stats.occupancy_sum) /
+                                              static_cast<double>(commands_delta) / fifo_size * 100.0) :
+                           0.0f;
+  s_state.fifo_peak_occupancy =
+    static_cast<float>(static_cast<double>(GPUThread::TakeFIFOIntervalPeakOccupancy()) / fifo_size * 100.0);
+  s_state.fifo_wraparounds = static_cast<u32>(fifo_stats.wraparounds - last_fifo_stats.wraparounds);
+  s_state.sync_count = 0;
+  s_state.sync_spin_time = 0.0f;
+  s_state.sync_wait_time = 0.0f;
+  for (u32 i = 0; i < GPUThread::FIFOStatistics::NUM_SYNC_REASONS; i++)
+  {
+    s_state.sync_count += static_cast<u32>(fifo_stats.sync_count[i] - last_fifo_stats.sync_count[i]);
+    s_state.sync_spin_time += static_cast<float>(fifo_stats.sync_spin_ms[i] - last_fifo_stats.sync_spin_ms[i]);
+    s_state.sync_wait_time += static_cast<float>(fifo_stats.sync_sleep_ms[i] - last_fifo_stats.sync_sleep_ms[i]);
+  }
+  s_state.last_fifo_stats = fifo_stats;
+
+  if (g_gpu_device && g_gpu_device->IsGPUTimingEnabled())
   {
     s_state.average_gpu_time =
       s_state.accumulated_gpu_time / static_cast<float>(std::max(s_state.presents_since_last_update, 1u));
@@ -24,6 +24,12 @@ float GetGPUThreadUsage();
 float GetGPUThreadAverageTime();
 float GetGPUUsage();
 float GetGPUAverageTime();
+float GetFIFOAverageOccupancy();
+float GetFIFOPeakOccupancy();
+u32 GetFIFOWraparounds();
+u32 GetGPUThreadSyncCount();
+float GetGPUThreadSyncSpinTime();
+float GetGPUThreadSyncWaitTime();
 const FrameTimeHistory& GetFrameTimeHistory();
 u32 GetFrameTimeHistoryPos();
 
@@ -229,6 +229,8 @@ void Settings::Load(const SettingsInterface& si, const SettingsInterface& contro
   gpu_use_thread = si.GetBoolValue("GPU", "UseThread", true);
   gpu_max_queued_frames = static_cast<u8>(si.GetUIntValue("GPU", "MaxQueuedFrames", DEFAULT_GPU_MAX_QUEUED_FRAMES));
   gpu_use_software_renderer_for_readbacks = si.GetBoolValue("GPU", "UseSoftwareRendererForReadbacks", false);
+  gpu_headless_software_renderer = si.GetBoolValue("GPU", "HeadlessSoftwareRenderer", false);
+  gpu_lazy_pipeline_creation = si.GetBoolValue("GPU", "LazyPipelineCreation", false);
   gpu_true_color = si.GetBoolValue("GPU", "TrueColor", true);
   gpu_scaled_dithering = si.GetBoolValue("GPU", "ScaledDithering", true);
   gpu_force_round_texcoords = si.GetBoolValue("GPU", "ForceRoundTextureCoordinates", false);
@@ -367,8 +369,12 @@ void Settings::Load(const SettingsInterface& si, const SettingsInterface& contro
   cdrom_region_check = si.GetBoolValue("CDROM", "RegionCheck", false);
   cdrom_subq_skew = si.GetBoolValue("CDROM", "SubQSkew", false);
   cdrom_load_image_to_ram = si.GetBoolValue("CDROM", "LoadImageToRAM", false);
+  cdrom_compress_image_in_ram = si.GetBoolValue("CDROM", "CompressImageInRAM", false);
+  cdrom_share_image_in_ram = si.GetBoolValue("CDROM", "ShareImageInRAM", false);
   cdrom_load_image_patches = si.GetBoolValue("CDROM", "LoadImagePatches", false);
   cdrom_mute_cd_audio = si.GetBoolValue("CDROM", "MuteCDAudio", false);
+  cdrom_access_trace_prefetch = si.GetBoolValue("CDROM", "AccessTracePrefetch", false);
+  cdrom_map_image_files = si.GetBoolValue("CDROM", "MapImageFiles", false);
   cdrom_read_speedup =
     Truncate8(std::min<u32>(si.GetUIntValue("CDROM", "ReadSpeedup", 1u), std::numeric_limits<u8>::max()));
   cdrom_seek_speedup =
@@ -390,6 +396,7 @@ void Settings::Load(const SettingsInterface& si, const SettingsInterface& contro
   audio_output_muted = si.GetBoolValue("Audio", "OutputMuted", false);
 
   use_old_mdec_routines = si.GetBoolValue("Hacks", "UseOldMDECRoutines", false);
+  mdec_async_decoding = si.GetBoolValue("Hacks", "AsyncMDECDecoding", false);
   export_shared_memory = si.GetBoolValue("Hacks", "ExportSharedMemory", false);
 
   dma_max_slice_ticks = si.GetIntValue("Hacks", "DMAMaxSliceTicks", DEFAULT_DMA_MAX_SLICE_TICKS);
@@ -580,12 +587,14 @@ void Settings::Save(SettingsInterface& si, bool ignore_base) const
     si.SetBoolValue("GPU", "DisableRasterOrderViews", gpu_disable_raster_order_views);
     si.SetBoolValue("GPU", "DisableComputeShaders", gpu_disable_compute_shaders);
     si.SetBoolValue("GPU", "DisableCompressedTextures", gpu_disable_compressed_textures);
+    si.SetBoolValue("GPU", "HeadlessSoftwareRenderer", gpu_headless_software_renderer);
   }
 
   si.SetBoolValue("GPU", "PerSampleShading", gpu_per_sample_shading);
   si.SetUIntValue("GPU", "MaxQueuedFrames", gpu_max_queued_frames);
   si.SetBoolValue("GPU", "UseThread", gpu_use_thread);
   si.SetBoolValue("GPU", "UseSoftwareRendererForReadbacks", gpu_use_software_renderer_for_readbacks);
+  si.SetBoolValue("GPU", "LazyPipelineCreation", gpu_lazy_pipeline_creation);
   si.SetBoolValue("GPU", "TrueColor", gpu_true_color);
   si.SetBoolValue("GPU", "ScaledDithering", gpu_scaled_dithering);
   si.SetBoolValue("GPU", "ForceRoundTextureCoordinates", gpu_force_round_texcoords);
@@ -666,8 +675,12 @@ void Settings::Save(SettingsInterface& si, bool ignore_base) const
   si.SetBoolValue("CDROM", "RegionCheck", cdrom_region_check);
   si.SetBoolValue("CDROM", "SubQSkew", cdrom_subq_skew);
   si.SetBoolValue("CDROM", "LoadImageToRAM", cdrom_load_image_to_ram);
+  si.SetBoolValue("CDROM", "CompressImageInRAM", cdrom_compress_image_in_ram);
+  si.SetBoolValue("CDROM", "ShareImageInRAM", cdrom_share_image_in_ram);
   si.SetBoolValue("CDROM", "LoadImagePatches", cdrom_load_image_patches);
   si.SetBoolValue("CDROM", "MuteCDAudio", cdrom_mute_cd_audio);
+  si.SetBoolValue("CDROM", "AccessTracePrefetch", cdrom_access_trace_prefetch);
+  si.SetBoolValue("CDROM", "MapImageFiles", cdrom_map_image_files);
   si.SetUIntValue("CDROM", "ReadSpeedup", cdrom_read_speedup);
   si.SetUIntValue("CDROM", "SeekSpeedup", cdrom_seek_speedup);
   si.SetUIntValue("CDROM", "MaxSpeedupCycles", cdrom_max_speedup_cycles);
@@ -681,6 +694,7 @@ void Settings::Save(SettingsInterface& si, bool ignore_base) const
   si.SetBoolValue("Audio", "OutputMuted", audio_output_muted);
 
   si.SetBoolValue("Hacks", "UseOldMDECRoutines", use_old_mdec_routines);
+  si.SetBoolValue("Hacks", "AsyncMDECDecoding", mdec_async_decoding);
   si.SetBoolValue("Hacks", "ExportSharedMemory", export_shared_memory);
 
   if (!ignore_base)
@@ -1131,6 +1145,7 @@ bool Settings::AreGPUDeviceSettingsChanged(const Settings& old_settings) const
           gpu_disable_raster_order_views != old_settings.gpu_disable_raster_order_views ||
           gpu_disable_compute_shaders != old_settings.gpu_disable_compute_shaders ||
           gpu_disable_compressed_textures != old_settings.gpu_disable_compressed_textures ||
+          gpu_headless_software_renderer != old_settings.gpu_headless_software_renderer ||
           display_exclusive_fullscreen_control != old_settings.display_exclusive_fullscreen_control);
 }
 
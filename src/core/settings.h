@@ -92,6 +92,8 @@ struct GPUSettings
 
   bool gpu_use_thread : 1 = true;
   bool gpu_use_software_renderer_for_readbacks : 1 = false;
+  bool gpu_headless_software_renderer : 1 = false;
+  bool gpu_lazy_pipeline_creation : 1 = false;
   bool gpu_use_debug_device : 1 = false;
   bool gpu_disable_shader_cache : 1 = false;
   bool gpu_disable_dual_source_blend : 1 = false;
@@ -294,8 +296,12 @@ struct Settings : public GPUSettings
   bool cdrom_region_check : 1 = false;
   bool cdrom_subq_skew : 1 = false;
   bool cdrom_load_image_to_ram : 1 = false;
+  bool cdrom_compress_image_in_ram : 1 = false;
+  bool cdrom_share_image_in_ram : 1 = false;
   bool cdrom_load_image_patches : 1 = false;
   bool cdrom_mute_cd_audio : 1 = false;
+  bool cdrom_access_trace_prefetch : 1 = false;
+  bool cdrom_map_image_files : 1 = false;
 
   u16 rewind_save_slots = 10;
   u8 runahead_frames = 0;
@@ -315,6 +321,7 @@ struct Settings : public GPUSettings
   bool audio_output_muted : 1 = false;
 
   bool use_old_mdec_routines : 1 = false;
+  bool mdec_async_decoding : 1 = false;
   bool pcdrv_enable : 1 = false;
   bool export_shared_memory : 1 = false;
 
@@ -806,7 +806,7 @@ bool System::IsDiscPath(std::string_view path)
           StringUtil::EndsWithNoCase(path, ".img") || StringUtil::EndsWithNoCase(path, ".iso") ||
           StringUtil::EndsWithNoCase(path, ".chd") || StringUtil::EndsWithNoCase(path, ".ecm") ||
           StringUtil::EndsWithNoCase(path, ".mds") || StringUtil::EndsWithNoCase(path, ".pbp") ||
-          StringUtil::EndsWithNoCase(path, ".m3u"));
+          StringUtil::EndsWithNoCase(path, ".zcd") || StringUtil::EndsWithNoCase(path, ".m3u"));
 }
 
 bool System::IsExePath(std::string_view path)
@@ -1234,6 +1234,9 @@ void System::LoadSettings(bool display_osd_messages)
   Cheats::ApplySettingOverrides();
 
   g_settings.FixIncompatibleSettings(si, display_osd_messages);
+
+  // only affects images opened from now on
+  CDImage::SetMapTrackFiles(g_settings.cdrom_map_image_files);
 }
 
 void System::ReloadInputSources()
@@ -2092,6 +2095,8 @@ void System::FrameDone()
       Achievements::FrameUpdate();
   }
 
+  GPUThread::PublishPushStatistics();
+
 #ifdef ENABLE_DISCORD_PRESENCE
   PollDiscordPresence();
 #endif
@@ -2608,7 +2613,7 @@ void System::FreeMemoryStateStorage(bool release_memory, bool release_textures,
       if ((mss.vram_texture || !mss.gpu_state_data.empty()) && !gpu_thread_synced)
       {
         gpu_thread_synced = true;
-        GPUThread::SyncGPUThread(true);
+        GPUThread::SyncGPUThread(true, GPUThread::SyncReason::SaveState);
       }
 
       if (mss.vram_texture)
@@ -4471,6 +4476,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
              g_settings.gpu_max_queued_frames != old_settings.gpu_max_queued_frames ||
              g_settings.gpu_use_software_renderer_for_readbacks !=
                old_settings.gpu_use_software_renderer_for_readbacks ||
+             g_settings.gpu_lazy_pipeline_creation != old_settings.gpu_lazy_pipeline_creation ||
              g_settings.gpu_true_color != old_settings.gpu_true_color ||
              g_settings.gpu_scaled_dithering != old_settings.gpu_scaled_dithering ||
              g_settings.gpu_force_round_texcoords != old_settings.gpu_force_round_texcoords ||
@@ -4592,6 +4598,11 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
 
     if (g_settings.cdrom_readahead_sectors != old_settings.cdrom_readahead_sectors)
       CDROM::SetReadaheadSectors(g_settings.cdrom_readahead_sectors);
+    else if (g_settings.cdrom_access_trace_prefetch != old_settings.cdrom_access_trace_prefetch)
+      CDROM::UpdateAccessTrace();
+
+    if (g_settings.mdec_async_decoding != old_settings.mdec_async_decoding)
+      MDEC::UpdateSettings(old_settings);
 
     bool controllers_updated = false;
     for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
@@ -4708,7 +4719,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
   }
 
   if (g_settings.gpu_use_thread && g_settings.gpu_max_queued_frames != old_settings.gpu_max_queued_frames) [[unlikely]]
-    GPUThread::SyncGPUThread(false);
+    GPUThread::SyncGPUThread(false, GPUThread::SyncReason::SettingsChange);
 }
 
 void System::SetTaintsFromSettings()
@@ -5074,6 +5085,11 @@ bool System::IsRunaheadActive()
   return (s_state.runahead_frames > 0);
 }
 
+bool System::IsReplayingRunahead()
+{
+  return (s_state.runahead_replay_frames > 0);
+}
+
 bool System::DoRunahead()
 {
 #ifdef PROFILE_MEMORY_SAVE_STATES
@@ -5092,11 +5108,11 @@ bool System::DoRunahead()
     if (s_state.memory_save_state_count == 0)
       return false;
 
-    LoadMemoryState(GetFirstMemoryState(), false);
-
-    // figure out how many frames we need to run to catch up
+    // figure out how many frames we need to run to catch up, before loading so the load counts as part of the replay
     s_state.runahead_replay_frames = s_state.memory_save_state_count;
 
+    LoadMemoryState(GetFirstMemoryState(), false);
+
     // and throw away all the states, forcing us to catch up below
     ClearMemorySaveStates(false, false);
 
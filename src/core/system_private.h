@@ -32,6 +32,7 @@ void LoadMemoryState(MemorySaveState& mss, bool update_display);
 void SaveMemoryState(MemorySaveState& mss);
 
 bool IsRunaheadActive();
+bool IsReplayingRunahead();
 void IncrementFrameNumber();
 void IncrementInternalFrameNumber();
 void FrameDone();
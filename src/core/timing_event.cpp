@@ -4,6 +4,7 @@
 #include "timing_event.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
+#include "host.h"
 #include "system.h"
 
 #include "util/state_wrapper.h"
@@ -12,11 +13,22 @@
 #include "common/log.h"
 #include "common/small_string.h"
 #include "common/thirdparty/SmallVector.h"
+#include "common/timer.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <mutex>
 
 LOG_CHANNEL(TimingEvents);
 
 namespace TimingEvents {
 
+#ifdef TIMING_EVENTS_USE_HEAP
+static constexpr u32 MAX_ACTIVE_EVENTS = 64;
+#endif
+
 static GlobalTicks GetTimestampForNewEvent();
 
 static void SortEvent(TimingEvent* event);
@@ -25,22 +37,49 @@ static void RemoveActiveEvent(TimingEvent* event);
 static void SortEvents();
 static TimingEvent* FindActiveEvent(const std::string_view name);
 static void CommitGlobalTicks(const GlobalTicks new_global_ticks);
+static void InvokeCallback(TimingEvent* event, TickCount ticks, TickCount ticks_late);
+
+#ifdef TIMING_EVENTS_USE_HEAP
+static bool HeapCompare(const TimingEvent* lhs, const TimingEvent* rhs);
+static void HeapSiftUp(u32 index);
+static void HeapSiftDown(u32 index);
+static void UpdateHeadEvent(const TimingEvent* old_head);
+#endif
+
+static void RegisterEvent(TimingEvent* event);
+static void UnregisterEvent(TimingEvent* event);
 
 namespace {
 struct TimingEventsState
 {
   TimingEvent* active_events_head = nullptr;
+#ifndef TIMING_EVENTS_USE_HEAP
   TimingEvent* active_events_tail = nullptr;
+#endif
   TimingEvent* current_event = nullptr;
   u32 active_event_count = 0;
   GlobalTicks current_event_next_run_time = 0;
   GlobalTicks global_tick_counter = 0;
   GlobalTicks event_run_tick_counter = 0;
+  bool profiling_enabled = false;
+
+#ifdef TIMING_EVENTS_USE_HEAP
+  u32 heap_sequence = 0;
+  std::array<TimingEvent*, MAX_ACTIVE_EVENTS> active_events_heap = {};
+#endif
+
+  // All constructed events, for statistics. Events are constructed during static initialization, so this must stay
+  // constant-initialized.
+  TimingEvent* registry_head = nullptr;
 };
 } // namespace
 
 ALIGN_TO_CACHE_LINE static TimingEventsState s_state;
 
+// Guards the registry, since the debug window reads it from the GPU thread. Events register themselves from static
+// constructors in other translation units, so the mutex is constructed on first use to avoid init order issues.
+static std::mutex& GetRegistryMutex();
+
 } // namespace TimingEvents
 
 GlobalTicks TimingEvents::GetGlobalTickCounter()
@@ -94,16 +133,31 @@ void TimingEvents::SetGlobalTickCounter(GlobalTicks ticks)
   s_state.global_tick_counter = ticks;
 }
 
+const char* TimingEvents::GetSchedulerName()
+{
+#ifndef TIMING_EVENTS_USE_HEAP
+  return "Sorted List";
+#else
+  return "Indexed Heap";
+#endif
+}
+
+#ifndef TIMING_EVENTS_USE_HEAP
+
 void TimingEvents::SortEvent(TimingEvent* event)
 {
   const GlobalTicks event_runtime = event->m_next_run_time;
+  event->m_reschedule_count++;
 
   if (event->prev && event->prev->m_next_run_time > event_runtime)
   {
     // move backwards
     TimingEvent* current = event->prev;
     while (current && current->m_next_run_time > event_runtime)
+    {
       current = current->prev;
+      event->m_sort_steps++;
+    }
 
     // unlink
     if (event->prev)
@@ -143,7 +197,10 @@ void TimingEvents::SortEvent(TimingEvent* event)
     // move forwards
     TimingEvent* current = event->next;
     while (current && event_runtime > current->m_next_run_time)
+    {
       current = current->next;
+      event->m_sort_steps++;
+    }
 
     // unlink
     if (event->prev)
@@ -196,6 +253,7 @@ void TimingEvents::AddActiveEvent(TimingEvent* event)
 {
   DebugAssert(!event->prev && !event->next);
   s_state.active_event_count++;
+  event->m_reschedule_count++;
 
   const GlobalTicks event_runtime = event->m_next_run_time;
   TimingEvent* current = nullptr;
@@ -204,6 +262,7 @@ void TimingEvents::AddActiveEvent(TimingEvent* event)
   {
     current = next;
     next = next->next;
+    event->m_sort_steps++;
   }
 
   if (!next)
@@ -290,8 +349,15 @@ void TimingEvents::SortEvents()
   s_state.active_events_tail = nullptr;
   s_state.active_event_count = 0;
 
+  // Only used when loading state, so don't count re-inserting the events in the statistics.
   for (TimingEvent* event : events)
+  {
+    const u64 reschedule_count = event->m_reschedule_count;
+    const u64 sort_steps = event->m_sort_steps;
     AddActiveEvent(event);
+    event->m_reschedule_count = reschedule_count;
+    event->m_sort_steps = sort_steps;
+  }
 }
 
 static TimingEvent* TimingEvents::FindActiveEvent(const std::string_view name)
@@ -305,6 +371,158 @@ static TimingEvent* TimingEvents::FindActiveEvent(const std::string_view name)
   return nullptr;
 }
 
+#else // TIMING_EVENTS_USE_HEAP
+
+// Events are kept in a binary min-heap ordered by next run time. Ties are broken by the order in which the events
+// were last (re)scheduled, so the ordering of simultaneous events can differ from the sorted list implementation.
+
+ALWAYS_INLINE bool TimingEvents::HeapCompare(const TimingEvent* lhs, const TimingEvent* rhs)
+{
+  return (lhs->m_next_run_time < rhs->m_next_run_time ||
+          (lhs->m_next_run_time == rhs->m_next_run_time &&
+           static_cast<s32>(lhs->m_heap_sequence - rhs->m_heap_sequence) < 0));
+}
+
+void TimingEvents::HeapSiftUp(u32 index)
+{
+  TimingEvent* const event = s_state.active_events_heap[index];
+  while (index > 0)
+  {
+    const u32 parent_index = (index - 1) / 2;
+    TimingEvent* const parent = s_state.active_events_heap[parent_index];
+    if (!HeapCompare(event, parent))
+      break;
+
+    s_state.active_events_heap[index] = parent;
+    parent->m_heap_index = index;
+    index = parent_index;
+    event->m_sort_steps++;
+  }
+
+  s_state.active_events_heap[index] = event;
+  event->m_heap_index = index;
+}
+
+void TimingEvents::HeapSiftDown(u32 index)
+{
+  TimingEvent* const event = s_state.active_events_heap[index];
+  const u32 count = s_state.active_event_count;
+  for (;;)
+  {
+    u32 child_index = index * 2 + 1;
+    if (child_index >= count)
+      break;
+
+    if ((child_index + 1) < count &&
+        HeapCompare(s_state.active_events_heap[child_index + 1], s_state.active_events_heap[child_index]))
+    {
+      child_index++;
+    }
+
+    TimingEvent* const child = s_state.active_events_heap[child_index];
+    if (!HeapCompare(child, event))
+      break;
+
+    s_state.active_events_heap[index] = child;
+    child->m_heap_index = index;
+    index = child_index;
+    event->m_sort_steps++;
+  }
+
+  s_state.active_events_heap[index] = event;
+  event->m_heap_index = index;
+}
+
+void TimingEvents::UpdateHeadEvent(const TimingEvent* old_head)
+{
+  TimingEvent* const new_head = (s_state.active_event_count > 0) ? s_state.active_events_heap[0] : nullptr;
+  s_state.active_events_head = new_head;
+
+  // While running events, the new head may already be due, in which case the downcount is updated after the loop.
+  if (new_head && new_head != old_head &&
+      (!s_state.current_event || new_head->m_next_run_time >= s_state.global_tick_counter))
+  {
+    UpdateCPUDowncount();
+  }
+}
+
+void TimingEvents::SortEvent(TimingEvent* event)
+{
+  const TimingEvent* old_head = s_state.active_events_head;
+  event->m_reschedule_count++;
+  event->m_heap_sequence = ++s_state.heap_sequence;
+
+  // New sequence number means it can only move down when the time is unchanged.
+  HeapSiftUp(event->m_heap_index);
+  HeapSiftDown(event->m_heap_index);
+  UpdateHeadEvent(old_head);
+}
+
+void TimingEvents::AddActiveEvent(TimingEvent* event)
+{
+  Assert(s_state.active_event_count < MAX_ACTIVE_EVENTS);
+
+  const TimingEvent* old_head = s_state.active_events_head;
+  event->m_reschedule_count++;
+  event->m_heap_sequence = ++s_state.heap_sequence;
+
+  const u32 index = s_state.active_event_count++;
+  s_state.active_events_heap[index] = event;
+  event->m_heap_index = index;
+  HeapSiftUp(index);
+  UpdateHeadEvent(old_head);
+}
+
+void TimingEvents::RemoveActiveEvent(TimingEvent* event)
+{
+  DebugAssert(s_state.active_event_count > 0);
+
+  const TimingEvent* old_head = s_state.active_events_head;
+  const u32 index = event->m_heap_index;
+  const u32 last_index = --s_state.active_event_count;
+  DebugAssert(s_state.active_events_heap[index] == event);
+  if (index != last_index)
+  {
+    TimingEvent* const last = s_state.active_events_heap[last_index];
+    s_state.active_events_heap[index] = last;
+    last->m_heap_index = index;
+    HeapSiftUp(index);
+    HeapSiftDown(last->m_heap_index);
+  }
+
+  s_state.active_events_heap[last_index] = nullptr;
+  UpdateHeadEvent(old_head);
+}
+
+void TimingEvents::SortEvents()
+{
+  const u32 count = s_state.active_event_count;
+  // Only used when loading state, so don't count rebuilding the heap in the statistics.
+  for (u32 i = count / 2; i > 0; i--)
+  {
+    TimingEvent* const event = s_state.active_events_heap[i - 1];
+    const u64 sort_steps = event->m_sort_steps;
+    HeapSiftDown(i - 1);
+    event->m_sort_steps = sort_steps;
+  }
+
+  s_state.active_events_head = (count > 0) ? s_state.active_events_heap[0] : nullptr;
+}
+
+static TimingEvent* TimingEvents::FindActiveEvent(const std::string_view name)
+{
+  for (u32 i = 0; i < s_state.active_event_count; i++)
+  {
+    TimingEvent* event = s_state.active_events_heap[i];
+    if (event->GetName() == name)
+      return event;
+  }
+
+  return nullptr;
+}
+
+#endif // TIMING_EVENTS_USE_HEAP
+
 bool TimingEvents::IsRunningEvents()
 {
   return (s_state.current_event != nullptr);
@@ -351,7 +569,7 @@ ALWAYS_INLINE_RELEASE void TimingEvents::CommitGlobalTicks(const GlobalTicks new
       event->m_last_run_time = s_state.global_tick_counter;
 
       // The cycles_late is only an indicator, it doesn't modify the cycles to execute.
-      event->m_callback(event->m_callback_param, ticks_to_execute, ticks_late);
+      InvokeCallback(event, ticks_to_execute, ticks_late);
       if (event->m_active)
       {
         event->m_next_run_time = s_state.current_event_next_run_time;
@@ -364,6 +582,20 @@ ALWAYS_INLINE_RELEASE void TimingEvents::CommitGlobalTicks(const GlobalTicks new
   s_state.current_event = nullptr;
 }
 
+ALWAYS_INLINE_RELEASE void TimingEvents::InvokeCallback(TimingEvent* event, TickCount ticks, TickCount ticks_late)
+{
+  event->m_invoke_count++;
+  if (!s_state.profiling_enabled) [[likely]]
+  {
+    event->m_callback(event->m_callback_param, ticks, ticks_late);
+    return;
+  }
+
+  const Timer::Value start_time = Timer::GetCurrentValue();
+  event->m_callback(event->m_callback_param, ticks, ticks_late);
+  event->m_callback_time += Timer::GetCurrentValue() - start_time;
+}
+
 void TimingEvents::RunEvents()
 {
   DebugAssert(!s_state.current_event);
@@ -507,8 +739,15 @@ bool TimingEvents::DoState(StateWrapper& sw)
     {
       sw.Do(&s_state.active_event_count);
 
+      // Order does not matter, the events are re-sorted on load.
+#ifndef TIMING_EVENTS_USE_HEAP
       for (TimingEvent* event = s_state.active_events_head; event; event = event->next)
       {
+#else
+      for (u32 i = 0; i < s_state.active_event_count; i++)
+      {
+        TimingEvent* event = s_state.active_events_heap[i];
+#endif
         sw.Do(&event->m_name);
         GlobalTicks next_run_time =
           (s_state.current_event == event) ? s_state.current_event_next_run_time : event->m_next_run_time;
@@ -525,6 +764,124 @@ bool TimingEvents::DoState(StateWrapper& sw)
   return !sw.HasError();
 }
 
+std::mutex& TimingEvents::GetRegistryMutex()
+{
+  // Constructed before the first event finishes registering, so it outlives all static events.
+  static std::mutex mutex;
+  return mutex;
+}
+
+void TimingEvents::RegisterEvent(TimingEvent* event)
+{
+  std::unique_lock lock(GetRegistryMutex());
+  event->m_registry_next = s_state.registry_head;
+  s_state.registry_head = event;
+}
+
+void TimingEvents::UnregisterEvent(TimingEvent* event)
+{
+  std::unique_lock lock(GetRegistryMutex());
+  TimingEvent** link = &s_state.registry_head;
+  while (*link && *link != event)
+    link = &(*link)->m_registry_next;
+  if (*link)
+    *link = event->m_registry_next;
+}
+
+bool TimingEvents::IsProfilingEnabled()
+{
+  return s_state.profiling_enabled;
+}
+
+void TimingEvents::SetProfilingEnabled(bool enabled)
+{
+  if (s_state.profiling_enabled == enabled)
+    return;
+
+  INFO_LOG("Timing event profiling is now {}.", enabled ? "enabled" : "disabled");
+  s_state.profiling_enabled = enabled;
+}
+
+std::vector<TimingEvents::EventStatistics> TimingEvents::GetStatistics()
+{
+  std::vector<EventStatistics> ret;
+
+  std::unique_lock lock(GetRegistryMutex());
+  for (const TimingEvent* event = s_state.registry_head; event; event = event->m_registry_next)
+  {
+    ret.push_back(EventStatistics{.name = event->m_name,
+                                  .invoke_count = event->m_invoke_count,
+                                  .reschedule_count = event->m_reschedule_count,
+                                  .sort_steps = event->m_sort_steps,
+                                  .callback_time_ms = Timer::ConvertValueToMilliseconds(event->m_callback_time),
+                                  .active = event->m_active});
+  }
+
+  return ret;
+}
+
+void TimingEvents::ResetStatistics()
+{
+  std::unique_lock lock(GetRegistryMutex());
+  for (TimingEvent* event = s_state.registry_head; event; event = event->m_registry_next)
+  {
+    event->m_invoke_count = 0;
+    event->m_reschedule_count = 0;
+    event->m_sort_steps = 0;
+    event->m_callback_time = 0;
+  }
+}
+
+void TimingEvents::DrawDebugWindow(float scale)
+{
+  static constexpr u32 NUM_COLUMNS = 6;
+  static constexpr std::array<const char*, NUM_COLUMNS> column_names = {
+    {"Name", "Active", "Invocations", "Reschedules", "Sort Steps", "Callback Time"}};
+
+  // NOTE: Racey read, since we're on the GPU thread. The counters are only informational.
+  std::vector<EventStatistics> stats = GetStatistics();
+  std::sort(stats.begin(), stats.end(),
+            [](const EventStatistics& lhs, const EventStatistics& rhs) { return lhs.invoke_count > rhs.invoke_count; });
+
+  ImGui::Text("Scheduler: %s", GetSchedulerName());
+  ImGui::SameLine();
+  bool profiling_enabled = s_state.profiling_enabled;
+  if (ImGui::Checkbox("Measure Callback Time", &profiling_enabled))
+    Host::RunOnCPUThread([profiling_enabled]() { SetProfilingEnabled(profiling_enabled); });
+  ImGui::SameLine();
+  if (ImGui::Button("Reset"))
+    Host::RunOnCPUThread(&TimingEvents::ResetStatistics);
+
+  ImGui::Columns(NUM_COLUMNS);
+  ImGui::SetColumnWidth(0, 200.0f * scale);
+  for (u32 i = 1; i < NUM_COLUMNS; i++)
+    ImGui::SetColumnWidth(i, 100.0f * scale);
+
+  for (const char* title : column_names)
+  {
+    ImGui::TextUnformatted(title);
+    ImGui::NextColumn();
+  }
+
+  for (const EventStatistics& es : stats)
+  {
+    ImGui::TextUnformatted(es.name.data(), es.name.data() + es.name.size());
+    ImGui::NextColumn();
+    ImGui::TextUnformatted(es.active ? "Yes" : "No");
+    ImGui::NextColumn();
+    ImGui::Text("%" PRIu64, es.invoke_count);
+    ImGui::NextColumn();
+    ImGui::Text("%" PRIu64, es.reschedule_count);
+    ImGui::NextColumn();
+    ImGui::Text("%" PRIu64, es.sort_steps);
+    ImGui::NextColumn();
+    ImGui::Text("%.3f ms", es.callback_time_ms);
+    ImGui::NextColumn();
+  }
+
+  ImGui::Columns(1);
+}
+
 TimingEvent::TimingEvent(const std::string_view name, TickCount period, TickCount interval,
                          TimingEventCallback callback, void* callback_param)
   : m_callback(callback), m_callback_param(callback_param), m_period(period), m_interval(interval), m_name(name)
@@ -532,11 +889,13 @@ TimingEvent::TimingEvent(const std::string_view name, TickCount period, TickCoun
   const GlobalTicks ts = TimingEvents::GetTimestampForNewEvent();
   m_last_run_time = ts;
   m_next_run_time = ts + static_cast<u32>(interval);
+  TimingEvents::RegisterEvent(this);
 }
 
 TimingEvent::~TimingEvent()
 {
   DebugAssert(!m_active);
+  TimingEvents::UnregisterEvent(this);
 }
 
 TickCount TimingEvent::GetTicksSinceLastExecution() const
@@ -645,7 +1004,7 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
   if (s_state.active_events_head == this)
     UpdateCPUDowncount();
 
-  m_callback(m_callback_param, ticks_to_execute, 0);
+  InvokeCallback(this, ticks_to_execute, 0);
 }
 
 void TimingEvent::Activate()
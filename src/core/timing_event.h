@@ -6,6 +6,7 @@
 #include "types.h"
 
 #include <string_view>
+#include <vector>
 
 class StateWrapper;
 
@@ -58,8 +59,13 @@ public:
   void SetInterval(TickCount interval) { m_interval = interval; }
   void SetPeriod(TickCount period) { m_period = period; }
 
+#ifndef TIMING_EVENTS_USE_HEAP
   TimingEvent* prev = nullptr;
   TimingEvent* next = nullptr;
+#else
+  u32 m_heap_index = 0;
+  u32 m_heap_sequence = 0;
+#endif
 
   TimingEventCallback m_callback;
   void* m_callback_param;
@@ -72,10 +78,27 @@ public:
   bool m_active = false;
 
   std::string_view m_name;
+
+  // Statistics. Callback time is only accumulated when profiling is enabled.
+  TimingEvent* m_registry_next = nullptr;
+  u64 m_invoke_count = 0;
+  u64 m_reschedule_count = 0;
+  u64 m_sort_steps = 0;
+  u64 m_callback_time = 0;
 };
 
 namespace TimingEvents {
 
+struct EventStatistics
+{
+  std::string_view name;
+  u64 invoke_count;
+  u64 reschedule_count;
+  u64 sort_steps;
+  double callback_time_ms;
+  bool active;
+};
+
 GlobalTicks GetGlobalTickCounter();
 GlobalTicks GetEventRunTickCounter();
 
@@ -97,4 +120,17 @@ TimingEvent** GetHeadEventPtr();
 // Tick counter injection, only for GPU dump replayer.
 void SetGlobalTickCounter(GlobalTicks ticks);
 
+/// Returns the name of the scheduler implementation selected at build time.
+const char* GetSchedulerName();
+
+/// Enables measurement of host time spent in event callbacks. Counters are always updated.
+bool IsProfilingEnabled();
+void SetProfilingEnabled(bool enabled);
+
+/// Returns statistics for every registered event, active or not.
+std::vector<EventStatistics> GetStatistics();
+void ResetStatistics();
+
+void DrawDebugWindow(float scale);
+
 } // namespace TimingEvents
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "core/game_list.h"
 #include "core/gpu.h"
 #include "core/gpu_backend.h"
+#include "core/gpu_presenter.h"
 #include "core/gpu_thread.h"
 #include "core/host.h"
 #include "core/imgui_overlays.h"
@@ -35,6 +36,7 @@
 #include "common/crash_handler.h"
 #include "common/error.h"
 #include "common/file_system.h"
+#include "common/heap_array.h"
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
@@ -91,6 +93,8 @@ static void CPUThreadMainLoop();
 static void GPUThreadEntryPoint();
 static void UIThreadMainLoop();
 static void ProcessSDLEvent(const SDL_Event* ev);
+static void PresentCPUDisplay(GPUBackend* gpu_backend);
+static void UpdateWindowSurface();
 static std::string GetWindowTitle(const std::string& game_title);
 static std::optional<WindowInfo> TranslateSDLWindowInfo(SDL_Window* win, Error* error);
 static bool GetSavedPlatformWindowGeometry(s32* x, s32* y, s32* width, s32* height);
@@ -119,6 +123,11 @@ struct SDLHostState
   std::mutex state_mutex;
   FullscreenUI::BackgroundProgressCallback* game_list_refresh_progress = nullptr;
 
+  // Software renderer output when there is no GPU device, handed from the GPU thread to the UI thread.
+  DynamicHeapArray<u32> cpu_display_buffer;
+  SDL_Rect cpu_display_rect = {};
+  std::atomic_bool cpu_display_present_pending{false};
+
   // CPU thread state.
   ALIGN_TO_CACHE_LINE std::atomic_bool cpu_thread_running{false};
   std::mutex cpu_thread_events_mutex;
@@ -323,6 +332,9 @@ void MiniHost::SetDefaultSettings(SettingsInterface& si, bool system, bool contr
     System::SetDefaultSettings(si);
     EmuFolders::SetDefaults();
     EmuFolders::Save(si);
+
+    // Present the software renderer through the window surface when the fullscreen UI isn't needed.
+    si.SetBoolValue("GPU", "HeadlessSoftwareRenderer", true);
   }
 
   if (controller)
@@ -911,6 +923,59 @@ void MiniHost::ProcessSDLEvent(const SDL_Event* ev)
   }
 }
 
+void MiniHost::PresentCPUDisplay(GPUBackend* gpu_backend)
+{
+  // Drop the frame if the UI thread hasn't shown the last one yet, rather than queuing them up.
+  if (s_state.cpu_display_present_pending.load(std::memory_order_acquire))
+    return;
+
+  const WindowInfo& wi = GPUThread::GetRenderWindowInfo();
+  GSVector4i display_rect, draw_rect;
+  gpu_backend->GetPresenter().CalculateDrawRect(wi.surface_width, wi.surface_height, true, true, &display_rect,
+                                                &draw_rect);
+  const u32 width = static_cast<u32>(draw_rect.width());
+  const u32 height = static_cast<u32>(draw_rect.height());
+  if (width == 0 || height == 0)
+    return;
+
+  s_state.cpu_display_buffer.resize(width * height);
+  if (!gpu_backend->RenderDisplayToBuffer(s_state.cpu_display_buffer.data(), width * sizeof(u32), width, height))
+    return;
+
+  s_state.cpu_display_rect = {draw_rect.left, draw_rect.top, static_cast<int>(width), static_cast<int>(height)};
+  s_state.cpu_display_present_pending.store(true, std::memory_order_release);
+  RunOnUIThread(&UpdateWindowSurface);
+}
+
+void MiniHost::UpdateWindowSurface()
+{
+  if (!s_state.cpu_display_present_pending.load(std::memory_order_acquire))
+    return;
+
+  SDL_Surface* const window_surface = s_state.sdl_window ? SDL_GetWindowSurface(s_state.sdl_window) : nullptr;
+  if (window_surface)
+  {
+    const SDL_Rect& rect = s_state.cpu_display_rect;
+    SDL_Surface* const display_surface =
+      SDL_CreateSurfaceFrom(rect.w, rect.h, SDL_PIXELFORMAT_RGBX32, s_state.cpu_display_buffer.data(),
+                            rect.w * static_cast<int>(sizeof(u32)));
+    if (display_surface)
+    {
+      SDL_FillSurfaceRect(window_surface, nullptr, SDL_MapSurfaceRGB(window_surface, 0, 0, 0));
+      SDL_BlitSurface(display_surface, nullptr, window_surface, &rect);
+      SDL_DestroySurface(display_surface);
+      if (!SDL_UpdateWindowSurface(s_state.sdl_window))
+        ERROR_LOG("SDL_UpdateWindowSurface() failed: {}", SDL_GetError());
+    }
+    else
+    {
+      ERROR_LOG("SDL_CreateSurfaceFrom() failed: {}", SDL_GetError());
+    }
+  }
+
+  s_state.cpu_display_present_pending.store(false, std::memory_order_release);
+}
+
 void MiniHost::RunOnUIThread(std::function<void()> func)
 {
   std::function<void()>* pfunc = new std::function<void()>(std::move(func));
@@ -1009,14 +1074,16 @@ void MiniHost::CPUThreadEntryPoint()
   // start up GPU thread
   s_state.gpu_thread.Start(&GPUThreadEntryPoint);
 
-  // start the fullscreen UI and get it going
-  if (GPUThread::StartFullscreenUI(s_state.start_fullscreen_ui_fullscreen, &error))
+  // start the fullscreen UI and get it going, batch mode goes straight to the game without it, which also lets the
+  // software renderer run without a GPU device
+  if (s_state.batch_mode || GPUThread::StartFullscreenUI(s_state.start_fullscreen_ui_fullscreen, &error))
   {
-    WarnAboutInterface();
-
     // kick a game list refresh if we're not in batch mode
     if (!s_state.batch_mode)
+    {
+      WarnAboutInterface();
       Host::RefreshGameListAsync(false);
+    }
 
     CPUThreadMainLoop();
 
@@ -1088,6 +1155,9 @@ void Host::OnSystemResumed()
 
 void Host::OnSystemDestroyed()
 {
+  // Nothing to go back to in batch mode.
+  if (MiniHost::s_state.batch_mode)
+    Host::RequestExitApplication(false);
 }
 
 void Host::OnSystemAbnormalShutdown(const std::string_view reason)
@@ -1106,6 +1176,8 @@ void Host::OnGPUThreadRunIdleChanged(bool is_active)
 
 void Host::FrameDoneOnGPUThread(GPUBackend* gpu_backend, u32 frame_number)
 {
+  if (!g_gpu_device)
+    MiniHost::PresentCPUDisplay(gpu_backend);
 }
 
 void Host::OnPerformanceCountersUpdated(const GPUBackend* gpu_backend)
@@ -1525,7 +1597,7 @@ void MiniHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "\n");
   std::fprintf(stderr, "  -help: Displays this information and exits.\n");
   std::fprintf(stderr, "  -version: Displays version information and exits.\n");
-  std::fprintf(stderr, "  -batch: Enables batch mode (exits after powering off).\n");
+  std::fprintf(stderr, "  -batch: Enables batch mode (exits after powering off, no fullscreen UI).\n");
   std::fprintf(stderr, "  -fastboot: Force fast boot for provided filename.\n");
   std::fprintf(stderr, "  -slowboot: Force slow boot for provided filename.\n");
   std::fprintf(stderr, "  -bios: Boot into the BIOS shell.\n");
@@ -1832,12 +1904,17 @@ int main(int argc, char* argv[])
     Host::RunOnCPUThread([params = std::move(autoboot.value())]() mutable {
       Error error;
       if (!System::BootSystem(std::move(params), &error))
+      {
         Host::ReportErrorAsync("Failed to boot system", error.GetDescription());
+        if (s_state.batch_mode)
+          Host::RequestExitApplication(false);
+      }
     });
   }
 
   UIThreadMainLoop();
 
+  GameList::StopWatcher();
   StopCPUThread();
 
   System::ProcessShutdown();
@@ -261,6 +261,10 @@ void AdvancedSettingsWidget::addTweakOptions()
                          Settings::DEFAULT_GPU_FIFO_SIZE);
   addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("GPU Max Run-Ahead"), "Hacks", "GPUMaxRunAhead", 0, 1000,
                          Settings::DEFAULT_GPU_MAX_RUN_AHEAD);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Lazy GPU Pipeline Creation"), "GPU",
+                        "LazyPipelineCreation", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Asynchronous MDEC Decoding"), "Hacks",
+                        "AsyncMDECDecoding", false);
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Memory Exceptions"), "CPU",
                         "RecompilerMemoryExceptions", false);
@@ -313,6 +317,8 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
                            static_cast<int>(Settings::DEFAULT_GPU_FIFO_SIZE)); // GPU FIFO size
     setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
                            static_cast<int>(Settings::DEFAULT_GPU_MAX_RUN_AHEAD)); // GPU max run-ahead
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Lazy GPU pipeline creation
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Asynchronous MDEC decoding
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Recompiler memory exceptions
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);                       // Recompiler block linking
     setChoiceTweakOption(m_ui.tweakOptionTable, i++,
@@ -348,6 +354,8 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("Hacks", "DMAHaltTicks");
   sif->DeleteValue("Hacks", "GPUFIFOSize");
   sif->DeleteValue("Hacks", "GPUMaxRunAhead");
+  sif->DeleteValue("GPU", "LazyPipelineCreation");
+  sif->DeleteValue("Hacks", "AsyncMDECDecoding");
   sif->DeleteValue("Hacks", "ExportSharedMemory");
   sif->DeleteValue("CPU", "RecompilerMemoryExceptions");
   sif->DeleteValue("CPU", "RecompilerBlockLinking");
@@ -64,7 +64,11 @@ ConsoleSettingsWidget::ConsoleSettingsWidget(SettingsWindow* dialog, QWidget* pa
   SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.cdromReadaheadSectors, "CDROM", "ReadaheadSectors",
                                               Settings::DEFAULT_CDROM_READAHEAD_SECTORS);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromLoadImageToRAM, "CDROM", "LoadImageToRAM", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromCompressImageInRAM, "CDROM", "CompressImageInRAM", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromShareImageInRAM, "CDROM", "ShareImageInRAM", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromLoadImagePatches, "CDROM", "LoadImagePatches", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromAccessTracePrefetch, "CDROM", "AccessTracePrefetch",
+                                               false);
 
   if (!m_dialog->isPerGameSettings())
   {
@@ -126,9 +130,22 @@ ConsoleSettingsWidget::ConsoleSettingsWidget(SettingsWindow* dialog, QWidget* pa
     m_ui.cdromLoadImageToRAM, tr("Preload Image to RAM"), tr("Unchecked"),
     tr("Loads the game image into RAM. Useful for network paths that may become unreliable during gameplay. In some "
        "cases also eliminates stutter when games initiate audio track playback."));
+  dialog->registerWidgetHelp(
+    m_ui.cdromCompressImageInRAM, tr("Compress Preloaded Image"), tr("Unchecked"),
+    tr("Compresses the image when it is preloaded to RAM, typically halving memory usage for data discs. Sectors are "
+       "decompressed in small groups as they are read. Has no effect on CHD images, which are already compressed."));
+  dialog->registerWidgetHelp(
+    m_ui.cdromShareImageInRAM, tr("Share Preloaded Image"), tr("Unchecked"),
+    tr("Places the preloaded image in memory which is shared with other running instances of the emulator, so running "
+       "the same game several times only stores and decompresses the image once. Takes priority over compression."));
   dialog->registerWidgetHelp(m_ui.cdromLoadImagePatches, tr("Apply Image Patches"), tr("Unchecked"),
                              tr("Automatically applies patches to disc images when they are present in the same "
                                 "directory. Currently only PPF patches are supported with this option."));
+  dialog->registerWidgetHelp(
+    m_ui.cdromAccessTracePrefetch, tr("Learn Disc Access Patterns"), tr("Unchecked"),
+    tr("Records the order in which the game reads the disc, and uses it on later boots to read and decompress "
+       "sectors before they are requested. Reduces loading stutter with compressed formats such as CHD and PBP. "
+       "Requires asynchronous readahead to be enabled."));
   dialog->registerWidgetHelp(
     m_ui.cdromIgnoreDriveSubcode, tr("Ignore Drive Subcode"), tr("Unchecked"),
     tr("Ignores the subchannel provided by the drive when using physical discs, instead always generating subchannel "
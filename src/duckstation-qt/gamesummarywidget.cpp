@@ -12,16 +12,19 @@
 #include "core/game_list.h"
 
 #include "common/error.h"
+#include "common/path.h"
 #include "common/string_util.h"
 
 #include "fmt/format.h"
 
 #include <QtCore/QDateTime>
+#include <QtCore/QDir>
 #include <QtCore/QFuture>
 #include <QtCore/QSignalBlocker>
 #include <QtCore/QStringBuilder>
 #include <QtWidgets/QDialog>
 #include <QtWidgets/QDialogButtonBox>
+#include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QTextBrowser>
 
@@ -68,6 +71,7 @@ GameSummaryWidget::GameSummaryWidget(const std::string& path, const std::string&
   connect(m_ui.inputProfile, &QComboBox::currentIndexChanged, this, &GameSummaryWidget::onInputProfileChanged);
   connect(m_ui.editInputProfile, &QAbstractButton::clicked, this, &GameSummaryWidget::onEditInputProfileClicked);
   connect(m_ui.computeHashes, &QAbstractButton::clicked, this, &GameSummaryWidget::onComputeHashClicked);
+  connect(m_ui.compressImage, &QAbstractButton::clicked, this, &GameSummaryWidget::onCompressImageClicked);
 
   connect(m_ui.title, &QLineEdit::editingFinished, this, [this]() {
     if (m_ui.title->isModified())
@@ -360,7 +364,10 @@ void GameSummaryWidget::populateTracksInfo()
 
   std::unique_ptr<CDImage> image = CDImage::Open(m_path.c_str(), false, nullptr);
   if (!image)
+  {
+    m_ui.compressImage->setEnabled(false);
     return;
+  }
 
   setRevisionText(tr("%1 tracks covering %2 MB (%3 MB on disk)")
                     .arg(image->GetTrackCount())
@@ -392,6 +399,18 @@ void GameSummaryWidget::populateTracksInfo()
     status->setTextAlignment(Qt::AlignCenter);
     m_ui.tracks->setItem(row, 5, status);
   }
+
+  // Show the hashes from the last verification if the image hasn't changed. Verifying always hashes it again.
+  std::vector<CDImageHasher::Hash> track_hashes;
+  if (GameList::GetCachedTrackHashes(m_path, image.get(), &track_hashes))
+  {
+    for (size_t i = 0; i < track_hashes.size(); i++)
+    {
+      QTableWidgetItem* item = m_ui.tracks->item(static_cast<int>(i), 4);
+      item->setText(QString::fromStdString(CDImageHasher::HashToString(track_hashes[i])));
+      item->setToolTip(tr("Hash from a previous verification. Verify the image to compute it again."));
+    }
+  }
 }
 
 void GameSummaryWidget::onCompatibilityCommentsClicked()
@@ -491,36 +510,28 @@ void GameSummaryWidget::onComputeHashClicked()
 
   QtModalProgressCallback progress_callback(this);
   progress_callback.SetCancellable(true);
-  progress_callback.SetProgressRange(image->GetTrackCount());
   progress_callback.MakeVisible();
 
+  // Always hash the whole image here, the cached hashes are only good enough for display.
   std::vector<CDImageHasher::Hash> track_hashes;
-  track_hashes.reserve(image->GetTrackCount());
-
-  // Calculate hashes
   bool calculate_hash_success = true;
-  for (u8 track = 1; track <= image->GetTrackCount(); track++)
+  if (CDImageHasher::GetTrackHashes(image.get(), &track_hashes, &progress_callback))
   {
-    progress_callback.SetProgressValue(track - 1);
-    progress_callback.PushState();
-
-    CDImageHasher::Hash hash;
-    if (!CDImageHasher::GetTrackHash(image.get(), track, &hash, &progress_callback))
-    {
-      progress_callback.PopState();
-
-      if (progress_callback.IsCancelled())
-        return;
-
-      calculate_hash_success = false;
-      break;
-    }
-    track_hashes.emplace_back(hash);
+    GameList::AddCachedTrackHashes(m_path, image.get(), track_hashes);
+  }
+  else
+  {
+    if (progress_callback.IsCancelled())
+      return;
 
-    QTableWidgetItem* item = m_ui.tracks->item(track - 1, 4);
-    item->setText(QString::fromStdString(CDImageHasher::HashToString(hash)));
+    calculate_hash_success = false;
+  }
 
-    progress_callback.PopState();
+  for (size_t i = 0; i < track_hashes.size(); i++)
+  {
+    QTableWidgetItem* item = m_ui.tracks->item(static_cast<int>(i), 4);
+    item->setText(QString::fromStdString(CDImageHasher::HashToString(track_hashes[i])));
+    item->setToolTip(QString());
   }
 
   // Verify hashes against gamedb
@@ -532,7 +543,8 @@ void GameSummaryWidget::onComputeHashClicked()
     m_redump_search_keyword = CDImageHasher::HashToString(track_hashes.front());
 
     progress_callback.SetStatusText(TRANSLATE("GameSummaryWidget", "Verifying hashes..."));
-    progress_callback.SetProgressValue(image->GetTrackCount());
+    progress_callback.SetProgressRange(1);
+    progress_callback.SetProgressValue(1);
 
     // Verification strategy used:
     // 1. First, find all matches for the data track
@@ -629,3 +641,39 @@ void GameSummaryWidget::onComputeHashClicked()
   else
     m_ui.computeHashes->setEnabled(false);
 }
+
+void GameSummaryWidget::onCompressImageClicked()
+{
+  const QString output_path = QDir::toNativeSeparators(QFileDialog::getSaveFileName(
+    QtUtils::GetRootWidget(this), tr("Select Compressed Image Path"),
+    QString::fromStdString(Path::ReplaceExtension(m_path, "zcd")), tr("Zstandard CD Images (*.zcd)")));
+  if (output_path.isEmpty())
+    return;
+
+  Error error;
+  std::unique_ptr<CDImage> image = CDImage::Open(m_path.c_str(), false, &error);
+  if (!image)
+  {
+    QMessageBox::critical(QtUtils::GetRootWidget(this), tr("Error"),
+                          tr("Failed to open CD image:\n%1").arg(QString::fromStdString(error.GetDescription())));
+    return;
+  }
+
+  QtModalProgressCallback progress_callback(this);
+  progress_callback.SetCancellable(true);
+  progress_callback.MakeVisible();
+
+  if (!CDImage::WriteZCDImage(output_path.toStdString().c_str(), image.get(), 8, 12, &progress_callback, &error))
+  {
+    if (progress_callback.IsCancelled())
+      return;
+
+    QMessageBox::critical(
+      QtUtils::GetRootWidget(this), tr("Error"),
+      tr("Failed to write compressed image:\n%1").arg(QString::fromStdString(error.GetDescription())));
+    return;
+  }
+
+  QMessageBox::information(QtUtils::GetRootWidget(this), tr("Compress"),
+                           tr("Compressed image written to %1.").arg(output_path));
+}
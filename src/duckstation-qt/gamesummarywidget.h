@@ -37,6 +37,7 @@ private Q_SLOTS:
   void onInputProfileChanged(int index);
   void onEditInputProfileClicked();
   void onComputeHashClicked();
+  void onCompressImageClicked();
 
 private:
   void populateUi(const std::string& path, const std::string& serial, DiscRegion region,
@@ -3036,6 +3036,7 @@ int main(int argc, char* argv[])
 
 shutdown_and_exit:
   // Shutting down.
+  GameList::StopWatcher();
   EmuThread::stop();
 
   // Close main window.
@@ -14,6 +14,7 @@
 #include "core/spu.h"
 #include "core/system.h"
 #include "core/system_private.h"
+#include "core/timing_event.h"
 
 #include "scmversion/scmversion.h"
 
@@ -54,7 +55,12 @@ static void HookSignals();
 static bool SetFolders();
 static bool SetNewDataRoot(const std::string& filename);
 static void DumpSystemStateHashes();
+static void DumpStatistics();
+static void AppendJSONString(std::string& dest, std::string_view str);
+static void AppendTimingEventStatistics(std::string& dest);
+static void AppendGPUThreadStatistics(std::string& dest);
 static std::string GetFrameDumpPath(u32 frame);
+static bool ReadDisplayTexture(GPUBackend* gpu_backend, Image* image);
 static void GPUThreadEntryPoint();
 
 } // namespace RegTestHost
@@ -66,6 +72,7 @@ static u32 s_frames_to_run = 60 * 60;
 static u32 s_frames_remaining = 0;
 static u32 s_frame_dump_interval = 0;
 static std::string s_dump_base_directory;
+static std::string s_statistics_path;
 
 bool RegTestHost::SetFolders()
 {
@@ -112,6 +119,7 @@ bool RegTestHost::InitializeConfig()
   g_settings.Save(si, false);
   si.SetStringValue("GPU", "Renderer", Settings::GetRendererName(GPURenderer::Software));
   si.SetBoolValue("GPU", "DisableShaderCache", true);
+  si.SetBoolValue("GPU", "HeadlessSoftwareRenderer", true);
   si.SetStringValue("Pad1", "Type", Controller::GetControllerInfo(ControllerType::AnalogController).name);
   si.SetStringValue("Pad2", "Type", Controller::GetControllerInfo(ControllerType::None).name);
   si.SetStringValue("MemoryCards", "Card1Type", Settings::GetMemoryCardTypeName(MemoryCardType::NonPersistent));
@@ -330,6 +338,7 @@ void Host::PumpMessagesOnCPUThread()
   if (s_frames_remaining == 0)
   {
     RegTestHost::DumpSystemStateHashes();
+    RegTestHost::DumpStatistics();
     System::ShutdownSystem(false);
   }
 }
@@ -409,11 +418,11 @@ void Host::DestroyAuxiliaryRenderWindow(AuxiliaryRenderWindowHandle handle, s32*
 {
 }
 
-void Host::FrameDoneOnGPUThread(GPUBackend* gpu_backend, u32 frame_number)
+bool RegTestHost::ReadDisplayTexture(GPUBackend* gpu_backend, Image* image)
 {
   const GPUPresenter& presenter = gpu_backend->GetPresenter();
-  if (s_frame_dump_interval == 0 || (frame_number % s_frame_dump_interval) != 0 || !presenter.HasDisplayTexture())
-    return;
+  if (!presenter.HasDisplayTexture())
+    return false;
 
   // Need to take a copy of the display texture.
   GPUTexture* const read_texture = presenter.GetDisplayTexture();
@@ -423,14 +432,14 @@ void Host::FrameDoneOnGPUThread(GPUBackend* gpu_backend, u32 frame_number)
   const u32 read_height = static_cast<u32>(presenter.GetDisplayTextureViewHeight());
   const ImageFormat read_format = GPUTexture::GetImageFormatForTextureFormat(read_texture->GetFormat());
   if (read_format == ImageFormat::None)
-    return;
+    return false;
 
-  Image image(read_width, read_height, read_format);
+  image->Resize(read_width, read_height, read_format, false);
   std::unique_ptr<GPUDownloadTexture> dltex;
   if (g_gpu_device->GetFeatures().memory_import)
   {
-    dltex = g_gpu_device->CreateDownloadTexture(read_width, read_height, read_texture->GetFormat(), image.GetPixels(),
-                                                image.GetStorageSize(), image.GetPitch());
+    dltex = g_gpu_device->CreateDownloadTexture(read_width, read_height, read_texture->GetFormat(), image->GetPixels(),
+                                                image->GetStorageSize(), image->GetPitch());
   }
   if (!dltex)
   {
@@ -438,21 +447,46 @@ void Host::FrameDoneOnGPUThread(GPUBackend* gpu_backend, u32 frame_number)
     {
       ERROR_LOG("Failed to create {}x{} {} download texture", read_width, read_height,
                 GPUTexture::GetFormatName(read_texture->GetFormat()));
-      return;
+      return false;
     }
   }
 
   dltex->CopyFromTexture(0, 0, read_texture, read_x, read_y, read_width, read_height, 0, 0, !dltex->IsImported());
-  if (!dltex->ReadTexels(0, 0, read_width, read_height, image.GetPixels(), image.GetPitch()))
+  if (!dltex->ReadTexels(0, 0, read_width, read_height, image->GetPixels(), image->GetPitch()))
   {
     ERROR_LOG("Failed to read {}x{} download texture", read_width, read_height);
     gpu_backend->RestoreDeviceContext();
-    return;
+    return false;
   }
 
   // no more GPU calls
   gpu_backend->RestoreDeviceContext();
 
+  return true;
+}
+
+void Host::FrameDoneOnGPUThread(GPUBackend* gpu_backend, u32 frame_number)
+{
+  if (s_frame_dump_interval == 0 || (frame_number % s_frame_dump_interval) != 0)
+    return;
+
+  // Without a device, the software renderer writes the display straight into the image.
+  Image image;
+  if (!g_gpu_device)
+  {
+    u32 cpu_width, cpu_height;
+    if (!gpu_backend->GetCPUDisplaySize(&cpu_width, &cpu_height))
+      return;
+
+    image.Resize(cpu_width, cpu_height, ImageFormat::RGBA8, false);
+    if (!gpu_backend->RenderDisplayToBuffer(image.GetPixels(), image.GetPitch(), cpu_width, cpu_height))
+      return;
+  }
+  else if (!RegTestHost::ReadDisplayTexture(gpu_backend, &image))
+  {
+    return;
+  }
+
   Error error;
   const std::string path = RegTestHost::GetFrameDumpPath(frame_number);
   auto fp = FileSystem::OpenManagedCFile(path.c_str(), "wb", &error);
@@ -669,6 +703,103 @@ void RegTestHost::DumpSystemStateHashes()
                               std::span<const u8>(reinterpret_cast<const u8*>(g_vram), VRAM_SIZE))));
 }
 
+void RegTestHost::AppendJSONString(std::string& dest, std::string_view str)
+{
+  dest.push_back('"');
+  for (const char ch : str)
+  {
+    if (ch == '"' || ch == '\\')
+    {
+      dest.push_back('\\');
+      dest.push_back(ch);
+    }
+    else if (static_cast<unsigned char>(ch) < 0x20)
+    {
+      fmt::format_to(std::back_inserter(dest), "\\u{:04x}", static_cast<unsigned>(ch));
+    }
+    else
+    {
+      dest.push_back(ch);
+    }
+  }
+  dest.push_back('"');
+}
+
+void RegTestHost::AppendTimingEventStatistics(std::string& dest)
+{
+  fmt::format_to(std::back_inserter(dest), "  \"timing_events\": {{\n    \"scheduler\": ");
+  AppendJSONString(dest, TimingEvents::GetSchedulerName());
+  dest.append(",\n    \"events\": [");
+
+  bool first = true;
+  for (const TimingEvents::EventStatistics& es : TimingEvents::GetStatistics())
+  {
+    dest.append(first ? "\n      {\"name\": " : ",\n      {\"name\": ");
+    AppendJSONString(dest, es.name);
+    fmt::format_to(std::back_inserter(dest),
+                   ", \"active\": {}, \"invocations\": {}, \"reschedules\": {}, \"sort_steps\": {}, "
+                   "\"callback_time_ms\": {:.3f}}}",
+                   es.active, es.invoke_count, es.reschedule_count, es.sort_steps, es.callback_time_ms);
+    first = false;
+  }
+
+  dest.append("\n    ]\n  }");
+}
+
+void RegTestHost::AppendGPUThreadStatistics(std::string& dest)
+{
+  const GPUThread::FIFOStatistics stats = GPUThread::GetFIFOStatistics();
+  const double average_occupancy =
+    (stats.commands_pushed > 0) ? (static_cast<double>(stats.occupancy_sum) / static_cast<double>(stats.commands_pushed)) :
+                                  0.0;
+  fmt::format_to(std::back_inserter(dest),
+                 "  \"gpu_thread\": {{\n    \"fifo_size\": {},\n    \"commands_pushed\": {},\n"
+                 "    \"bytes_pushed\": {},\n    \"average_occupancy\": {:.1f},\n    \"peak_occupancy\": {},\n"
+                 "    \"wraparounds\": {},\n    \"wakeups\": {},\n    \"gpu_thread_sleeps\": {},\n"
+                 "    \"fifo_full_waits\": {},\n    \"fifo_full_wait_ms\": {:.3f},\n"
+                 "    \"shadow_vram_readbacks\": {},\n    \"shadow_vram_partial_waits\": {},\n"
+                 "    \"occupancy_histogram\": [",
+                 stats.fifo_size, stats.commands_pushed, stats.bytes_pushed, average_occupancy, stats.peak_occupancy,
+                 stats.wraparounds, stats.wakeups, stats.gpu_thread_sleeps, stats.fifo_full_waits,
+                 stats.fifo_full_wait_ms, stats.shadow_vram_readbacks, stats.shadow_vram_partial_waits);
+  for (u32 i = 0; i < GPUThread::FIFOStatistics::NUM_OCCUPANCY_BUCKETS; i++)
+    fmt::format_to(std::back_inserter(dest), "{}{}", (i > 0) ? ", " : "", stats.occupancy_histogram[i]);
+
+  dest.append("],\n    \"syncs\": [");
+  for (u32 i = 0; i < GPUThread::FIFOStatistics::NUM_SYNC_REASONS; i++)
+  {
+    dest.append((i > 0) ? ",\n      {\"reason\": " : "\n      {\"reason\": ");
+    AppendJSONString(dest, GPUThread::GetSyncReasonName(static_cast<GPUThread::SyncReason>(i)));
+    fmt::format_to(std::back_inserter(dest),
+                   ", \"count\": {}, \"stalls\": {}, \"spin_ms\": {:.3f}, \"sleep_ms\": {:.3f}}}",
+                   stats.sync_count[i], stats.sync_stall_count[i], stats.sync_spin_ms[i], stats.sync_sleep_ms[i]);
+  }
+
+  dest.append("\n    ]\n  }");
+}
+
+void RegTestHost::DumpStatistics()
+{
+  if (s_statistics_path.empty())
+    return;
+
+  std::string json;
+  fmt::format_to(std::back_inserter(json), "{{\n  \"frames\": {},\n", s_frames_to_run);
+  AppendTimingEventStatistics(json);
+  json.append(",\n");
+  AppendGPUThreadStatistics(json);
+  json.append("\n}\n");
+
+  Error error;
+  if (!FileSystem::WriteStringToFile(s_statistics_path.c_str(), json, &error))
+  {
+    ERROR_LOG("Failed to write statistics to '{}': {}", s_statistics_path, error.GetDescription());
+    return;
+  }
+
+  INFO_LOG("Wrote statistics to '{}'.", s_statistics_path);
+}
+
 void RegTestHost::InitializeEarlyConsole()
 {
   const bool was_console_enabled = Log::IsConsoleOutputEnabled();
@@ -697,7 +828,12 @@ void RegTestHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "  -version: Displays version information and exits.\n");
   std::fprintf(stderr, "  -dumpdir: Set frame dump base directory (will be dumped to basedir/gametitle).\n");
   std::fprintf(stderr, "  -dumpinterval: Dumps every N frames.\n");
+  std::fprintf(stderr, "  -gpudevice: Creates a GPU device for the software renderer, and dumps the display\n"
+                       "    texture instead of the display processed on the CPU.\n");
   std::fprintf(stderr, "  -frames: Sets the number of frames to execute.\n");
+  std::fprintf(stderr, "  -stats <path>: Writes performance statistics in JSON format to the specified file.\n");
+  std::fprintf(stderr, "  -gpustats <path>: Writes per-frame GPU renderer statistics in CSV format to the specified "
+                       "file.\n");
   std::fprintf(stderr, "  -log <level>: Sets the log level. Defaults to verbose.\n");
   std::fprintf(stderr, "  -console: Enables console logging output.\n");
   std::fprintf(stderr, "  -pgxp: Enables PGXP.\n");
@@ -760,6 +896,11 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
 
         continue;
       }
+      else if (CHECK_ARG("-gpudevice"))
+      {
+        s_base_settings_interface->SetBoolValue("GPU", "HeadlessSoftwareRenderer", false);
+        continue;
+      }
       else if (CHECK_ARG_PARAM("-frames"))
       {
         s_frames_to_run = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
@@ -771,6 +912,30 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
 
         continue;
       }
+      else if (CHECK_ARG_PARAM("-stats"))
+      {
+        s_statistics_path = argv[++i];
+        if (s_statistics_path.empty())
+        {
+          ERROR_LOG("Invalid statistics path specified.");
+          return false;
+        }
+
+        TimingEvents::SetProfilingEnabled(true);
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-gpustats"))
+      {
+        std::string path = argv[++i];
+        if (path.empty())
+        {
+          ERROR_LOG("Invalid GPU statistics path specified.");
+          return false;
+        }
+
+        GPUBackend::SetStatisticsDumpPath(std::move(path));
+        continue;
+      }
       else if (CHECK_ARG_PARAM("-log"))
       {
         std::optional<Log::Level> level = Settings::ParseLogLevelName(argv[++i]);
@@ -95,6 +95,10 @@ std::unique_ptr<CDImage> CDImage::Open(const char* path, bool allow_patches, Err
   {
     image = OpenPBPImage(path, error);
   }
+  else if (StringUtil::EqualNoCase(extension, "zcd"))
+  {
+    image = OpenZCDImage(path, error);
+  }
   else if (StringUtil::EqualNoCase(extension, "m3u"))
   {
     // skip applying patches to the main path, which isn't a real disc
@@ -293,6 +297,39 @@ bool CDImage::ReadRawSector(void* buffer, SubChannelQ* subq)
   return true;
 }
 
+const u8* CDImage::ReadRawSectorPointer(void* buffer, SubChannelQ* subq)
+{
+  if (m_position_in_index == m_current_index->length)
+  {
+    if (!Seek(m_position_on_disc))
+      return nullptr;
+  }
+
+  // Only raw sectors can be returned as-is.
+  const void* ptr = (m_current_index->file_sector_size == RAW_SECTOR_SIZE) ?
+                      GetSectorPointerFromIndex(*m_current_index, m_position_in_index) :
+                      nullptr;
+  if (!ptr)
+    return ReadRawSector(buffer, subq) ? static_cast<const u8*>(buffer) : nullptr;
+
+  if (subq && !ReadSubChannelQ(subq, *m_current_index, m_position_in_index))
+  {
+    ERROR_LOG("Subchannel read of LBA {} failed", m_position_on_disc);
+    Seek(m_position_on_disc);
+    return nullptr;
+  }
+
+  m_position_on_disc++;
+  m_position_in_index++;
+  m_position_in_track++;
+  return static_cast<const u8*>(ptr);
+}
+
+const void* CDImage::GetSectorPointerFromIndex(const Index& index, LBA lba_in_index)
+{
+  return nullptr;
+}
+
 bool CDImage::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   GenerateSubChannelQ(subq, index, lba_in_index);
@@ -304,6 +341,11 @@ bool CDImage::HasSubchannelData() const
   return false;
 }
 
+bool CDImage::IsPatched() const
+{
+  return false;
+}
+
 std::string CDImage::GetMetadata(std::string_view type) const
 {
   std::string result;
@@ -239,6 +239,10 @@ public:
   /// Returns true if the specified filename is a CD-ROM device name.
   static bool IsDeviceName(const char* filename);
 
+  /// Enables memory-mapping of BIN track files on local disks, instead of reading them with stdio. Off by default,
+  /// since a mapped file being truncated or failing to read faults the process rather than failing the read.
+  static void SetMapTrackFiles(bool enabled);
+
   // Opening disc image.
   static std::unique_ptr<CDImage> Open(const char* path, bool allow_patches, Error* error);
   static std::unique_ptr<CDImage> OpenBinImage(const char* path, Error* error);
@@ -246,13 +250,25 @@ public:
   static std::unique_ptr<CDImage> OpenCHDImage(const char* path, Error* error);
   static std::unique_ptr<CDImage> OpenMdsImage(const char* path, Error* error);
   static std::unique_ptr<CDImage> OpenPBPImage(const char* path, Error* error);
+  static std::unique_ptr<CDImage> OpenZCDImage(const char* path, Error* error);
   static std::unique_ptr<CDImage> OpenM3uImage(const char* path, bool apply_patches, Error* error);
   static std::unique_ptr<CDImage> OpenDeviceImage(const char* path, Error* error);
   static std::unique_ptr<CDImage>
   CreateMemoryImage(CDImage* image, ProgressCallback* progress = ProgressCallback::NullProgressCallback);
+  static std::unique_ptr<CDImage>
+  CreateCompressedMemoryImage(CDImage* image, ProgressCallback* progress = ProgressCallback::NullProgressCallback);
+
+  /// Copies the image into named shared memory, keyed by the image contents. Other processes preloading the same image
+  /// map the existing copy instead of reading it again.
+  static std::unique_ptr<CDImage> CreateSharedMemoryImage(CDImage* image, ProgressCallback* progress, Error* error);
   static std::unique_ptr<CDImage> OverlayPPFPatch(const char* path, std::unique_ptr<CDImage> parent_image,
                                                   ProgressCallback* progress = ProgressCallback::NullProgressCallback);
 
+  /// Writes the image to a seekable zstd (ZCD) file. Smaller hunks give faster random access at the cost of size.
+  static bool WriteZCDImage(const char* path, CDImage* image, u32 sectors_per_hunk = 8, int compression_level = 12,
+                            ProgressCallback* progress = ProgressCallback::NullProgressCallback,
+                            Error* error = nullptr);
+
   // Accessors.
   const std::string& GetPath() const { return m_filename; }
   LBA GetPositionOnDisc() const { return m_position_on_disc; }
@@ -293,6 +309,10 @@ public:
   // Read a single raw sector, and subchannel from the current LBA.
   bool ReadRawSector(void* buffer, SubChannelQ* subq);
 
+  // Read a single raw sector, and subchannel from the current LBA. If the image can access the sector without a copy,
+  // a pointer to it is returned directly, otherwise the sector is read into buffer. Returns nullptr on failure.
+  const u8* ReadRawSectorPointer(void* buffer, SubChannelQ* subq);
+
   /// Generates sub-channel Q given the specified position.
   bool GenerateSubChannelQ(SubChannelQ* subq, LBA lba) const;
 
@@ -305,9 +325,15 @@ public:
   // Returns true if the image has replacement subchannel data.
   virtual bool HasSubchannelData() const;
 
+  // Returns true if patches are applied on top of the image file, e.g. PPF.
+  virtual bool IsPatched() const;
+
   // Reads a single sector from an index.
   virtual bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) = 0;
 
+  // Returns a pointer to a single raw sector from an index, if it can be accessed without copying.
+  virtual const void* GetSectorPointerFromIndex(const Index& index, LBA lba_in_index);
+
   // Retrieve image metadata.
   virtual std::string GetMetadata(std::string_view type) const;
 
@@ -5,89 +5,286 @@
 #include "cd_image.h"
 #include "host.h"
 
+#include "common/heap_array.h"
 #include "common/md5_digest.h"
 #include "common/string_util.h"
+#include "common/task_queue.h"
 
 #include "fmt/format.h"
 
+#ifndef XXH_STATIC_LINKING_ONLY
+#define XXH_STATIC_LINKING_ONLY
+#endif
+#include "xxhash.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 namespace CDImageHasher {
 
-static bool ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest, ProgressCallback* progress_callback);
-static bool ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallback* progress_callback);
+namespace {
+
+/// Range of sectors which is fed into a digest.
+struct HashRange
+{
+  u32 stream;
+  u8 track;
+  u8 index;
+  CDImage::LBA start;
+  u32 length;
+};
+
+/// Overlaps reading the image with hashing. Sectors are read on the calling thread into large blocks, which are
+/// handed off to one consumer per digest ("stream"), so separate tracks are hashed concurrently.
+class HashPipeline
+{
+public:
+  static constexpr u32 BLOCK_SECTORS = 64;
+  static constexpr u32 BLOCK_SIZE = BLOCK_SECTORS * CDImage::RAW_SECTOR_SIZE;
+  static constexpr u32 NUM_BLOCKS = 16;
+  static constexpr u32 MAX_THREADS = 4;
+
+  HashPipeline(u32 num_streams);
+  ~HashPipeline();
+
+  bool Run(CDImage* image, const std::vector<HashRange>& ranges, ProgressCallback* progress_callback);
+
+  void GetHash(u32 stream, Hash* out_hash) { m_streams[stream].digest.Final(*out_hash); }
+
+private:
+  struct Block
+  {
+    FixedHeapArray<u8, BLOCK_SIZE, 64> data;
+    u32 size;
+  };
+
+  struct Stream
+  {
+    MD5Digest digest;
+    std::deque<Block*> queue;
+    bool started = false;
+    bool finished = false;
+  };
+
+  Block* GetFreeBlock();
+  void QueueBlock(u32 stream, Block* block);
+  void StartStream(u32 stream);
+  void FinishStream(u32 stream);
+  void ConsumeStream(u32 stream);
+  void Abort();
+
+  std::vector<Stream> m_streams;
+  std::vector<std::unique_ptr<Block>> m_blocks;
+  std::vector<Block*> m_free_blocks;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  TaskQueue m_queue;
+  bool m_aborted = false;
+};
+
+} // namespace
+
+static std::vector<HashRange> GetTrackRanges(CDImage* image, u8 track, u32 stream);
+static bool HashRanges(CDImage* image, const std::vector<HashRange>& ranges, u32 num_streams, Hash* out_hashes,
+                       ProgressCallback* progress_callback);
 
 } // namespace CDImageHasher
 
-bool CDImageHasher::ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest,
-                              ProgressCallback* progress_callback)
+CDImageHasher::HashPipeline::HashPipeline(u32 num_streams) : m_streams(num_streams)
 {
-  const CDImage::LBA index_start = image->GetTrackIndexPosition(track, index);
-  const u32 index_length = image->GetTrackIndexLength(track, index);
-  const u32 update_interval = std::max<u32>(index_length / 100u, 1u);
+  m_blocks.reserve(NUM_BLOCKS);
+  for (u32 i = 0; i < NUM_BLOCKS; i++)
+    m_free_blocks.push_back(m_blocks.emplace_back(std::make_unique<Block>()).get());
 
-  progress_callback->SetStatusText(
-    fmt::format(TRANSLATE_FS("CDImageHasher", "Computing hash for Track {}/Index {}..."), track, index).c_str());
-  progress_callback->SetProgressRange(index_length);
+  // Consumers wait for data from the reader, so there has to be at least one worker thread.
+  const u32 num_threads = std::max(std::min({std::thread::hardware_concurrency(), MAX_THREADS, num_streams}), 1u);
+  m_queue.SetWorkerCount(num_threads);
+}
 
-  if (!image->Seek(index_start))
+CDImageHasher::HashPipeline::~HashPipeline()
+{
+  Abort();
+}
+
+CDImageHasher::HashPipeline::Block* CDImageHasher::HashPipeline::GetFreeBlock()
+{
+  std::unique_lock lock(m_mutex);
+  m_cv.wait(lock, [this]() { return !m_free_blocks.empty(); });
+
+  Block* block = m_free_blocks.back();
+  m_free_blocks.pop_back();
+  return block;
+}
+
+void CDImageHasher::HashPipeline::QueueBlock(u32 stream, Block* block)
+{
+  std::unique_lock lock(m_mutex);
+  m_streams[stream].queue.push_back(block);
+  m_cv.notify_all();
+}
+
+void CDImageHasher::HashPipeline::StartStream(u32 stream)
+{
+  // Tasks are started in stream order, and the reader only moves forward, so the oldest streams always have a
+  // worker. That guarantees blocks are eventually returned, even with fewer threads than streams in flight.
+  if (m_streams[stream].started)
+    return;
+
+  m_streams[stream].started = true;
+  m_queue.SubmitTask([this, stream]() { ConsumeStream(stream); });
+}
+
+void CDImageHasher::HashPipeline::FinishStream(u32 stream)
+{
+  std::unique_lock lock(m_mutex);
+  m_streams[stream].finished = true;
+  m_cv.notify_all();
+}
+
+void CDImageHasher::HashPipeline::ConsumeStream(u32 stream)
+{
+  Stream& st = m_streams[stream];
+  std::unique_lock lock(m_mutex);
+  for (;;)
   {
-    progress_callback->FormatModalError("Failed to seek to sector {} for track {} index {}", index_start, track, index);
-    return false;
+    m_cv.wait(lock, [this, &st]() { return (m_aborted || st.finished || !st.queue.empty()); });
+    if (m_aborted || st.queue.empty())
+      break;
+
+    Block* block = st.queue.front();
+    st.queue.pop_front();
+    lock.unlock();
+
+    st.digest.Update(block->data.data(), block->size);
+
+    lock.lock();
+    m_free_blocks.push_back(block);
+    m_cv.notify_all();
   }
+}
 
-  std::array<u8, CDImage::RAW_SECTOR_SIZE> sector;
-  for (u32 lba = 0; lba < index_length; lba++)
+void CDImageHasher::HashPipeline::Abort()
+{
   {
-    if ((lba % update_interval) == 0)
-      progress_callback->SetProgressValue(lba);
+    std::unique_lock lock(m_mutex);
+    m_aborted = true;
+    m_cv.notify_all();
+  }
 
-    if (progress_callback->IsCancelled())
-      return false;
+  m_queue.WaitForAll();
+}
+
+bool CDImageHasher::HashPipeline::Run(CDImage* image, const std::vector<HashRange>& ranges,
+                                      ProgressCallback* progress_callback)
+{
+  u32 total_sectors = 0;
+  for (const HashRange& range : ranges)
+    total_sectors += range.length;
 
-    if (!image->ReadRawSector(sector.data(), nullptr))
+  const u32 update_interval = std::max<u32>(total_sectors / 100u, 1u);
+  progress_callback->SetProgressRange(total_sectors);
+  progress_callback->SetProgressValue(0);
+
+  u32 sectors_read = 0;
+  for (size_t i = 0; i < ranges.size(); i++)
+  {
+    const HashRange& range = ranges[i];
+    progress_callback->SetStatusText(
+      fmt::format(TRANSLATE_FS("CDImageHasher", "Computing hash for Track {}/Index {}..."), range.track, range.index)
+        .c_str());
+
+    if (!image->Seek(range.start))
     {
-      progress_callback->FormatModalError("Failed to read sector {} from image", image->GetPositionOnDisc());
+      progress_callback->FormatModalError("Failed to seek to sector {} for track {} index {}", range.start,
+                                          range.track, range.index);
+      Abort();
       return false;
     }
 
-    digest->Update(sector);
+    StartStream(range.stream);
+
+    for (u32 lba = 0; lba < range.length;)
+    {
+      if (progress_callback->IsCancelled())
+      {
+        Abort();
+        return false;
+      }
+
+      Block* block = GetFreeBlock();
+      const u32 count = std::min(BLOCK_SECTORS, range.length - lba);
+      for (u32 j = 0; j < count; j++)
+      {
+        u8* dst = &block->data[j * CDImage::RAW_SECTOR_SIZE];
+        const u8* sector_ptr = image->ReadRawSectorPointer(dst, nullptr);
+        if (!sector_ptr)
+        {
+          progress_callback->FormatModalError("Failed to read sector {} from image", image->GetPositionOnDisc());
+          {
+            std::unique_lock lock(m_mutex);
+            m_free_blocks.push_back(block);
+          }
+          Abort();
+          return false;
+        }
+        else if (sector_ptr != dst)
+        {
+          std::memcpy(dst, sector_ptr, CDImage::RAW_SECTOR_SIZE);
+        }
+      }
+
+      block->size = count * CDImage::RAW_SECTOR_SIZE;
+      QueueBlock(range.stream, block);
+
+      if ((sectors_read / update_interval) != ((sectors_read + count) / update_interval))
+        progress_callback->SetProgressValue(sectors_read + count);
+
+      lba += count;
+      sectors_read += count;
+    }
+
+    // streams can span multiple ranges, e.g. pregap and track
+    if ((i + 1) == ranges.size() || ranges[i + 1].stream != range.stream)
+      FinishStream(range.stream);
   }
 
-  progress_callback->SetProgressValue(index_length);
+  m_queue.WaitForAll();
+  progress_callback->SetProgressValue(total_sectors);
   return true;
 }
 
-bool CDImageHasher::ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallback* progress_callback)
+std::vector<CDImageHasher::HashRange> CDImageHasher::GetTrackRanges(CDImage* image, u8 track, u32 stream)
 {
   static constexpr u8 INDICES_TO_READ = 2;
 
-  progress_callback->PushState();
-
-  const bool dataTrack = track == 1;
-  progress_callback->SetProgressRange(dataTrack ? 1 : 2);
-
-  u8 progress = 0;
+  std::vector<HashRange> ranges;
   for (u8 index = 0; index < INDICES_TO_READ; index++)
   {
-    progress_callback->SetProgressValue(progress);
-
     // skip index 0 if data track
-    if (dataTrack && index == 0)
+    if (track == 1 && index == 0)
       continue;
 
-    progress++;
-    progress_callback->PushState();
-    if (!ReadIndex(image, track, index, digest, progress_callback))
-    {
-      progress_callback->PopState();
-      progress_callback->PopState();
-      return false;
-    }
-
-    progress_callback->PopState();
+    ranges.push_back(HashRange{stream, track, index, image->GetTrackIndexPosition(track, index),
+                               image->GetTrackIndexLength(track, index)});
   }
 
-  progress_callback->SetProgressValue(progress);
-  progress_callback->PopState();
+  return ranges;
+}
+
+bool CDImageHasher::HashRanges(CDImage* image, const std::vector<HashRange>& ranges, u32 num_streams,
+                               Hash* out_hashes, ProgressCallback* progress_callback)
+{
+  HashPipeline pipeline(num_streams);
+  if (!pipeline.Run(image, ranges, progress_callback))
+    return false;
+
+  for (u32 i = 0; i < num_streams; i++)
+    pipeline.GetHash(i, &out_hashes[i]);
+
   return true;
 }
 
@@ -113,35 +310,72 @@ std::optional<CDImageHasher::Hash> CDImageHasher::HashFromString(std::string_vie
 bool CDImageHasher::GetImageHash(CDImage* image, Hash* out_hash,
                                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
 {
-  MD5Digest digest;
-
   progress_callback->SetCancellable(true);
-  progress_callback->SetProgressRange(image->GetTrackCount());
-  progress_callback->SetProgressValue(0);
-  progress_callback->PushState();
 
+  // whole image goes into a single digest, so the only parallelism is between reading and hashing
+  std::vector<HashRange> ranges;
   for (u32 i = 1; i <= image->GetTrackCount(); i++)
   {
-    progress_callback->SetProgressValue(i - 1);
-    if (!ReadTrack(image, static_cast<u8>(i), &digest, progress_callback))
-    {
-      progress_callback->PopState();
-      return false;
-    }
+    std::vector<HashRange> track_ranges = GetTrackRanges(image, static_cast<u8>(i), 0);
+    ranges.insert(ranges.end(), track_ranges.begin(), track_ranges.end());
   }
 
-  progress_callback->SetProgressValue(image->GetTrackCount());
-  digest.Final(*out_hash);
-  return true;
+  return HashRanges(image, ranges, 1, out_hash, progress_callback);
 }
 
 bool CDImageHasher::GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
                                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
 {
-  MD5Digest digest;
-  if (!ReadTrack(image, track, &digest, progress_callback))
-    return false;
+  return HashRanges(image, GetTrackRanges(image, track, 0), 1, out_hash, progress_callback);
+}
 
-  digest.Final(*out_hash);
-  return true;
+bool CDImageHasher::GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                                   ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
+{
+  const u32 num_tracks = image->GetTrackCount();
+  std::vector<HashRange> ranges;
+  for (u32 i = 1; i <= num_tracks; i++)
+  {
+    std::vector<HashRange> track_ranges = GetTrackRanges(image, static_cast<u8>(i), i - 1);
+    ranges.insert(ranges.end(), track_ranges.begin(), track_ranges.end());
+  }
+
+  out_hashes->resize(num_tracks);
+  return HashRanges(image, ranges, num_tracks, out_hashes->data(), progress_callback);
+}
+
+std::optional<u64> CDImageHasher::GetImageFingerprint(CDImage* image)
+{
+  static constexpr u32 SAMPLES_PER_TRACK = 16;
+
+  XXH3_state_t state;
+  XXH3_64bits_reset(&state);
+
+  const u32 lba_count = image->GetLBACount();
+  XXH3_64bits_update(&state, &lba_count, sizeof(lba_count));
+
+  std::array<u8, CDImage::RAW_SECTOR_SIZE> sector;
+  for (const CDImage::Track& track : image->GetTracks())
+  {
+    const u32 toc[4] = {track.track_number, track.start_lba, track.length, static_cast<u32>(track.mode)};
+    XXH3_64bits_update(&state, toc, sizeof(toc));
+
+    // first and last sectors, and evenly spaced in between
+    const u32 num_samples = std::min(SAMPLES_PER_TRACK, track.length);
+    for (u32 i = 0; i < num_samples; i++)
+    {
+      const u32 offset =
+        (num_samples > 1) ? static_cast<u32>(static_cast<u64>(track.length - 1) * i / (num_samples - 1)) : 0;
+      if (!image->Seek(track.start_lba + offset))
+        return std::nullopt;
+
+      const u8* sector_ptr = image->ReadRawSectorPointer(sector.data(), nullptr);
+      if (!sector_ptr)
+        return std::nullopt;
+
+      XXH3_64bits_update(&state, sector_ptr, CDImage::RAW_SECTOR_SIZE);
+    }
+  }
+
+  return XXH3_64bits_digest(&state);
 }
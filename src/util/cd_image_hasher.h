@@ -7,6 +7,7 @@
 #include <array>
 #include <optional>
 #include <string>
+#include <vector>
 
 class CDImage;
 
@@ -21,4 +22,12 @@ bool GetImageHash(CDImage* image, Hash* out_hash,
 bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
                   ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
 
-} // namespace CDImageHasher
\ No newline at end of file
+/// Hashes all tracks in the image. The image is read on the calling thread, while tracks are hashed concurrently.
+bool GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                    ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
+
+/// Returns a quick fingerprint of the image from the TOC and a small sample of sectors from each track.
+/// Not a substitute for the track hashes, but good enough to tell if cached hashes still belong to the image.
+std::optional<u64> GetImageFingerprint(CDImage* image);
+
+} // namespace CDImageHasher
@@ -29,6 +29,7 @@ public:
 
   bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
   bool HasSubchannelData() const override;
+  bool IsPatched() const override;
 
   bool HasSubImages() const override;
   u32 GetSubImageCount() const override;
@@ -38,6 +39,7 @@ public:
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  const void* GetSectorPointerFromIndex(const Index& index, LBA lba_in_index) override;
 
 private:
   struct Entry
@@ -120,6 +122,11 @@ bool CDImageM3u::HasSubchannelData() const
   return m_current_image->HasSubchannelData();
 }
 
+bool CDImageM3u::IsPatched() const
+{
+  return m_current_image->IsPatched();
+}
+
 bool CDImageM3u::HasSubImages() const
 {
   return true;
@@ -177,6 +184,11 @@ bool CDImageM3u::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   return m_current_image->ReadSectorFromIndex(buffer, index, lba_in_index);
 }
 
+const void* CDImageM3u::GetSectorPointerFromIndex(const Index& index, LBA lba_in_index)
+{
+  return m_current_image->GetSectorPointerFromIndex(index, lba_in_index);
+}
+
 bool CDImageM3u::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   return m_current_image->ReadSubChannelQ(subq, index, lba_in_index);
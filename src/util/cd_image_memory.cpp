@@ -2,14 +2,32 @@
 // SPDX-License-Identifier: CC-BY-NC-ND-4.0
 
 #include "cd_image.h"
+#include "cd_image_hasher.h"
+#include "cd_sector_ecc.h"
 
+#include "common/align.h"
 #include "common/assert.h"
+#include "common/error.h"
 #include "common/file_system.h"
+#include "common/heap_array.h"
 #include "common/log.h"
+#include "common/lru_cache.h"
+#include "common/memmap.h"
 #include "common/path.h"
+#include "common/timer.h"
+
+#include "fmt/format.h"
+
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash.h"
+
+#include <zstd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <thread>
+#include <vector>
 
 LOG_CHANNEL(CDImage);
 
@@ -22,15 +40,88 @@ public:
   ~CDImageMemory() override;
 
   bool CopyImage(CDImage* image, ProgressCallback* progress);
+  bool CopyImageShared(CDImage* image, ProgressCallback* progress, Error* error);
 
   bool IsPrecached() const override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  const void* GetSectorPointerFromIndex(const Index& index, LBA lba_in_index) override;
 
 private:
+  enum class SharedState : u32
+  {
+    Copying,
+    Ready,
+    Failed,
+  };
+
+  /// Lives in the first page of the shared mapping, zero-filled by the OS on creation.
+  struct SharedHeader
+  {
+    std::atomic<SharedState> state;
+    std::atomic<u32> sectors_copied;
+    u32 num_sectors;
+    u64 key;
+  };
+  static_assert(std::atomic<u32>::is_always_lock_free, "Atomics must be lock-free to be shared between processes");
+
+  // Header gets its own mapping, so the sectors can be read-only. Windows needs views to be 64KB aligned.
+  static constexpr size_t SHARED_HEADER_SIZE = 64 * 1024;
+  static constexpr double SHARED_COPY_TIMEOUT = 10.0;
+
+  static u32 CountSectors(CDImage* image);
+  static std::optional<u64> GetSharedKey(CDImage* image, u32 num_sectors);
+
+  bool ReadSectors(CDImage* image, u8* dst, ProgressCallback* progress, std::atomic<u32>* sectors_copied);
+  bool WaitForSharedCopy(ProgressCallback* progress, Error* error);
+  void CopyLayout(CDImage* image);
+  void ReleaseSharedMemory();
+
   u8* m_memory = nullptr;
   u32 m_memory_sectors = 0;
+
+  // Only set when the sectors are in memory shared with other processes.
+  SharedHeader* m_shared_header = nullptr;
+  void* m_shared_handle = nullptr;
+  std::string m_shared_name;
+  size_t m_shared_data_size = 0;
+};
+
+/// Stores sectors in independently-compressed groups, with a small cache of decompressed groups.
+/// EDC/ECC is dropped from data sectors where it can be regenerated exactly, and rebuilt on decompression.
+class CDImageCompressedMemory : public CDImage
+{
+public:
+  static constexpr u32 SECTORS_PER_GROUP = 16;
+  static constexpr u32 GROUP_SIZE = SECTORS_PER_GROUP * RAW_SECTOR_SIZE;
+  static constexpr u32 CACHED_GROUPS = 8;
+  static constexpr int COMPRESSION_LEVEL = 1;
+  static_assert(SECTORS_PER_GROUP <= 16, "Regenerated sector mask is 16 bits");
+
+  CDImageCompressedMemory();
+  ~CDImageCompressedMemory() override;
+
+  bool CopyImage(CDImage* image, ProgressCallback* progress);
+
+  bool IsPrecached() const override;
+
+protected:
+  bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+
+private:
+  using GroupBuffer = DynamicHeapArray<u8>;
+
+  static void EncodeGroup(u8* dst, const u8* src, u32 num_sectors, LBA start_lba, bool is_data);
+  static void DecodeGroup(u8* dst, const u8* src, u32 num_sectors, LBA start_lba, bool is_data);
+
+  const u8* GetGroup(const Index& index, u32 group_in_index);
+
+  std::vector<GroupBuffer> m_groups;
+  std::vector<u16> m_group_regenerated_sectors;
+  LRUCache<u32, GroupBuffer> m_group_cache{CACHED_GROUPS};
+  GroupBuffer m_transform_buffer;
+  ZSTD_DCtx* m_dctx = nullptr;
 };
 
 } // namespace
@@ -39,43 +130,32 @@ CDImageMemory::CDImageMemory() = default;
 
 CDImageMemory::~CDImageMemory()
 {
-  if (m_memory)
+  if (m_shared_header)
+    ReleaseSharedMemory();
+  else if (m_memory)
     std::free(m_memory);
 }
 
-bool CDImageMemory::CopyImage(CDImage* image, ProgressCallback* progress)
+u32 CDImageMemory::CountSectors(CDImage* image)
 {
   // figure out the total number of sectors (not including blank pregaps)
-  m_memory_sectors = 0;
+  u32 num_sectors = 0;
   for (u32 i = 0; i < image->GetIndexCount(); i++)
   {
     const Index& index = image->GetIndex(i);
     if (index.file_sector_size > 0)
-      m_memory_sectors += image->GetIndex(i).length;
+      num_sectors += index.length;
   }
 
-  if ((static_cast<u64>(RAW_SECTOR_SIZE) * static_cast<u64>(m_memory_sectors)) >=
-      static_cast<u64>(std::numeric_limits<size_t>::max()))
-  {
-    progress->ModalError("Insufficient address space");
-    return false;
-  }
-
-  progress->FormatStatusText("Allocating memory for {} sectors...", m_memory_sectors);
-
-  m_memory =
-    static_cast<u8*>(std::malloc(static_cast<size_t>(RAW_SECTOR_SIZE) * static_cast<size_t>(m_memory_sectors)));
-  if (!m_memory)
-  {
-    progress->FormatModalError("Failed to allocate memory for {} sectors", m_memory_sectors);
-    return false;
-  }
+  return num_sectors;
+}
 
-  progress->SetStatusText("Preloading CD image to RAM...");
+bool CDImageMemory::ReadSectors(CDImage* image, u8* dst, ProgressCallback* progress, std::atomic<u32>* sectors_copied)
+{
   progress->SetProgressRange(m_memory_sectors);
   progress->SetProgressValue(0);
 
-  u8* memory_ptr = m_memory;
+  u8* memory_ptr = dst;
   u32 sectors_read = 0;
   for (u32 i = 0; i < image->GetIndexCount(); i++)
   {
@@ -94,9 +174,18 @@ bool CDImageMemory::CopyImage(CDImage* image, ProgressCallback* progress)
       progress->SetProgressValue(sectors_read);
       memory_ptr += RAW_SECTOR_SIZE;
       sectors_read++;
+
+      // lets other processes know we're still alive
+      if (sectors_copied)
+        sectors_copied->store(sectors_read, std::memory_order_relaxed);
     }
   }
 
+  return true;
+}
+
+void CDImageMemory::CopyLayout(CDImage* image)
+{
   for (u32 i = 1; i <= image->GetTrackCount(); i++)
     m_tracks.push_back(image->GetTrack(i));
 
@@ -116,10 +205,216 @@ bool CDImageMemory::CopyImage(CDImage* image, ProgressCallback* progress)
   Assert(current_offset == m_memory_sectors);
   m_filename = image->GetPath();
   m_lba_count = image->GetLBACount();
+}
+
+bool CDImageMemory::CopyImage(CDImage* image, ProgressCallback* progress)
+{
+  m_memory_sectors = CountSectors(image);
+  if ((static_cast<u64>(RAW_SECTOR_SIZE) * static_cast<u64>(m_memory_sectors)) >=
+      static_cast<u64>(std::numeric_limits<size_t>::max()))
+  {
+    progress->ModalError("Insufficient address space");
+    return false;
+  }
+
+  progress->FormatStatusText("Allocating memory for {} sectors...", m_memory_sectors);
+
+  m_memory =
+    static_cast<u8*>(std::malloc(static_cast<size_t>(RAW_SECTOR_SIZE) * static_cast<size_t>(m_memory_sectors)));
+  if (!m_memory)
+  {
+    progress->FormatModalError("Failed to allocate memory for {} sectors", m_memory_sectors);
+    return false;
+  }
 
+  progress->SetStatusText("Preloading CD image to RAM...");
+  if (!ReadSectors(image, m_memory, progress, nullptr))
+    return false;
+
+  CopyLayout(image);
   return Seek(1, Position{0, 0, 0});
 }
 
+std::optional<u64> CDImageMemory::GetSharedKey(CDImage* image, u32 num_sectors)
+{
+  // The fingerprint only samples the image, so include the file size and modification time as well. Otherwise a
+  // rewritten image which happens to match the samples could pick up stale sectors from another process. The path is
+  // the cue/m3u for multi-file images, so the size of the track files is included too.
+  const std::optional<u64> fingerprint = CDImageHasher::GetImageFingerprint(image);
+  const s64 size_on_disk = image->GetSizeOnDisk();
+  FILESYSTEM_STAT_DATA sd;
+  if (!fingerprint.has_value() || size_on_disk < 0 || !FileSystem::StatFile(image->GetPath().c_str(), &sd))
+    return std::nullopt;
+
+  XXH3_state_t state;
+  XXH3_64bits_reset(&state);
+  XXH3_64bits_update(&state, &fingerprint.value(), sizeof(u64));
+  XXH3_64bits_update(&state, &sd.Size, sizeof(sd.Size));
+  XXH3_64bits_update(&state, &sd.ModificationTime, sizeof(sd.ModificationTime));
+  XXH3_64bits_update(&state, &size_on_disk, sizeof(size_on_disk));
+  XXH3_64bits_update(&state, &num_sectors, sizeof(num_sectors));
+  return XXH3_64bits_digest(&state);
+}
+
+bool CDImageMemory::CopyImageShared(CDImage* image, ProgressCallback* progress, Error* error)
+{
+  // Patches are applied on top of the file the key is derived from, so patched and unpatched copies would collide.
+  if (image->IsPatched())
+  {
+    Error::SetStringView(error, "Patched images are not shared.");
+    return false;
+  }
+
+  // Only the sectors are shared, replacement subchannel Q (e.g. LibCrypt) would be lost.
+  if (image->HasSubchannelData())
+  {
+    Error::SetStringView(error, "Images with subchannel data are not shared.");
+    return false;
+  }
+
+  m_memory_sectors = CountSectors(image);
+  const std::optional<u64> key = GetSharedKey(image, m_memory_sectors);
+  if (!key.has_value())
+  {
+    Error::SetStringView(error, "Failed to compute key for shared image.");
+    return false;
+  }
+
+  const u64 data_size = Common::AlignUp(static_cast<u64>(RAW_SECTOR_SIZE) * static_cast<u64>(m_memory_sectors),
+                                        static_cast<u64>(MemMap::GetRuntimePageSize()));
+  if ((data_size + SHARED_HEADER_SIZE) >= static_cast<u64>(std::numeric_limits<size_t>::max()))
+  {
+    Error::SetStringView(error, "Insufficient address space");
+    return false;
+  }
+
+  m_shared_name = MemMap::GetSharedFileMappingName(fmt::format("duckstation_disc_{:016x}", key.value()).c_str());
+  m_shared_data_size = static_cast<size_t>(data_size);
+
+  bool created;
+  m_shared_handle =
+    MemMap::OpenSharedMemory(m_shared_name.c_str(), SHARED_HEADER_SIZE + m_shared_data_size, &created, error);
+  if (!m_shared_handle)
+    return false;
+
+  m_shared_header = static_cast<SharedHeader*>(
+    MemMap::MapSharedMemory(m_shared_handle, 0, nullptr, SHARED_HEADER_SIZE, PageProtect::ReadWrite));
+  if (!m_shared_header)
+  {
+    Error::SetStringView(error, "Failed to map shared image header.");
+    MemMap::CloseSharedMemory(m_shared_handle, m_shared_name.c_str());
+    m_shared_handle = nullptr;
+    return false;
+  }
+
+  m_memory = static_cast<u8*>(MemMap::MapSharedMemory(m_shared_handle, SHARED_HEADER_SIZE, nullptr, m_shared_data_size,
+                                                      created ? PageProtect::ReadWrite : PageProtect::ReadOnly));
+  if (!m_memory)
+  {
+    Error::SetStringView(error, "Failed to map shared image sectors.");
+    if (created)
+      m_shared_header->state.store(SharedState::Failed, std::memory_order_release);
+    ReleaseSharedMemory();
+    return false;
+  }
+
+  if (created)
+  {
+    INFO_LOG("Creating shared image '{}' for {} sectors", m_shared_name, m_memory_sectors);
+    m_shared_header->num_sectors = m_memory_sectors;
+    m_shared_header->key = key.value();
+
+    progress->SetStatusText("Preloading CD image to shared RAM...");
+    if (!ReadSectors(image, m_memory, progress, &m_shared_header->sectors_copied))
+    {
+      Error::SetStringView(error, "Failed to read image.");
+      m_shared_header->state.store(SharedState::Failed, std::memory_order_release);
+      ReleaseSharedMemory();
+      return false;
+    }
+
+    MemMap::MemProtect(m_memory, m_shared_data_size, PageProtect::ReadOnly);
+    m_shared_header->state.store(SharedState::Ready, std::memory_order_release);
+  }
+  else
+  {
+    INFO_LOG("Using shared image '{}' from another process", m_shared_name);
+    if (!WaitForSharedCopy(progress, error))
+    {
+      ReleaseSharedMemory();
+      return false;
+    }
+  }
+
+  CopyLayout(image);
+  return Seek(1, Position{0, 0, 0});
+}
+
+bool CDImageMemory::WaitForSharedCopy(ProgressCallback* progress, Error* error)
+{
+  progress->SetStatusText("Waiting for another process to preload CD image...");
+  progress->SetProgressRange(m_memory_sectors);
+
+  // If the other process dies while copying, the state will never change. So give up if it stops making progress.
+  Timer::Value last_progress_time = Timer::GetCurrentValue();
+  u32 last_sectors_copied = 0;
+  for (;;)
+  {
+    const SharedState state = m_shared_header->state.load(std::memory_order_acquire);
+    if (state == SharedState::Ready)
+      break;
+
+    if (state == SharedState::Failed)
+    {
+      Error::SetStringView(error, "Other process failed to preload image.");
+      return false;
+    }
+
+    const u32 sectors_copied = m_shared_header->sectors_copied.load(std::memory_order_relaxed);
+    const Timer::Value current_time = Timer::GetCurrentValue();
+    if (sectors_copied != last_sectors_copied)
+    {
+      last_sectors_copied = sectors_copied;
+      last_progress_time = current_time;
+      progress->SetProgressValue(sectors_copied);
+    }
+    else if (Timer::ConvertValueToSeconds(current_time - last_progress_time) >= SHARED_COPY_TIMEOUT)
+    {
+      // Fail anyone else waiting on the abandoned copy, the last one out removes it.
+      Error::SetStringView(error, "Timed out waiting for other process to preload image.");
+      SharedState expected = SharedState::Copying;
+      m_shared_header->state.compare_exchange_strong(expected, SharedState::Failed, std::memory_order_acq_rel);
+      return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  if (m_shared_header->num_sectors != m_memory_sectors)
+  {
+    Error::SetStringFmt(error, "Shared image has {} sectors, expected {}.", m_shared_header->num_sectors,
+                        m_memory_sectors);
+    return false;
+  }
+
+  return true;
+}
+
+void CDImageMemory::ReleaseSharedMemory()
+{
+  if (m_memory)
+  {
+    MemMap::UnmapSharedMemory(m_memory, m_shared_data_size);
+    m_memory = nullptr;
+  }
+
+  // Last one out removes the name, so the next process starts fresh. Existing mappings are unaffected.
+  MemMap::UnmapSharedMemory(m_shared_header, SHARED_HEADER_SIZE);
+  m_shared_header = nullptr;
+  MemMap::CloseSharedMemory(m_shared_handle, m_shared_name.c_str());
+  m_shared_handle = nullptr;
+}
+
 bool CDImageMemory::IsPrecached() const
 {
   return true;
@@ -138,6 +433,253 @@ bool CDImageMemory::ReadSectorFromIndex(void* buffer, const Index& index, LBA lb
   return true;
 }
 
+const void* CDImageMemory::GetSectorPointerFromIndex(const Index& index, LBA lba_in_index)
+{
+  DebugAssert(index.file_index == 0);
+
+  const u64 sector_number = index.file_offset + lba_in_index;
+  if (sector_number >= m_memory_sectors)
+    return nullptr;
+
+  return &m_memory[static_cast<size_t>(sector_number) * static_cast<size_t>(RAW_SECTOR_SIZE)];
+}
+
+CDImageCompressedMemory::CDImageCompressedMemory() = default;
+
+CDImageCompressedMemory::~CDImageCompressedMemory()
+{
+  if (m_dctx)
+    ZSTD_freeDCtx(m_dctx);
+}
+
+// Sync and header are the only predictable parts of a data sector. XORing them with the expected values turns them
+// into zeros, and moving all the headers in a group to the front keeps them from breaking up matches in the data.
+static constexpr std::array<u8, CDImage::SECTOR_SYNC_SIZE> s_sector_sync = {
+  {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00}};
+static constexpr u32 SECTOR_PREFIX_SIZE = CDImage::SECTOR_SYNC_SIZE + 4;
+
+void CDImageCompressedMemory::EncodeGroup(u8* dst, const u8* src, u32 num_sectors, LBA start_lba, bool is_data)
+{
+  u8* dst_prefix = dst;
+  u8* dst_payload = dst + num_sectors * SECTOR_PREFIX_SIZE;
+  for (u32 i = 0; i < num_sectors; i++)
+  {
+    std::memcpy(dst_prefix, src, SECTOR_PREFIX_SIZE);
+    if (is_data)
+    {
+      const auto [mm, ss, ff] = Position::FromLBA(start_lba + i).ToBCD();
+      for (u32 j = 0; j < SECTOR_SYNC_SIZE; j++)
+        dst_prefix[j] ^= s_sector_sync[j];
+      dst_prefix[12] ^= mm;
+      dst_prefix[13] ^= ss;
+      dst_prefix[14] ^= ff;
+    }
+
+    std::memcpy(dst_payload, src + SECTOR_PREFIX_SIZE, RAW_SECTOR_SIZE - SECTOR_PREFIX_SIZE);
+    src += RAW_SECTOR_SIZE;
+    dst_prefix += SECTOR_PREFIX_SIZE;
+    dst_payload += RAW_SECTOR_SIZE - SECTOR_PREFIX_SIZE;
+  }
+}
+
+void CDImageCompressedMemory::DecodeGroup(u8* dst, const u8* src, u32 num_sectors, LBA start_lba, bool is_data)
+{
+  const u8* src_prefix = src;
+  const u8* src_payload = src + num_sectors * SECTOR_PREFIX_SIZE;
+  for (u32 i = 0; i < num_sectors; i++)
+  {
+    std::memcpy(dst, src_prefix, SECTOR_PREFIX_SIZE);
+    if (is_data)
+    {
+      const auto [mm, ss, ff] = Position::FromLBA(start_lba + i).ToBCD();
+      for (u32 j = 0; j < SECTOR_SYNC_SIZE; j++)
+        dst[j] ^= s_sector_sync[j];
+      dst[12] ^= mm;
+      dst[13] ^= ss;
+      dst[14] ^= ff;
+    }
+
+    std::memcpy(dst + SECTOR_PREFIX_SIZE, src_payload, RAW_SECTOR_SIZE - SECTOR_PREFIX_SIZE);
+    dst += RAW_SECTOR_SIZE;
+    src_prefix += SECTOR_PREFIX_SIZE;
+    src_payload += RAW_SECTOR_SIZE - SECTOR_PREFIX_SIZE;
+  }
+}
+
+bool CDImageCompressedMemory::CopyImage(CDImage* image, ProgressCallback* progress)
+{
+  u32 total_sectors = 0;
+  for (u32 i = 0; i < image->GetIndexCount(); i++)
+  {
+    const Index& index = image->GetIndex(i);
+    if (index.file_sector_size > 0)
+      total_sectors += index.length;
+  }
+
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  m_dctx = ZSTD_createDCtx();
+  if (!cctx || !m_dctx)
+  {
+    if (cctx)
+      ZSTD_freeCCtx(cctx);
+    progress->ModalError("Failed to create zstd context");
+    return false;
+  }
+
+  progress->SetStatusText("Preloading CD image to RAM (compressed)...");
+  progress->SetProgressRange(total_sectors);
+  progress->SetProgressValue(0);
+
+  GroupBuffer raw_buffer(GROUP_SIZE);
+  GroupBuffer compress_buffer(ZSTD_compressBound(GROUP_SIZE));
+  m_transform_buffer.resize(GROUP_SIZE);
+
+  u64 compressed_bytes = 0;
+  u32 sectors_read = 0;
+  u32 sectors_regenerated = 0;
+  for (u32 i = 0; i < image->GetIndexCount(); i++)
+  {
+    Index new_index = image->GetIndex(i);
+    if (new_index.file_sector_size == 0)
+    {
+      m_indices.push_back(new_index);
+      continue;
+    }
+
+    // groups never cross index boundaries, so the first group number can be stored as the file index
+    new_index.file_index = static_cast<u32>(m_groups.size());
+    new_index.file_offset = 0;
+
+    const bool is_data = (new_index.mode != TrackMode::Audio);
+    for (u32 lba = 0; lba < new_index.length; lba += SECTORS_PER_GROUP)
+    {
+      const u32 num_sectors = std::min(SECTORS_PER_GROUP, new_index.length - lba);
+      for (u32 j = 0; j < num_sectors; j++)
+      {
+        if (!image->ReadSectorFromIndex(&raw_buffer[j * RAW_SECTOR_SIZE], image->GetIndex(i), lba + j))
+        {
+          ERROR_LOG("Failed to read LBA {} in index {}", lba + j, i);
+          ZSTD_freeCCtx(cctx);
+          return false;
+        }
+      }
+
+      // no point storing what we can compute
+      u16 regenerated_mask = 0;
+      if (is_data)
+      {
+        for (u32 j = 0; j < num_sectors; j++)
+        {
+          u8* sector = &raw_buffer[j * RAW_SECTOR_SIZE];
+          const CDSectorECC::SectorType type = CDSectorECC::GetRegenerableType(sector);
+          if (type == CDSectorECC::SectorType::Unknown)
+            continue;
+
+          CDSectorECC::ClearRegenerableBytes(sector, type);
+          regenerated_mask |= static_cast<u16>(1u << j);
+          sectors_regenerated++;
+        }
+      }
+
+      EncodeGroup(m_transform_buffer.data(), raw_buffer.data(), num_sectors, new_index.start_lba_on_disc + lba,
+                  is_data);
+
+      const size_t result = ZSTD_compressCCtx(cctx, compress_buffer.data(), compress_buffer.size(),
+                                              m_transform_buffer.data(), num_sectors * RAW_SECTOR_SIZE,
+                                              COMPRESSION_LEVEL);
+      if (ZSTD_isError(result)) [[unlikely]]
+      {
+        progress->FormatModalError("ZSTD_compressCCtx() failed: {}", ZSTD_getErrorName(result));
+        ZSTD_freeCCtx(cctx);
+        return false;
+      }
+
+      GroupBuffer& group = m_groups.emplace_back(result);
+      std::memcpy(group.data(), compress_buffer.data(), result);
+      m_group_regenerated_sectors.push_back(regenerated_mask);
+      compressed_bytes += result;
+
+      sectors_read += num_sectors;
+      progress->SetProgressValue(sectors_read);
+    }
+
+    m_indices.push_back(new_index);
+  }
+
+  ZSTD_freeCCtx(cctx);
+
+  for (u32 i = 1; i <= image->GetTrackCount(); i++)
+    m_tracks.push_back(image->GetTrack(i));
+
+  m_filename = image->GetPath();
+  m_lba_count = image->GetLBACount();
+
+  const u64 uncompressed_bytes = static_cast<u64>(total_sectors) * RAW_SECTOR_SIZE;
+  INFO_LOG("Compressed {} sectors in {} groups, {:.2f} MB to {:.2f} MB ({:.1f}%)", total_sectors, m_groups.size(),
+           static_cast<double>(uncompressed_bytes) / 1048576.0, static_cast<double>(compressed_bytes) / 1048576.0,
+           (uncompressed_bytes > 0) ?
+             (static_cast<double>(compressed_bytes) * 100.0 / static_cast<double>(uncompressed_bytes)) :
+             0.0);
+  INFO_LOG("{} of {} sectors stored without EDC/ECC", sectors_regenerated, total_sectors);
+
+  return Seek(1, Position{0, 0, 0});
+}
+
+bool CDImageCompressedMemory::IsPrecached() const
+{
+  return true;
+}
+
+const u8* CDImageCompressedMemory::GetGroup(const Index& index, u32 group_in_index)
+{
+  const u32 group_number = index.file_index + group_in_index;
+  if (const GroupBuffer* cached = m_group_cache.Lookup(group_number))
+    return cached->data();
+
+  if (group_number >= m_groups.size()) [[unlikely]]
+    return nullptr;
+
+  const u32 first_lba = group_in_index * SECTORS_PER_GROUP;
+  const u32 num_sectors = std::min(SECTORS_PER_GROUP, index.length - first_lba);
+  const GroupBuffer& compressed = m_groups[group_number];
+  const size_t result = ZSTD_decompressDCtx(m_dctx, m_transform_buffer.data(), m_transform_buffer.size(),
+                                            compressed.data(), compressed.size());
+  if (ZSTD_isError(result) || result != (num_sectors * RAW_SECTOR_SIZE)) [[unlikely]]
+  {
+    ERROR_LOG("Failed to decompress group {}: {}", group_number,
+              ZSTD_isError(result) ? ZSTD_getErrorName(result) : "size mismatch");
+    return nullptr;
+  }
+
+  GroupBuffer decoded(num_sectors * RAW_SECTOR_SIZE);
+  DecodeGroup(decoded.data(), m_transform_buffer.data(), num_sectors, index.start_lba_on_disc + first_lba,
+              (index.mode != TrackMode::Audio));
+
+  const u16 regenerated_mask = m_group_regenerated_sectors[group_number];
+  for (u32 i = 0; i < num_sectors; i++)
+  {
+    if (regenerated_mask & (1u << i))
+    {
+      u8* sector = &decoded[i * RAW_SECTOR_SIZE];
+      CDSectorECC::Regenerate(sector, CDSectorECC::GetSectorType(sector));
+    }
+  }
+  return m_group_cache.Insert(group_number, std::move(decoded))->data();
+}
+
+bool CDImageCompressedMemory::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
+{
+  if (lba_in_index >= index.length) [[unlikely]]
+    return false;
+
+  const u8* group = GetGroup(index, lba_in_index / SECTORS_PER_GROUP);
+  if (!group) [[unlikely]]
+    return false;
+
+  std::memcpy(buffer, group + (lba_in_index % SECTORS_PER_GROUP) * RAW_SECTOR_SIZE, RAW_SECTOR_SIZE);
+  return true;
+}
+
 std::unique_ptr<CDImage>
 CDImage::CreateMemoryImage(CDImage* image, ProgressCallback* progress /* = ProgressCallback::NullProgressCallback */)
 {
@@ -147,3 +689,22 @@ CDImage::CreateMemoryImage(CDImage* image, ProgressCallback* progress /* = Progr
 
   return memory_image;
 }
+
+std::unique_ptr<CDImage> CDImage::CreateSharedMemoryImage(CDImage* image, ProgressCallback* progress, Error* error)
+{
+  std::unique_ptr<CDImageMemory> memory_image = std::make_unique<CDImageMemory>();
+  if (!memory_image->CopyImageShared(image, progress, error))
+    return {};
+
+  return memory_image;
+}
+
+std::unique_ptr<CDImage> CDImage::CreateCompressedMemoryImage(
+  CDImage* image, ProgressCallback* progress /* = ProgressCallback::NullProgressCallback */)
+{
+  std::unique_ptr<CDImageCompressedMemory> memory_image = std::make_unique<CDImageCompressedMemory>();
+  if (!memory_image->CopyImage(image, progress))
+    return {};
+
+  return memory_image;
+}
@@ -9,14 +9,18 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/task_queue.h"
 
 #include "fmt/format.h"
 #include "zlib.h"
 
 #include <array>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <variant>
 #include <vector>
@@ -146,12 +150,35 @@ protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
 
 private:
+  // Games often alternate between nearby files, so keep a few blocks around instead of inflating them again.
+  static constexpr u32 NUM_CACHED_BLOCKS = 16;
+  static constexpr u32 PREFETCH_BLOCKS = 3;
+  static constexpr u32 MAX_PENDING_BLOCKS = 6;
+  static constexpr u32 NUM_INFLATE_THREADS = 2;
+  static constexpr u32 INVALID_BLOCK = static_cast<u32>(-1);
+
   struct BlockInfo
   {
     u32 offset; // Absolute offset from start of file
     u16 size;
   };
 
+  enum class BlockState : u8
+  {
+    Empty,
+    Pending,
+    Ready,
+  };
+
+  struct CachedBlock
+  {
+    u32 block;
+    BlockState state;
+    u64 last_used;
+    std::vector<u8> compressed;
+    std::array<u8, DECOMPRESSED_BLOCK_SIZE> data;
+  };
+
 #if defined(_DEBUG) || defined(_DEVEL)
   static void PrintPBPHeaderInfo(const PBPHeader& pbp_header);
   static void PrintSFOHeaderInfo(const SFOHeader& sfo_header);
@@ -167,7 +194,14 @@ private:
   bool IsValidEboot(Error* error);
 
   bool InitDecompressionStream();
-  bool DecompressBlock(const BlockInfo& block_info);
+  bool ReadBlock(const BlockInfo& block_info, CachedBlock* cb, bool* needs_inflate);
+  static bool InflateBlock(z_stream* stream, CachedBlock* cb);
+
+  const u8* GetBlock(u32 block);
+  CachedBlock* LookupCachedBlock(u32 block);
+  CachedBlock* AllocateCachedBlock(u32 block);
+  void PrefetchBlocks(u32 block);
+  void ClearBlockCache();
 
   bool OpenDisc(u32 index, Error* error);
 
@@ -189,20 +223,30 @@ private:
 
   std::array<TOCEntry, TOC_NUM_ENTRIES> m_toc;
 
-  u32 m_current_block = static_cast<u32>(-1);
-  std::array<u8, DECOMPRESSED_BLOCK_SIZE> m_decompressed_block;
-  std::vector<u8> m_compressed_block;
+  z_stream m_inflate_stream = {};
+  bool m_inflate_stream_initialized = false;
+
+  std::unique_ptr<std::array<CachedBlock, NUM_CACHED_BLOCKS>> m_block_cache;
+  u64 m_block_access_counter = 0;
+  u32 m_pending_blocks = 0;
+  std::mutex m_block_cache_mutex;
+  std::condition_variable m_block_ready_cv;
 
-  z_stream m_inflate_stream;
+  // must be destroyed before the cache
+  TaskQueue m_inflate_queue;
+  bool m_inflate_threads_started = false;
 };
 } // namespace
 
 CDImagePBP::~CDImagePBP()
 {
+  m_inflate_queue.WaitForAll();
+
   if (m_file)
     std::fclose(m_file);
 
-  inflateEnd(&m_inflate_stream);
+  if (m_inflate_stream_initialized)
+    inflateEnd(&m_inflate_stream);
 }
 
 bool CDImagePBP::LoadPBPHeader(Error* error)
@@ -500,11 +544,9 @@ bool CDImagePBP::OpenDisc(u32 index, Error* error)
     return false;
   }
 
-  m_current_block = static_cast<u32>(-1);
+  ClearBlockCache();
   m_blockinfo_table.fill({});
   m_toc.fill({});
-  m_decompressed_block.fill(0x00);
-  m_compressed_block.clear();
 
   // Go to ISO header
   const u32 iso_header_start = m_disc_offsets[index];
@@ -743,6 +785,9 @@ const std::string* CDImagePBP::LookupStringSFOTableEntry(const char* key, const
 
 bool CDImagePBP::InitDecompressionStream()
 {
+  if (m_inflate_stream_initialized)
+    return true;
+
   m_inflate_stream = {};
   m_inflate_stream.next_in = Z_NULL;
   m_inflate_stream.avail_in = 0;
@@ -751,35 +796,38 @@ bool CDImagePBP::InitDecompressionStream()
   m_inflate_stream.opaque = Z_NULL;
 
   int ret = inflateInit2(&m_inflate_stream, -MAX_WBITS);
-  return ret == Z_OK;
+  m_inflate_stream_initialized = (ret == Z_OK);
+  return m_inflate_stream_initialized;
 }
 
-bool CDImagePBP::DecompressBlock(const BlockInfo& block_info)
+bool CDImagePBP::ReadBlock(const BlockInfo& block_info, CachedBlock* cb, bool* needs_inflate)
 {
   if (FileSystem::FSeek64(m_file, block_info.offset, SEEK_SET) != 0)
     return false;
 
   // Compression level 0 has compressed size == decompressed size.
-  if (block_info.size == m_decompressed_block.size())
+  if (block_info.size == cb->data.size())
   {
-    return (std::fread(m_decompressed_block.data(), sizeof(u8), m_decompressed_block.size(), m_file) ==
-            m_decompressed_block.size());
+    *needs_inflate = false;
+    return (std::fread(cb->data.data(), sizeof(u8), cb->data.size(), m_file) == cb->data.size());
   }
 
-  m_compressed_block.resize(block_info.size);
-
-  if (std::fread(m_compressed_block.data(), sizeof(u8), m_compressed_block.size(), m_file) != m_compressed_block.size())
-    return false;
+  *needs_inflate = true;
+  cb->compressed.resize(block_info.size);
+  return (std::fread(cb->compressed.data(), sizeof(u8), cb->compressed.size(), m_file) == cb->compressed.size());
+}
 
-  m_inflate_stream.next_in = m_compressed_block.data();
-  m_inflate_stream.avail_in = static_cast<uInt>(m_compressed_block.size());
-  m_inflate_stream.next_out = m_decompressed_block.data();
-  m_inflate_stream.avail_out = static_cast<uInt>(m_decompressed_block.size());
+bool CDImagePBP::InflateBlock(z_stream* stream, CachedBlock* cb)
+{
+  stream->next_in = cb->compressed.data();
+  stream->avail_in = static_cast<uInt>(cb->compressed.size());
+  stream->next_out = cb->data.data();
+  stream->avail_out = static_cast<uInt>(cb->data.size());
 
-  if (inflateReset(&m_inflate_stream) != Z_OK)
+  if (inflateReset(stream) != Z_OK)
     return false;
 
-  int err = inflate(&m_inflate_stream, Z_FINISH);
+  int err = inflate(stream, Z_FINISH);
   if (err != Z_STREAM_END) [[unlikely]]
   {
     ERROR_LOG("Inflate error {}", err);
@@ -789,6 +837,177 @@ bool CDImagePBP::DecompressBlock(const BlockInfo& block_info)
   return true;
 }
 
+CDImagePBP::CachedBlock* CDImagePBP::LookupCachedBlock(u32 block)
+{
+  for (CachedBlock& cb : *m_block_cache)
+  {
+    if (cb.block == block)
+      return &cb;
+  }
+
+  return nullptr;
+}
+
+CDImagePBP::CachedBlock* CDImagePBP::AllocateCachedBlock(u32 block)
+{
+  // evict the least recently used block which isn't being inflated
+  CachedBlock* lru = nullptr;
+  for (CachedBlock& cb : *m_block_cache)
+  {
+    if (cb.state == BlockState::Pending)
+      continue;
+    if (cb.state == BlockState::Empty)
+    {
+      lru = &cb;
+      break;
+    }
+    if (!lru || cb.last_used < lru->last_used)
+      lru = &cb;
+  }
+
+  DebugAssert(lru);
+  lru->block = block;
+  lru->state = BlockState::Pending;
+  lru->last_used = ++m_block_access_counter;
+  return lru;
+}
+
+void CDImagePBP::ClearBlockCache()
+{
+  m_inflate_queue.WaitForAll();
+
+  if (!m_block_cache)
+    m_block_cache = std::make_unique<std::array<CachedBlock, NUM_CACHED_BLOCKS>>();
+
+  for (CachedBlock& cb : *m_block_cache)
+  {
+    cb.block = INVALID_BLOCK;
+    cb.state = BlockState::Empty;
+    cb.last_used = 0;
+    cb.compressed = {};
+  }
+
+  m_block_access_counter = 0;
+  m_pending_blocks = 0;
+}
+
+void CDImagePBP::PrefetchBlocks(u32 block)
+{
+  // The lock is only held to look up and claim cache entries. Pending entries are never evicted, and the file is only
+  // accessed from the reading thread, so the reads themselves don't need it.
+  for (u32 next_block = block + 1; next_block <= (block + PREFETCH_BLOCKS) && next_block < BLOCK_TABLE_NUM_ENTRIES;
+       next_block++)
+  {
+    const BlockInfo& bi = m_blockinfo_table[next_block];
+    if (bi.size == 0)
+      break;
+
+    CachedBlock* cb;
+    {
+      std::unique_lock lock(m_block_cache_mutex);
+      if (m_pending_blocks >= MAX_PENDING_BLOCKS)
+        break;
+      if (LookupCachedBlock(next_block))
+        continue;
+
+      cb = AllocateCachedBlock(next_block);
+    }
+
+    bool needs_inflate;
+    const bool read_result = ReadBlock(bi, cb, &needs_inflate);
+    if (!read_result || !needs_inflate)
+    {
+      std::unique_lock lock(m_block_cache_mutex);
+      if (!read_result) [[unlikely]]
+      {
+        cb->block = INVALID_BLOCK;
+        cb->state = BlockState::Empty;
+        break;
+      }
+
+      cb->state = BlockState::Ready;
+      continue;
+    }
+
+    if (!m_inflate_threads_started)
+    {
+      m_inflate_queue.SetWorkerCount(NUM_INFLATE_THREADS);
+      m_inflate_threads_started = true;
+    }
+
+    {
+      std::unique_lock lock(m_block_cache_mutex);
+      m_pending_blocks++;
+    }
+
+    m_inflate_queue.SubmitTask([this, cb]() {
+      z_stream stream = {};
+      const bool result = (inflateInit2(&stream, -MAX_WBITS) == Z_OK && InflateBlock(&stream, cb));
+      inflateEnd(&stream);
+
+      std::unique_lock lock(m_block_cache_mutex);
+      if (!result) [[unlikely]]
+      {
+        ERROR_LOG("Failed to inflate prefetched block {}", cb->block);
+        cb->block = INVALID_BLOCK;
+      }
+
+      cb->state = result ? BlockState::Ready : BlockState::Empty;
+      m_pending_blocks--;
+      m_block_ready_cv.notify_all();
+    });
+  }
+}
+
+const u8* CDImagePBP::GetBlock(u32 block)
+{
+  CachedBlock* cb;
+  bool needs_read = false;
+  {
+    std::unique_lock lock(m_block_cache_mutex);
+
+    cb = LookupCachedBlock(block);
+    if (cb && cb->state == BlockState::Pending)
+    {
+      // being inflated on a worker, wait for it rather than doing it twice
+      m_block_ready_cv.wait(lock, [cb]() { return cb->state != BlockState::Pending; });
+      if (cb->block != block) [[unlikely]]
+        cb = nullptr;
+    }
+
+    if (cb)
+    {
+      cb->last_used = ++m_block_access_counter;
+    }
+    else
+    {
+      cb = AllocateCachedBlock(block);
+      needs_read = true;
+    }
+  }
+
+  if (needs_read)
+  {
+    // The entry is pending, so nothing else touches it while it's read and inflated outside the lock.
+    bool needs_inflate;
+    const bool result = (ReadBlock(m_blockinfo_table[block], cb, &needs_inflate) &&
+                         (!needs_inflate || InflateBlock(&m_inflate_stream, cb)));
+
+    std::unique_lock lock(m_block_cache_mutex);
+    if (!result) [[unlikely]]
+    {
+      cb->block = INVALID_BLOCK;
+      cb->state = BlockState::Empty;
+      return nullptr;
+    }
+
+    cb->state = BlockState::Ready;
+  }
+
+  PrefetchBlocks(block);
+  return cb->data.data();
+}
+
 bool CDImagePBP::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
 {
   const u32 offset_in_file = static_cast<u32>(index.file_offset) + (lba_in_index * index.file_sector_size);
@@ -803,13 +1022,15 @@ bool CDImagePBP::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
     return false;
   }
 
-  if (m_current_block != requested_block && !DecompressBlock(bi)) [[unlikely]]
+  const u8* block_data = GetBlock(requested_block);
+  if (!block_data) [[unlikely]]
   {
     ERROR_LOG("Failed to decompress block {}", requested_block);
     return false;
   }
 
-  std::memcpy(buffer, &m_decompressed_block[offset_in_block], RAW_SECTOR_SIZE);
+  // pointer stays valid, blocks are only evicted from this thread
+  std::memcpy(buffer, &block_data[offset_in_block], RAW_SECTOR_SIZE);
   return true;
 }
 
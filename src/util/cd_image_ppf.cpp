@@ -33,6 +33,7 @@ public:
 
   bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
   bool HasSubchannelData() const override;
+  bool IsPatched() const override;
   s64 GetSizeOnDisk() const override;
 
   std::string GetMetadata(std::string_view type) const override;
@@ -420,6 +421,11 @@ bool CDImagePPF::HasSubchannelData() const
   return m_parent_image->HasSubchannelData();
 }
 
+bool CDImagePPF::IsPatched() const
+{
+  return true;
+}
+
 std::string CDImagePPF::GetMetadata(std::string_view type) const
 {
   return m_parent_image->GetMetadata(type);
@@ -0,0 +1,753 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "cd_image.h"
+#include "cd_sector_ecc.h"
+
+#include "common/assert.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/heap_array.h"
+#include "common/log.h"
+#include "common/lru_cache.h"
+#include "common/path.h"
+#include "common/scoped_guard.h"
+#include "common/task_queue.h"
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+LOG_CHANNEL(CDImage);
+
+// ZCD is a seekable zstd container for CD images. Sectors are grouped into small hunks which are compressed
+// independently, optionally with a shared dictionary trained on the disc itself, so random access only ever needs to
+// decompress a few KB. Hunks never cross index boundaries, and data sectors whose EDC/ECC can be regenerated exactly
+// are stored with those bytes zeroed.
+//
+// Layout: header, dictionary, hunk data, hunk table, tracks, indices. The header is written last.
+
+namespace {
+
+static constexpr u32 ZCD_MAGIC = 0x1A44435A; // ZCD\x1A
+static constexpr u32 ZCD_VERSION = 1;
+static constexpr u32 ZCD_FLAG_SUBCHANNEL_Q = (1u << 0);
+static constexpr u32 ZCD_MAX_SECTORS_PER_HUNK = 32;
+static constexpr u32 ZCD_MAX_TRACKS = 99;
+static constexpr u32 ZCD_MAX_INDICES = 1024;
+static constexpr u32 ZCD_MAX_DICTIONARY_SIZE = 1024 * 1024;
+
+static constexpr u8 ZCD_INDEX_FLAG_PREGAP = (1u << 0);
+static constexpr u8 ZCD_INDEX_FLAG_HAS_DATA = (1u << 1);
+
+#pragma pack(push, 1)
+struct ZCDHeader
+{
+  u32 magic;
+  u32 version;
+  u32 flags;
+  u32 sectors_per_hunk;
+  u32 lba_count;
+  u32 num_tracks;
+  u32 num_indices;
+  u32 num_hunks;
+  u64 dictionary_offset;
+  u32 dictionary_size;
+  u64 hunk_table_offset;
+  u64 toc_offset;
+};
+static_assert(sizeof(ZCDHeader) == 60);
+
+struct ZCDHunk
+{
+  u64 offset;
+  u32 compressed_size; // equal to the decompressed size when stored uncompressed
+  u32 regenerated_sectors;
+};
+static_assert(sizeof(ZCDHunk) == 16);
+
+struct ZCDTrack
+{
+  u32 track_number;
+  u32 start_lba;
+  u32 first_index;
+  u32 length;
+  u8 mode;
+  u8 submode;
+  u8 control;
+  u8 pad;
+};
+static_assert(sizeof(ZCDTrack) == 20);
+
+struct ZCDIndex
+{
+  u32 first_hunk;
+  u32 start_lba_on_disc;
+  u32 track_number;
+  u32 index_number;
+  u32 start_lba_in_track;
+  u32 length;
+  u8 mode;
+  u8 submode;
+  u8 control;
+  u8 flags;
+};
+static_assert(sizeof(ZCDIndex) == 28);
+#pragma pack(pop)
+
+class CDImageZCD : public CDImage
+{
+public:
+  static constexpr u32 CACHED_HUNKS = 4;
+
+  CDImageZCD();
+  ~CDImageZCD() override;
+
+  bool Open(const char* filename, Error* error);
+
+  bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
+  bool HasSubchannelData() const override;
+  s64 GetSizeOnDisk() const override;
+
+protected:
+  bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+
+private:
+  using HunkBuffer = DynamicHeapArray<u8>;
+
+  const u8* GetHunk(const Index& index, u32 hunk_in_index);
+
+  ALWAYS_INLINE u32 GetHunkSectorCount(const Index& index, u32 hunk_in_index) const
+  {
+    return std::min(m_sectors_per_hunk, index.length - hunk_in_index * m_sectors_per_hunk);
+  }
+  ALWAYS_INLINE u32 GetHunkSize(u32 num_sectors) const
+  {
+    return num_sectors * (RAW_SECTOR_SIZE + (m_has_subchannel_q ? SUBCHANNEL_BYTES_PER_FRAME : 0));
+  }
+
+  FileSystem::ManagedCFilePtr m_fp;
+  s64 m_file_size = 0;
+  u32 m_sectors_per_hunk = 0;
+  bool m_has_subchannel_q = false;
+
+  std::vector<ZCDHunk> m_hunks;
+  HunkBuffer m_compressed_buffer;
+  LRUCache<u32, HunkBuffer> m_hunk_cache{CACHED_HUNKS};
+  ZSTD_DCtx* m_dctx = nullptr;
+  ZSTD_DDict* m_ddict = nullptr;
+};
+
+} // namespace
+
+CDImageZCD::CDImageZCD() = default;
+
+CDImageZCD::~CDImageZCD()
+{
+  if (m_ddict)
+    ZSTD_freeDDict(m_ddict);
+  if (m_dctx)
+    ZSTD_freeDCtx(m_dctx);
+}
+
+bool CDImageZCD::Open(const char* filename, Error* error)
+{
+  m_fp = FileSystem::OpenManagedSharedCFile(filename, "rb", FileSystem::FileShareMode::DenyWrite, error);
+  if (!m_fp)
+  {
+    Error::AddPrefixFmt(error, "Failed to open '{}': ", Path::GetFileName(filename));
+    return false;
+  }
+
+  m_file_size = FileSystem::FSize64(m_fp.get(), error);
+  if (m_file_size < 0)
+    return false;
+
+  ZCDHeader header;
+  if (std::fread(&header, sizeof(header), 1, m_fp.get()) != 1 || header.magic != ZCD_MAGIC)
+  {
+    Error::SetStringView(error, "Invalid ZCD header.");
+    return false;
+  }
+
+  if (header.version != ZCD_VERSION)
+  {
+    Error::SetStringFmt(error, "Unsupported ZCD version {}.", header.version);
+    return false;
+  }
+
+  // offsets come from the file, so compare against the space left rather than adding them up and overflowing
+  const u64 file_size = static_cast<u64>(m_file_size);
+  const auto in_file = [file_size](u64 offset, u64 size) {
+    return (offset <= file_size && size <= (file_size - offset));
+  };
+  if (header.sectors_per_hunk == 0 || header.sectors_per_hunk > ZCD_MAX_SECTORS_PER_HUNK || header.num_tracks == 0 ||
+      header.num_tracks > ZCD_MAX_TRACKS || header.num_indices == 0 || header.num_indices > ZCD_MAX_INDICES ||
+      header.dictionary_size > ZCD_MAX_DICTIONARY_SIZE || !in_file(header.dictionary_offset, header.dictionary_size) ||
+      !in_file(header.hunk_table_offset, static_cast<u64>(header.num_hunks) * sizeof(ZCDHunk)) ||
+      !in_file(header.toc_offset, static_cast<u64>(header.num_tracks) * sizeof(ZCDTrack) +
+                                    static_cast<u64>(header.num_indices) * sizeof(ZCDIndex)))
+  {
+    Error::SetStringView(error, "Corrupted ZCD header.");
+    return false;
+  }
+
+  m_sectors_per_hunk = header.sectors_per_hunk;
+  m_has_subchannel_q = ((header.flags & ZCD_FLAG_SUBCHANNEL_Q) != 0);
+
+  m_dctx = ZSTD_createDCtx();
+  if (!m_dctx)
+  {
+    Error::SetStringView(error, "Failed to create zstd context.");
+    return false;
+  }
+
+  if (header.dictionary_size > 0)
+  {
+    HunkBuffer dictionary(header.dictionary_size);
+    if (FileSystem::FSeek64(m_fp.get(), static_cast<s64>(header.dictionary_offset), SEEK_SET) != 0 ||
+        std::fread(dictionary.data(), dictionary.size(), 1, m_fp.get()) != 1)
+    {
+      Error::SetStringView(error, "Failed to read compression dictionary.");
+      return false;
+    }
+
+    m_ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    if (!m_ddict)
+    {
+      Error::SetStringView(error, "Failed to load compression dictionary.");
+      return false;
+    }
+  }
+
+  m_hunks.resize(header.num_hunks);
+  if (FileSystem::FSeek64(m_fp.get(), static_cast<s64>(header.hunk_table_offset), SEEK_SET) != 0 ||
+      (header.num_hunks > 0 &&
+       std::fread(m_hunks.data(), sizeof(ZCDHunk), m_hunks.size(), m_fp.get()) != m_hunks.size()))
+  {
+    Error::SetStringView(error, "Failed to read hunk table.");
+    return false;
+  }
+
+  u32 max_compressed_size = 0;
+  for (const ZCDHunk& hunk : m_hunks)
+  {
+    if (!in_file(hunk.offset, hunk.compressed_size))
+    {
+      Error::SetStringView(error, "Corrupted hunk table.");
+      return false;
+    }
+
+    max_compressed_size = std::max(max_compressed_size, hunk.compressed_size);
+  }
+  m_compressed_buffer.resize(max_compressed_size);
+
+  std::vector<ZCDTrack> tracks(header.num_tracks);
+  std::vector<ZCDIndex> indices(header.num_indices);
+  if (FileSystem::FSeek64(m_fp.get(), static_cast<s64>(header.toc_offset), SEEK_SET) != 0 ||
+      std::fread(tracks.data(), sizeof(ZCDTrack), tracks.size(), m_fp.get()) != tracks.size() ||
+      std::fread(indices.data(), sizeof(ZCDIndex), indices.size(), m_fp.get()) != indices.size())
+  {
+    Error::SetStringView(error, "Failed to read table of contents.");
+    return false;
+  }
+
+  for (const ZCDTrack& track : tracks)
+  {
+    if (track.mode > static_cast<u8>(TrackMode::Mode2Raw) || track.submode > static_cast<u8>(SubchannelMode::Raw) ||
+        track.first_index >= header.num_indices)
+    {
+      Error::SetStringFmt(error, "Corrupted track {}.", track.track_number);
+      return false;
+    }
+
+    m_tracks.push_back(Track{track.track_number, track.start_lba, track.first_index, track.length,
+                             static_cast<TrackMode>(track.mode), static_cast<SubchannelMode>(track.submode),
+                             SubChannelQ::Control(track.control)});
+  }
+
+  for (const ZCDIndex& zindex : indices)
+  {
+    // indices are read with the subchannel mode of their track
+    const auto track = std::find_if(tracks.begin(), tracks.end(), [&zindex](const ZCDTrack& t) {
+      return (t.track_number == zindex.track_number);
+    });
+    if (track == tracks.end() || zindex.submode != track->submode)
+    {
+      Error::SetStringFmt(error, "Corrupted index {} of track {}.", zindex.index_number, zindex.track_number);
+      return false;
+    }
+
+    Index index = {};
+    index.start_lba_on_disc = zindex.start_lba_on_disc;
+    index.track_number = zindex.track_number;
+    index.index_number = zindex.index_number;
+    index.start_lba_in_track = zindex.start_lba_in_track;
+    index.length = zindex.length;
+    index.mode = static_cast<TrackMode>(zindex.mode);
+    index.submode = static_cast<SubchannelMode>(zindex.submode);
+    index.control.bits = zindex.control;
+    index.is_pregap = ((zindex.flags & ZCD_INDEX_FLAG_PREGAP) != 0);
+
+    if (zindex.flags & ZCD_INDEX_FLAG_HAS_DATA)
+    {
+      // first hunk is stored in the file index, since hunks never cross index boundaries
+      const u32 num_hunks = (zindex.length + (m_sectors_per_hunk - 1)) / m_sectors_per_hunk;
+      if (zindex.mode > static_cast<u8>(TrackMode::Mode2Raw) || zindex.first_hunk > header.num_hunks ||
+          num_hunks > (header.num_hunks - zindex.first_hunk))
+      {
+        Error::SetStringFmt(error, "Corrupted index {} of track {}.", zindex.index_number, zindex.track_number);
+        return false;
+      }
+
+      index.file_index = zindex.first_hunk;
+      index.file_offset = 0;
+      index.file_sector_size = RAW_SECTOR_SIZE;
+    }
+
+    m_indices.push_back(index);
+  }
+
+  m_filename = filename;
+  m_lba_count = header.lba_count;
+  AddLeadOutIndex();
+
+  DEV_LOG("ZCD '{}': {} hunks of {} sectors, {} byte dictionary{}", Path::GetFileName(filename), header.num_hunks,
+          m_sectors_per_hunk, header.dictionary_size, m_has_subchannel_q ? ", subchannel Q" : "");
+
+  return Seek(1, Position{0, 0, 0});
+}
+
+const u8* CDImageZCD::GetHunk(const Index& index, u32 hunk_in_index)
+{
+  const u32 hunk_number = index.file_index + hunk_in_index;
+  if (const HunkBuffer* cached = m_hunk_cache.Lookup(hunk_number))
+    return cached->data();
+
+  const ZCDHunk& hunk = m_hunks[hunk_number];
+  const u32 num_sectors = GetHunkSectorCount(index, hunk_in_index);
+  const u32 hunk_size = GetHunkSize(num_sectors);
+  HunkBuffer decoded(hunk_size);
+
+  const bool stored = (hunk.compressed_size == hunk_size);
+  u8* const read_ptr = stored ? decoded.data() : m_compressed_buffer.data();
+  if (FileSystem::FSeek64(m_fp.get(), static_cast<s64>(hunk.offset), SEEK_SET) != 0 ||
+      std::fread(read_ptr, hunk.compressed_size, 1, m_fp.get()) != 1) [[unlikely]]
+  {
+    ERROR_LOG("Failed to read hunk {}: errno {}", hunk_number, errno);
+    return nullptr;
+  }
+
+  if (!stored)
+  {
+    const size_t result =
+      m_ddict ? ZSTD_decompress_usingDDict(m_dctx, decoded.data(), decoded.size(), m_compressed_buffer.data(),
+                                           hunk.compressed_size, m_ddict) :
+                ZSTD_decompressDCtx(m_dctx, decoded.data(), decoded.size(), m_compressed_buffer.data(),
+                                    hunk.compressed_size);
+    if (ZSTD_isError(result) || result != hunk_size) [[unlikely]]
+    {
+      ERROR_LOG("Failed to decompress hunk {}: {}", hunk_number,
+                ZSTD_isError(result) ? ZSTD_getErrorName(result) : "size mismatch");
+      return nullptr;
+    }
+  }
+
+  for (u32 i = 0; i < num_sectors; i++)
+  {
+    if (hunk.regenerated_sectors & (1u << i))
+    {
+      u8* sector = &decoded[i * RAW_SECTOR_SIZE];
+      CDSectorECC::Regenerate(sector, CDSectorECC::GetSectorType(sector));
+    }
+  }
+
+  return m_hunk_cache.Insert(hunk_number, std::move(decoded))->data();
+}
+
+bool CDImageZCD::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
+{
+  if (lba_in_index >= index.length) [[unlikely]]
+    return false;
+
+  const u32 hunk_in_index = lba_in_index / m_sectors_per_hunk;
+  const u8* hunk = GetHunk(index, hunk_in_index);
+  if (!hunk) [[unlikely]]
+    return false;
+
+  std::memcpy(buffer, &hunk[(lba_in_index % m_sectors_per_hunk) * RAW_SECTOR_SIZE], RAW_SECTOR_SIZE);
+  return true;
+}
+
+bool CDImageZCD::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
+{
+  if (!m_has_subchannel_q || index.file_sector_size == 0 || lba_in_index >= index.length)
+    return CDImage::ReadSubChannelQ(subq, index, lba_in_index);
+
+  const u32 hunk_in_index = lba_in_index / m_sectors_per_hunk;
+  const u8* hunk = GetHunk(index, hunk_in_index);
+  if (!hunk) [[unlikely]]
+    return false;
+
+  // Q is stored after all the sectors in the hunk
+  const u32 num_sectors = GetHunkSectorCount(index, hunk_in_index);
+  std::memcpy(subq->data.data(),
+              &hunk[num_sectors * RAW_SECTOR_SIZE + (lba_in_index % m_sectors_per_hunk) * SUBCHANNEL_BYTES_PER_FRAME],
+              SUBCHANNEL_BYTES_PER_FRAME);
+  return true;
+}
+
+bool CDImageZCD::HasSubchannelData() const
+{
+  return m_has_subchannel_q;
+}
+
+s64 CDImageZCD::GetSizeOnDisk() const
+{
+  return m_file_size;
+}
+
+std::unique_ptr<CDImage> CDImage::OpenZCDImage(const char* path, Error* error)
+{
+  std::unique_ptr<CDImageZCD> image = std::make_unique<CDImageZCD>();
+  if (!image->Open(path, error))
+    return {};
+
+  return image;
+}
+
+namespace {
+
+/// Hunks read from the source image waiting to be compressed.
+struct ZCDPendingHunk
+{
+  const CDImage::Index* index;
+  u32 lba_in_index;
+  u32 num_sectors;
+  u32 regenerated_sectors;
+  u32 size;
+  size_t compressed_size;
+  DynamicHeapArray<u8> data;
+  DynamicHeapArray<u8> compressed;
+};
+
+} // namespace
+
+static bool ReadZCDHunk(CDImage* image, ZCDPendingHunk* hunk, bool store_subchannel_q, Error* error)
+{
+  const CDImage::Index& index = *hunk->index;
+  const bool is_data = (index.mode != CDImage::TrackMode::Audio);
+  u8* sector = hunk->data.data();
+  u8* subq_ptr = sector + hunk->num_sectors * CDImage::RAW_SECTOR_SIZE;
+
+  hunk->regenerated_sectors = 0;
+  for (u32 i = 0; i < hunk->num_sectors; i++, sector += CDImage::RAW_SECTOR_SIZE)
+  {
+    const CDImage::LBA lba = hunk->lba_in_index + i;
+    if (!image->ReadSectorFromIndex(sector, index, lba))
+    {
+      Error::SetStringFmt(error, "Failed to read sector {} of track {}.", index.start_lba_in_track + lba,
+                          index.track_number);
+      return false;
+    }
+
+    if (store_subchannel_q)
+    {
+      CDImage::SubChannelQ subq;
+      if (!image->ReadSubChannelQ(&subq, index, lba))
+      {
+        Error::SetStringFmt(error, "Failed to read subchannel Q of sector {} of track {}.",
+                            index.start_lba_in_track + lba, index.track_number);
+        return false;
+      }
+
+      std::memcpy(subq_ptr, subq.data.data(), CDImage::SUBCHANNEL_BYTES_PER_FRAME);
+      subq_ptr += CDImage::SUBCHANNEL_BYTES_PER_FRAME;
+    }
+
+    // no point storing what we can compute
+    const CDSectorECC::SectorType type =
+      is_data ? CDSectorECC::GetRegenerableType(sector) : CDSectorECC::SectorType::Unknown;
+    if (type != CDSectorECC::SectorType::Unknown)
+    {
+      CDSectorECC::ClearRegenerableBytes(sector, type);
+      hunk->regenerated_sectors |= (1u << i);
+    }
+  }
+
+  return true;
+}
+
+bool CDImage::WriteZCDImage(const char* path, CDImage* image, u32 sectors_per_hunk, int compression_level,
+                            ProgressCallback* progress, Error* error)
+{
+  static constexpr u32 HUNKS_PER_BATCH = 256;
+  static constexpr u32 MAX_COMPRESS_THREADS = 8;
+  static constexpr u32 DICTIONARY_SIZE = 64 * 1024;
+  static constexpr u32 MAX_DICTIONARY_SAMPLES = 1024;
+  static constexpr u32 MIN_DICTIONARY_SAMPLES = 16;
+
+  if (sectors_per_hunk == 0 || sectors_per_hunk > ZCD_MAX_SECTORS_PER_HUNK)
+  {
+    Error::SetStringFmt(error, "Invalid hunk size of {} sectors.", sectors_per_hunk);
+    return false;
+  }
+
+  const bool store_subchannel_q = image->HasSubchannelData();
+  const u32 hunk_stride = CDImage::RAW_SECTOR_SIZE + (store_subchannel_q ? SUBCHANNEL_BYTES_PER_FRAME : 0);
+  const u32 max_hunk_size = sectors_per_hunk * hunk_stride;
+
+  // lead-out is synthesized on load
+  std::vector<ZCDIndex> indices;
+  std::vector<ZCDPendingHunk> hunks;
+  for (const Index& index : image->GetIndices())
+  {
+    if (index.track_number == LEAD_OUT_TRACK_NUMBER)
+      continue;
+
+    const bool has_data = (index.file_sector_size > 0);
+    indices.push_back(ZCDIndex{has_data ? static_cast<u32>(hunks.size()) : 0, index.start_lba_on_disc,
+                               index.track_number, index.index_number, index.start_lba_in_track, index.length,
+                               static_cast<u8>(index.mode), static_cast<u8>(index.submode), index.control.bits,
+                               static_cast<u8>((index.is_pregap ? ZCD_INDEX_FLAG_PREGAP : 0) |
+                                               (has_data ? ZCD_INDEX_FLAG_HAS_DATA : 0))});
+    if (!has_data)
+      continue;
+
+    for (u32 lba = 0; lba < index.length; lba += sectors_per_hunk)
+    {
+      const u32 num_sectors = std::min(sectors_per_hunk, index.length - lba);
+      hunks.push_back(ZCDPendingHunk{&index, lba, num_sectors, 0, num_sectors * hunk_stride, 0, {}, {}});
+    }
+  }
+
+  std::vector<ZCDTrack> tracks;
+  for (const Track& track : image->GetTracks())
+  {
+    tracks.push_back(ZCDTrack{track.track_number, track.start_lba, track.first_index, track.length,
+                              static_cast<u8>(track.mode), static_cast<u8>(track.submode), track.control.bits, 0});
+  }
+
+  if (tracks.empty() || tracks.size() > ZCD_MAX_TRACKS || indices.size() > ZCD_MAX_INDICES)
+  {
+    Error::SetStringFmt(error, "Unsupported number of tracks ({}) or indices ({}).", tracks.size(), indices.size());
+    return false;
+  }
+
+  // Train a dictionary on hunks sampled evenly across the disc. Each hunk on its own is too small for zstd to build
+  // up a useful history, so this is where most of the gain over plain per-hunk compression comes from.
+  DynamicHeapArray<u8> dictionary;
+  const u32 num_samples = std::min(static_cast<u32>(hunks.size()), MAX_DICTIONARY_SAMPLES);
+  if (num_samples >= MIN_DICTIONARY_SAMPLES)
+  {
+    progress->SetStatusText("Training compression dictionary...");
+    progress->SetProgressRange(num_samples);
+    progress->SetProgressValue(0);
+
+    DynamicHeapArray<u8> samples(static_cast<size_t>(num_samples) * max_hunk_size);
+    std::vector<size_t> sample_sizes;
+    sample_sizes.reserve(num_samples);
+
+    size_t samples_size = 0;
+    for (u32 i = 0; i < num_samples; i++)
+    {
+      ZCDPendingHunk sample = hunks[static_cast<size_t>(i) * hunks.size() / num_samples];
+      sample.data.resize(sample.size);
+      if (!ReadZCDHunk(image, &sample, store_subchannel_q, error))
+        return false;
+
+      std::memcpy(&samples[samples_size], sample.data.data(), sample.size);
+      samples_size += sample.size;
+      sample_sizes.push_back(sample.size);
+      progress->SetProgressValue(i + 1);
+    }
+
+    dictionary.resize(DICTIONARY_SIZE);
+    const size_t result = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(),
+                                                sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+    if (ZDICT_isError(result))
+    {
+      WARNING_LOG("Dictionary training failed, compressing without: {}", ZDICT_getErrorName(result));
+      dictionary.deallocate();
+    }
+    else
+    {
+      dictionary.resize(result);
+    }
+  }
+
+  FileSystem::AtomicRenamedFile fp = FileSystem::CreateAtomicRenamedFile(path, error);
+  if (!fp)
+    return false;
+
+  const auto write_data = [&fp, error](const void* data, size_t size) {
+    if (size > 0 && std::fwrite(data, size, 1, fp.get()) != 1) [[unlikely]]
+    {
+      Error::SetErrno(error, "fwrite() failed: ", errno);
+      return false;
+    }
+
+    return true;
+  };
+
+  ZCDHeader header = {};
+  header.magic = ZCD_MAGIC;
+  header.version = ZCD_VERSION;
+  header.flags = store_subchannel_q ? ZCD_FLAG_SUBCHANNEL_Q : 0;
+  header.sectors_per_hunk = sectors_per_hunk;
+  header.lba_count = image->GetLBACount();
+  header.num_tracks = static_cast<u32>(tracks.size());
+  header.num_indices = static_cast<u32>(indices.size());
+  header.num_hunks = static_cast<u32>(hunks.size());
+  header.dictionary_offset = sizeof(header);
+  header.dictionary_size = static_cast<u32>(dictionary.size());
+  if (!write_data(&header, sizeof(header)) || !write_data(dictionary.data(), dictionary.size()))
+    return false;
+
+  const u32 num_threads = std::max(std::min(std::thread::hardware_concurrency(), MAX_COMPRESS_THREADS), 1u);
+  std::vector<ZSTD_CCtx*> cctxs;
+  ZSTD_CDict* cdict = nullptr;
+  const ScopedGuard zstd_guard([&cctxs, &cdict]() {
+    for (ZSTD_CCtx* cctx : cctxs)
+      ZSTD_freeCCtx(cctx);
+    if (cdict)
+      ZSTD_freeCDict(cdict);
+  });
+
+  for (u32 i = 0; i < num_threads; i++)
+  {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    if (!cctx)
+    {
+      Error::SetStringView(error, "Failed to create zstd context.");
+      return false;
+    }
+    cctxs.push_back(cctx);
+  }
+
+  if (!dictionary.empty())
+  {
+    cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), compression_level);
+    if (!cdict)
+    {
+      Error::SetStringView(error, "Failed to create compression dictionary.");
+      return false;
+    }
+  }
+
+  TaskQueue queue;
+  queue.SetWorkerCount((num_threads > 1) ? num_threads : 0);
+
+  progress->SetStatusText("Compressing disc image...");
+  progress->SetProgressRange(static_cast<u32>(hunks.size()));
+  progress->SetProgressValue(0);
+
+  std::vector<ZCDHunk> hunk_table;
+  hunk_table.reserve(hunks.size());
+  u64 current_offset = sizeof(header) + dictionary.size();
+  u64 uncompressed_bytes = 0;
+
+  for (size_t batch_start = 0; batch_start < hunks.size(); batch_start += HUNKS_PER_BATCH)
+  {
+    if (progress->IsCancelled())
+    {
+      Error::SetStringView(error, "Operation was cancelled.");
+      FileSystem::DiscardAtomicRenamedFile(fp);
+      return false;
+    }
+
+    // source images aren't thread-safe, so reading is serialized
+    const size_t batch_end = std::min(batch_start + HUNKS_PER_BATCH, hunks.size());
+    for (size_t i = batch_start; i < batch_end; i++)
+    {
+      ZCDPendingHunk& hunk = hunks[i];
+      hunk.data.resize(hunk.size);
+      hunk.compressed.resize(ZSTD_compressBound(hunk.size));
+      if (!ReadZCDHunk(image, &hunk, store_subchannel_q, error))
+      {
+        FileSystem::DiscardAtomicRenamedFile(fp);
+        return false;
+      }
+    }
+
+    // each thread gets a contiguous slice of the batch and its own context
+    const size_t batch_size = batch_end - batch_start;
+    const size_t hunks_per_thread = (batch_size + (num_threads - 1)) / num_threads;
+    for (u32 thread = 0; thread < num_threads; thread++)
+    {
+      const size_t slice_start = batch_start + thread * hunks_per_thread;
+      const size_t slice_end = std::min(slice_start + hunks_per_thread, batch_end);
+      if (slice_start >= slice_end)
+        break;
+
+      queue.SubmitTask([&hunks, cctx = cctxs[thread], cdict, compression_level, slice_start, slice_end]() {
+        for (size_t i = slice_start; i < slice_end; i++)
+        {
+          ZCDPendingHunk& hunk = hunks[i];
+          hunk.compressed_size =
+            cdict ? ZSTD_compress_usingCDict(cctx, hunk.compressed.data(), hunk.compressed.size(), hunk.data.data(),
+                                             hunk.size, cdict) :
+                    ZSTD_compressCCtx(cctx, hunk.compressed.data(), hunk.compressed.size(), hunk.data.data(),
+                                      hunk.size, compression_level);
+        }
+      });
+    }
+    queue.WaitForAll();
+
+    for (size_t i = batch_start; i < batch_end; i++)
+    {
+      ZCDPendingHunk& hunk = hunks[i];
+      if (ZSTD_isError(hunk.compressed_size)) [[unlikely]]
+      {
+        Error::SetStringFmt(error, "Failed to compress hunk {}: {}", i, ZSTD_getErrorName(hunk.compressed_size));
+        FileSystem::DiscardAtomicRenamedFile(fp);
+        return false;
+      }
+
+      // incompressible hunks, e.g. XA audio, are stored as-is
+      const bool stored = (hunk.compressed_size >= hunk.size);
+      const u32 write_size = stored ? hunk.size : static_cast<u32>(hunk.compressed_size);
+      if (!write_data(stored ? hunk.data.data() : hunk.compressed.data(), write_size))
+      {
+        FileSystem::DiscardAtomicRenamedFile(fp);
+        return false;
+      }
+
+      hunk_table.push_back(ZCDHunk{current_offset, write_size, hunk.regenerated_sectors});
+      current_offset += write_size;
+      uncompressed_bytes += hunk.size;
+
+      hunk.data.deallocate();
+      hunk.compressed.deallocate();
+    }
+
+    progress->SetProgressValue(static_cast<u32>(batch_end));
+  }
+
+  header.hunk_table_offset = current_offset;
+  header.toc_offset = current_offset + hunk_table.size() * sizeof(ZCDHunk);
+  if (!write_data(hunk_table.data(), hunk_table.size() * sizeof(ZCDHunk)) ||
+      !write_data(tracks.data(), tracks.size() * sizeof(ZCDTrack)) ||
+      !write_data(indices.data(), indices.size() * sizeof(ZCDIndex)))
+  {
+    FileSystem::DiscardAtomicRenamedFile(fp);
+    return false;
+  }
+
+  if (!FileSystem::FSeek64(fp.get(), 0, SEEK_SET, error) || !write_data(&header, sizeof(header)) ||
+      !FileSystem::CommitAtomicRenamedFile(fp, error))
+  {
+    FileSystem::DiscardAtomicRenamedFile(fp);
+    return false;
+  }
+
+  INFO_LOG("Wrote ZCD '{}': {} hunks, {:.2f} MB to {:.2f} MB, {} byte dictionary", Path::GetFileName(path),
+           hunk_table.size(), static_cast<double>(uncompressed_bytes) / 1048576.0,
+           static_cast<double>(current_offset) / 1048576.0, dictionary.size());
+  return true;
+}
@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#include "cd_sector_ecc.h"
+#include "cd_image.h"
+
+#include "common/assert.h"
+
+#include <array>
+#include <cstring>
+
+namespace CDSectorECC {
+
+static constexpr u32 EDC_POLYNOMIAL = 0xD8018001; // reversed 0x8001801B
+
+static constexpr u32 MODE1_EDC_OFFSET = 0x810;
+static constexpr u32 MODE1_ZERO_OFFSET = 0x814;
+static constexpr u32 MODE1_ZERO_SIZE = 8;
+static constexpr u32 MODE2_FORM1_EDC_OFFSET = 0x818;
+static constexpr u32 MODE2_FORM2_EDC_OFFSET = 0x92C;
+static constexpr u32 ECC_P_OFFSET = 0x81C;
+static constexpr u32 ECC_P_SIZE = 172;
+static constexpr u32 ECC_Q_OFFSET = 0x8C8;
+static constexpr u32 ECC_Q_SIZE = 104;
+static constexpr u32 HEADER_OFFSET = 0x0C;
+static constexpr u32 SUBHEADER_OFFSET = 0x10;
+static constexpr u8 SUBMODE_FORM2 = 0x20;
+
+static constexpr std::array<u8, CDImage::SECTOR_SYNC_SIZE> s_sync_pattern = {
+  {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00}};
+
+// Slicing-by-4 tables, table 0 is the regular bytewise table.
+static constexpr std::array<std::array<u32, 256>, 4> s_edc_tables = []() {
+  std::array<std::array<u32, 256>, 4> ret = {};
+  for (u32 i = 0; i < 256; i++)
+  {
+    u32 edc = i;
+    for (u32 j = 0; j < 8; j++)
+      edc = (edc >> 1) ^ ((edc & 1) ? EDC_POLYNOMIAL : 0);
+    ret[0][i] = edc;
+  }
+  for (u32 i = 0; i < 256; i++)
+  {
+    for (u32 j = 1; j < 4; j++)
+      ret[j][i] = (ret[j - 1][i] >> 8) ^ ret[0][ret[j - 1][i] & 0xFF];
+  }
+  return ret;
+}();
+
+// GF(2^8) multiply-by-alpha, and the inverse of (1 + alpha), for polynomial 0x11D.
+static constexpr std::array<u8, 256> s_ecc_f_lut = []() {
+  std::array<u8, 256> ret = {};
+  for (u32 i = 0; i < 256; i++)
+    ret[i] = static_cast<u8>((i << 1) ^ ((i & 0x80) ? 0x11D : 0));
+  return ret;
+}();
+static constexpr std::array<u8, 256> s_ecc_b_lut = []() {
+  std::array<u8, 256> ret = {};
+  for (u32 i = 0; i < 256; i++)
+    ret[i ^ s_ecc_f_lut[i]] = static_cast<u8>(i);
+  return ret;
+}();
+
+static void ComputeECCBlock(const u8* src, u32 major_count, u32 minor_count, u32 major_mult, u32 minor_inc, u8* dst)
+{
+  const u32 size = major_count * minor_count;
+  for (u32 major = 0; major < major_count; major++)
+  {
+    u32 index = (major >> 1) * major_mult + (major & 1);
+    u8 ecc_a = 0;
+    u8 ecc_b = 0;
+    for (u32 minor = 0; minor < minor_count; minor++)
+    {
+      const u8 value = src[index];
+      index += minor_inc;
+      if (index >= size)
+        index -= size;
+
+      ecc_a ^= value;
+      ecc_b ^= value;
+      ecc_a = s_ecc_f_lut[ecc_a];
+    }
+
+    ecc_a = s_ecc_b_lut[s_ecc_f_lut[ecc_a] ^ ecc_b];
+    dst[major] = ecc_a;
+    dst[major + major_count] = ecc_a ^ ecc_b;
+  }
+}
+
+static void GenerateECC(u8* sector)
+{
+  // P parity covers the header and data, Q parity covers that plus the P parity.
+  ComputeECCBlock(sector + HEADER_OFFSET, 86, 24, 2, 86, sector + ECC_P_OFFSET);
+  ComputeECCBlock(sector + HEADER_OFFSET, 52, 43, 86, 88, sector + ECC_Q_OFFSET);
+}
+
+static void StoreEDC(u8* dst, u32 edc)
+{
+  // always little-endian
+  dst[0] = Truncate8(edc);
+  dst[1] = Truncate8(edc >> 8);
+  dst[2] = Truncate8(edc >> 16);
+  dst[3] = Truncate8(edc >> 24);
+}
+
+} // namespace CDSectorECC
+
+u32 CDSectorECC::ComputeEDC(const void* data, size_t length, u32 edc)
+{
+  const u8* ptr = static_cast<const u8*>(data);
+  for (; length >= 4; length -= 4, ptr += 4)
+  {
+    edc ^= static_cast<u32>(ptr[0]) | (static_cast<u32>(ptr[1]) << 8) | (static_cast<u32>(ptr[2]) << 16) |
+           (static_cast<u32>(ptr[3]) << 24);
+    edc = s_edc_tables[3][edc & 0xFF] ^ s_edc_tables[2][(edc >> 8) & 0xFF] ^ s_edc_tables[1][(edc >> 16) & 0xFF] ^
+          s_edc_tables[0][edc >> 24];
+  }
+  for (; length > 0; length--, ptr++)
+    edc = (edc >> 8) ^ s_edc_tables[0][(edc ^ *ptr) & 0xFF];
+
+  return edc;
+}
+
+void CDSectorECC::GenerateMode1(u8* sector)
+{
+  StoreEDC(sector + MODE1_EDC_OFFSET, ComputeEDC(sector, MODE1_EDC_OFFSET));
+  std::memset(sector + MODE1_ZERO_OFFSET, 0, MODE1_ZERO_SIZE);
+  GenerateECC(sector);
+}
+
+void CDSectorECC::GenerateMode2Form1(u8* sector)
+{
+  StoreEDC(sector + MODE2_FORM1_EDC_OFFSET,
+           ComputeEDC(sector + SUBHEADER_OFFSET, MODE2_FORM1_EDC_OFFSET - SUBHEADER_OFFSET));
+
+  // Mode 2 parity is computed with a zero header, so the sector can be relocated.
+  u8 header[4];
+  std::memcpy(header, sector + HEADER_OFFSET, sizeof(header));
+  std::memset(sector + HEADER_OFFSET, 0, sizeof(header));
+  GenerateECC(sector);
+  std::memcpy(sector + HEADER_OFFSET, header, sizeof(header));
+}
+
+void CDSectorECC::GenerateMode2Form2(u8* sector)
+{
+  StoreEDC(sector + MODE2_FORM2_EDC_OFFSET,
+           ComputeEDC(sector + SUBHEADER_OFFSET, MODE2_FORM2_EDC_OFFSET - SUBHEADER_OFFSET));
+}
+
+CDSectorECC::SectorType CDSectorECC::GetSectorType(const u8* sector)
+{
+  if (std::memcmp(sector, s_sync_pattern.data(), s_sync_pattern.size()) != 0)
+    return SectorType::Unknown;
+
+  const u8 mode = sector[HEADER_OFFSET + 3];
+  if (mode == 1)
+    return SectorType::Mode1;
+  else if (mode != 2)
+    return SectorType::Unknown;
+
+  // subheader is stored twice, use the first copy
+  return (sector[SUBHEADER_OFFSET + 2] & SUBMODE_FORM2) ? SectorType::Mode2Form2 : SectorType::Mode2Form1;
+}
+
+bool CDSectorECC::Regenerate(u8* sector, SectorType type)
+{
+  switch (type)
+  {
+    case SectorType::Mode1:
+      GenerateMode1(sector);
+      return true;
+
+    case SectorType::Mode2Form1:
+      GenerateMode2Form1(sector);
+      return true;
+
+    case SectorType::Mode2Form2:
+      GenerateMode2Form2(sector);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+CDSectorECC::SectorType CDSectorECC::GetRegenerableType(const u8* sector)
+{
+  const SectorType type = GetSectorType(sector);
+  if (type == SectorType::Unknown)
+    return type;
+
+  u8 temp[CDImage::RAW_SECTOR_SIZE];
+  std::memcpy(temp, sector, CDImage::RAW_SECTOR_SIZE);
+  ClearRegenerableBytes(temp, type);
+  Regenerate(temp, type);
+  return (std::memcmp(temp, sector, CDImage::RAW_SECTOR_SIZE) == 0) ? type : SectorType::Unknown;
+}
+
+void CDSectorECC::ClearRegenerableBytes(u8* sector, SectorType type)
+{
+  switch (type)
+  {
+    case SectorType::Mode1:
+      std::memset(sector + MODE1_EDC_OFFSET, 0, CDImage::RAW_SECTOR_SIZE - MODE1_EDC_OFFSET);
+      break;
+
+    case SectorType::Mode2Form1:
+      std::memset(sector + MODE2_FORM1_EDC_OFFSET, 0, CDImage::RAW_SECTOR_SIZE - MODE2_FORM1_EDC_OFFSET);
+      break;
+
+    case SectorType::Mode2Form2:
+      std::memset(sector + MODE2_FORM2_EDC_OFFSET, 0, CDImage::RAW_SECTOR_SIZE - MODE2_FORM2_EDC_OFFSET);
+      break;
+
+    default:
+      break;
+  }
+}
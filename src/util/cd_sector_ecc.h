@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2019-2025 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+#pragma once
+
+#include "common/types.h"
+
+#include <cstddef>
+
+/// CD-ROM sector EDC (error detection code) and ECC (Reed-Solomon P/Q parity) generation.
+namespace CDSectorECC {
+
+enum class SectorType : u8
+{
+  Unknown,
+  Mode1,
+  Mode2Form1,
+  Mode2Form2,
+};
+
+/// Computes the CD-ROM EDC (CRC-32 with polynomial 0x8001801B, reflected) of the specified data.
+u32 ComputeEDC(const void* data, size_t length, u32 edc = 0);
+
+/// Fills in the EDC, zero fill and P/Q parity of a Mode 1 sector from the sync, header and user data.
+void GenerateMode1(u8* sector);
+
+/// Fills in the EDC and P/Q parity of a Mode 2 Form 1 sector from the subheader and user data.
+void GenerateMode2Form1(u8* sector);
+
+/// Fills in the EDC of a Mode 2 Form 2 sector from the subheader and user data.
+void GenerateMode2Form2(u8* sector);
+
+/// Returns the type of the sector from the sync pattern, mode and subheader. Does not check EDC/ECC.
+SectorType GetSectorType(const u8* sector);
+
+/// Regenerates the EDC/ECC of a sector of the specified type. Returns false for unknown sectors.
+bool Regenerate(u8* sector, SectorType type);
+
+/// Returns the type of the sector if regenerating its EDC/ECC reproduces it exactly, otherwise Unknown.
+/// Sectors with bad or missing EDC/ECC, e.g. copy protection or Form 2 sectors without EDC, will return Unknown.
+SectorType GetRegenerableType(const u8* sector);
+
+/// Zeros the bytes which would be filled in by Regenerate(). Header, subheader and user data are left untouched.
+void ClearRegenerableBytes(u8* sector, SectorType type);
+
+} // namespace CDSectorECC
@@ -193,6 +193,7 @@ void D3D11Device::SetFeatures(FeatureMask disabled_features)
   m_features.gpu_timing = true;
   m_features.shader_cache = true;
   m_features.pipeline_cache = false;
+  m_features.concurrent_shader_compile = true;
   m_features.prefer_unused_textures = false;
   m_features.raster_order_views = false;
   if (!(disabled_features & FEATURE_MASK_RASTER_ORDER_VIEWS))
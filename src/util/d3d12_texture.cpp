@@ -1019,6 +1019,11 @@ void D3D12DownloadTexture::Flush()
   }
 }
 
+bool D3D12DownloadTexture::IsCopyComplete() const
+{
+  return (!m_needs_flush || D3D12Device::GetInstance().GetCompletedFenceValue() >= m_copy_fence_value);
+}
+
 #ifdef ENABLE_GPU_OBJECT_NAMES
 
 void D3D12DownloadTexture::SetDebugName(std::string_view name)
@@ -170,6 +170,7 @@ public:
   void Unmap() override;
 
   void Flush() override;
+  bool IsCopyComplete() const override;
 
 #ifdef ENABLE_GPU_OBJECT_NAMES
   void SetDebugName(std::string_view name) override;
@@ -18,6 +18,7 @@
 #include <d3dcompiler.h>
 #include <dxcapi.h>
 #include <dxgi1_5.h>
+#include <mutex>
 
 LOG_CHANNEL(GPUDevice);
 
@@ -597,6 +598,8 @@ std::optional<DynamicHeapArray<u8>> D3DCommon::CompileShaderWithDXC(u32 shader_m
 
 bool D3DCommon::LoadDXCompilerLibrary(Error* error)
 {
+  static std::mutex load_mutex;
+  std::unique_lock lock(load_mutex);
   if (s_dxcompiler_library.IsOpen())
     return true;
 
@@ -874,15 +874,21 @@ std::unique_ptr<GPUShader> GPUDevice::CreateShader(GPUShaderStage stage, GPUShad
                                                    std::string_view source, Error* error /* = nullptr */,
                                                    const char* entry_point /* = "main" */)
 {
+  // Shaders may be compiled from multiple threads if the backend supports it, only the cache itself needs locking.
   std::unique_ptr<GPUShader> shader;
+  std::unique_lock lock(m_shader_cache_mutex);
   if (!m_shader_cache.IsOpen())
   {
+    lock.unlock();
     shader = CreateShaderFromSource(stage, language, source, entry_point, nullptr, error);
     return shader;
   }
 
-  const GPUShaderCache::CacheIndexKey key = m_shader_cache.GetCacheKey(stage, language, source, entry_point);
+  lock.unlock();
+  const GPUShaderCache::CacheIndexKey key = GPUShaderCache::GetCacheKey(stage, language, source, entry_point);
+  lock.lock();
   std::optional<GPUShaderCache::ShaderBinary> binary = m_shader_cache.Lookup(key);
+  lock.unlock();
   if (binary.has_value())
   {
     shader = CreateShaderFromBinary(stage, binary->cspan(), error);
@@ -890,7 +896,9 @@ std::unique_ptr<GPUShader> GPUDevice::CreateShader(GPUShaderStage stage, GPUShad
       return shader;
 
     ERROR_LOG("Failed to create shader from binary (driver changed?). Clearing cache.");
+    lock.lock();
     m_shader_cache.Clear();
+    lock.unlock();
     binary.reset();
   }
 
@@ -902,7 +910,8 @@ std::unique_ptr<GPUShader> GPUDevice::CreateShader(GPUShaderStage stage, GPUShad
   // Don't insert empty shaders into the cache...
   if (!new_binary.empty())
   {
-    if (!m_shader_cache.Insert(key, new_binary.data(), static_cast<u32>(new_binary.size())))
+    lock.lock();
+    if (m_shader_cache.IsOpen() && !m_shader_cache.Insert(key, new_binary.data(), static_cast<u32>(new_binary.size())))
       m_shader_cache.Close();
   }
 
@@ -1413,7 +1422,6 @@ std::unique_ptr<GPUDevice> GPUDevice::CreateDeviceForAPI(RenderAPI api)
 #define SPIRV_CROSS_MSL_FUNCTIONS(X)
 #endif
 
-// TODO: NOT thread safe, yet.
 namespace dyn_libs {
 static bool OpenShaderc(Error* error);
 static void CloseShaderc();
@@ -1428,6 +1436,9 @@ static shaderc_compiler_t s_shaderc_compiler = nullptr;
 
 static bool s_close_registered = false;
 
+// Shaders can be compiled from worker threads, so loading needs to be serialized.
+static std::mutex s_load_mutex;
+
 #define ADD_FUNC(F) static decltype(&::F) F;
 SHADERC_FUNCTIONS(ADD_FUNC)
 SPIRV_CROSS_FUNCTIONS(ADD_FUNC)
@@ -1439,6 +1450,7 @@ SPIRV_CROSS_MSL_FUNCTIONS(ADD_FUNC)
 
 bool dyn_libs::OpenShaderc(Error* error)
 {
+  std::unique_lock lock(s_load_mutex);
   if (s_shaderc_library.IsOpen())
     return true;
 
@@ -1494,6 +1506,7 @@ void dyn_libs::CloseShaderc()
 
 bool dyn_libs::OpenSpirvCross(Error* error)
 {
+  std::unique_lock lock(s_load_mutex);
   if (s_spirv_cross_library.IsOpen())
     return true;
 
@@ -18,6 +18,7 @@
 #include <cstring>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
@@ -605,6 +606,7 @@ public:
     bool gpu_timing : 1;
     bool shader_cache : 1;
     bool pipeline_cache : 1;
+    bool concurrent_shader_compile : 1;
     bool prefer_unused_textures : 1;
     bool raster_order_views : 1;
     bool dxt_textures : 1;
@@ -928,6 +930,7 @@ protected:
   GPUSampler* m_linear_sampler = nullptr;
 
   GPUShaderCache m_shader_cache;
+  std::mutex m_shader_cache_mutex;
 
 private:
   static constexpr u32 MAX_TEXTURE_POOL_SIZE = 125;
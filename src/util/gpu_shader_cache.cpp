@@ -15,6 +15,15 @@
 
 #include "compress_helpers.h"
 
+#include <algorithm>
+
+#ifdef _WIN32
+#include "common/windows_headers.h"
+#include <io.h>
+#else
+#include <sys/file.h>
+#endif
+
 LOG_CHANNEL(GPUDevice);
 
 #pragma pack(push, 1)
@@ -23,8 +32,11 @@ struct CacheFileHeader
   u32 signature;
   u32 render_api_version;
   u32 cache_version;
+  u32 session;            // incremented each time the cache is opened
+  u32 num_sorted_entries; // entries at the start of the index which are sorted by key
+  u32 reserved;
 };
-struct CacheIndexEntry
+struct GPUShaderCache::CacheIndexEntry
 {
   u8 shader_type;
   u8 shader_language;
@@ -37,10 +49,62 @@ struct CacheIndexEntry
   u32 file_offset;
   u32 compressed_size;
   u32 uncompressed_size;
+  u32 last_used_session;
 };
 #pragma pack(pop)
 
-static constexpr u32 EXPECTED_SIGNATURE = 0x434B5544; // DUKC
+// Entries are searched in place in the mapped index, keep them aligned.
+static_assert(sizeof(CacheFileHeader) % 8 == 0 && sizeof(GPUShaderCache::CacheIndexKey) == 40);
+
+static constexpr u32 EXPECTED_SIGNATURE = 0x444B5544; // DUKD
+
+/// Once the blobs grow past this size, the least recently used ones are dropped when the cache is compacted.
+static constexpr u64 MAX_BLOB_BYTES = 128 * 1024 * 1024;
+
+/// Size the blobs are trimmed down to, so the blob file isn't rewritten every time a few shaders are added.
+static constexpr u64 TRIMMED_BLOB_BYTES = MAX_BLOB_BYTES / 4 * 3;
+
+/// Used entries only have their session refreshed every so often, to avoid rewriting the index every time.
+static constexpr u32 SESSION_REFRESH_INTERVAL = 8;
+
+/// Blobs are stored in creation order, so nearby shaders are usually requested together.
+static constexpr u32 BLOB_PREFETCH_SIZE = 256 * 1024;
+
+static bool LockCacheShared(std::FILE* fp);
+static bool UpgradeCacheLock(std::FILE* fp);
+
+static int CompareKey(const GPUShaderCache::CacheIndexKey& key, const void* entry)
+{
+  return std::memcmp(&key, entry, sizeof(key));
+}
+
+bool LockCacheShared(std::FILE* fp)
+{
+#ifdef _WIN32
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+  OVERLAPPED ov = {};
+  return LockFileEx(handle, 0, 0, 1, 0, &ov);
+#else
+  int res;
+  while ((res = flock(fileno(fp), LOCK_SH)) != 0 && errno == EINTR)
+    ;
+  return (res == 0);
+#endif
+}
+
+bool UpgradeCacheLock(std::FILE* fp)
+{
+  // Neither API converts locks atomically, but the lock is only upgraded right before closing anyway.
+#ifdef _WIN32
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+  OVERLAPPED ov = {};
+  UnlockFileEx(handle, 0, 1, 0, &ov);
+  ov = {};
+  return LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &ov);
+#else
+  return (flock(fileno(fp), LOCK_EX | LOCK_NB) == 0);
+#endif
+}
 
 GPUShaderCache::GPUShaderCache() = default;
 
@@ -76,6 +140,16 @@ bool GPUShaderCache::Open(std::string_view base_filename, u32 render_api_version
   if (base_filename.empty())
     return true;
 
+  // Every instance using the cache holds a shared lock on this file, compaction requires it exclusively.
+  const std::string lock_filename = fmt::format("{}.lck", m_base_filename);
+  m_lock_file = FileSystem::OpenSharedCFile(lock_filename.c_str(), "a+b", FileSystem::FileShareMode::DenyNone);
+  if (m_lock_file && !LockCacheShared(m_lock_file))
+  {
+    WARNING_LOG("Failed to lock shader cache '{}', it will not be compacted.", Path::GetFileName(m_base_filename));
+    std::fclose(m_lock_file);
+    m_lock_file = nullptr;
+  }
+
   const std::string index_filename = fmt::format("{}.idx", m_base_filename);
   const std::string blob_filename = fmt::format("{}.bin", m_base_filename);
   return ReadExisting(index_filename, blob_filename);
@@ -90,6 +164,28 @@ bool GPUShaderCache::Create()
 
 void GPUShaderCache::Close()
 {
+  if (m_index_file && m_blob_file)
+    Compact();
+
+  CloseFiles();
+
+  if (m_lock_file)
+  {
+    std::fclose(m_lock_file);
+    m_lock_file = nullptr;
+  }
+}
+
+void GPUShaderCache::CloseFiles()
+{
+  m_sorted_entries = nullptr;
+  m_num_sorted_entries = 0;
+  m_sorted_entries_used.clear();
+  m_index.clear();
+  m_index_mapping.Close();
+  m_blob_mapping.Close();
+  m_blob_prefetch_end = 0;
+
   if (m_index_file)
   {
     std::fclose(m_index_file);
@@ -107,7 +203,7 @@ void GPUShaderCache::Clear()
   if (!IsOpen())
     return;
 
-  Close();
+  CloseFiles();
 
   WARNING_LOG("Clearing shader cache at {}.", Path::GetFileName(m_base_filename));
 
@@ -136,8 +232,14 @@ bool GPUShaderCache::CreateNew(const std::string& index_filename, const std::str
     return false;
   }
 
-  const CacheFileHeader file_header = {
-    .signature = EXPECTED_SIGNATURE, .render_api_version = m_render_api_version, .cache_version = m_version};
+  m_session = 1;
+
+  const CacheFileHeader file_header = {.signature = EXPECTED_SIGNATURE,
+                                       .render_api_version = m_render_api_version,
+                                       .cache_version = m_version,
+                                       .session = m_session,
+                                       .num_sorted_entries = 0,
+                                       .reserved = 0};
   if (std::fwrite(&file_header, sizeof(file_header), 1, m_index_file) != 1) [[unlikely]]
   {
     ERROR_LOG("Failed to write version to index file '{}'", Path::GetFileName(index_filename));
@@ -182,8 +284,7 @@ bool GPUShaderCache::ReadExisting(const std::string& index_filename, const std::
       file_header.cache_version != m_version) [[unlikely]]
   {
     ERROR_LOG("Bad file/data version in '{}'", Path::GetFileName(index_filename));
-    std::fclose(m_index_file);
-    m_index_file = nullptr;
+    CloseFiles();
     return false;
   }
 
@@ -191,31 +292,44 @@ bool GPUShaderCache::ReadExisting(const std::string& index_filename, const std::
   if (!m_blob_file) [[unlikely]]
   {
     ERROR_LOG("Blob file '{}' is missing", Path::GetFileName(blob_filename));
-    std::fclose(m_index_file);
-    m_index_file = nullptr;
+    CloseFiles();
     return false;
   }
 
   std::fseek(m_blob_file, 0, SEEK_END);
   const u32 blob_file_size = static_cast<u32>(std::ftell(m_blob_file));
 
-  for (;;)
+  // The index is searched in place, and blobs are read straight out of the mapping.
+  Error error;
+  if (!m_index_mapping.Open(index_filename.c_str(), false, &error) ||
+      (blob_file_size > 0 && !m_blob_mapping.Open(blob_filename.c_str(), false, &error))) [[unlikely]]
   {
-    CacheIndexEntry entry;
-    if (std::fread(&entry, sizeof(entry), 1, m_index_file) != 1 ||
-        (entry.file_offset + entry.compressed_size) > blob_file_size) [[unlikely]]
-    {
-      if (std::feof(m_index_file))
-        break;
+    ERROR_LOG("Failed to map shader cache: {}", error.GetDescription());
+    CloseFiles();
+    return false;
+  }
 
-      ERROR_LOG("Failed to read entry from '{}', corrupt file?", Path::GetFileName(index_filename));
-      m_index.clear();
-      std::fclose(m_blob_file);
-      m_blob_file = nullptr;
-      std::fclose(m_index_file);
-      m_index_file = nullptr;
-      return false;
-    }
+  // A partially-written entry at the end is ignored, same as a failed fread() would.
+  const u32 num_entries =
+    static_cast<u32>((m_index_mapping.GetSize() - sizeof(CacheFileHeader)) / sizeof(CacheIndexEntry));
+  if (file_header.num_sorted_entries > num_entries) [[unlikely]]
+  {
+    ERROR_LOG("Sorted entry count in '{}' is out of range, corrupt file?", Path::GetFileName(index_filename));
+    CloseFiles();
+    return false;
+  }
+
+  // Entries aren't validated here, ReadBlob() checks them when they're looked up.
+  const CacheIndexEntry* entries =
+    reinterpret_cast<const CacheIndexEntry*>(m_index_mapping.GetData() + sizeof(CacheFileHeader));
+  m_sorted_entries = entries;
+  m_num_sorted_entries = file_header.num_sorted_entries;
+  m_sorted_entries_used.resize(m_num_sorted_entries);
+
+  // Entries appended since the last compaction are unsorted, and usually only a handful.
+  for (u32 i = m_num_sorted_entries; i < num_entries; i++)
+  {
+    const CacheIndexEntry& entry = entries[i];
 
     const CacheIndexKey key{entry.shader_type,     entry.shader_language, {},
                             entry.source_length,   entry.source_hash_low, entry.source_hash_high,
@@ -224,10 +338,23 @@ bool GPUShaderCache::ReadExisting(const std::string& index_filename, const std::
     m_index.emplace(key, data);
   }
 
+  // Bump the session counter, this is what ages out unused blobs.
+  m_session = file_header.session + 1;
+  file_header.session = m_session;
+  if (std::fseek(m_index_file, 0, SEEK_SET) != 0 ||
+      std::fwrite(&file_header, sizeof(file_header), 1, m_index_file) != 1 ||
+      std::fflush(m_index_file) != 0) [[unlikely]]
+  {
+    ERROR_LOG("Failed to update header in '{}'", Path::GetFileName(index_filename));
+    CloseFiles();
+    return false;
+  }
+
   // ensure we don't write before seeking
   std::fseek(m_index_file, 0, SEEK_END);
 
-  DEV_LOG("Read {} entries from '{}'", m_index.size(), Path::GetFileName(index_filename));
+  DEV_LOG("Mapped {} sorted and {} unsorted entries from '{}'", m_num_sorted_entries, m_index.size(),
+          Path::GetFileName(index_filename));
   return true;
 }
 
@@ -264,32 +391,94 @@ GPUShaderCache::CacheIndexKey GPUShaderCache::GetCacheKey(GPUShaderStage stage,
   return key;
 }
 
+s32 GPUShaderCache::FindSortedEntry(const CacheIndexKey& key) const
+{
+  u32 low = 0;
+  u32 high = m_num_sorted_entries;
+  while (low < high)
+  {
+    const u32 mid = low + (high - low) / 2;
+    const int res = CompareKey(key, &m_sorted_entries[mid]);
+    if (res == 0)
+      return static_cast<s32>(mid);
+    else if (res < 0)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+
+  return -1;
+}
+
 std::optional<GPUShaderCache::ShaderBinary> GPUShaderCache::Lookup(const CacheIndexKey& key)
+{
+  if (const s32 index = FindSortedEntry(key); index >= 0)
+  {
+    // A broken entry is replaced by the next Insert(), which goes in m_index and takes precedence when compacting.
+    const CacheIndexEntry& entry = m_sorted_entries[index];
+    std::optional<ShaderBinary> ret =
+      ReadBlob(key, CacheIndexData{entry.file_offset, entry.compressed_size, entry.uncompressed_size});
+    if (ret.has_value())
+    {
+      m_sorted_entries_used[index] = true;
+      return ret;
+    }
+  }
+
+  if (auto iter = m_index.find(key); iter != m_index.end())
+    return ReadBlob(key, iter->second);
+
+  return std::nullopt;
+}
+
+std::optional<GPUShaderCache::ShaderBinary> GPUShaderCache::ReadBlob(const CacheIndexKey& key,
+                                                                     const CacheIndexData& data)
 {
   std::optional<ShaderBinary> ret;
+  Error error;
 
-  auto iter = m_index.find(key);
-  if (iter != m_index.end())
+  const size_t data_end = static_cast<size_t>(data.file_offset) + data.compressed_size;
+  if (data_end <= m_blob_mapping.GetSize())
   {
-    DynamicHeapArray<u8> compressed_data(iter->second.compressed_size);
+    if (data_end > m_blob_prefetch_end)
+    {
+      m_blob_mapping.Prefetch(data.file_offset, BLOB_PREFETCH_SIZE);
+      m_blob_prefetch_end = std::max<size_t>(data_end, static_cast<size_t>(data.file_offset) + BLOB_PREFETCH_SIZE);
+    }
 
-    if (std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
-        std::fread(compressed_data.data(), iter->second.compressed_size, 1, m_blob_file) != 1) [[unlikely]]
+    ret = CompressHelpers::DecompressBuffer(CompressHelpers::CompressType::Zstandard,
+                                            m_blob_mapping.GetSpan().subspan(data.file_offset, data.compressed_size),
+                                            data.uncompressed_size, &error);
+  }
+  else
+  {
+    // Written after the cache was opened, not part of the mapping. Check the size before allocating for it, in case
+    // the entry is corrupted.
+    if (std::fseek(m_blob_file, 0, SEEK_END) != 0 ||
+        data_end > static_cast<size_t>(std::ftell(m_blob_file))) [[unlikely]]
     {
-      ERROR_LOG("Read {} byte {} shader from file failed", iter->second.compressed_size,
-                GPUShader::GetStageName(static_cast<GPUShaderStage>(key.shader_type)));
+      ERROR_LOG("{} shader at offset {} is out of range, corrupt file?",
+                GPUShader::GetStageName(static_cast<GPUShaderStage>(key.shader_type)), data.file_offset);
+      return ret;
     }
-    else
+
+    DynamicHeapArray<u8> compressed_data(data.compressed_size);
+    if (std::fseek(m_blob_file, data.file_offset, SEEK_SET) != 0 ||
+        std::fread(compressed_data.data(), data.compressed_size, 1, m_blob_file) != 1) [[unlikely]]
     {
-      Error error;
-      ret = CompressHelpers::DecompressBuffer(CompressHelpers::CompressType::Zstandard,
-                                              CompressHelpers::OptionalByteBuffer(std::move(compressed_data)),
-                                              iter->second.uncompressed_size, &error);
-      if (!ret.has_value()) [[unlikely]]
-        ERROR_LOG("Failed to decompress shader: {}", error.GetDescription());
+      ERROR_LOG("Read {} byte {} shader from file failed", data.compressed_size,
+                GPUShader::GetStageName(static_cast<GPUShaderStage>(key.shader_type)));
+      return ret;
     }
+
+    ret = CompressHelpers::DecompressBuffer(CompressHelpers::CompressType::Zstandard,
+                                            CompressHelpers::OptionalByteBuffer(std::move(compressed_data)),
+                                            data.uncompressed_size, &error);
   }
 
+  if (!ret.has_value()) [[unlikely]]
+    ERROR_LOG("Failed to decompress shader: {}", error.GetDescription());
+
   return ret;
 }
 
@@ -323,6 +512,7 @@ bool GPUShaderCache::Insert(const CacheIndexKey& key, const void* data, u32 data
   entry.file_offset = idata.file_offset;
   entry.compressed_size = idata.compressed_size;
   entry.uncompressed_size = idata.uncompressed_size;
+  entry.last_used_session = m_session;
 
   if (std::fwrite(compress_buffer->data(), compress_buffer->size(), 1, m_blob_file) != 1 ||
       std::fflush(m_blob_file) != 0 || std::fwrite(&entry, sizeof(entry), 1, m_index_file) != 1 ||
@@ -338,3 +528,198 @@ bool GPUShaderCache::Insert(const CacheIndexKey& key, const void* data, u32 data
   m_index.emplace(key, idata);
   return true;
 }
+
+void GPUShaderCache::Compact()
+{
+  // Blobs are only dropped once the cache outgrows its budget, least recently used first, so shaders for games which
+  // haven't been played in a while survive as long as there's room for them.
+  u64 total_bytes = 0;
+  bool refresh_sessions = false;
+  std::vector<u32> unused_entries;
+  for (u32 i = 0; i < m_num_sorted_entries; i++)
+  {
+    const CacheIndexEntry& entry = m_sorted_entries[i];
+    total_bytes += entry.compressed_size;
+    if (m_sorted_entries_used[i])
+      refresh_sessions |= ((entry.last_used_session + SESSION_REFRESH_INTERVAL) <= m_session);
+    else
+      unused_entries.push_back(i);
+  }
+  for (const auto& [key, data] : m_index)
+    total_bytes += data.compressed_size;
+
+  std::vector<bool> evict_entries;
+  u64 evicted_bytes = 0;
+  if (total_bytes > MAX_BLOB_BYTES)
+  {
+    evict_entries.resize(m_num_sorted_entries);
+    std::sort(unused_entries.begin(), unused_entries.end(), [this](u32 lhs, u32 rhs) {
+      return (m_sorted_entries[lhs].last_used_session < m_sorted_entries[rhs].last_used_session);
+    });
+    for (const u32 i : unused_entries)
+    {
+      if ((total_bytes - evicted_bytes) <= TRIMMED_BLOB_BYTES)
+        break;
+
+      evict_entries[i] = true;
+      evicted_bytes += m_sorted_entries[i].compressed_size;
+    }
+  }
+
+  const bool compact_blobs = (evicted_bytes > 0);
+  if (m_index.empty() && !refresh_sessions && !compact_blobs)
+    return;
+
+  std::vector<CacheIndexEntry> entries;
+  entries.reserve(m_num_sorted_entries + m_index.size());
+  for (u32 i = 0; i < m_num_sorted_entries; i++)
+  {
+    CacheIndexEntry entry = m_sorted_entries[i];
+    if (m_sorted_entries_used[i])
+      entry.last_used_session = m_session;
+    else if (compact_blobs && evict_entries[i])
+      continue;
+
+    // replaced by a new entry after failing to load
+    CacheIndexKey key;
+    std::memcpy(&key, &entry, sizeof(key));
+    if (!m_index.empty() && m_index.contains(key))
+      continue;
+
+    entries.push_back(entry);
+  }
+  for (const auto& [key, data] : m_index)
+  {
+    CacheIndexEntry& entry = entries.emplace_back();
+    std::memcpy(&entry, &key, sizeof(key));
+    entry.file_offset = data.file_offset;
+    entry.compressed_size = data.compressed_size;
+    entry.uncompressed_size = data.uncompressed_size;
+    entry.last_used_session = m_session;
+  }
+
+  // Replacing the files would fail or pull them out from under other instances which have them mapped.
+  if (!m_lock_file || !UpgradeCacheLock(m_lock_file))
+  {
+    DEV_LOG("Shader cache '{}' is in use by another process, not compacting.", Path::GetFileName(m_base_filename));
+    return;
+  }
+
+  // Handles have to be closed before the files can be replaced. Entries have already been copied out.
+  CloseFiles();
+
+  const std::string index_filename = fmt::format("{}.idx", m_base_filename);
+  const std::string blob_filename = fmt::format("{}.bin", m_base_filename);
+  Error error;
+
+  FileSystem::AtomicRenamedFile new_blob_file(nullptr,
+                                              FileSystem::AtomicRenamedFileDeleter(std::string(), std::string()));
+  if (compact_blobs)
+  {
+    MappedFile blob_mapping;
+    if (!blob_mapping.Open(blob_filename.c_str(), false, &error))
+    {
+      ERROR_LOG("Failed to map shader blobs for compaction: {}", error.GetDescription());
+      return;
+    }
+
+    new_blob_file = FileSystem::CreateAtomicRenamedFile(blob_filename, &error);
+    if (!new_blob_file)
+    {
+      ERROR_LOG("Failed to create compacted shader blob file: {}", error.GetDescription());
+      return;
+    }
+
+    // Keep blobs in their original order, so prefetching still picks up neighbouring shaders.
+    std::vector<CacheIndexEntry*> ordered_entries;
+    ordered_entries.reserve(entries.size());
+    for (CacheIndexEntry& entry : entries)
+      ordered_entries.push_back(&entry);
+    std::sort(ordered_entries.begin(), ordered_entries.end(),
+              [](const CacheIndexEntry* lhs, const CacheIndexEntry* rhs) {
+                return (lhs->file_offset < rhs->file_offset);
+              });
+
+    u32 new_offset = 0;
+    for (CacheIndexEntry* entry : ordered_entries)
+    {
+      if ((static_cast<size_t>(entry->file_offset) + entry->compressed_size) > blob_mapping.GetSize() ||
+          std::fwrite(blob_mapping.GetData() + entry->file_offset, entry->compressed_size, 1, new_blob_file.get()) !=
+            1) [[unlikely]]
+      {
+        ERROR_LOG("Failed to write compacted shader blob file.");
+        FileSystem::DiscardAtomicRenamedFile(new_blob_file);
+        return;
+      }
+
+      entry->file_offset = new_offset;
+      new_offset += entry->compressed_size;
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const CacheIndexEntry& lhs, const CacheIndexEntry& rhs) {
+    return (std::memcmp(&lhs, &rhs, sizeof(CacheIndexKey)) < 0);
+  });
+
+  const CacheFileHeader file_header = {.signature = EXPECTED_SIGNATURE,
+                                       .render_api_version = m_render_api_version,
+                                       .cache_version = m_version,
+                                       .session = m_session,
+                                       .num_sorted_entries = static_cast<u32>(entries.size()),
+                                       .reserved = 0};
+  FileSystem::AtomicRenamedFile new_index_file = FileSystem::CreateAtomicRenamedFile(index_filename, &error);
+  if (!new_index_file || std::fwrite(&file_header, sizeof(file_header), 1, new_index_file.get()) != 1 ||
+      (!entries.empty() && std::fwrite(entries.data(), sizeof(CacheIndexEntry), entries.size(),
+                                       new_index_file.get()) != entries.size())) [[unlikely]]
+  {
+    ERROR_LOG("Failed to write sorted shader cache index.");
+    if (new_index_file)
+      FileSystem::DiscardAtomicRenamedFile(new_index_file);
+    if (new_blob_file)
+      FileSystem::DiscardAtomicRenamedFile(new_blob_file);
+    return;
+  }
+
+  if (!compact_blobs)
+  {
+    // Old index is left as-is if the rename fails, it's still valid for the blob file.
+    if (!FileSystem::CommitAtomicRenamedFile(new_index_file, &error))
+      ERROR_LOG("Failed to replace shader cache index: {}", error.GetDescription());
+    else
+      DEV_LOG("Wrote {} sorted entries to '{}'", entries.size(), Path::GetFileName(index_filename));
+
+    return;
+  }
+
+  // The old blob file is kept until the new index is in place, so the old pair can be restored if either rename
+  // fails. Offsets in the old index don't match the compacted blob file.
+  const std::string old_blob_filename = fmt::format("{}.bin.old", m_base_filename);
+  if (!FileSystem::RenamePath(blob_filename.c_str(), old_blob_filename.c_str(), &error))
+  {
+    ERROR_LOG("Failed to move old shader blob file: {}", error.GetDescription());
+    FileSystem::DiscardAtomicRenamedFile(new_index_file);
+    FileSystem::DiscardAtomicRenamedFile(new_blob_file);
+    return;
+  }
+
+  if (!FileSystem::CommitAtomicRenamedFile(new_blob_file, &error) ||
+      !FileSystem::CommitAtomicRenamedFile(new_index_file, &error))
+  {
+    ERROR_LOG("Failed to replace shader cache files: {}", error.GetDescription());
+    if (new_index_file)
+      FileSystem::DiscardAtomicRenamedFile(new_index_file);
+
+    Error restore_error;
+    if (!FileSystem::RenamePath(old_blob_filename.c_str(), blob_filename.c_str(), &restore_error))
+    {
+      // Nothing left that matches the index, it'll be recreated next time.
+      ERROR_LOG("Failed to restore old shader blob file: {}", restore_error.GetDescription());
+      FileSystem::DeleteFile(index_filename.c_str());
+    }
+
+    return;
+  }
+
+  FileSystem::DeleteFile(old_blob_filename.c_str());
+  INFO_LOG("Compacted shader cache '{}', {} KB reclaimed.", Path::GetFileName(m_base_filename), evicted_bytes / 1024);
+}
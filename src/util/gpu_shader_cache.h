@@ -5,6 +5,7 @@
 
 #include "common/hash_combine.h"
 #include "common/heap_array.h"
+#include "common/memmap.h"
 #include "common/types.h"
 
 #include <optional>
@@ -62,6 +63,8 @@ public:
   void Clear();
 
 private:
+  struct CacheIndexEntry;
+
   struct CacheIndexData
   {
     u32 file_offset;
@@ -74,12 +77,30 @@ private:
   bool CreateNew(const std::string& index_filename, const std::string& blob_filename);
   bool ReadExisting(const std::string& index_filename, const std::string& blob_filename);
 
+  void CloseFiles();
+
+  s32 FindSortedEntry(const CacheIndexKey& key) const;
+  std::optional<ShaderBinary> ReadBlob(const CacheIndexKey& key, const CacheIndexData& data);
+
+  /// Merges appended entries into the sorted index, and drops the least recently used blobs if it's over budget.
+  void Compact();
+
+  // Entries at the start of the index file are sorted by key and searched in place, anything
+  // appended after the last compaction is kept in m_index.
+  MappedFile m_index_mapping;
+  MappedFile m_blob_mapping;
+  const CacheIndexEntry* m_sorted_entries = nullptr;
+  u32 m_num_sorted_entries = 0;
+  std::vector<bool> m_sorted_entries_used;
   CacheIndex m_index;
+  size_t m_blob_prefetch_end = 0;
 
   std::string m_base_filename;
   u32 m_render_api_version = 0;
   u32 m_version = 0;
+  u32 m_session = 0;
 
   std::FILE* m_index_file = nullptr;
   std::FILE* m_blob_file = nullptr;
+  std::FILE* m_lock_file = nullptr;
 };
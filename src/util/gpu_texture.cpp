@@ -387,6 +387,11 @@ GPUDownloadTexture::GPUDownloadTexture(u32 width, u32 height, GPUTexture::Format
 
 GPUDownloadTexture::~GPUDownloadTexture() = default;
 
+bool GPUDownloadTexture::IsCopyComplete() const
+{
+  return !m_needs_flush;
+}
+
 u32 GPUDownloadTexture::GetBufferSize(u32 width, u32 height, GPUTexture::Format format, u32 pitch_align /* = 1 */)
 {
   DebugAssert(std::has_single_bit(pitch_align));
@@ -263,6 +263,10 @@ public:
   /// call to CopyFromTexture() and the Flush() call.
   virtual void Flush() = 0;
 
+  /// Returns true if the copy queued by CopyFromTexture() has completed on the GPU, i.e. Flush() will not block.
+  /// Backends which cannot query this without waiting return false until the texture has been flushed.
+  virtual bool IsCopyComplete() const;
+
 #if defined(_DEBUG) || defined(_DEVEL)
   /// Sets object name that will be displayed in graphics debuggers.
   virtual void SetDebugName(std::string_view name) = 0;
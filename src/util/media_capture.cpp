@@ -15,6 +15,7 @@
 #include "common/path.h"
 #include "common/string_util.h"
 #include "common/threading.h"
+#include "common/timer.h"
 
 #include "IconsFontAwesome5.h"
 #include "fmt/format.h"
@@ -79,7 +80,7 @@ static constexpr u32 VIDEO_HEIGHT_ALIGNMENT = 8;
 class ALIGN_TO_CACHE_LINE MediaCaptureBase : public MediaCapture
 {
 public:
-  static constexpr u32 NUM_FRAMES_IN_FLIGHT = 3;
+  static constexpr u32 NUM_FRAMES_IN_FLIGHT = 4;
   static constexpr u32 MAX_PENDING_FRAMES = NUM_FRAMES_IN_FLIGHT * 2;
   static constexpr u32 AUDIO_CHANNELS = 2;
 
@@ -99,6 +100,8 @@ public:
   float GetCaptureThreadUsage() const override final;
   float GetCaptureThreadTime() const override final;
   void UpdateCaptureThreadUsage(double pct_divider, double time_divider) override final;
+  u32 GetCaptureStallCount() const override final;
+  float GetCaptureStallTime() const override final;
 
   GPUTexture* GetRenderTexture() override final;
   bool DeliverVideoFrame(GPUTexture* stex) override final;
@@ -127,6 +130,8 @@ protected:
   }
 
   void ProcessFramePendingMap(std::unique_lock<std::mutex>& lock);
+  void ProcessCompletedFramesPendingMap(std::unique_lock<std::mutex>& lock);
+  void AddStall(Timer::Value start_time);
   void ProcessAllInFlightFrames(std::unique_lock<std::mutex>& lock);
   void EncoderThreadEntryPoint();
   void StartEncoderThread();
@@ -164,6 +169,14 @@ protected:
   float m_encoder_thread_usage = 0.0f;
   float m_encoder_thread_time = 0.0f;
 
+  // Written by the GPU thread when delivering frames, read by the CPU thread when updating usage.
+  std::atomic<u64> m_stall_ticks{0};
+  std::atomic<u32> m_stall_count{0};
+  u64 m_last_stall_ticks = 0;
+  u32 m_last_stall_count = 0;
+  float m_stall_time = 0.0f;
+  u32 m_stall_count_since_update = 0;
+
   std::condition_variable m_frame_ready_cv;
   std::condition_variable m_frame_encoded_cv;
   std::array<PendingFrame, MAX_PENDING_FRAMES> m_pending_frames = {};
@@ -260,8 +273,14 @@ bool MediaCaptureBase::DeliverVideoFrame(GPUTexture* stex)
   if (m_encoding_error.load(std::memory_order_acquire))
     return false;
 
+  // Hand off any downloads the GPU has already finished, so we only have to wait when the ring is full.
+  ProcessCompletedFramesPendingMap(lock);
   if (m_frames_pending_map >= NUM_FRAMES_IN_FLIGHT)
+  {
+    const Timer::Value start_time = Timer::GetCurrentValue();
     ProcessFramePendingMap(lock);
+    AddStall(start_time);
+  }
 
   PendingFrame& pf = m_pending_frames[m_pending_frames_pos];
 
@@ -269,7 +288,9 @@ bool MediaCaptureBase::DeliverVideoFrame(GPUTexture* stex)
   DebugAssert(pf.state != PendingFrame::State::NeedsMap);
   if (pf.state == PendingFrame::State::NeedsEncoding)
   {
+    const Timer::Value start_time = Timer::GetCurrentValue();
     m_frame_encoded_cv.wait(lock, [&pf]() { return pf.state == PendingFrame::State::Unused; });
+    AddStall(start_time);
   }
 
   if (!pf.tex || pf.tex->GetWidth() != static_cast<u32>(stex->GetWidth()) ||
@@ -324,6 +345,19 @@ void MediaCaptureBase::ProcessFramePendingMap(std::unique_lock<std::mutex>& lock
   m_frame_ready_cv.notify_one();
 }
 
+void MediaCaptureBase::ProcessCompletedFramesPendingMap(std::unique_lock<std::mutex>& lock)
+{
+  // Frames must be handed to the encoder in order, so stop at the first one still in flight.
+  while (m_frames_pending_map > 0 && m_pending_frames[m_frames_map_consume_pos].tex->IsCopyComplete())
+    ProcessFramePendingMap(lock);
+}
+
+void MediaCaptureBase::AddStall(Timer::Value start_time)
+{
+  m_stall_ticks.fetch_add(Timer::GetCurrentValue() - start_time, std::memory_order_relaxed);
+  m_stall_count.fetch_add(1, std::memory_order_relaxed);
+}
+
 void MediaCaptureBase::EncoderThreadEntryPoint()
 {
   Threading::SetNameOfCurrentThread("Media Capture Encoding");
@@ -465,6 +499,13 @@ bool MediaCaptureBase::InternalEndCapture(std::unique_lock<std::mutex>& lock, Er
 
   m_capturing.store(false, std::memory_order_release);
   StopEncoderThread(lock);
+
+  if (const u32 stall_count = m_stall_count.load(std::memory_order_relaxed); stall_count > 0)
+  {
+    INFO_LOG("Frame delivery stalled {} times for {:.2f}ms total.", stall_count,
+             Timer::ConvertValueToMilliseconds(m_stall_ticks.load(std::memory_order_relaxed)));
+  }
+
   return !had_error;
 }
 
@@ -488,6 +529,13 @@ void MediaCaptureBase::ClearState()
   m_audio_buffer.deallocate();
 
   m_encoding_error.store(false, std::memory_order_release);
+
+  m_stall_ticks.store(0, std::memory_order_relaxed);
+  m_stall_count.store(0, std::memory_order_relaxed);
+  m_last_stall_ticks = 0;
+  m_last_stall_count = 0;
+  m_stall_time = 0.0f;
+  m_stall_count_since_update = 0;
 }
 
 bool MediaCaptureBase::EndCapture(Error* error)
@@ -569,6 +617,23 @@ void MediaCaptureBase::UpdateCaptureThreadUsage(double pct_divider, double time_
   m_encoder_thread_usage = static_cast<float>(static_cast<double>(delta) * pct_divider);
   m_encoder_thread_time = static_cast<float>(static_cast<double>(delta) * time_divider);
   m_encoder_thread_last_time = time;
+
+  const u64 stall_ticks = m_stall_ticks.load(std::memory_order_relaxed);
+  const u32 stall_count = m_stall_count.load(std::memory_order_relaxed);
+  m_stall_time = static_cast<float>(Timer::ConvertValueToMilliseconds(stall_ticks - m_last_stall_ticks));
+  m_stall_count_since_update = stall_count - m_last_stall_count;
+  m_last_stall_ticks = stall_ticks;
+  m_last_stall_count = stall_count;
+}
+
+u32 MediaCaptureBase::GetCaptureStallCount() const
+{
+  return m_stall_count_since_update;
+}
+
+float MediaCaptureBase::GetCaptureStallTime() const
+{
+  return m_stall_time;
 }
 
 void MediaCaptureBase::Flush()
@@ -1854,6 +1919,8 @@ bool MediaCaptureMF::ProcessAudioPackets(s64 video_pts, Error* error)
   X(av_frame_get_buffer)                                                                                               \
   X(av_frame_free)                                                                                                     \
   X(av_frame_make_writable)                                                                                            \
+  X(av_frame_is_writable)                                                                                              \
+  X(av_frame_unref)                                                                                                    \
   X(av_strerror)                                                                                                       \
   X(av_reduce)                                                                                                         \
   X(av_dict_parse_string)                                                                                              \
@@ -2653,8 +2720,25 @@ bool MediaCaptureFFmpeg::SendFrame(const PendingFrame& pf, Error* error)
     source_pitch = -source_pitch;
   }
 
-  // In case a previous frame is still using the frame.
-  wrap_av_frame_make_writable(m_converted_video_frame);
+  // In case the encoder is still referencing the previous frame. Rather than av_frame_make_writable(), which would
+  // copy contents we're about to overwrite, give the frame a fresh buffer and let the encoder keep the old one.
+  if (!wrap_av_frame_is_writable(m_converted_video_frame))
+  {
+    const int format = m_converted_video_frame->format;
+    const int width = m_converted_video_frame->width;
+    const int height = m_converted_video_frame->height;
+    wrap_av_frame_unref(m_converted_video_frame);
+    m_converted_video_frame->format = format;
+    m_converted_video_frame->width = width;
+    m_converted_video_frame->height = height;
+
+    const int res = wrap_av_frame_get_buffer(m_converted_video_frame, 0);
+    if (res < 0) [[unlikely]]
+    {
+      SetAVError(error, "av_frame_get_buffer() for converted frame failed: ", res);
+      return false;
+    }
+  }
 
   m_sws_context = wrap_sws_getCachedContext(m_sws_context, source_width, source_height, m_video_pixel_format,
                                             m_converted_video_frame->width, m_converted_video_frame->height,
@@ -70,6 +70,11 @@ public:
   virtual float GetCaptureThreadTime() const = 0;
   virtual void UpdateCaptureThreadUsage(double pct_divider, double time_divider) = 0;
 
+  /// Returns the number of times, and total time in milliseconds, that frame delivery had to wait for a GPU download
+  /// or the encoder thread since the last usage update.
+  virtual u32 GetCaptureStallCount() const = 0;
+  virtual float GetCaptureStallTime() const = 0;
+
   virtual GPUTexture* GetRenderTexture() = 0;
   virtual bool DeliverVideoFrame(GPUTexture* stex) = 0;
   virtual bool DeliverAudioFrames(const s16* frames, u32 num_frames) = 0;
@@ -390,6 +390,7 @@ void MetalDevice::SetFeatures(FeatureMask disabled_features)
   m_features.timed_present = true;
   m_features.shader_cache = true;
   m_features.pipeline_cache = true;
+  m_features.concurrent_shader_compile = false;
   m_features.prefer_unused_textures = true;
 
   // Same feature bit for both.
@@ -1395,6 +1396,11 @@ void MetalDownloadTexture::Flush()
     dev.WaitForFenceCounter(m_copy_fence_counter);
 }
 
+bool MetalDownloadTexture::IsCopyComplete() const
+{
+  return (!m_needs_flush || MetalDevice::GetInstance().GetCompletedFenceCounter() >= m_copy_fence_counter);
+}
+
 #ifdef ENABLE_GPU_OBJECT_NAMES
 
 void MetalDownloadTexture::SetDebugName(std::string_view name)
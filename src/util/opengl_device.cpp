@@ -494,6 +494,7 @@ bool OpenGLDevice::CheckFeatures(FeatureMask disabled_features)
   m_features.timed_present = false;
 
   m_features.shader_cache = false;
+  m_features.concurrent_shader_compile = false; // needs the context current
 
   m_features.dxt_textures =
     (!(disabled_features & FEATURE_MASK_COMPRESSED_TEXTURES) && GLAD_GL_EXT_texture_compression_s3tc);
@@ -1039,6 +1039,16 @@ void OpenGLDownloadTexture::Flush()
   m_sync = {};
 }
 
+bool OpenGLDownloadTexture::IsCopyComplete() const
+{
+  if (!m_needs_flush || !m_sync)
+    return true;
+
+  GLint status = GL_UNSIGNALED;
+  glGetSynciv(m_sync, GL_SYNC_STATUS, 1, nullptr, &status);
+  return (status == GL_SIGNALED);
+}
+
 #ifdef ENABLE_GPU_OBJECT_NAMES
 
 void OpenGLDownloadTexture::SetDebugName(std::string_view name)
@@ -2485,6 +2485,7 @@ void VulkanDevice::SetFeatures(FeatureMask disabled_features, const VkPhysicalDe
   m_features.timed_present = false;
   m_features.shader_cache = true;
   m_features.pipeline_cache = true;
+  m_features.concurrent_shader_compile = true;
   m_features.prefer_unused_textures = true;
   m_features.raster_order_views =
     (!(disabled_features & FEATURE_MASK_RASTER_ORDER_VIEWS) && vk_features.fragmentStoresAndAtomics &&
@@ -1184,6 +1184,11 @@ void VulkanDownloadTexture::Flush()
   }
 }
 
+bool VulkanDownloadTexture::IsCopyComplete() const
+{
+  return (!m_needs_flush || VulkanDevice::GetInstance().GetCompletedFenceCounter() >= m_copy_fence_counter);
+}
+
 #ifdef ENABLE_GPU_OBJECT_NAMES
 
 void VulkanDownloadTexture::SetDebugName(std::string_view name)